@@ -7,6 +7,7 @@ LOCAL_MODULE := zxing_core
 LOCAL_CPPFLAGS += -std=c++11
 LOCAL_CFLAGS += -Wall
 LOCAL_CPPFLAGS += -Wno-missing-braces  # Seems to be a bug in clang https://llvm.org/bugs/show_bug.cgi?id=21629
+LOCAL_CPPFLAGS += -fconstexpr-steps=100000000  # GenericGF.cpp computes its tables at compile time
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/src
 LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)/src
@@ -17,6 +18,7 @@ COMMON_FILES :=	\
 	src/BitMatrix.cpp \
 	src/BitSource.cpp \
 	src/CharacterSetECI.cpp \
+	src/DecodeContext.cpp \
 	src/DecodeHints.cpp \
 	src/DecodeStatus.cpp \
 	src/GenericGF.cpp \
@@ -25,6 +27,7 @@ COMMON_FILES :=	\
 	src/GlobalHistogramBinarizer.cpp \
 	src/GridSampler.cpp \
 	src/HybridBinarizer.cpp \
+	src/LuminanceGridSampler.cpp \
 	src/LuminanceSource.cpp \
 	src/MultiFormatReader.cpp \
 	src/PerspectiveTransform.cpp \
@@ -35,7 +38,8 @@ COMMON_FILES :=	\
 	src/TextDecoder.cpp \
 	src/TextUtfEncoding.cpp \
 	src/WhiteRectDetector.cpp \
-	src/ZXBigInteger.cpp
+	src/ZXBigInteger.cpp \
+	src/ZXThreads.cpp
 
 AZTEC_FILES := \
 	src/aztec/AZDecoder.cpp \
@@ -44,6 +48,7 @@ AZTEC_FILES := \
 
 DATAMATRIX_FILES :=	\
 	src/datamatrix/DMBitMatrixParser.cpp \
+	src/datamatrix/DMCodewordLayout.cpp \
 	src/datamatrix/DMDataBlock.cpp \
 	src/datamatrix/DMDecoder.cpp \
 	src/datamatrix/DMDetector.cpp \
@@ -90,8 +95,8 @@ PDF417_FILES := \
 	src/pdf417/PDFDetectionResult.cpp \
 	src/pdf417/PDFDetectionResultColumn.cpp \
 	src/pdf417/PDFDetector.cpp \
+	src/pdf417/PDFErrorCorrection.cpp \
 	src/pdf417/PDFModulusGF.cpp \
-	src/pdf417/PDFModulusPoly.cpp \
 	src/pdf417/PDFReader.cpp \
 	src/pdf417/PDFScanningDecoder.cpp
 
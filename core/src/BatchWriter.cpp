@@ -0,0 +1,74 @@
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "BatchWriter.h"
+#include "BitMatrix.h"
+#include "ZXThreads.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+namespace ZXing {
+
+BatchWriter::BatchWriter(const EncodeFunction& encode) :
+	_encode(encode),
+	_threadCount(1)
+{
+}
+
+BatchWriter&
+BatchWriter::setThreadCount(int threadCount)
+{
+	_threadCount = threadCount;
+	return *this;
+}
+
+void
+BatchWriter::encode(const std::vector<std::wstring>& contents, const Sink& sink) const
+{
+	int count = static_cast<int>(contents.size());
+	std::atomic<int> next(0);
+	std::mutex sinkMutex;
+	std::exception_ptr error;
+
+	// The contents are handed out one at a time, so that the threads stay busy even if the sizes of
+	// the symbols differ a lot.
+	auto worker = [&]() {
+		BitMatrix symbol;
+		for (int i; (i = next++) < count;) {
+			try {
+				_encode(contents[i], symbol);
+				std::lock_guard<std::mutex> lock(sinkMutex);
+				sink(i, symbol);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(sinkMutex);
+				if (!error)
+					error = std::current_exception();
+				next = count;
+			}
+		}
+	};
+
+	RunOnThreads(_threadCount, count, worker);
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+} // ZXing
@@ -0,0 +1,70 @@
+#pragma once
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ZXing {
+
+class BitMatrix;
+
+/**
+* Encodes a batch of contents with the same writer settings, e.g. all the labels of a print job, and hands
+* the symbols to a sink. Any of the format writers can be used, e.g.
+*
+*   QRCode::Writer writer;
+*   BatchWriter batch([&writer](const std::wstring& contents, BitMatrix& output) { writer.encode(contents, 0, 0, output); });
+*   batch.setThreadCount(4).encode(labels, [](int index, const BitMatrix& symbol) { ... });
+*
+* The threads live for the whole batch, so the per thread caches of the encoders, e.g. the Reed-Solomon
+* generator polynomials, stay warm from one symbol to the next.
+*/
+class BatchWriter
+{
+public:
+	using EncodeFunction = std::function<void(const std::wstring& contents, BitMatrix& output)>;
+	using Sink = std::function<void(int index, const BitMatrix& symbol)>;
+
+	/**
+	* @param encode encodes one content, it is called from several threads at once if setThreadCount() is
+	* more than 1. The writers are safe for that, as their encode() is const.
+	*/
+	explicit BatchWriter(const EncodeFunction& encode);
+
+	/**
+	* Sets the number of threads to encode on, the calling one included. The default is 1. If the system
+	* cannot start that many, the batch is done by the ones it could start.
+	*/
+	BatchWriter& setThreadCount(int threadCount);
+
+	/**
+	* Encodes all contents and calls the sink with each symbol and the index of its content. The sink is
+	* never called concurrently. With one thread it is called in the order of the contents, otherwise in
+	* the order the symbols are done. The symbol is only valid during the call.
+	*
+	* If encoding a content or the sink throws, e.g. because a content does not fit into a symbol, the rest is
+	* skipped and the first exception is rethrown once all threads have stopped.
+	*/
+	void encode(const std::vector<std::wstring>& contents, const Sink& sink) const;
+
+private:
+	EncodeFunction _encode;
+	int _threadCount;
+};
+
+} // ZXing
@@ -22,6 +22,7 @@ namespace ZXing {
 
 class BitArray;
 class BitMatrix;
+class LuminanceSource;
 enum class DecodeStatus;
 
 /**
@@ -72,6 +73,13 @@ public:
 	*/
 	virtual std::shared_ptr<const BitMatrix> getBlackMatrix() const = 0;
 
+	/**
+	* @return the grayscale image this bitmap is binarized from, or null if there is none.
+	*/
+	virtual std::shared_ptr<const LuminanceSource> luminanceSource() const {
+		return nullptr;
+	}
+
 	/**
 	* @return Whether this bitmap can be cropped.
 	*/
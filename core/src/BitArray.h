@@ -220,6 +220,14 @@ public:
 		std::fill(_bits.begin(), _bits.end(), 0);
 	}
 
+	/**
+	* Gives the array the size size with all bits cleared, reusing the memory it already holds.
+	*/
+	void reset(int size) {
+		_size = size;
+		_bits.assign((size + 31) / 32, 0);
+	}
+
 	/**
 	* Efficient method to check if a range of bits is set, or not set.
 	*
@@ -53,8 +53,11 @@ BitMatrix::getRow(int y, BitArray& row) const
 	if (y < 0 || y >= _height) {
 		throw std::out_of_range("Requested row is outside the matrix");
 	}
-	if (row.size() != _width)
-		row = BitArray(_width);
+	if (row.size() != _width) {
+		// resize in place, so that a row buffer that is used again keeps its memory
+		row._size = _width;
+		row._bits.resize(_rowSize);
+	}
 	std::copy_n(_bits.begin() + y * _rowSize, _rowSize, row._bits.begin());
 }
 
@@ -69,6 +69,16 @@ public:
 
 	void copyTo(BitMatrix& other) const;
 
+	/**
+	* Gives the matrix the size width x height with all bits cleared, reusing the memory it already holds.
+	*/
+	void reset(int width, int height) {
+		_width = width;
+		_height = height;
+		_rowSize = (width + 31) / 32;
+		_bits.assign(_rowSize * _height, 0);
+	}
+
 	//void parse(const std::string& stringRepresentation, const std::string& setString, const std::string& unsetString);
 
 	/**
@@ -82,6 +92,13 @@ public:
 		return ((_bits.at(y * _rowSize + (x / 32)) >> (x & 0x1f)) & 1) != 0;
 	}
 
+	/**
+	* Same as get() but without bounds check, for hot loops that have validated their coordinates up front.
+	*/
+	bool getUnchecked(int x, int y) const {
+		return ((_bits[y * _rowSize + (x / 32)] >> (x & 0x1f)) & 1) != 0;
+	}
+
 	/**
 	* <p>Sets the given bit to true.</p>
 	*
@@ -106,6 +123,19 @@ public:
 		_bits.at(y * _rowSize + (x / 32)) ^= 1 << (x & 0x1f);
 	}
 
+	/**
+	* Exclusive-or (XOR): Flip the bits in row y for which the corresponding bit in mask is set.
+	*
+	* @param y The row to modify
+	* @param mask rowSize() words packed like the rows of this matrix, the bits beyond the width must be 0
+	*/
+	void flipRow(int y, const uint32_t* mask) {
+		auto row = _bits.begin() + y * _rowSize;
+		for (int i = 0; i < _rowSize; ++i) {
+			row[i] ^= mask[i];
+		}
+	}
+
 	void flipAll() {
 		for (auto& i : _bits) {
 			i = ~i;
@@ -0,0 +1,72 @@
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "DecodeContext.h"
+#include "ZXConfig.h"
+
+#include <algorithm>
+
+namespace ZXing {
+
+static const size_t MIN_BLOCK_SIZE = 16 * 1024;
+
+DecodeContext::DecodeContext()
+{
+}
+
+DecodeContext::~DecodeContext()
+{
+}
+
+void*
+DecodeContext::allocateBytes(size_t size, size_t alignment)
+{
+	// Look for the first block (starting at the current one) with enough space left. Blocks are only
+	// ever appended, so the memory handed out before stays valid until the owning Scope is closed.
+	for (; _block < _blocks.size(); ++_block, _offset = 0) {
+		size_t offset = (_offset + alignment - 1) & ~(alignment - 1);
+		if (offset + size <= _blocks[_block].size) {
+			_offset = offset + size;
+			return _blocks[_block].data.get() + offset;
+		}
+	}
+
+	// The blocks grow geometrically, so that the number of blocks stays small. Memory returned by
+	// new[] is suitably aligned for any fundamental type.
+	size_t blockSize = std::max(std::max(MIN_BLOCK_SIZE, size), 2 * capacity());
+	_blocks.push_back({std::unique_ptr<char[]>(new char[blockSize]), blockSize});
+	_block = _blocks.size() - 1;
+	_offset = size;
+	return _blocks.back().data.get();
+}
+
+size_t
+DecodeContext::capacity() const
+{
+	size_t result = 0;
+	for (auto& b : _blocks)
+		result += b.size;
+	return result;
+}
+
+DecodeContext&
+DecodeContext::ThreadLocal()
+{
+	ZX_THREAD_LOCAL DecodeContext context;
+	return context;
+}
+
+} // ZXing
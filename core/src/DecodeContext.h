@@ -0,0 +1,132 @@
+#pragma once
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace ZXing {
+
+/**
+* Scratch memory for the temporary buffers needed while decoding a symbol. The memory is kept between
+* decode calls, so that once the buffers have grown to the size required by the processed images, the
+* hot paths of the readers do not hit the heap anymore.
+*
+* There are two kinds of scratch memory:
+*  - allocate<T>(n) returns uninitialized memory for n trivial objects from a monotonic arena. The memory
+*    is released in LIFO order when the enclosing Scope ends.
+*  - scratch<T>() returns a default constructed object of type T owned by the context. It is meant for
+*    containers that keep their capacity between calls. The object is keyed by its type, hence callers
+*    should use a private struct to not share it accidentally with other users.
+*
+* A DecodeContext must not be used by more than one thread at a time. Use ThreadLocal() to get the
+* instance that is private to the calling thread.
+*/
+class DecodeContext
+{
+public:
+	/**
+	* Marks the current fill level of the arena and releases everything allocated after it on destruction.
+	*/
+	class Scope
+	{
+		DecodeContext& _context;
+		size_t _block;
+		size_t _offset;
+
+	public:
+		explicit Scope(DecodeContext& context) : _context(context), _block(context._block), _offset(context._offset) {}
+		~Scope() { _context._block = _block; _context._offset = _offset; }
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+	DecodeContext();
+	~DecodeContext();
+
+	DecodeContext(const DecodeContext&) = delete;
+	DecodeContext& operator=(const DecodeContext&) = delete;
+
+	template <typename T>
+	T* allocate(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destructed");
+		return static_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+	}
+
+	template <typename T>
+	T& scratch()
+	{
+		auto key = &TypeKey<T>::id;
+		for (auto& o : _objects)
+			if (o.key == key)
+				return static_cast<Holder<T>&>(*o.holder).value;
+		_objects.push_back({key, std::unique_ptr<HolderBase>(new Holder<T>())});
+		return static_cast<Holder<T>&>(*_objects.back().holder).value;
+	}
+
+	/**
+	* @return the total number of bytes reserved by the arena.
+	*/
+	size_t capacity() const;
+
+	static DecodeContext& ThreadLocal();
+
+private:
+	struct Block
+	{
+		std::unique_ptr<char[]> data;
+		size_t size;
+	};
+
+	struct HolderBase
+	{
+		virtual ~HolderBase() {}
+	};
+
+	template <typename T>
+	struct Holder : HolderBase
+	{
+		T value;
+	};
+
+	template <typename T>
+	struct TypeKey
+	{
+		static const char id;
+	};
+
+	struct Object
+	{
+		const void* key;
+		std::unique_ptr<HolderBase> holder;
+	};
+
+	void* allocateBytes(size_t size, size_t alignment);
+
+	std::vector<Block> _blocks;
+	size_t _block = 0;  // index of the block currently allocated from
+	size_t _offset = 0; // fill level of the current block
+	std::vector<Object> _objects;
+};
+
+template <typename T>
+const char DecodeContext::TypeKey<T>::id = 0;
+
+} // ZXing
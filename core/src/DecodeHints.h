@@ -18,10 +18,12 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 
 namespace ZXing {
 
 enum class BarcodeFormat;
+class GridSampler;
 //typedef std::function<void(float x, float y)> PointCallback;
 
 class DecodeHints
@@ -53,6 +55,21 @@ public:
 		setFlag(TRY_ROTATE, v);
 	}
 
+	/**
+	* For QR Code, Data Matrix and Aztec, read the modules of a detected symbol from the grayscale image
+	* instead of the binarized one, see LuminanceGridSampler. This helps with small symbols of only about
+	* 2 pixels per module. It takes precedence over gridSampler(). Off by default: where the detected grid
+	* is off by a fraction of a module at these sizes, the averaged footprint can lose a symbol that the
+	* center pixel still reads (e.g. test/blackbox/datamatrix-1/C40.png).
+	*/
+	bool shouldSampleLuminance() const {
+		return getFlag(SAMPLE_LUMINANCE);
+	}
+
+	void setShouldSampleLuminance(bool v) {
+		setFlag(SAMPLE_LUMINANCE, v);
+	}
+
 	/**
 	* Specifies what character encoding to use when decoding, where applicable.
 	*/
@@ -138,9 +155,24 @@ public:
 		_eanExts = extensions;
 	}
 
+	/**
+	* The sampler the readers of 2D barcodes use to read the modules of a detected symbol off the image.
+	* If not set, they use the one installed by the deprecated GridSampler::SetInstance(), or else
+	* GridSampler::Default(). Each reader keeps a reference to the sampler it was constructed with, so a
+	* sampler only has to be thread-safe if the readers sharing it are used concurrently.
+	*/
+	std::shared_ptr<const GridSampler> gridSampler() const {
+		return _gridSampler;
+	}
+
+	void setGridSampler(const std::shared_ptr<const GridSampler>& sampler) {
+		_gridSampler = sampler;
+	}
+
 private:
 	uint32_t _flags = 0;
 	std::string _charset;
+	std::shared_ptr<const GridSampler> _gridSampler;
 	//PointCallback _callback;
 	std::vector<int> _lengths;
 	std::vector<int> _eanExts;
@@ -152,6 +184,7 @@ private:
 		ASSUME_CODE_39_CHECK_DIGIT,
 		ASSUME_GS1,
 		RETURN_CODABAR_START_END,
+		SAMPLE_LUMINANCE,
 	};
 
 	bool getFlag(int f) const {
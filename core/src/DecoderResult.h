@@ -21,6 +21,7 @@
 #include <memory>
 #include <list>
 #include <string>
+#include <utility>
 
 namespace ZXing {
 
@@ -54,19 +55,23 @@ public:
 	DecoderResult(const DecoderResult &) = delete;
 	DecoderResult& operator=(const DecoderResult &) = delete;
 
-	const ByteArray& rawBytes() const { return _rawBytes; }
-	void setRawBytes(const ByteArray& bytes) { _rawBytes = bytes; _numBits = 8 * bytes.length(); }
+	// The && overloads hand the contents on to the Result without copying them.
+	const ByteArray& rawBytes() const & { return _rawBytes; }
+	ByteArray&& rawBytes() && { return std::move(_rawBytes); }
+	void setRawBytes(ByteArray bytes) { _rawBytes = std::move(bytes); _numBits = 8 * _rawBytes.length(); }
 	int numBits() const { return _numBits; }
 	void setNumBits(int numBits) { _numBits = numBits; }
 
-	const std::wstring& text() const { return _text; }
-	void setText(const std::wstring& txt) { _text = txt; }
+	const std::wstring& text() const & { return _text; }
+	std::wstring&& text() && { return std::move(_text); }
+	void setText(std::wstring txt) { _text = std::move(txt); }
 
-	const std::list<ByteArray>& byteSegments() const { return _byteSegments; }
-	void setByteSegments(const std::list<ByteArray>& segments) { _byteSegments = segments; }
+	const std::list<ByteArray>& byteSegments() const & { return _byteSegments; }
+	std::list<ByteArray>&& byteSegments() && { return std::move(_byteSegments); }
+	void setByteSegments(std::list<ByteArray> segments) { _byteSegments = std::move(segments); }
 
 	std::wstring ecLevel() const { return _ecLevel; }
-	void setEcLevel(const std::wstring& level) { _ecLevel = level; }
+	void setEcLevel(std::wstring level) { _ecLevel = std::move(level); }
 
 	int errorsCorrected() const { return _errorsCorrected; }
 	void setErrorsCorrected(int ec) { _errorsCorrected = ec; }
@@ -17,9 +17,11 @@
 */
 
 #include "ResultPoint.h"
+#include "GridSampler.h"
 
 #include <vector>
 #include <memory>
+#include <utility>
 
 namespace ZXing {
 
@@ -35,6 +37,7 @@ class BitMatrix;
 class DetectorResult
 {
 	std::shared_ptr<const BitMatrix> _bits;
+	UncertainModules _uncertainModules;
 	std::vector<ResultPoint> _points;
 
 public:
@@ -45,8 +48,12 @@ public:
 
 	std::shared_ptr<const BitMatrix> bits() const { return _bits; }
 	void setBits(const std::shared_ptr<const BitMatrix>& bits) { _bits = bits; }
-	const std::vector<ResultPoint>& points() const { return _points; }
-	void setPoints(const std::vector<ResultPoint>& points) { _points = points; }
+	// Computes the modules of bits() whose sampled value is unreliable on demand, see GridSampler.
+	const UncertainModules& uncertainModules() const { return _uncertainModules; }
+	void setUncertainModules(const UncertainModules& uncertain) { _uncertainModules = uncertain; }
+	const std::vector<ResultPoint>& points() const & { return _points; }
+	std::vector<ResultPoint>&& points() && { return std::move(_points); }
+	void setPoints(std::vector<ResultPoint> points) { _points = std::move(points); }
 	void setPoints(std::initializer_list<ResultPoint> list) { _points.assign(list); }
 };
 
@@ -16,100 +16,223 @@
 */
 
 #include "GenericGF.h"
+#include "ZXConstexprArray.h"
 
-#include <stdexcept>
+#include <array>
 
 namespace ZXing {
 
+namespace {
+
+/**
+* Generates the exp table 2^i for i in [0, 2 * (size - 1)] of GF(size) as a constant expression. The elements
+* are polynomials over GF(2) stored in the bits of an int, 'primitive' is the irreducible field polynomial.
+* The exp tables span two periods, so that the sum of two logs can be looked up directly.
+*/
+struct ExpTableEntry
+{
+	int primitive;
+	int size;
+
+	constexpr int timesTwo(int a) const {
+		return (a << 1) & size ? (a << 1) ^ primitive : a << 1;
+	}
+
+	constexpr int multiply(int a, int b) const {
+		return b == 0 ? 0 : ((b & 1) ? a : 0) ^ multiply(timesTwo(a), b >> 1);
+	}
+
+	constexpr int square(int a) const {
+		return multiply(a, a);
+	}
+
+	constexpr int power(int e) const {
+		return e == 0 ? 1 : e % 2 ? timesTwo(power(e - 1)) : square(power(e / 2));
+	}
+
+	constexpr int operator()(int i) const {
+		return power(i % (size - 1));
+	}
+};
+
+/**
+* Generates the log table of GF(size) as a constant expression. C++11 constexpr functions cannot invert the
+* exp table and searching it for every element would exceed the constexpr limits of the compilers, so the
+* logs are found with the Pohlig-Hellman method instead: the order n = 2^m - 1 of the multiplicative group
+* of the Aztec, QR and Data Matrix fields (m is even) is the product of the coprime A = 2^(m/2) - 1 and
+* B = 2^(m/2) + 1. x^B lies in the subgroup of order A generated by 2^B, where log(x) mod A is looked up,
+* and x^A in the subgroup of order B generated by 2^A, where log(x) mod B is looked up. The two remainders
+* are combined with the Chinese remainder theorem, where the inverse of B mod A and of A mod B is 2^(m/2-1).
+* Squaring is linear over GF(2), so it is done with a table of the squares of the nibbles.
+*/
+struct LogTableEntry
+{
+	static const int MAX_SUBGROUP_ORDER = 65; // 2^6 + 1 for GF(4096)
+	static const int NIBBLES = 3;
+
+	ExpTableEntry field;
+	int half; // 2^(m/2)
+	uint16_t squares[16 * NIBBLES]; // squares[16 * i + v] == (v * 16^i)^2
+	uint16_t lowOrder[MAX_SUBGROUP_ORDER]; // the subgroup of order half - 1, lowOrder[k] == 2^((half + 1) * k)
+	uint16_t highOrder[MAX_SUBGROUP_ORDER]; // the subgroup of order half + 1, highOrder[k] == 2^((half - 1) * k)
+
+	constexpr int square(int x) const {
+		return squares[x & 15] ^ squares[16 + (x >> 4 & 15)] ^ squares[32 + (x >> 8)];
+	}
+
+	// y == x^j, acc == x^(j - 1), j a power of 2, returns x^(half - 1) == x * x^2 * x^4 * ... * x^(half / 2)
+	constexpr int powerLow(int y, int j, int acc) const {
+		return j == half ? acc : powerLow(square(y), 2 * j, field.multiply(y, acc));
+	}
+
+	static constexpr int Find(const uint16_t* subgroup, int y, int k = 0) {
+		return subgroup[k] == y ? k : Find(subgroup, y, k + 1);
+	}
+
+	constexpr int combine(int modLow, int modHigh) const {
+		return (modLow * (half + 1) + modHigh * (half - 1)) * (half / 2) % (field.size - 1);
+	}
+
+	// xLow == x^(half - 1), x^(half + 1) == xLow * x^2
+	constexpr int log(int x, int xLow) const {
+		return combine(Find(lowOrder, field.multiply(square(x), xLow)), Find(highOrder, xLow));
+	}
+
+	constexpr int operator()(int x) const {
+		return x == 0 ? 0 : log(x, powerLow(square(x), 2, x)); // result[0] == 0 but this should never be used
+	}
+};
+
+constexpr int HalfBits(int size) {
+	return size <= 4 ? 1 : 1 + HalfBits(size / 4);
+}
+
+template <int... I, int... J>
+constexpr LogTableEntry MakeLogTableEntry(ExpTableEntry field, int half, ConstexprArray::Indexes<I...>, ConstexprArray::Indexes<J...>)
+{
+	return {field, half,
+			{static_cast<uint16_t>(field.square(J % 16 << J / 16 * 4) & (field.size - 1))...},
+			{static_cast<uint16_t>(field((half + 1) * I))...},
+			{static_cast<uint16_t>(field((half - 1) * I))...}};
+}
+
+constexpr LogTableEntry MakeLogTableEntry(ExpTableEntry field)
+{
+	return MakeLogTableEntry(field, 1 << HalfBits(field.size), ConstexprArray::MakeIndexes<LogTableEntry::MAX_SUBGROUP_ORDER>::type(),
+							 ConstexprArray::MakeIndexes<16 * LogTableEntry::NIBBLES>::type());
+}
+
+/**
+* Generates the row of the multiplication table of GF(256) for the element a.
+*/
+struct MulTableRow
+{
+	ExpTableEntry field;
+	int a;
+
+	constexpr int operator()(int b) const {
+		return field.multiply(a, b);
+	}
+};
+
+struct MulTableEntry
+{
+	ExpTableEntry field;
+
+	constexpr std::array<uint8_t, 256> operator()(int a) const {
+		return GenerateArray<uint8_t, 256>(MulTableRow{field, a});
+	}
+};
+
+template <int SIZE>
+using ExpTable = PlainArray<uint16_t, 2 * (SIZE - 1) + 1>;
+
+template <int SIZE>
+using LogTable = PlainArray<uint16_t, SIZE>;
+
+using MulTable = PlainArray<std::array<uint8_t, 256>, 256>;
+
+constexpr ExpTableEntry AZTEC_DATA_12_FIELD = {0x1069, 4096}; // x^12 + x^6 + x^5 + x^3 + 1
+constexpr ExpTableEntry AZTEC_DATA_10_FIELD = {0x409, 1024}; // x^10 + x^3 + 1
+constexpr ExpTableEntry AZTEC_DATA_6_FIELD = {0x43, 64}; // x^6 + x + 1
+constexpr ExpTableEntry AZTEC_PARAM_FIELD = {0x13, 16}; // x^4 + x + 1
+constexpr ExpTableEntry QR_CODE_FIELD_256_FIELD = {0x011D, 256}; // x^8 + x^4 + x^3 + x^2 + 1
+constexpr ExpTableEntry DATA_MATRIX_FIELD_256_FIELD = {0x012D, 256}; // x^8 + x^5 + x^3 + x^2 + 1
+
+// All tables are computed by the compiler and live in read-only memory. GF(4096) takes about two thirds of
+// GCC's default -fconstexpr-ops-limit, the build raises the lower limits of Clang and MSVC for this file.
+constexpr ExpTable<4096> AZTEC_DATA_12_EXP = GeneratePlainArray<uint16_t, 2 * 4095 + 1>(AZTEC_DATA_12_FIELD);
+constexpr ExpTable<1024> AZTEC_DATA_10_EXP = GeneratePlainArray<uint16_t, 2 * 1023 + 1>(AZTEC_DATA_10_FIELD);
+constexpr ExpTable<64> AZTEC_DATA_6_EXP = GeneratePlainArray<uint16_t, 2 * 63 + 1>(AZTEC_DATA_6_FIELD);
+constexpr ExpTable<16> AZTEC_PARAM_EXP = GeneratePlainArray<uint16_t, 2 * 15 + 1>(AZTEC_PARAM_FIELD);
+constexpr ExpTable<256> QR_CODE_FIELD_256_EXP = GeneratePlainArray<uint16_t, 2 * 255 + 1>(QR_CODE_FIELD_256_FIELD);
+constexpr ExpTable<256> DATA_MATRIX_FIELD_256_EXP = GeneratePlainArray<uint16_t, 2 * 255 + 1>(DATA_MATRIX_FIELD_256_FIELD);
+
+constexpr LogTable<4096> AZTEC_DATA_12_LOG = GeneratePlainArray<uint16_t, 4096>(MakeLogTableEntry(AZTEC_DATA_12_FIELD));
+constexpr LogTable<1024> AZTEC_DATA_10_LOG = GeneratePlainArray<uint16_t, 1024>(MakeLogTableEntry(AZTEC_DATA_10_FIELD));
+constexpr LogTable<64> AZTEC_DATA_6_LOG = GeneratePlainArray<uint16_t, 64>(MakeLogTableEntry(AZTEC_DATA_6_FIELD));
+constexpr LogTable<16> AZTEC_PARAM_LOG = GeneratePlainArray<uint16_t, 16>(MakeLogTableEntry(AZTEC_PARAM_FIELD));
+constexpr LogTable<256> QR_CODE_FIELD_256_LOG = GeneratePlainArray<uint16_t, 256>(MakeLogTableEntry(QR_CODE_FIELD_256_FIELD));
+constexpr LogTable<256> DATA_MATRIX_FIELD_256_LOG = GeneratePlainArray<uint16_t, 256>(MakeLogTableEntry(DATA_MATRIX_FIELD_256_FIELD));
+
+constexpr MulTable QR_CODE_FIELD_256_MUL = GeneratePlainArray<std::array<uint8_t, 256>, 256>(MulTableEntry{QR_CODE_FIELD_256_FIELD});
+constexpr MulTable DATA_MATRIX_FIELD_256_MUL = GeneratePlainArray<std::array<uint8_t, 256>, 256>(MulTableEntry{DATA_MATRIX_FIELD_256_FIELD});
+
+} // anonymous
+
+constexpr GenericGF GenericGF::AZTEC_DATA_12(4096, 1, AZTEC_DATA_12_EXP.values, AZTEC_DATA_12_LOG.values, nullptr);
+constexpr GenericGF GenericGF::AZTEC_DATA_10(1024, 1, AZTEC_DATA_10_EXP.values, AZTEC_DATA_10_LOG.values, nullptr);
+constexpr GenericGF GenericGF::AZTEC_DATA_6(64, 1, AZTEC_DATA_6_EXP.values, AZTEC_DATA_6_LOG.values, nullptr);
+constexpr GenericGF GenericGF::AZTEC_PARAM(16, 1, AZTEC_PARAM_EXP.values, AZTEC_PARAM_LOG.values, nullptr);
+constexpr GenericGF GenericGF::QR_CODE_FIELD_256(256, 0, QR_CODE_FIELD_256_EXP.values, QR_CODE_FIELD_256_LOG.values, QR_CODE_FIELD_256_MUL.values);
+constexpr GenericGF GenericGF::DATA_MATRIX_FIELD_256(256, 1, DATA_MATRIX_FIELD_256_EXP.values, DATA_MATRIX_FIELD_256_LOG.values, DATA_MATRIX_FIELD_256_MUL.values);
+
 const GenericGF &
 GenericGF::AztecData12()
 {
-	static GenericGF inst(0x1069, 4096, 1); // x^12 + x^6 + x^5 + x^3 + 1
-	return inst;
+	return AZTEC_DATA_12;
 }
 
 const GenericGF &
 GenericGF::AztecData10()
 {
-	static GenericGF inst(0x409, 1024, 1); // x^10 + x^3 + 1
-	return inst;
+	return AZTEC_DATA_10;
 }
 
 const GenericGF &
 GenericGF::AztecData6()
 {
-	static GenericGF inst(0x43, 64, 1); // x^6 + x + 1
-	return inst;
+	return AZTEC_DATA_6;
 }
 
 const GenericGF &
 GenericGF::AztecParam()
 {
-	static GenericGF inst(0x13, 16, 1); // x^4 + x + 1
-	return inst;
+	return AZTEC_PARAM;
 }
 
 const GenericGF &
 GenericGF::QRCodeField256()
 {
-	static GenericGF inst(0x011D, 256, 0); // x^8 + x^4 + x^3 + x^2 + 1
-	return inst;
+	return QR_CODE_FIELD_256;
 }
 
 const GenericGF &
 GenericGF::DataMatrixField256()
 {
-	static GenericGF inst(0x012D, 256, 1); // x^8 + x^5 + x^3 + x^2 + 1
-	return inst;
+	return DATA_MATRIX_FIELD_256;
 }
 
 const GenericGF &
 GenericGF::AztecData8()
 {
-	static GenericGF inst(0x012D, 256, 1); // = DATA_MATRIX_FIELD_256;
-	return inst;
+	return DATA_MATRIX_FIELD_256;
 }
 
 const GenericGF &
 GenericGF::MaxiCodeField64()
 {
-	static GenericGF inst(0x43, 64, 1); // = AZTEC_DATA_6;
-	return inst;
-}
-
-
-/**
-* Create a representation of GF(size) using the given primitive polynomial.
-*
-* @param primitive irreducible polynomial whose coefficients are represented by
-*  the bits of an int, where the least-significant bit represents the constant
-*  coefficient
-* @param size the size of the field
-* @param b the factor b in the generator polynomial can be 0- or 1-based
-*  (g(x) = (x+a^b)(x+a^(b+1))...(x+a^(b+2t-1))).
-*  In most cases it should be 1, but for QR code it is 0.
-*/
-GenericGF::GenericGF(int primitive, int size, int b) :
-	_size(size),
-	_generatorBase(b)
-{
-	_expTable.resize(size, 0);
-	_logTable.resize(size, 0);
-	int x = 1;
-	for (int i = 0; i < size; ++i)
-	{
-		_expTable[i] = x;
-		x *= 2; // we're assuming the generator alpha is 2
-		if (x >= size) {
-			x ^= primitive;
-			x &= size - 1;
-		}
-	}
-	for (int i = 0; i < size - 1; ++i)
-	{
-		_logTable[_expTable[i]] = i;
-	}
-	// logTable[0] == 0 but this should never be used
+	return AZTEC_DATA_6;
 }
 
 } // ZXing
@@ -18,8 +18,9 @@
 
 #include "GenericGFPoly.h"
 
+#include <array>
 #include <cassert>
-#include <vector>
+#include <cstdint>
 #include <stdexcept>
 
 namespace ZXing {
@@ -83,10 +84,11 @@ public:
 	}
 
 	/**
-	* @return 2 to the power of a in GF(size)
+	* @return 2 to the power of a in GF(size), a must be in [0, 2 * (size - 1)]
 	*/
 	int exp(int a) const {
-		return _expTable.at(a);
+		assert(a >= 0 && a <= 2 * (_size - 1));
+		return _expTable[a];
 	}
 
 	/**
@@ -116,10 +118,17 @@ public:
 		if (a == 0 || b == 0) {
 			return 0;
 		}
-		return _expTable[(_logTable[a] + _logTable[b]) % (_size - 1)];
+		return _expTable[_logTable[a] + _logTable[b]];
+	}
+
+	/**
+	* @return the row of the full multiplication table for a, i.e. multiplicationTable(a)[b] == multiply(a, b),
+	* or nullptr if the field keeps no such table (only the GF(256) fields do).
+	*/
+	const uint8_t* multiplicationTable(int a) const {
+		return _mulTable != nullptr ? _mulTable[a].data() : nullptr;
 	}
 
-	
 	int size() const {
 		return _size;
 	}
@@ -131,21 +140,31 @@ public:
 private:
 	int _size;
 	int _generatorBase;
-	std::vector<int> _expTable;
-	std::vector<int> _logTable;
+	const uint16_t* _expTable; // 2 * (size - 1) + 1 entries, so that the sum of two logs needs no modulo
+	const uint16_t* _logTable;
+	const std::array<uint8_t, 256>* _mulTable; // 256 rows for the GF(256) fields, nullptr for the others
 
 	/**
-	* Create a representation of GF(size) using the given primitive polynomial.
+	* Create a representation of GF(size) from its precomputed tables.
 	*
-	* @param primitive irreducible polynomial whose coefficients are represented by
-	*  the bits of an int, where the least-significant bit represents the constant
-	*  coefficient
 	* @param size the size of the field
 	* @param b the factor b in the generator polynomial can be 0- or 1-based
 	*  (g(x) = (x+a^b)(x+a^(b+1))...(x+a^(b+2t-1))).
 	*  In most cases it should be 1, but for QR code it is 0.
+	* @param expTable 2^i for i in [0, 2 * (size - 1)], the generator alpha is 2
+	* @param logTable the inverse of expTable for the non-zero elements
+	* @param mulTable the products of all pairs of elements or nullptr
 	*/
-	GenericGF(int primitive, int size, int b);
+	constexpr GenericGF(int size, int b, const uint16_t* expTable, const uint16_t* logTable, const std::array<uint8_t, 256>* mulTable)
+		: _size(size), _generatorBase(b), _expTable(expTable), _logTable(logTable), _mulTable(mulTable) {}
+
+	// The fields, constant initialized from tables computed at compile time, see GenericGF.cpp
+	static const GenericGF AZTEC_DATA_12;
+	static const GenericGF AZTEC_DATA_10;
+	static const GenericGF AZTEC_DATA_6;
+	static const GenericGF AZTEC_PARAM;
+	static const GenericGF QR_CODE_FIELD_256;
+	static const GenericGF DATA_MATRIX_FIELD_256;
 };
 
 } // ZXing
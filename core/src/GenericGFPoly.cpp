@@ -147,22 +147,29 @@ GenericGFPoly::divide(const GenericGFPoly& other, GenericGFPoly& quotient)
 
 	_field->setZero(quotient);
 	auto& remainder = *this;
+	if (remainder.degree() < other.degree() || remainder.isZero()) {
+		return *this;
+	}
 
 	int denominatorLeadingTerm = other.coefficient(other.degree());
 	int inverseDenominatorLeadingTerm = _field->inverse(denominatorLeadingTerm);
 
-	ZX_THREAD_LOCAL GenericGFPoly temp;
+	// The quotient and remainder are updated in place, the quotient terms are written
+	// directly and the scaled divisor is subtracted from the leading remainder terms.
+	quotient._coefficients.resize(remainder.degree() - other.degree() + 1, 0);
+	auto& otherCoefs = other._coefficients;
 
 	while (remainder.degree() >= other.degree() && !remainder.isZero()) {
 		int degreeDifference = remainder.degree() - other.degree();
 		int scale = _field->multiply(remainder.coefficient(remainder.degree()), inverseDenominatorLeadingTerm);
-		_field->setMonomial(temp, degreeDifference, scale);
-		quotient.addOrSubtract(temp);
-		temp = other;
-		temp.multiplyByMonomial(degreeDifference, scale);
-		remainder.addOrSubtract(temp);
+		quotient._coefficients[quotient._coefficients.size() - 1 - degreeDifference] = scale;
+		for (size_t i = 0; i < otherCoefs.size(); ++i) {
+			_coefficients[i] = _field->addOrSubtract(_coefficients[i], _field->multiply(otherCoefs[i], scale));
+		}
+		normalize();
 	}
 
+	quotient.normalize();
 	return *this;
 }
 
@@ -16,8 +16,6 @@
 * limitations under the License.
 */
 
-#include "ZXConfig.h"
-
 #include <cassert>
 #include <vector>
 #include <utility>
@@ -96,6 +94,23 @@ public:
 		*this = other;
 	}
 
+	/**
+	* Re-initializes this polynomial, reusing the already allocated memory.
+	*
+	* @param field the {@link GenericGF} instance representing the field to use
+	* @param coefficients as in the constructor above, from most significant coefficient to least significant
+	* @param count number of coefficients
+	*/
+	GenericGFPoly& setCoefficients(const GenericGF& field, const int* coefficients, size_t count)
+	{
+		assert(count > 0);
+		_field = &field;
+		_coefficients.resize(count);
+		std::copy_n(coefficients, count, _coefficients.begin());
+		normalize();
+		return *this;
+	}
+
 	const std::vector<int>& coefficients() const {
 		return _coefficients;
 	}
@@ -21,9 +21,20 @@
 #include "ByteArray.h"
 
 #include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
 
 namespace ZXing {
 
+// Rotations by 90 and 270 degrees are done tile by tile, so that the reads as well as the transposed
+// writes stay within a small number of cache lines. Walking the destination column by column instead
+// touches a new cache line for every single pixel on large images.
+static const int ROTATION_TILE_SIZE = 16;
+
+// Number of rotated rows (i.e. original columns) that RotatedLuminanceSource extracts at once.
+static const int ROTATION_STRIP_SIZE = 8;
+
 inline static uint8_t RGBToGray(unsigned r, unsigned g, unsigned b)
 {
 	// This optimization is not necessary as the computation below is cheap enough.
@@ -50,14 +61,206 @@ static std::shared_ptr<ByteArray> MakeCopy(const void* src, int rowBytes, int le
 	return result;
 }
 
-static std::shared_ptr<ByteArray> MakeCopy(const ByteArray& pixels, int rowBytes, int left, int top, int width, int height)
+/**
+* Writes the 'width' x 'height' pixels starting at 'src' rotated by 'degreeCW' (90, 180 or 270) to 'dest',
+* which is tightly packed with the dimensions of the rotated image.
+*/
+static void RotatePixels(const uint8_t* src, int srcRowBytes, int width, int height, int degreeCW, uint8_t* dest)
 {
-	if (top == 0 && left == 0 && width * height == (int)pixels.size()) {
-		return std::make_shared<ByteArray>(pixels);
+	if (degreeCW == 180) {
+		// same as a vertical flip followed a horizonal flip
+		uint8_t* destRow = dest + width * height;
+		for (int y = 0; y < height; ++y, src += srcRowBytes) {
+			destRow -= width;
+			std::reverse_copy(src, src + width, destRow);
+		}
+		return;
+	}
+
+	for (int ty = 0; ty < height; ty += ROTATION_TILE_SIZE) {
+		int tyEnd = std::min(ty + ROTATION_TILE_SIZE, height);
+		for (int tx = 0; tx < width; tx += ROTATION_TILE_SIZE) {
+			int txEnd = std::min(tx + ROTATION_TILE_SIZE, width);
+			for (int y = ty; y < tyEnd; ++y) {
+				const uint8_t* srcRow = src + y * srcRowBytes;
+				if (degreeCW == 90) {
+					uint8_t* destCol = dest + (height - y - 1);
+					for (int x = tx; x < txEnd; ++x)
+						destCol[x * height] = srcRow[x];
+				}
+				else {
+					uint8_t* destCol = dest + y;
+					for (int x = tx; x < txEnd; ++x)
+						destCol[(width - x - 1) * height] = srcRow[x];
+				}
+			}
+		}
 	}
-	return MakeCopy(pixels.data(), rowBytes, left, top, width, height);
 }
 
+namespace {
+
+/**
+* A lazily rotated view of the pixels of a GenericLuminanceSource. Rows are extracted on demand from the
+* columns of the original image, so that a 1D reader scanning a few rows of a rotated image does not
+* have to pay for a full-frame copy. For 90 and 270 degrees, a strip of ROTATION_STRIP_SIZE neighboring
+* columns is extracted at once and cached, since the original pixels are read row by row anyway.
+* A strip is never modified after it has been filled, so getRow() only synchronizes on its first use.
+* The full rotated image is only materialized once getMatrix() or cropped() gets called.
+*/
+class RotatedLuminanceSource : public LuminanceSource
+{
+	struct Strip
+	{
+		std::once_flag once;
+		ByteArray pixels;
+	};
+
+	struct DataCache
+	{
+		std::once_flag once;
+		std::shared_ptr<const ByteArray> pixels;
+		std::vector<Strip> strips;
+
+		explicit DataCache(int stripCount) : strips(stripCount) {}
+	};
+
+	std::shared_ptr<const ByteArray> _pixels;
+	int _left;
+	int _top;
+	int _width;  // of the original (unrotated) image
+	int _height; // of the original (unrotated) image
+	int _rowBytes;
+	int _degreeCW;
+	std::unique_ptr<DataCache> _cache;
+
+	const uint8_t* origin() const
+	{
+		return _pixels->data() + _top * _rowBytes + _left;
+	}
+
+	static void InitPixels(const RotatedLuminanceSource& self, std::shared_ptr<const ByteArray>& outPixels)
+	{
+		auto pixels = std::make_shared<ByteArray>(self._width * self._height);
+		RotatePixels(self.origin(), self._rowBytes, self._width, self._height, self._degreeCW, pixels->data());
+		outPixels = pixels;
+	}
+
+	const ByteArray& rotatedPixels() const
+	{
+		std::call_once(_cache->once, &InitPixels, std::cref(*this), std::ref(_cache->pixels));
+		return *_cache->pixels;
+	}
+
+	// Fills 'strip' with the rotated rows [first, first + ROTATION_STRIP_SIZE), i.e. with the corresponding columns.
+	void fillStrip(ByteArray& pixels, int first) const
+	{
+		int count = std::min(ROTATION_STRIP_SIZE, _width - first);
+		// rotated row r is column r (bottom to top) for 90 degrees and column width-1-r (top to bottom) for 270
+		int firstCol = _degreeCW == 90 ? first : _width - first - count;
+		pixels.resize(count * _height);
+		const uint8_t* srcRow = origin() + firstCol;
+		for (int y = 0; y < _height; ++y, srcRow += _rowBytes) {
+			for (int i = 0; i < count; ++i) {
+				if (_degreeCW == 90)
+					pixels[i * _height + (_height - y - 1)] = srcRow[i];
+				else
+					pixels[(count - i - 1) * _height + y] = srcRow[i];
+			}
+		}
+	}
+
+public:
+	RotatedLuminanceSource(const std::shared_ptr<const ByteArray>& pixels, int left, int top, int width, int height, int rowBytes, int degreeCW) :
+		_pixels(pixels),
+		_left(left),
+		_top(top),
+		_width(width),
+		_height(height),
+		_rowBytes(rowBytes),
+		_degreeCW(degreeCW),
+		_cache(new DataCache(degreeCW == 180 ? 0 : (width + ROTATION_STRIP_SIZE - 1) / ROTATION_STRIP_SIZE))
+	{
+	}
+
+	virtual int width() const override
+	{
+		return _degreeCW == 180 ? _width : _height;
+	}
+
+	virtual int height() const override
+	{
+		return _degreeCW == 180 ? _height : _width;
+	}
+
+	virtual const uint8_t* getRow(int y, ByteArray& buffer, bool forceCopy) const override
+	{
+		if (y < 0 || y >= height()) {
+			throw std::out_of_range("Requested row is outside the image");
+		}
+
+		int rowLength = width();
+		if (_degreeCW == 180) {
+			// the row has to be reversed, so it is always copied
+			buffer.resize(rowLength);
+			const uint8_t* srcRow = origin() + (_height - y - 1) * _rowBytes;
+			std::reverse_copy(srcRow, srcRow + _width, buffer.begin());
+			return buffer.data();
+		}
+
+		int first = y - y % ROTATION_STRIP_SIZE;
+		Strip& strip = _cache->strips[y / ROTATION_STRIP_SIZE];
+		std::call_once(strip.once, &RotatedLuminanceSource::fillStrip, this, std::ref(strip.pixels), first);
+		const uint8_t* row = strip.pixels.data() + (y - first) * _height;
+		if (!forceCopy) {
+			return row;
+		}
+		buffer.resize(rowLength);
+		std::copy_n(row, rowLength, buffer.begin());
+		return buffer.data();
+	}
+
+	virtual const uint8_t* getMatrix(ByteArray& buffer, int& outRowBytes, bool forceCopy) const override
+	{
+		const ByteArray& pixels = rotatedPixels();
+		outRowBytes = width();
+		if (!forceCopy) {
+			return pixels.data();
+		}
+		buffer = pixels;
+		return buffer.data();
+	}
+
+	virtual bool canCrop() const override
+	{
+		return true;
+	}
+
+	virtual std::shared_ptr<LuminanceSource> cropped(int left, int top, int width, int height) const override
+	{
+		if (left < 0 || top < 0 || width < 0 || height < 0 || left + width > this->width() || top + height > this->height()) {
+			throw std::out_of_range("Crop rectangle does not fit within image data.");
+		}
+		rotatedPixels();
+		return std::make_shared<GenericLuminanceSource>(left, top, width, height, _cache->pixels, this->width());
+	}
+
+	virtual bool canRotate() const override
+	{
+		return true;
+	}
+
+	virtual std::shared_ptr<LuminanceSource> rotated(int degreeCW) const override
+	{
+		// rotate the original pixels instead of rotating the rotation
+		GenericLuminanceSource original(_left, _top, _width, _height, _pixels, _rowBytes);
+		return original.rotated(_degreeCW + degreeCW);
+	}
+
+}; // RotatedLuminanceSource
+
+} // anonymous
+
 GenericLuminanceSource::GenericLuminanceSource(int left, int top, int width, int height, const void* bytes, int rowBytes, int pixelBytes, int redIndex, int greenIndex, int blueIndex) :
 	_left(0),	// since we copy the pixels
 	_top(0),
@@ -184,37 +387,11 @@ std::shared_ptr<LuminanceSource>
 GenericLuminanceSource::rotated(int degreeCW) const
 {
 	degreeCW = (degreeCW + 360) % 360;
-	if (degreeCW == 90)
-	{
-		auto pixels = std::make_shared<ByteArray>(_width * _height);
-		const uint8_t* srcRow = _pixels->data() + _top * _rowBytes + _left;
-		uint8_t* dest = pixels->data();
-		for (int y = 0; y < _height; ++y, srcRow += _rowBytes) {
-			for (int x = 0; x < _width; ++x) {
-				dest[x * _height + (_height - y - 1)] = srcRow[x];
-			}
-		}
-		return std::make_shared<GenericLuminanceSource>(0, 0, _height, _width, pixels, _height);
-	}
-	else if (degreeCW == 180) {
-		// same as a vertical flip followed a horizonal flip
-		auto pixels = MakeCopy(*_pixels, _rowBytes, _left, _top, _width, _height);
-		std::reverse(pixels->begin(), pixels->end());
-		return std::make_shared<GenericLuminanceSource>(0, 0, _width, _height, pixels, _width);
-	}
-	else if (degreeCW == 270) {
-		auto pixels = std::make_shared<ByteArray>(_width * _height);
-		const uint8_t* srcRow = _pixels->data() + _top * _rowBytes + _left;
-		uint8_t* dest = pixels->data();
-		for (int y = 0; y < _height; ++y, srcRow += _rowBytes) {
-			for (int x = 0; x < _width; ++x) {
-				dest[(_width - x - 1) * _height + y] = srcRow[x];
-			}
-		}
-		return std::make_shared<GenericLuminanceSource>(0, 0, _height, _width, pixels, _height);
+	if (degreeCW == 90 || degreeCW == 180 || degreeCW == 270) {
+		return std::make_shared<RotatedLuminanceSource>(_pixels, _left, _top, _width, _height, _rowBytes, degreeCW);
 	}
 	else if (degreeCW == 0) {
-		return std::make_shared<GenericLuminanceSource>(0, 0, _width, _height, _pixels, _width);
+		return std::make_shared<GenericLuminanceSource>(_left, _top, _width, _height, _pixels, _rowBytes);
 	}
 	throw std::invalid_argument("Unsupported rotation");
 }
@@ -61,6 +61,11 @@ public:
 	virtual bool canCrop() const override;
 	virtual std::shared_ptr<LuminanceSource> cropped(int left, int top, int width, int height) const override;
 	virtual bool canRotate() const override;
+
+	/**
+	* Returns a lazily rotated view of the pixels. Rows of the rotated image are extracted on demand,
+	* the full rotated image is only created by getMatrix() or cropped().
+	*/
 	virtual std::shared_ptr<LuminanceSource> rotated(int degreeCW) const override;
 
 private:
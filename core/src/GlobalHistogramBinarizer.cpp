@@ -67,6 +67,12 @@ GlobalHistogramBinarizer::height() const
 	return _source->height();
 }
 
+std::shared_ptr<const LuminanceSource>
+GlobalHistogramBinarizer::luminanceSource() const
+{
+	return _source;
+}
+
 
 // Return -1 on error
 static int EstimateBlackPoint(const std::array<int, LUMINANCE_BUCKETS>& buckets)
@@ -121,10 +127,7 @@ DecodeStatus
 GlobalHistogramBinarizer::getBlackRow(int y, BitArray& row) const
 {
 	int width = _source->width();
-	if (row.size() != width)
-		row = BitArray(width);
-	else
-		row.clearBits();
+	row.reset(width);
 
 	ByteArray buffer;
 	const uint8_t* luminances = _source->getRow(y, buffer);
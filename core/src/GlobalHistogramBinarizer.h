@@ -48,6 +48,7 @@ public:
 	virtual int height() const override;
 	virtual DecodeStatus getBlackRow(int y, BitArray& outArray) const override;
 	virtual std::shared_ptr<const BitMatrix> getBlackMatrix() const override;
+	virtual std::shared_ptr<const LuminanceSource> luminanceSource() const override;
 	virtual bool canCrop() const override;
 	virtual std::shared_ptr<BinaryBitmap> cropped(int left, int top, int width, int height) const override;
 	virtual bool canRotate() const override;
@@ -16,14 +16,26 @@
 */
 
 #include "GridSampler.h"
+#include "LuminanceGridSampler.h"
+#include "BinaryBitmap.h"
 #include "PerspectiveTransform.h"
 #include "BitMatrix.h"
 #include "DecodeStatus.h"
+#include "DecodeContext.h"
+
+#include <algorithm>
+#include <stdexcept>
 
 namespace ZXing {
 
 namespace {
 
+// The matrix of the last UncertainModules::operator() call, kept in the DecodeContext so that its memory gets reused.
+struct UncertainScratch
+{
+	std::shared_ptr<BitMatrix> uncertain;
+};
+
 /**
 * <p>Checks a set of points that have been transformed to sample points on an image against
 * the image's dimensions to see if the point are even within the image.</p>
@@ -37,15 +49,16 @@ namespace {
 *
 * @param image image into which the points should map
 * @param points actual points in x1,y1,...,xn,yn form
+* @param count number of floats in points
 * @throws NotFoundException if an endpoint is lies outside the image boundaries
 */
-static DecodeStatus CheckAndNudgePoints(const BitMatrix& image, std::vector<float>& points)
+static DecodeStatus CheckAndNudgePoints(const BitMatrix& image, float* points, int count)
 {
 	int width = image.width();
 	int height = image.height();
 	// Check and nudge points from start until we see some that are OK:
 	bool nudged = true;
-	for (size_t offset = 0; offset < points.size() && nudged; offset += 2) {
+	for (int offset = 0; offset < count && nudged; offset += 2) {
 		int x = (int)points[offset];
 		int y = (int)points[offset + 1];
 		if (x < -1 || x > width || y < -1 || y > height) {
@@ -71,7 +84,7 @@ static DecodeStatus CheckAndNudgePoints(const BitMatrix& image, std::vector<floa
 	}
 	// Check and nudge points from end:
 	nudged = true;
-	for (int offset = int(points.size()) - 2; offset >= 0 && nudged; offset -= 2) {
+	for (int offset = count - 2; offset >= 0 && nudged; offset -= 2) {
 		int x = (int)points[offset];
 		int y = (int)points[offset + 1];
 		if (x < -1 || x > width || y < -1 || y > height) {
@@ -98,6 +111,83 @@ static DecodeStatus CheckAndNudgePoints(const BitMatrix& image, std::vector<floa
 	return DecodeStatus::NoError;
 }
 
+/**
+* Samples the grid with a full evaluation of the transform per point and bounds checked access to the image.
+* Used for the transforms that IsGridInsideImage() can not vouch for.
+*/
+static DecodeStatus SampleGridChecked(const BitMatrix& image, int dimensionX, int dimensionY, const PerspectiveTransform& transform, BitMatrix& result)
+{
+	int max = 2 * dimensionX;
+	auto& context = DecodeContext::ThreadLocal();
+	DecodeContext::Scope scope(context);
+	float* points = context.allocate<float>(max);
+	for (int y = 0; y < dimensionY; y++) {
+		float iValue = (float)y + 0.5f;
+		for (int x = 0; x < max; x += 2) {
+			points[x] = static_cast<float>(x / 2) + 0.5f;
+			points[x + 1] = iValue;
+		}
+		transform.transformPoints(points, max);
+		// Quick check to see if points transformed to something inside the image;
+		// sufficient to check the endpoints
+		CheckAndNudgePoints(image, points, max);
+		try {
+			for (int x = 0; x < max; x += 2) {
+				if (image.get(static_cast<int>(points[x]), static_cast<int>(points[x + 1]))) {
+					// Black(-ish) pixel
+					result.set(x / 2, y);
+				}
+			}
+		}
+		catch (const std::out_of_range&) {
+			// This feels wrong, but, sometimes if the finder patterns are misidentified, the resulting
+			// transform gets "twisted" such that it maps a straight line of points to a set of points
+			// whose endpoints are in bounds, but others are not. There is probably some mathematical
+			// way to detect this about the transformation that I don't know yet.
+			// This results in an ugly runtime exception despite our clever checks above -- can't have
+			// that. We could check each point's coordinates but that feels duplicative. We settle for
+			// catching and wrapping ArrayIndexOutOfBoundsException.
+			return DecodeStatus::NotFound;
+		}
+	}
+	return DecodeStatus::NoError;
+}
+
+/**
+* Checks up front whether all module centers of the grid map into the image, give or take the one pixel
+* by which CheckAndNudgePoints() moves the endpoints of a row. If the grid is entirely on one side of the
+* vanishing line of the transform, its image is the convex quadrilateral spanned by the images of the corner
+* modules and checking those four points suffices. The "twisted" transforms mentioned in SampleGridChecked()
+* are the ones where this does not hold. They are recognized by the image of the corners not turning the
+* same way at every corner, which is the case if and only if the denominator of the transform differs in
+* sign between the corners.
+*/
+static bool IsGridInsideImage(const BitMatrix& image, int dimensionX, int dimensionY, const PerspectiveTransform& transform)
+{
+	float xs[4], ys[4];
+	transform.transformLine(0.5f, 0.5f, static_cast<float>(dimensionX - 1), 2, xs, ys);
+	transform.transformLine(0.5f, static_cast<float>(dimensionY) - 0.5f, static_cast<float>(dimensionX - 1), 2, xs + 2, ys + 2);
+	// reorder to walk around the quadrilateral
+	std::swap(xs[2], xs[3]);
+	std::swap(ys[2], ys[3]);
+
+	float width = static_cast<float>(image.width());
+	float height = static_cast<float>(image.height());
+	float turn = 0;
+	for (int i = 0; i < 4; ++i) {
+		// written such that NaNs fail as well
+		if (!(xs[i] >= -1 && xs[i] < width + 1 && ys[i] >= -1 && ys[i] < height + 1))
+			return false;
+		int j = (i + 1) % 4, k = (i + 2) % 4;
+		float cross = (xs[j] - xs[i]) * (ys[k] - ys[j]) - (ys[j] - ys[i]) * (xs[k] - xs[j]);
+		if (i == 0)
+			turn = cross;
+		if (!(cross * turn > 0))
+			return false;
+	}
+	return true;
+}
+
 class DefaultGridSampler : public GridSampler
 {
 public:
@@ -119,56 +209,160 @@ public:
 		if (dimensionX <= 0 || dimensionY <= 0) {
 			return DecodeStatus::NotFound;
 		}
-		result = BitMatrix(dimensionX, dimensionY);
-		int max = 2 * dimensionX;
-		std::vector<float> points(max);
+		// Reuse the memory of the caller's matrix, it is the only allocation left here.
+		result.reset(dimensionX, dimensionY);
+		if (!IsGridInsideImage(image, dimensionX, dimensionY, transform)) {
+			return SampleGridChecked(image, dimensionX, dimensionY, transform, result);
+		}
+
+		// All points are known to be at most one pixel off the image, so clamping them is all the checking needed.
+		int maxX = image.width() - 1;
+		int maxY = image.height() - 1;
+		auto& context = DecodeContext::ThreadLocal();
+		DecodeContext::Scope scope(context);
+		float* xs = context.allocate<float>(dimensionX);
+		float* ys = context.allocate<float>(dimensionX);
+		uint32_t* row = context.allocate<uint32_t>(result.rowSize());
 		for (int y = 0; y < dimensionY; y++) {
-			float iValue = (float)y + 0.5f;
-			for (int x = 0; x < max; x += 2) {
-				points[x] = static_cast<float>(x / 2) + 0.5f;
-				points[x + 1] = iValue;
-			}
-			transform.transformPoints(points.data(), max);
-			// Quick check to see if points transformed to something inside the image;
-			// sufficient to check the endpoints
-			CheckAndNudgePoints(image, points);
-			try {
-				for (int x = 0; x < max; x += 2) {
-					if (image.get(static_cast<int>(points[x]), static_cast<int>(points[x + 1]))) {
-						// Black(-ish) pixel
-						result.set(x / 2, y);
-					}
-				}
-			}
-			catch (const std::out_of_range aioobe) {
-				// This feels wrong, but, sometimes if the finder patterns are misidentified, the resulting
-				// transform gets "twisted" such that it maps a straight line of points to a set of points
-				// whose endpoints are in bounds, but others are not. There is probably some mathematical
-				// way to detect this about the transformation that I don't know yet.
-				// This results in an ugly runtime exception despite our clever checks above -- can't have
-				// that. We could check each point's coordinates but that feels duplicative. We settle for
-				// catching and wrapping ArrayIndexOutOfBoundsException.
-				return DecodeStatus::NotFound;
+			transform.transformLine(0.5f, static_cast<float>(y) + 0.5f, 1.0f, dimensionX, xs, ys);
+			// Collect the row in words (without branching on the pixels, which are as good as random), then
+			// flip the bits of the still empty row of the result.
+			std::fill_n(row, result.rowSize(), 0);
+			for (int x = 0; x < dimensionX; x++) {
+				int ix = std::min(std::max(static_cast<int>(xs[x]), 0), maxX);
+				int iy = std::min(std::max(static_cast<int>(ys[x]), 0), maxY);
+				row[x / 32] |= static_cast<uint32_t>(image.getUnchecked(ix, iy)) << (x & 0x1f);
 			}
+			result.flipRow(y, row);
 		}
 		return DecodeStatus::NoError;
 	}
+
+	virtual void findUncertainModules(const BitMatrix& image, int dimensionX, int dimensionY, const PerspectiveTransform& transform, BitMatrix& uncertain) const override
+	{
+		uncertain.reset(0, 0);
+		if (dimensionX <= 0 || dimensionY <= 0) {
+			return;
+		}
+
+		float width = static_cast<float>(image.width());
+		float height = static_cast<float>(image.height());
+		int maxX = image.width() - 1;
+		int maxY = image.height() - 1;
+		auto isInside = [width, height](float x, float y) { return x >= 0 && x < width && y >= 0 && y < height; };
+		auto markUncertain = [&uncertain, dimensionX, dimensionY](int x, int y) {
+			if (uncertain.width() == 0)
+				uncertain.reset(dimensionX, dimensionY);
+			uncertain.set(x, y);
+		};
+		auto isSame = [&image, &isInside](float x, float y, bool center) {
+			return isInside(x, y) && image.getUnchecked(static_cast<int>(x), static_cast<int>(y)) == center;
+		};
+
+		// The centers of one row of modules, the points a quarter module left and right of them (interleaved)
+		// and the ones a quarter module above and below them
+		auto& context = DecodeContext::ThreadLocal();
+		DecodeContext::Scope scope(context);
+		float* points = context.allocate<float>(10 * dimensionX);
+		float* centerX = points;
+		float* centerY = centerX + dimensionX;
+		float* sideX = centerY + dimensionX;
+		float* sideY = sideX + 2 * dimensionX;
+		float* upX = sideY + 2 * dimensionX;
+		float* upY = upX + dimensionX;
+		float* downX = upY + dimensionX;
+		float* downY = downX + dimensionX;
+		for (int y = 0; y < dimensionY; y++) {
+			float fy = static_cast<float>(y);
+			transform.transformLine(0.5f, fy + 0.5f, 1.0f, dimensionX, centerX, centerY);
+			transform.transformLine(0.25f, fy + 0.5f, 0.5f, 2 * dimensionX, sideX, sideY);
+			transform.transformLine(0.5f, fy + 0.25f, 1.0f, dimensionX, upX, upY);
+			transform.transformLine(0.5f, fy + 0.75f, 1.0f, dimensionX, downX, downY);
+			for (int x = 0; x < dimensionX; x++) {
+				// the value sampleGrid() read for this module, the center clamped onto the image
+				int ix = std::min(std::max(static_cast<int>(centerX[x]), 0), maxX);
+				int iy = std::min(std::max(static_cast<int>(centerY[x]), 0), maxY);
+				bool value = image.getUnchecked(ix, iy);
+				bool reliable = isInside(centerX[x], centerY[x]) &&
+								isSame(sideX[2 * x], sideY[2 * x], value) && isSame(sideX[2 * x + 1], sideY[2 * x + 1], value) &&
+								isSame(upX[x], upY[x], value) && isSame(downX[x], downY[x], value);
+				if (!reliable)
+					markUncertain(x, y);
+			}
+		}
+	}
 };
 
 } // anonymous
 
-static std::shared_ptr<GridSampler> globalInstance = std::make_shared<DefaultGridSampler>();
+void
+GridSampler::findUncertainModules(const BitMatrix&, int, int, const PerspectiveTransform&, BitMatrix& uncertain) const
+{
+	uncertain.reset(0, 0);
+}
+
+UncertainModules
+UncertainModules::mirrored() const
+{
+	UncertainModules result(*this);
+	result._mirrored = !_mirrored;
+	return result;
+}
+
+std::shared_ptr<const BitMatrix>
+UncertainModules::operator()() const
+{
+	if (_sampler == nullptr)
+		return nullptr;
+	// The matrix is only reused once the caller of the previous call has let go of it.
+	auto& uncertain = DecodeContext::ThreadLocal().scratch<UncertainScratch>().uncertain;
+	if (uncertain == nullptr || uncertain.use_count() > 1)
+		uncertain = std::make_shared<BitMatrix>();
+	_sampler->findUncertainModules(*_image, _dimensionX, _dimensionY, _transform, *uncertain);
+	if (uncertain->width() == 0)
+		return nullptr;
+	if (_mirrored)
+		uncertain->mirror();
+	return uncertain;
+}
+
+const GridSampler&
+GridSampler::Default()
+{
+	static const DefaultGridSampler instance{};
+	return instance;
+}
+
+static std::shared_ptr<GridSampler> legacyInstance;
 
 std::shared_ptr<GridSampler>
 GridSampler::Instance()
 {
-	return globalInstance;
+	if (legacyInstance)
+		return legacyInstance;
+	// non-owning, the built-in sampler lives as long as the program
+	return std::shared_ptr<GridSampler>(std::shared_ptr<GridSampler>(), const_cast<GridSampler*>(&Default()));
 }
 
 void
 GridSampler::SetInstance(const std::shared_ptr<GridSampler>& inst)
 {
-	globalInstance = inst;
+	legacyInstance = inst;
+}
+
+ImageGridSampler::ImageGridSampler(const BinaryBitmap& image, const std::shared_ptr<const GridSampler>& sampler, bool sampleLuminance)
+{
+	// The luminance sampler reads the grayscale image of this very bitmap, so it is made per image.
+	auto source = sampleLuminance ? image.luminanceSource() : nullptr;
+	if (source != nullptr) {
+		_sampler = std::make_shared<LuminanceGridSampler>(source);
+	}
+	else if (sampler != nullptr) {
+		_sampler = sampler;
+	}
+	else {
+		_sampler = GridSampler::Instance();
+	}
 }
 
 } // ZXing
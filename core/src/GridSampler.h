@@ -16,12 +16,14 @@
 * limitations under the License.
 */
 
+#include "PerspectiveTransform.h"
+
 #include <memory>
 
 namespace ZXing {
 
 class BitMatrix;
-class PerspectiveTransform;
+class BinaryBitmap;
 enum class DecodeStatus;
 
 /**
@@ -32,8 +34,9 @@ enum class DecodeStatus;
 * Imaging library, but which may not be available in other environments such as J2ME, and vice
 * versa.
 *
-* The implementation used can be controlled by calling {@link #setGridSampler(GridSampler)}
-* with an instance of a class which implements this interface.
+* The readers use Default() unless another instance is passed to them via DecodeHints::setGridSampler().
+* An instance may be used by several readers, and these may decode on different threads, so
+* implementations must not modify any state in sampleGrid().
 *
 * @author Sean Owen
 */
@@ -78,8 +81,73 @@ public:
 
 	virtual DecodeStatus sampleGrid(const BitMatrix& image, int dimensionX, int dimensionY, const PerspectiveTransform& transform, BitMatrix& result) const = 0;
 
+	/**
+	* Finds the modules of a grid sampled by sampleGrid() above whose sampled value is unreliable: their center
+	* fell outside the image, or the points a quarter module off their center do not all have the color of
+	* the center (the grid hits a black/white edge there). The decoders use them as erasures for the
+	* Reed-Solomon error correction.
+	*
+	* @param uncertain set to a matrix of size dimensionX x dimensionY with the unreliable modules set, or to
+	*   an empty matrix if there are none. The default implementation knows of none.
+	*/
+	virtual void findUncertainModules(const BitMatrix& image, int dimensionX, int dimensionY, const PerspectiveTransform& transform, BitMatrix& uncertain) const;
+
+	/**
+	* @return the built-in sampler, which samples the image at the center of each module
+	*/
+	static const GridSampler& Default();
+
+	/**
+	* Deprecated, pass the sampler to the readers via DecodeHints::setGridSampler() instead.
+	* Instance() returns the sampler installed by SetInstance(), or Default(). SetInstance() installs the
+	* sampler used by readers whose hints have none; it must not be called while decoding.
+	*/
 	static std::shared_ptr<GridSampler> Instance();
 	static void SetInstance(const std::shared_ptr<GridSampler>& inst);
 };
 
+/**
+* The sampler a reader of 2D barcodes uses for one image: a LuminanceGridSampler over the grayscale
+* source of the image if luminance sampling is requested and the source is available, else the sampler
+* given in the hints, else the one installed by GridSampler::SetInstance() or GridSampler::Default().
+*/
+class ImageGridSampler
+{
+	std::shared_ptr<const GridSampler> _sampler;
+
+public:
+	ImageGridSampler(const BinaryBitmap& image, const std::shared_ptr<const GridSampler>& sampler, bool sampleLuminance);
+
+	const std::shared_ptr<const GridSampler>& get() const { return _sampler; }
+};
+
+/**
+* Computes on demand the unreliable modules of a sampled grid, see GridSampler::findUncertainModules().
+* Only the error correction of damaged symbols needs them. It shares the ownership of the sampler and the
+* image, so it stays valid after the reader is done with them.
+*/
+class UncertainModules
+{
+	std::shared_ptr<const GridSampler> _sampler;
+	std::shared_ptr<const BitMatrix> _image;
+	int _dimensionX = 0;
+	int _dimensionY = 0;
+	PerspectiveTransform _transform;
+	bool _mirrored = false;
+
+public:
+	UncertainModules() {}
+	UncertainModules(const std::shared_ptr<const GridSampler>& sampler, const std::shared_ptr<const BitMatrix>& image, int dimensionX, int dimensionY, const PerspectiveTransform& transform)
+		: _sampler(sampler), _image(image), _dimensionX(dimensionX), _dimensionY(dimensionY), _transform(transform) {}
+
+	// false if nothing is known about the reliability of the modules
+	explicit operator bool() const { return _sampler != nullptr; }
+
+	// The same modules, mirrored like BitMatrix::mirror() does.
+	UncertainModules mirrored() const;
+
+	// The matrix with the unreliable modules set, or null if there are none.
+	std::shared_ptr<const BitMatrix> operator()() const;
+};
+
 } // ZXing
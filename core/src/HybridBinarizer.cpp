@@ -21,6 +21,7 @@
 #include "BitArray.h"
 #include "BitMatrix.h"
 #include "DecodeStatus.h"
+#include "DecodeContext.h"
 #include "ZXNumeric.h"
 
 #include <cassert>
@@ -37,23 +38,25 @@ static const int BLOCK_SIZE_MASK = BLOCK_SIZE - 1;   // ...0011...11
 static const int MINIMUM_DIMENSION = BLOCK_SIZE * 5;
 static const int MIN_DYNAMIC_RANGE = 24;
 
+// A 2D view on memory owned by someone else, e.g. a DecodeContext.
 template <typename T>
-class Matrix : std::vector<T>
+class Matrix
 {
+	T* _data;
 	int _width, _height;
 
 public:
-	Matrix(int width, int height) : std::vector<T>(width*height), _width(width), _height(height) {}
+	Matrix(T* data, int width, int height) : _data(data), _width(width), _height(height) {}
 
 	T& operator()(int x, int y)
 	{
 		assert(x < _width && y < _height);
-		return std::vector<T>::operator[](y* _width + x);
+		return _data[y * _width + x];
 	}
 	const T& operator()(int x, int y) const
 	{
 		assert(x < _width && y < _height);
-		return std::vector<T>::operator[](y* _width + x);
+		return _data[y * _width + x];
 	}
 };
 
@@ -78,10 +81,8 @@ HybridBinarizer::~HybridBinarizer()
 * See the following thread for a discussion of this algorithm:
 *  http://groups.google.com/group/zxing/browse_thread/thread/d06efa2c35a7ddc0
 */
-static Matrix<int> CalculateBlackPoints(const uint8_t* luminances, int subWidth, int subHeight, int width, int height, int stride)
+static void CalculateBlackPoints(const uint8_t* luminances, int subWidth, int subHeight, int width, int height, int stride, Matrix<int>& blackPoints)
 {
-	Matrix<int>	blackPoints(subWidth, subHeight);
-
 	for (int y = 0; y < subHeight; y++) {
 		int yoffset = y << BLOCK_SIZE_POWER;
 		int maxYOffset = height - BLOCK_SIZE;
@@ -149,7 +150,6 @@ static Matrix<int> CalculateBlackPoints(const uint8_t* luminances, int subWidth,
 			blackPoints(x, y) = average;
 		}
 	}
-	return blackPoints;
 }
 
 
@@ -223,7 +223,10 @@ static void InitBlackMatrix(const LuminanceSource& source, std::shared_ptr<const
 	if ((height & BLOCK_SIZE_MASK) != 0) {
 		subHeight++;
 	}
-	auto blackPoints = CalculateBlackPoints(luminances, subWidth, subHeight, width, height, stride);
+	auto& context = DecodeContext::ThreadLocal();
+	DecodeContext::Scope scope(context);
+	Matrix<int> blackPoints(context.allocate<int>(subWidth * subHeight), subWidth, subHeight);
+	CalculateBlackPoints(luminances, subWidth, subHeight, width, height, stride, blackPoints);
 
 	auto matrix = std::make_shared<BitMatrix>(width, height);
 	CalculateThresholdForBlock(luminances, subWidth, subHeight, width, height, stride, blackPoints, *matrix);
@@ -0,0 +1,228 @@
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "LuminanceGridSampler.h"
+#include "LuminanceSource.h"
+#include "PerspectiveTransform.h"
+#include "BitMatrix.h"
+#include "DecodeStatus.h"
+#include "DecodeContext.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ZXing {
+
+namespace {
+
+// The positions of the footprint points inside a module, in both directions
+static const float FOOTPRINT[] = {0.3f, 0.5f, 0.7f};
+
+// The local threshold and levels are taken from the modules at most this far away in both directions
+static const int LEVEL_RADIUS = 4;
+
+/**
+* Bilinearly interpolates the luminance at the given image position. Pixel (i, j) covers [i, i + 1) x [j, j + 1),
+* as in the BitMatrix samplers, so its value is located at (i + 0.5, j + 0.5). Positions off the image are
+* clamped to the border.
+*/
+static float Interpolate(const uint8_t* pixels, int rowBytes, int width, int height, float x, float y)
+{
+	x = std::min(std::max(x - 0.5f, 0.0f), static_cast<float>(width - 1));
+	y = std::min(std::max(y - 0.5f, 0.0f), static_cast<float>(height - 1));
+	int x0 = static_cast<int>(x);
+	int y0 = static_cast<int>(y);
+	int x1 = std::min(x0 + 1, width - 1);
+	int y1 = std::min(y0 + 1, height - 1);
+	float fx = x - x0;
+	float fy = y - y0;
+	const uint8_t* row0 = pixels + y0 * rowBytes;
+	const uint8_t* row1 = pixels + y1 * rowBytes;
+	float top = row0[x0] + fx * (row0[x1] - row0[x0]);
+	float bottom = row1[x0] + fx * (row1[x1] - row1[x0]);
+	return top + fy * (bottom - top);
+}
+
+/**
+* Computes the mean, minimum and maximum of the values in the (2 * LEVEL_RADIUS + 1)^2 window around each
+* value of the width x height array, with the window cut off at the borders. The mean comes from a table
+* of prefix sums, the minimum and maximum are separable, so rows and columns are done one after the other.
+*/
+static void LocalLevels(const float* values, int width, int height, float* sums, float* rowMin, float* rowMax,
+	float* localMean, float* localMin, float* localMax)
+{
+	int stride = width + 1;
+	std::fill_n(sums, stride, 0.0f);
+	for (int y = 0; y < height; ++y) {
+		float rowSum = 0;
+		sums[(y + 1) * stride] = 0;
+		for (int x = 0; x < width; ++x) {
+			rowSum += values[y * width + x];
+			sums[(y + 1) * stride + x + 1] = sums[y * stride + x + 1] + rowSum;
+		}
+	}
+	for (int y = 0; y < height; ++y) {
+		int top = std::max(y - LEVEL_RADIUS, 0);
+		int bottom = std::min(y + LEVEL_RADIUS + 1, height);
+		for (int x = 0; x < width; ++x) {
+			int left = std::max(x - LEVEL_RADIUS, 0);
+			int right = std::min(x + LEVEL_RADIUS + 1, width);
+			float sum = sums[bottom * stride + right] - sums[top * stride + right] - sums[bottom * stride + left] + sums[top * stride + left];
+			localMean[y * width + x] = sum / ((right - left) * (bottom - top));
+
+			float lo = values[y * width + x];
+			float hi = lo;
+			for (int i = left; i < right; ++i) {
+				lo = std::min(lo, values[y * width + i]);
+				hi = std::max(hi, values[y * width + i]);
+			}
+			rowMin[y * width + x] = lo;
+			rowMax[y * width + x] = hi;
+		}
+	}
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			float lo = rowMin[y * width + x];
+			float hi = rowMax[y * width + x];
+			for (int j = std::max(y - LEVEL_RADIUS, 0); j <= std::min(y + LEVEL_RADIUS, height - 1); ++j) {
+				lo = std::min(lo, rowMin[j * width + x]);
+				hi = std::max(hi, rowMax[j * width + x]);
+			}
+			localMin[y * width + x] = lo;
+			localMax[y * width + x] = hi;
+		}
+	}
+}
+
+} // anonymous
+
+LuminanceGridSampler::LuminanceGridSampler(const std::shared_ptr<const LuminanceSource>& source) :
+	_source(source)
+{
+	_pixels = _source->getMatrix(_buffer, _rowBytes);
+}
+
+DecodeStatus
+LuminanceGridSampler::sampleGrid(const BitMatrix& image, int dimensionX, int dimensionY,
+	float p1ToX, float p1ToY, float p2ToX, float p2ToY, float p3ToX, float p3ToY, float p4ToX, float p4ToY,
+	float p1FromX, float p1FromY, float p2FromX, float p2FromY, float p3FromX, float p3FromY, float p4FromX, float p4FromY,
+	BitMatrix& result) const
+{
+	auto transform = PerspectiveTransform::QuadrilateralToQuadrilateral(
+		p1ToX, p1ToY, p2ToX, p2ToY, p3ToX, p3ToY, p4ToX, p4ToY,
+		p1FromX, p1FromY, p2FromX, p2FromY, p3FromX, p3FromY, p4FromX, p4FromY);
+
+	return sampleGrid(image, dimensionX, dimensionY, transform, result);
+}
+
+DecodeStatus
+LuminanceGridSampler::sampleGrid(const BitMatrix&, int dimensionX, int dimensionY, const PerspectiveTransform& transform, BitMatrix& result) const
+{
+	return sample(dimensionX, dimensionY, transform, result, nullptr);
+}
+
+void
+LuminanceGridSampler::findUncertainModules(const BitMatrix&, int dimensionX, int dimensionY, const PerspectiveTransform& transform, BitMatrix& uncertain) const
+{
+	// The uncertain modules are a by-product of the thresholding, so the grid is simply sampled once more.
+	BitMatrix result;
+	uncertain.reset(0, 0);
+	sample(dimensionX, dimensionY, transform, result, &uncertain);
+}
+
+/**
+* Samples the grid into result. If uncertain is not null, it is set to the modules whose value is unreliable, see
+* GridSampler::findUncertainModules(), or left empty if there are none.
+*/
+DecodeStatus
+LuminanceGridSampler::sample(int dimensionX, int dimensionY, const PerspectiveTransform& transform, BitMatrix& result, BitMatrix* uncertain) const
+{
+	if (dimensionX <= 0 || dimensionY <= 0) {
+		return DecodeStatus::NotFound;
+	}
+
+	int width = _source->width();
+	int height = _source->height();
+	int count = dimensionX * dimensionY;
+	auto& context = DecodeContext::ThreadLocal();
+	DecodeContext::Scope scope(context);
+	float* xs = context.allocate<float>(dimensionX);
+	float* ys = context.allocate<float>(dimensionX);
+	float* values = context.allocate<float>(count);
+	bool* offImage = context.allocate<bool>(count);
+
+	// Sum up the footprint of every module (the scale of the averages does not matter). As the other
+	// samplers, give up if a module center is more than a pixel off the image, and treat the ones less
+	// than that off as unreliable.
+	std::fill_n(values, count, 0.0f);
+	for (int y = 0; y < dimensionY; ++y) {
+		float* row = values + y * dimensionX;
+		transform.transformLine(0.5f, y + 0.5f, 1.0f, dimensionX, xs, ys);
+		for (int x = 0; x < dimensionX; ++x) {
+			if (!(xs[x] >= -1 && xs[x] < width + 1 && ys[x] >= -1 && ys[x] < height + 1))
+				return DecodeStatus::NotFound;
+			offImage[y * dimensionX + x] = xs[x] < 0 || xs[x] >= width || ys[x] < 0 || ys[x] >= height;
+		}
+		for (float dy : FOOTPRINT) {
+			for (float dx : FOOTPRINT) {
+				transform.transformLine(dx, y + dy, 1.0f, dimensionX, xs, ys);
+				for (int x = 0; x < dimensionX; ++x) {
+					row[x] += Interpolate(_pixels, _rowBytes, width, height, xs[x], ys[x]);
+				}
+			}
+		}
+	}
+
+	// Every part of a symbol the size of the level window contains both colors in about equal shares, so
+	// the local mean follows uneven lighting and blur. The local contrast only decides which modules are
+	// too close to call; where it is low, the contrast of the whole grid is used instead.
+	float* sums = context.allocate<float>((dimensionX + 1) * (dimensionY + 1));
+	float* rowMin = context.allocate<float>(count);
+	float* rowMax = context.allocate<float>(count);
+	float* localMean = context.allocate<float>(count);
+	float* localMin = context.allocate<float>(count);
+	float* localMax = context.allocate<float>(count);
+	LocalLevels(values, dimensionX, dimensionY, sums, rowMin, rowMax, localMean, localMin, localMax);
+	auto levels = std::minmax_element(values, values + count);
+	float globalContrast = *levels.second - *levels.first;
+
+	// Reuse the caller's matrix if it already has the right size, it is the only allocation left here.
+	if (result.width() == dimensionX && result.height() == dimensionY)
+		result.clear();
+	else
+		result = BitMatrix(dimensionX, dimensionY);
+	for (int y = 0; y < dimensionY; ++y) {
+		for (int x = 0; x < dimensionX; ++x) {
+			int i = y * dimensionX + x;
+			float threshold = localMean[i];
+			float contrast = localMax[i] - localMin[i];
+			if (contrast < globalContrast / 4) {
+				contrast = globalContrast;
+			}
+			if (values[i] < threshold) {
+				result.set(x, y);
+			}
+			if (uncertain && (offImage[i] || std::abs(values[i] - threshold) < contrast / 8)) {
+				if (uncertain->width() == 0)
+					*uncertain = BitMatrix(dimensionX, dimensionY);
+				uncertain->set(x, y);
+			}
+		}
+	}
+	return DecodeStatus::NoError;
+}
+
+} // ZXing
@@ -0,0 +1,66 @@
+#pragma once
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "GridSampler.h"
+#include "ByteArray.h"
+
+#include <memory>
+
+namespace ZXing {
+
+class LuminanceSource;
+
+/**
+* A GridSampler that reads the modules from the grayscale image the binarized image was made from.
+*
+* Instead of looking at the one binarized pixel under the center of a module, it averages a 3x3
+* footprint of bilinearly interpolated luminance values inside the module. The averages are then
+* thresholded against the mean of the 9x9 modules around each module. Every part of a symbol that
+* size contains both colors, e.g. the finder and timing patterns, so the threshold follows uneven
+* lighting. This reads symbols with only about 2 pixels per module, where the binarizer and center
+* sampling often fail. Modules whose average is close to the threshold, relative to the local
+* contrast, are reported as uncertain.
+*
+* The BitMatrix passed to sampleGrid() is not read, the modules are sampled from the source only. The
+* transform must hence map into the coordinates of the source, as it does for its binarized image.
+* An instance is bound to one source. The readers create it per image if
+* DecodeHints::shouldSampleLuminance() is set.
+*/
+class LuminanceGridSampler : public GridSampler
+{
+public:
+	explicit LuminanceGridSampler(const std::shared_ptr<const LuminanceSource>& source);
+
+	virtual DecodeStatus sampleGrid(const BitMatrix& image, int dimensionX, int dimensionY,
+		float p1ToX, float p1ToY, float p2ToX, float p2ToY, float p3ToX, float p3ToY, float p4ToX, float p4ToY,
+		float p1FromX, float p1FromY, float p2FromX, float p2FromY, float p3FromX, float p3FromY, float p4FromX, float p4FromY,
+		BitMatrix& result) const override;
+
+	virtual DecodeStatus sampleGrid(const BitMatrix& image, int dimensionX, int dimensionY, const PerspectiveTransform& transform, BitMatrix& result) const override;
+
+	virtual void findUncertainModules(const BitMatrix& image, int dimensionX, int dimensionY, const PerspectiveTransform& transform, BitMatrix& uncertain) const override;
+
+private:
+	DecodeStatus sample(int dimensionX, int dimensionY, const PerspectiveTransform& transform, BitMatrix& result, BitMatrix* uncertain) const;
+
+	std::shared_ptr<const LuminanceSource> _source;
+	ByteArray _buffer;
+	const uint8_t* _pixels;
+	int _rowBytes;
+};
+
+} // ZXing
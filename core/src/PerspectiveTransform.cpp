@@ -57,6 +57,22 @@ PerspectiveTransform::transformPoints(float* xValues, float* yValues, int count)
 	}
 }
 
+void
+PerspectiveTransform::transformLine(float x0, float y, float dx, int count, float* xValues, float* yValues) const
+{
+	float numeratorX = a11 * x0 + a21 * y + a31;
+	float numeratorY = a12 * x0 + a22 * y + a32;
+	float denominator = a13 * x0 + a23 * y + a33;
+	float stepX = a11 * dx;
+	float stepY = a12 * dx;
+	float stepDenominator = a13 * dx;
+	for (int i = 0; i < count; i++) {
+		float scale = 1.0f / (denominator + i * stepDenominator);
+		xValues[i] = (numeratorX + i * stepX) * scale;
+		yValues[i] = (numeratorY + i * stepY) * scale;
+	}
+}
+
 PerspectiveTransform
 PerspectiveTransform::buildAdjoint() const
 {
@@ -44,6 +44,13 @@ public:
 	void transformPoints(float* points, int count) const;
 	void transformPoints(float* xValues, float* yValues, int count) const;
 
+	/**
+	* Transforms the points (x0 + i * dx, y) for i in [0, count). Along such a line the numerators and the
+	* denominator of the transform change by a constant per step, so they are computed from their values at
+	* the first point instead of evaluating the whole transform for every point.
+	*/
+	void transformLine(float x0, float y, float dx, int count, float* xValues, float* yValues) const;
+
 	PerspectiveTransform buildAdjoint() const;
 	PerspectiveTransform times(const PerspectiveTransform& other) const;
 
@@ -0,0 +1,273 @@
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "RasterWriter.h"
+#include "BitMatrix.h"
+#include "ZXConstexprArray.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ZXing {
+
+namespace {
+
+constexpr uint32_t CrcStep(uint32_t c, int k)
+{
+	return k == 0 ? c : CrcStep((c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1, k - 1);
+}
+
+// Computes entry n of the CRC-32 table used by PNG
+struct CrcTableEntry
+{
+	constexpr uint32_t operator()(int n) const {
+		return CrcStep(static_cast<uint32_t>(n), 8);
+	}
+};
+
+static constexpr std::array<uint32_t, 256> CRC_TABLE = GenerateArray<uint32_t, 256>(CrcTableEntry());
+
+static uint32_t Crc32(const uint8_t* data, size_t size)
+{
+	uint32_t crc = 0xffffffff;
+	for (size_t i = 0; i < size; ++i) {
+		crc = CRC_TABLE[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	}
+	return crc ^ 0xffffffff;
+}
+
+// Continues the Adler-32 checksum of the zlib stream
+static uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t size)
+{
+	// 5552 is the largest number of bytes that can be summed up before the sums could overflow
+	uint32_t a = adler & 0xffff;
+	uint32_t b = adler >> 16;
+	while (size > 0) {
+		size_t n = std::min(size, size_t(5552));
+		size -= n;
+		for (; n > 0; --n) {
+			a += *data++;
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	return (b << 16) | a;
+}
+
+static void AppendBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+	out.push_back(static_cast<uint8_t>(value >> 24));
+	out.push_back(static_cast<uint8_t>(value >> 16));
+	out.push_back(static_cast<uint8_t>(value >> 8));
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+static void WriteString(const RasterWriter::Sink& sink, const std::string& str)
+{
+	sink(reinterpret_cast<const uint8_t*>(str.data()), str.size());
+}
+
+static void CheckScale(const BitMatrix& modules, int scale)
+{
+	if (scale < 1) {
+		throw std::invalid_argument("Invalid scale");
+	}
+	if (modules.width() == 0 || modules.height() == 0) {
+		throw std::invalid_argument("Empty matrix");
+	}
+	if (modules.width() > std::numeric_limits<int>::max() / scale || modules.height() > std::numeric_limits<int>::max() / scale) {
+		throw std::invalid_argument("Image too large");
+	}
+}
+
+/**
+* Calls fill(from, count) for every run of black modules in row y, with the pixel columns they cover.
+*/
+template <typename Fill>
+static void ForEachBlackRun(const BitMatrix& modules, int y, int scale, Fill fill)
+{
+	int width = modules.width();
+	for (int x = 0; x < width;) {
+		if (!modules.get(x, y)) {
+			++x;
+			continue;
+		}
+		int start = x;
+		while (x < width && modules.get(x, y)) {
+			++x;
+		}
+		fill(start * scale, (x - start) * scale);
+	}
+}
+
+/**
+* Scales row y of the modules up to packed pixels, most significant bit first, 1 for black. Whole bytes
+* of a run are filled with memset.
+*/
+static void PackRow(const BitMatrix& modules, int y, int scale, uint8_t* bits, int rowBytes)
+{
+	std::memset(bits, 0, rowBytes);
+	ForEachBlackRun(modules, y, scale, [bits](int from, int count) {
+		int to = from + count;
+		int first = from / 8;
+		int last = (to - 1) / 8;
+		uint8_t firstMask = static_cast<uint8_t>(0xff >> (from % 8));
+		uint8_t lastMask = static_cast<uint8_t>(0xff << (7 - (to - 1) % 8));
+		if (first == last) {
+			bits[first] |= firstMask & lastMask;
+		}
+		else {
+			bits[first] |= firstMask;
+			std::memset(bits + first + 1, 0xff, last - first - 1);
+			bits[last] |= lastMask;
+		}
+	});
+}
+
+} // anonymous
+
+void
+RasterWriter::WritePBM(const BitMatrix& modules, int scale, const Sink& sink)
+{
+	CheckScale(modules, scale);
+	int width = modules.width() * scale;
+	int rowBytes = (width + 7) / 8;
+	WriteString(sink, "P4\n" + std::to_string(width) + ' ' + std::to_string(modules.height() * scale) + '\n');
+
+	std::vector<uint8_t> row(rowBytes);
+	for (int y = 0; y < modules.height(); ++y) {
+		PackRow(modules, y, scale, row.data(), rowBytes);
+		for (int i = 0; i < scale; ++i) {
+			sink(row.data(), row.size());
+		}
+	}
+}
+
+void
+RasterWriter::WritePGM(const BitMatrix& modules, int scale, const Sink& sink)
+{
+	CheckScale(modules, scale);
+	int width = modules.width() * scale;
+	WriteString(sink, "P5\n" + std::to_string(width) + ' ' + std::to_string(modules.height() * scale) + "\n255\n");
+
+	std::vector<uint8_t> row(width);
+	for (int y = 0; y < modules.height(); ++y) {
+		std::fill(row.begin(), row.end(), 255);
+		ForEachBlackRun(modules, y, scale, [&row](int from, int count) {
+			std::memset(row.data() + from, 0, count);
+		});
+		for (int i = 0; i < scale; ++i) {
+			sink(row.data(), row.size());
+		}
+	}
+}
+
+void
+RasterWriter::WritePNG(const BitMatrix& modules, int scale, const Sink& sink)
+{
+	CheckScale(modules, scale);
+	int width = modules.width() * scale;
+	int height = modules.height() * scale;
+	int rowBytes = (width + 7) / 8;
+	// Every image row goes into a stored deflate block of its own, which holds at most 65535 bytes.
+	if (rowBytes + 1 > 0xffff) {
+		throw std::invalid_argument("Image too wide for PNG output");
+	}
+
+	std::vector<uint8_t> chunk;
+	auto writeChunk = [&sink, &chunk]() {
+		// chunk holds the length and type, followed by the data; the CRC covers type and data.
+		uint32_t size = static_cast<uint32_t>(chunk.size() - 8);
+		for (int i = 0; i < 4; ++i) {
+			chunk[i] = static_cast<uint8_t>(size >> (24 - 8 * i));
+		}
+		AppendBigEndian(chunk, Crc32(chunk.data() + 4, chunk.size() - 4));
+		sink(chunk.data(), chunk.size());
+	};
+	auto startChunk = [&chunk](const char* type) {
+		chunk.assign(4, 0);
+		chunk.insert(chunk.end(), type, type + 4);
+	};
+
+	static const uint8_t SIGNATURE[] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+	sink(SIGNATURE, sizeof(SIGNATURE));
+
+	startChunk("IHDR");
+	AppendBigEndian(chunk, width);
+	AppendBigEndian(chunk, height);
+	const uint8_t header[] = {1 /*bit depth*/, 0 /*grayscale*/, 0 /*deflate*/, 0 /*no filter*/, 0 /*no interlace*/};
+	chunk.insert(chunk.end(), header, header + sizeof(header));
+	writeChunk();
+
+	// In a 1 bit grayscale PNG 0 is black, hence the packed row is inverted. The scanline starts with filter type 0.
+	std::vector<uint8_t> scanline(rowBytes + 1);
+	uint32_t adler = 1;
+	for (int y = 0; y < modules.height(); ++y) {
+		PackRow(modules, y, scale, scanline.data() + 1, rowBytes);
+		for (int i = 1; i <= rowBytes; ++i) {
+			scanline[i] = ~scanline[i];
+		}
+		for (int i = 0; i < scale; ++i) {
+			bool first = y == 0 && i == 0;
+			bool last = y == modules.height() - 1 && i == scale - 1;
+			startChunk("IDAT");
+			if (first) {
+				// zlib header: deflate with a 32K window, no preset dictionary, check bits for 0x7801
+				chunk.push_back(0x78);
+				chunk.push_back(0x01);
+			}
+			uint16_t length = static_cast<uint16_t>(scanline.size());
+			const uint8_t block[] = {static_cast<uint8_t>(last ? 1 : 0), static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8),
+									 static_cast<uint8_t>(~length), static_cast<uint8_t>(~length >> 8)};
+			chunk.insert(chunk.end(), block, block + sizeof(block));
+			chunk.insert(chunk.end(), scanline.begin(), scanline.end());
+			adler = Adler32(adler, scanline.data(), scanline.size());
+			if (last) {
+				AppendBigEndian(chunk, adler);
+			}
+			writeChunk();
+		}
+	}
+
+	startChunk("IEND");
+	writeChunk();
+}
+
+void
+RasterWriter::WritePBM(const BitMatrix& modules, int scale, std::ostream& out)
+{
+	WritePBM(modules, scale, [&out](const uint8_t* data, size_t size) { out.write(reinterpret_cast<const char*>(data), size); });
+}
+
+void
+RasterWriter::WritePGM(const BitMatrix& modules, int scale, std::ostream& out)
+{
+	WritePGM(modules, scale, [&out](const uint8_t* data, size_t size) { out.write(reinterpret_cast<const char*>(data), size); });
+}
+
+void
+RasterWriter::WritePNG(const BitMatrix& modules, int scale, std::ostream& out)
+{
+	WritePNG(modules, scale, [&out](const uint8_t* data, size_t size) { out.write(reinterpret_cast<const char*>(data), size); });
+}
+
+} // ZXing
@@ -0,0 +1,53 @@
+#pragma once
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+
+namespace ZXing {
+
+class BitMatrix;
+
+/**
+* Writes a symbol as an image file, scaled up while writing. The input is the matrix of modules, i.e. what
+* the writers return for a width and height of 0, quiet zone included. Each module becomes scale x scale
+* pixels. Only one row of the image is kept in memory at a time, so large print resolutions do not need a
+* BitMatrix at the final size.
+*
+* The file is passed to the sink in pieces of at most one image row plus a few bytes of framing.
+*
+* Supported formats are binary PBM (P4), 8 bit PGM (P5) and 1 bit grayscale PNG. The PNG image data is
+* stored without compression, in zlib format with stored deflate blocks, as there is no deflate
+* implementation in this library.
+*/
+class RasterWriter
+{
+public:
+	using Sink = std::function<void(const uint8_t* data, size_t size)>;
+
+	static void WritePBM(const BitMatrix& modules, int scale, const Sink& sink);
+	static void WritePGM(const BitMatrix& modules, int scale, const Sink& sink);
+	static void WritePNG(const BitMatrix& modules, int scale, const Sink& sink);
+
+	static void WritePBM(const BitMatrix& modules, int scale, std::ostream& out);
+	static void WritePGM(const BitMatrix& modules, int scale, std::ostream& out);
+	static void WritePNG(const BitMatrix& modules, int scale, std::ostream& out);
+};
+
+} // ZXing
@@ -18,31 +18,71 @@
 #include "ReedSolomonDecoder.h"
 #include "GenericGF.h"
 #include "DecodeStatus.h"
+#include "DecodeContext.h"
 
+#include <algorithm>
 #include <memory>
+#include <stdexcept>
 
 namespace ZXing {
 
+namespace {
+
+// The temporaries of decode(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::vector<int> syndromes, erasureLocator, modifiedSyndromes, chienTerms, errorLocations, errorMagnitudes;
+	GenericGFPoly r, q, rLast, sigma, omega;
+};
+
+} // anonymous
+
+/**
+* Solves the key equation with the extended Euclidean algorithm. With erasures (the erasure locator gamma
+* has a degree > 0), it runs on the modified syndromes S(x) * gamma(x) mod x^R and starts with t = gamma,
+* so that t ends up as the locator of errors and erasures together.
+*/
 // May throw ReedSolomonException
 static DecodeStatus
-RunEuclideanAlgorithm(const GenericGF& field, std::vector<int>&& rCoefs, int R, GenericGFPoly& sigma, GenericGFPoly& omega)
+RunEuclideanAlgorithm(const GenericGF& field, const std::vector<int>& rCoefs, int R, const std::vector<int>& gamma, Scratch& scratch)
 {
-	GenericGFPoly r(field, std::move(rCoefs));
-	GenericGFPoly& tLast = omega;
-	GenericGFPoly& t = sigma;
-	ZX_THREAD_LOCAL GenericGFPoly q, rLast;
+	int numErasures = static_cast<int>(gamma.size()) - 1;
+	GenericGFPoly& r = scratch.r;
+	GenericGFPoly& tLast = scratch.omega;
+	GenericGFPoly& t = scratch.sigma;
+	GenericGFPoly& q = scratch.q;
+	GenericGFPoly& rLast = scratch.rLast;
+
+	if (numErasures == 0) {
+		r.setCoefficients(field, rCoefs.data(), rCoefs.size());
+		field.setOne(t);
+	}
+	else {
+		// rCoefs and the modified syndromes hold the coefficient of x^k at index R - 1 - k
+		auto& modified = scratch.modifiedSyndromes;
+		modified.assign(R, 0);
+		for (int k = 0; k < R; ++k) {
+			int sum = 0;
+			for (int i = 0; i <= std::min(k, numErasures); ++i)
+				sum ^= field.multiply(gamma[i], rCoefs[R - 1 - (k - i)]);
+			modified[R - 1 - k] = sum;
+		}
+		r.setCoefficients(field, modified.data(), modified.size());
+		auto& reversed = scratch.modifiedSyndromes; // free again, r has its own copy
+		reversed.assign(gamma.rbegin(), gamma.rend());
+		t.setCoefficients(field, reversed.data(), reversed.size());
+	}
 
 	field.setMonomial(rLast, R, 1);
 	field.setZero(tLast);
-	field.setOne(t);
 
 	// Assume r's degree is < rLast's
 	if (r.degree() >= rLast.degree()) {
 		swap(r, rLast);
 	}
 
-	// Run Euclidean algorithm until r's degree is less than R/2
-	while (r.degree() >= R / 2) {
+	// Run Euclidean algorithm until r's degree is less than (R + numErasures) / 2
+	while (r.degree() >= (R + numErasures) / 2) {
 		swap(tLast, t);
 		swap(rLast, r);
 
@@ -74,24 +114,128 @@ RunEuclideanAlgorithm(const GenericGF& field, std::vector<int>&& rCoefs, int R,
 	r.multiply(inverse);
 
 	// sigma is t
-	omega = std::move(r);
+	swap(scratch.omega, r);
 	return DecodeStatus::NoError;
 }
 
-// May throw ReedSolomonException
+/**
+* Berlekamp-Massey: finds the shortest LFSR (the error locator sigma) generating the syndrome sequence, then
+* the error evaluator omega = S(x) * sigma(x) mod x^R. All intermediate polynomials live in arrays with room
+* for MAX_EC_CODEWORDS + 1 coefficients (least significant first), only the results are copied into the
+* GenericGFPoly objects of the scratch memory. Erasures are handled by starting from the erasure locator
+* gamma with length numErasures (Forney's modification), sigma then locates errors and erasures.
+*/
+static DecodeStatus
+RunBerlekampMassey(const GenericGF& field, const std::vector<int>& syndromeCoefs, int R, const std::vector<int>& gamma, Scratch& scratch)
+{
+	static const int CAPACITY = ReedSolomonDecoder::MAX_EC_CODEWORDS + 1;
+
+	// syndromeCoefs holds S_i at index R - 1 - i
+	auto S = [&syndromeCoefs, R](int i) { return syndromeCoefs[R - 1 - i]; };
+
+	int C[CAPACITY]; // current connection polynomial
+	int B[CAPACITY]; // connection polynomial before the last length change
+	int T[CAPACITY];
+	int numErasures = static_cast<int>(gamma.size()) - 1;
+	int lenC = numErasures + 1, lenB = numErasures + 1;
+	std::copy(gamma.begin(), gamma.end(), C);
+	std::copy(gamma.begin(), gamma.end(), B);
+	int L = numErasures;
+	int m = 1;
+	int b = 1;
+
+	for (int n = numErasures; n < R; ++n) {
+		int d = S(n);
+		for (int i = 1; i <= L; ++i)
+			d ^= field.multiply(C[i], S(n - i));
+		if (d == 0) {
+			++m;
+			continue;
+		}
+		int coef = field.multiply(d, field.inverse(b));
+		bool lengthChange = 2 * L <= n + numErasures;
+		if (lengthChange)
+			std::copy_n(C, lenC, T);
+		// C(x) -= d / b * x^m * B(x)
+		int newLen = std::max(lenC, lenB + m);
+		std::fill(C + lenC, C + newLen, 0);
+		for (int i = 0; i < lenB; ++i)
+			C[i + m] ^= field.multiply(coef, B[i]);
+		if (lengthChange) {
+			std::copy_n(T, lenC, B);
+			lenB = lenC;
+			L = n + 1 + numErasures - L;
+			b = d;
+			m = 1;
+		} else {
+			++m;
+		}
+		lenC = newLen;
+	}
+
+	if (2 * L - numErasures > R) {
+		return DecodeStatus::ReedSolomonAlgoFailed;
+	}
+
+	// omega = S * sigma mod x^R, its degree is below L for a correctable error pattern
+	int lenOmega = std::max(L, 1);
+	for (int k = 0; k < lenOmega; ++k) {
+		int sum = 0;
+		for (int i = 0; i <= std::min(k, lenC - 1); ++i)
+			sum ^= field.multiply(C[i], S(k - i));
+		T[k] = sum;
+	}
+
+	// GenericGFPoly wants the most significant coefficient first
+	std::reverse(C, C + L + 1);
+	std::reverse(T, T + lenOmega);
+	scratch.sigma.setCoefficients(field, C, L + 1);
+	scratch.omega.setCoefficients(field, T, lenOmega);
+	return DecodeStatus::NoError;
+}
+
+/**
+* Chien search: finds the roots of the error locator by evaluating it at every non-zero field element a^i.
+* Instead of evaluating the polynomial from scratch for each i, the terms sigma_j * a^(i*j) are kept in
+* log representation and advanced by j from one element to the next, which costs one table lookup per term.
+*/
 static DecodeStatus
-FindErrorLocations(const GenericGF& field, const GenericGFPoly& errorLocator, std::vector<int>& outLocations)
+FindErrorLocations(const GenericGF& field, const GenericGFPoly& errorLocator, std::vector<int>& terms, std::vector<int>& outLocations)
 {
-	// This is a direct application of Chien's search
 	int numErrors = errorLocator.degree();
 	outLocations.resize(numErrors);
 	if (numErrors == 1) { // shortcut
 		outLocations[0] = errorLocator.coefficient(1);
+		return DecodeStatus::NoError;
+	}
+
+	int order = field.size() - 1;
+	int constant = errorLocator.coefficient(0);
+	// log of the terms sigma_j * a^(i*j) for j >= 1 with non-zero coefficients, followed by their step j
+	terms.resize(2 * numErrors);
+	int* logs = terms.data();
+	int* steps = logs + numErrors;
+	int numTerms = 0;
+	for (int j = 1; j <= numErrors; ++j) {
+		int c = errorLocator.coefficient(j);
+		if (c != 0) {
+			logs[numTerms] = field.log(c);
+			steps[numTerms] = j % order;
+			++numTerms;
+		}
 	}
+
 	int e = 0;
-	for (int i = 1; i < field.size() && e < numErrors; i++) {
-		if (errorLocator.evaluateAt(i) == 0) {
-			outLocations[e] = field.inverse(i);
+	for (int i = 1; i <= order && e < numErrors; i++) {
+		int sum = constant;
+		for (int t = 0; t < numTerms; ++t) {
+			int l = logs[t] + steps[t];
+			l = l >= order ? l - order : l;
+			logs[t] = l;
+			sum ^= field.exp(l);
+		}
+		if (sum == 0) {
+			outLocations[e] = field.exp(order - i); // inverse of a^i
 			e++;
 		}
 	}
@@ -129,46 +273,161 @@ static void FindErrorMagnitudes(const GenericGF& field, const GenericGFPoly& err
 	}
 }
 
+/**
+* Calculates the syndromes S_i = received(a^(i + b)) for i in [0, twoS), stored in reverse order as the
+* coefficients of the syndrome polynomial. Returns false if all of them are zero, i.e. there is no error.
+* Fields up to GF(256) use a row of the full multiplication table per syndrome, which turns every Horner
+* step into one byte lookup. The Horner recurrences of GROUP_SIZE syndromes are run side by side, so that
+* their independent table lookups can overlap instead of waiting for each other.
+* Larger fields have no such table. Instead of evaluating the polynomial with Horner's method, which chains
+* every step to the previous one, each non-zero codeword c at degree d adds its term c * a^((i + b) * d) to
+* all syndromes. The exponent of the term grows by d from one syndrome to the next, so every term costs one
+* table lookup. The terms of GROUP_SIZE codewords are added side by side. A term costs about 1.5 times
+* a Horner step, so this is also used for the small fields if at most two thirds of the codewords are non-zero.
+*/
+static bool CalculateSyndromes(const GenericGF& field, const std::vector<int>& received, int twoS, std::vector<int>& syndromes)
+{
+	static const int GROUP_SIZE = 8;
+
+	syndromes.assign(twoS, 0);
+	int order = field.size() - 1;
+
+	int numCodewords = static_cast<int>(received.size());
+	int numNonZero = numCodewords - static_cast<int>(std::count(received.begin(), received.end(), 0));
+	if (3 * numNonZero > 2 * numCodewords && field.multiplicationTable(0) != nullptr) {
+		for (int first = 0; first < twoS; first += GROUP_SIZE) {
+			int count = std::min(GROUP_SIZE, twoS - first);
+			const uint8_t* rows[GROUP_SIZE];
+			int results[GROUP_SIZE] = {};
+			for (int k = 0; k < count; ++k)
+				rows[k] = field.multiplicationTable(field.exp((first + k + field.generatorBase()) % order));
+			for (int c : received)
+				for (int k = 0; k < count; ++k)
+					results[k] = rows[k][results[k]] ^ c;
+			for (int k = 0; k < count; ++k)
+				syndromes[twoS - 1 - first - k] = results[k];
+		}
+		return std::any_of(syndromes.begin(), syndromes.end(), [](int s) { return s != 0; });
+	}
+
+	int exponents[GROUP_SIZE];
+	int steps[GROUP_SIZE];
+	int count = 0;
+	auto addTerms = [&]() {
+		for (int i = twoS - 1; i >= 0; --i) {
+			int sum = 0;
+			for (int k = 0; k < count; ++k) {
+				sum ^= field.exp(exponents[k]);
+				exponents[k] += steps[k];
+				if (exponents[k] >= order)
+					exponents[k] -= order;
+			}
+			syndromes[i] ^= sum;
+		}
+		count = 0;
+	};
+
+	int degree = numCodewords;
+	for (int c : received) {
+		--degree;
+		if (c == 0)
+			continue;
+		steps[count] = degree % order;
+		exponents[count] = (field.log(c) + field.generatorBase() * steps[count]) % order;
+		if (++count == GROUP_SIZE)
+			addTerms();
+	}
+	if (count > 0)
+		addTerms();
+	return std::any_of(syndromes.begin(), syndromes.end(), [](int s) { return s != 0; });
+}
 
 DecodeStatus
 ReedSolomonDecoder::decode(std::vector<int>& received, int twoS) const
 {
-	GenericGFPoly poly(*_field, received);
-	std::vector<int> syndromeCoefficients(twoS, 0);
-	bool noError = true;
-	for (int i = 0; i < twoS; i++) {
-		int eval = poly.evaluateAt(_field->exp(i + _field->generatorBase()));
-		syndromeCoefficients[twoS - 1 - i] = eval;
-		if (eval != 0) {
-			noError = false;
-		}
+	static const std::vector<int> NO_ERASURES;
+	return decode(received, twoS, NO_ERASURES);
+}
+
+DecodeStatus
+ReedSolomonDecoder::decode(std::vector<int>& received, int twoS, const std::vector<int>& erasures) const
+{
+	int receivedCount = static_cast<int>(received.size());
+	if (static_cast<int>(erasures.size()) > twoS) {
+		return DecodeStatus::ReedSolomonAlgoFailed;
 	}
-	if (noError) {
+
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+	if (!CalculateSyndromes(*_field, received, twoS, scratch.syndromes)) {
 		return DecodeStatus::NoError;
 	}
 
-	ZX_THREAD_LOCAL GenericGFPoly sigma, omega;
+	// The erasure locator gamma(x) = prod(1 - X_k * x) with X_k = a^(n - 1 - position), least significant first
+	auto& gamma = scratch.erasureLocator;
+	gamma.assign(1, 1);
+	for (int position : erasures) {
+		if (position < 0 || position >= receivedCount) {
+			return DecodeStatus::ReedSolomonBadLocation;
+		}
+		int X = _field->exp(receivedCount - 1 - position);
+		gamma.push_back(0);
+		for (size_t i = gamma.size() - 1; i > 0; --i)
+			gamma[i] ^= _field->multiply(X, gamma[i - 1]);
+	}
 
-	auto errStat = RunEuclideanAlgorithm(*_field, std::move(syndromeCoefficients), twoS, sigma, omega);
+	auto errStat = _algorithm == Algorithm::BerlekampMassey && twoS <= MAX_EC_CODEWORDS
+					   ? RunBerlekampMassey(*_field, scratch.syndromes, twoS, gamma, scratch)
+					   : RunEuclideanAlgorithm(*_field, scratch.syndromes, twoS, gamma, scratch);
 	if (StatusIsError(errStat)) {
 		return errStat;
 	}
-	std::vector<int> errorLocations, errorMagnitudes;
-	errStat = FindErrorLocations(*_field, sigma, errorLocations);
+	auto& errorLocations = scratch.errorLocations;
+	auto& errorMagnitudes = scratch.errorMagnitudes;
+	errStat = FindErrorLocations(*_field, scratch.sigma, scratch.chienTerms, errorLocations);
 	if (StatusIsError(errStat)) {
 		return errStat;
 	}
-	FindErrorMagnitudes(*_field, omega, errorLocations, errorMagnitudes);
+	FindErrorMagnitudes(*_field, scratch.omega, errorLocations, errorMagnitudes);
 
-	int receivedCount = static_cast<int>(received.size());
-	for (size_t i = 0; i < errorLocations.size(); ++i) {
-		int position = receivedCount - 1 - _field->log(errorLocations[i]);
-		if (position < 0) {
+	// Check all locations before touching received, so that it is left unchanged on failure
+	for (int location : errorLocations) {
+		if (_field->log(location) >= receivedCount) {
 			return DecodeStatus::ReedSolomonBadLocation;
 		}
+	}
+	for (size_t i = 0; i < errorLocations.size(); ++i) {
+		int position = receivedCount - 1 - _field->log(errorLocations[i]);
 		received[position] = _field->addOrSubtract(received[position], errorMagnitudes[i]);
 	}
 	return DecodeStatus::NoError;
 }
 
+void
+ReedSolomonDecoder::SelectErasures(const std::vector<int>& uncertainty, int maxErasures, std::vector<int>& erasures)
+{
+	erasures.clear();
+	for (int i = 0; i < static_cast<int>(uncertainty.size()); ++i) {
+		if (uncertainty[i] > 0)
+			erasures.push_back(i);
+	}
+	if (static_cast<int>(erasures.size()) > maxErasures) {
+		// the order of a stable sort by uncertainty, but std::stable_sort may allocate a buffer
+		std::sort(erasures.begin(), erasures.end(), [&uncertainty](int a, int b) {
+			return uncertainty[a] > uncertainty[b] || (uncertainty[a] == uncertainty[b] && a < b);
+		});
+		erasures.resize(std::max(maxErasures, 0));
+		std::sort(erasures.begin(), erasures.end());
+	}
+}
+
+DecodeStatus
+ReedSolomonDecoder::decodeWithUncertainty(std::vector<int>& received, int twoS, const std::vector<int>& uncertainty, std::vector<int>& erasures) const
+{
+	SelectErasures(uncertainty, twoS / 2, erasures);
+	if (erasures.empty()) {
+		return DecodeStatus::ReedSolomonError;
+	}
+	return decode(received, twoS, erasures);
+}
+
 } // ZXing
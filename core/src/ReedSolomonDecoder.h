@@ -49,7 +49,25 @@ enum class DecodeStatus;
 class ReedSolomonDecoder
 {
 public:
-	explicit ReedSolomonDecoder(const GenericGF& field) : _field(&field) {}
+	/**
+	* The algorithm that solves the key equation, i.e. finds the error locator and error evaluator
+	* polynomials from the syndromes. Both give the same corrections.
+	*/
+	enum class Algorithm
+	{
+		Euclidean,       // extended Euclidean algorithm on GenericGFPoly objects
+		BerlekampMassey, // Berlekamp-Massey on fixed-capacity arrays on the stack
+	};
+
+	/**
+	* The largest number of error-correction codewords the Berlekamp-Massey implementation handles with its
+	* fixed-capacity buffers (a full range 32 layer Aztec symbol has 1664 12-bit codewords). Larger inputs fall
+	* back to the Euclidean algorithm.
+	*/
+	static const int MAX_EC_CODEWORDS = 1664;
+
+	explicit ReedSolomonDecoder(const GenericGF& field, Algorithm algorithm = Algorithm::Euclidean)
+		: _field(&field), _algorithm(algorithm) {}
 
 	/**
 	* <p>Decodes given set of received codewords, which include both data and error-correction
@@ -62,8 +80,34 @@ public:
 	*/
 	DecodeStatus decode(std::vector<int>& received, int twoS) const;
 
+	/**
+	* <p>Same as above, but additionally takes the positions of codewords known (or suspected) to be wrong.
+	* Each such erasure costs only one error-correction codeword instead of two for an error of unknown
+	* location, i.e. 2 * errors + erasures <= twoS are corrected.</p>
+	*
+	* @param erasures distinct indexes into received
+	*/
+	DecodeStatus decode(std::vector<int>& received, int twoS, const std::vector<int>& erasures) const;
+
+	/**
+	* Picks the indexes with the highest non-zero uncertainty (e.g. the number of unreliably sampled modules
+	* of a codeword) as erasures, at most maxErasures of them, in ascending order.
+	*/
+	static void SelectErasures(const std::vector<int>& uncertainty, int maxErasures, std::vector<int>& erasures);
+
+	/**
+	* Decodes with the most uncertain codewords (see SelectErasures) as erasures. Only half of the error-correction
+	* codewords are spent on erasures, the rest is kept for errors at unknown positions to limit miscorrections.
+	*
+	* @param uncertainty per codeword of received, e.g. the number of its unreliably sampled modules
+	* @param erasures buffer for the selected erasures
+	* @return ReedSolomonError without trying if no codeword is uncertain
+	*/
+	DecodeStatus decodeWithUncertainty(std::vector<int>& received, int twoS, const std::vector<int>& uncertainty, std::vector<int>& erasures) const;
+
 private:
 	const GenericGF* _field;
+	Algorithm _algorithm;
 };
 
 //class ReedSolomonException : public std::exception
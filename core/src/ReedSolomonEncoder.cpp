@@ -17,32 +17,48 @@
 
 #include "ReedSolomonEncoder.h"
 #include "GenericGF.h"
+#include "ZXConfig.h"
+
+#include <utility>
 
 namespace ZXing {
 
+static std::list<GenericGFPoly>& CachedGenerators(const GenericGF& field)
+{
+	ZX_THREAD_LOCAL std::list<std::pair<const GenericGF*, std::list<GenericGFPoly>>> caches;
+	for (auto& cache : caches) {
+		if (cache.first == &field) {
+			return cache.second;
+		}
+	}
+	caches.emplace_back(&field, std::list<GenericGFPoly>());
+	caches.back().second.push_back(GenericGFPoly(field, { 1 }));
+	return caches.back().second;
+}
+
 ReedSolomonEncoder::ReedSolomonEncoder(const GenericGF& field)
 : _field(&field)
 {
-	_cachedGenerators.push_back(GenericGFPoly(field, { 1 }));
 }
 
 const GenericGFPoly&
-ReedSolomonEncoder::buildGenerator(int degree)
+ReedSolomonEncoder::buildGenerator(int degree) const
 {
-	int cachedGenSize = static_cast<int>(_cachedGenerators.size());
+	auto& cachedGenerators = CachedGenerators(*_field);
+	int cachedGenSize = static_cast<int>(cachedGenerators.size());
 	if (degree >= cachedGenSize) {
-		GenericGFPoly lastGenerator = _cachedGenerators.back();
+		GenericGFPoly lastGenerator = cachedGenerators.back();
 		for (int d = cachedGenSize; d <= degree; d++) {
 			lastGenerator.multiply(GenericGFPoly(*_field, { 1, _field->exp(d - 1 + _field->generatorBase()) }));
-			_cachedGenerators.push_back(lastGenerator);
+			cachedGenerators.push_back(lastGenerator);
 		}
 	}
 
-	return *std::next(_cachedGenerators.begin(), degree);
+	return *std::next(cachedGenerators.begin(), degree);
 }
 
 void
-ReedSolomonEncoder::encode(std::vector<int>& toEncode, const int ecBytes)
+ReedSolomonEncoder::encode(std::vector<int>& toEncode, const int ecBytes) const
 {
 	if (ecBytes == 0) {
 		throw std::invalid_argument("No error correction bytes");
@@ -20,18 +20,22 @@
 
 namespace ZXing {
 
+/**
+* The generator polynomials only depend on the field and the degree. They are cached per thread and
+* field, not per instance, so creating an encoder for every symbol does not rebuild them. Each encode()
+* looks up the cache of the calling thread, so an instance may be used from any thread.
+*/
 class ReedSolomonEncoder
 {
 public:
 	ReedSolomonEncoder(const GenericGF& field);
 
-	void encode(std::vector<int>& toEncode, const int ecBytes);
+	void encode(std::vector<int>& toEncode, const int ecBytes) const;
 
 private:
 	const GenericGF* _field;
-	std::list<GenericGFPoly> _cachedGenerators;
 
-	const GenericGFPoly& buildGenerator(int degree);
+	const GenericGFPoly& buildGenerator(int degree) const;
 };
 
 } // ZXing
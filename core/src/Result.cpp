@@ -17,6 +17,8 @@
 
 #include "Result.h"
 
+#include <utility>
+
 namespace ZXing {
 
 Result::Result(DecodeStatus status) :
@@ -24,22 +26,23 @@ Result::Result(DecodeStatus status) :
 {
 }
 
-Result::Result(const std::wstring& text, const ByteArray& rawBytes, const std::vector<ResultPoint>& resultPoints, BarcodeFormat format, time_point tt) :
+Result::Result(std::wstring text, ByteArray rawBytes, std::vector<ResultPoint> resultPoints, BarcodeFormat format, time_point tt) :
 	_status(DecodeStatus::NoError),
-	_text(text),
-	_rawBytes(rawBytes),
-	_resultPoints(resultPoints),
+	_text(std::move(text)),
+	_rawBytes(std::move(rawBytes)),
+	_numBits(8 * _rawBytes.length()),
+	_resultPoints(std::move(resultPoints)),
 	_format(format),
 	_timestamp(tt)
 {
 }
 
-Result::Result(const std::wstring& text, const ByteArray& rawBytes, int numBits, const std::vector<ResultPoint>& resultPoints, BarcodeFormat format, time_point tt) :
+Result::Result(std::wstring text, ByteArray rawBytes, int numBits, std::vector<ResultPoint> resultPoints, BarcodeFormat format, time_point tt) :
 	_status(DecodeStatus::NoError),
-	_text(text),
-	_rawBytes(rawBytes),
+	_text(std::move(text)),
+	_rawBytes(std::move(rawBytes)),
 	_numBits(numBits),
-	_resultPoints(resultPoints),
+	_resultPoints(std::move(resultPoints)),
 	_format(format),
 	_timestamp(tt)
 {
@@ -53,4 +56,11 @@ Result::addResultPoints(const std::vector<ResultPoint>& points)
 	std::copy(points.begin(), points.end(), _resultPoints.begin() + oldSize);
 }
 
+void
+Result::convertTo(BarcodeFormat format, int prefixLength)
+{
+	_text.erase(0, prefixLength);
+	_format = format;
+}
+
 } // ZXing
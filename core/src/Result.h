@@ -41,8 +41,8 @@ public:
 	typedef std::chrono::steady_clock::time_point time_point;
 
 	explicit Result(DecodeStatus status);
-	Result(const std::wstring& text, const ByteArray& rawBytes, const std::vector<ResultPoint>& resultPoints, BarcodeFormat format, time_point tt = std::chrono::steady_clock::now());
-	Result(const std::wstring& text, const ByteArray& rawBytes, int numBits, const std::vector<ResultPoint>& resultPoints, BarcodeFormat format, time_point tt = std::chrono::steady_clock::now());
+	Result(std::wstring text, ByteArray rawBytes, std::vector<ResultPoint> resultPoints, BarcodeFormat format, time_point tt = std::chrono::steady_clock::now());
+	Result(std::wstring text, ByteArray rawBytes, int numBits, std::vector<ResultPoint> resultPoints, BarcodeFormat format, time_point tt = std::chrono::steady_clock::now());
 
 	bool isValid() const {
 		return StatusIsOK(_status);
@@ -78,6 +78,12 @@ public:
 		return _format;
 	}
 
+	/**
+	* Turns this result into one of the given format by dropping the first prefixLength characters of its text,
+	* for a symbology that is read as a larger one, like UPC-A as an EAN-13 starting with 0.
+	*/
+	void convertTo(BarcodeFormat format, int prefixLength);
+
 	time_point timestamp() const {
 		return _timestamp;
 	}
@@ -18,6 +18,8 @@
 #include "ResultMetadata.h"
 #include "ByteArray.h"
 
+#include <utility>
+
 namespace ZXing {
 
 struct ResultMetadata::Value
@@ -49,7 +51,7 @@ struct ResultMetadata::IntegerValue : public Value
 struct ResultMetadata::StringValue : public Value
 {
 	std::wstring value;
-	StringValue(const std::wstring& v) : value(v) {}
+	StringValue(std::wstring v) : value(std::move(v)) {}
 	virtual std::wstring toString() const override {
 		return value;
 	}
@@ -58,7 +60,7 @@ struct ResultMetadata::StringValue : public Value
 struct ResultMetadata::ByteArrayListValue : public Value
 {
 	std::list<ByteArray> value;
-	ByteArrayListValue(const std::list<ByteArray>& v) : value(v) {}
+	ByteArrayListValue(std::list<ByteArray> v) : value(std::move(v)) {}
 	virtual std::list<ByteArray> toByteArrayList() const override {
 		return value;
 	}
@@ -108,15 +110,15 @@ ResultMetadata::put(Key key, int value)
 }
 
 void
-ResultMetadata::put(Key key, const std::wstring& value)
+ResultMetadata::put(Key key, std::wstring value)
 {
-	_contents[key] = std::make_shared<StringValue>(value);
+	_contents[key] = std::make_shared<StringValue>(std::move(value));
 }
 
 void
-ResultMetadata::put(Key key, const std::list<ByteArray>& value)
+ResultMetadata::put(Key key, std::list<ByteArray> value)
 {
-	_contents[key] = std::make_shared<ByteArrayListValue>(value);
+	_contents[key] = std::make_shared<ByteArrayListValue>(std::move(value));
 }
 
 void
@@ -117,8 +117,8 @@ public:
 	std::shared_ptr<CustomData> getCustomData(Key key) const;
 	
 	void put(Key key, int value);
-	void put(Key key, const std::wstring& value);
-	void put(Key key, const std::list<ByteArray>& value);
+	void put(Key key, std::wstring value);
+	void put(Key key, std::list<ByteArray> value);
 	void put(Key key, const std::shared_ptr<CustomData>& value);
 
 	void putAll(const ResultMetadata& other);
@@ -16,12 +16,15 @@
 
 #include "TextDecoder.h"
 #include "CharacterSet.h"
+#include "DecodeContext.h"
 #include "TextUtfEncoding.h"
 #include "textcodec/JPTextDecoder.h"
 #include "textcodec/GBTextDecoder.h"
 #include "textcodec/Big5TextDecoder.h"
 #include "textcodec/KRTextDecoder.h"
 
+#include <algorithm>
+
 namespace ZXing {
 
 namespace Codecs {
@@ -223,6 +226,23 @@ static const uint16_t SINGLE_BYTE_CODEPAGES[] = {
 } // Codecs
 
 
+namespace {
+
+// The UTF-16 output of the multi-byte codecs, kept in the DecodeContext so that its memory gets reused.
+struct Utf16Scratch
+{
+	std::vector<uint16_t> buf;
+};
+
+} // anonymous
+
+static std::vector<uint16_t>& Utf16Buffer()
+{
+	auto& buf = DecodeContext::ThreadLocal().scratch<Utf16Scratch>().buf;
+	buf.clear();
+	return buf;
+}
+
 void
 TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, CharacterSet charset)
 {
@@ -232,7 +252,10 @@ TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, Char
 	case CharacterSet::ISO8859_1:
 	case CharacterSet::ASCII:
 	{
-		str.append(bytes, bytes + length);
+		// not str.append(bytes, bytes + length), which builds a temporary string from the foreign iterators
+		size_t offset = str.length();
+		str.resize(offset + length);
+		std::copy_n(bytes, length, &str[offset]);
 		break;
 	}
 	case CharacterSet::ISO8859_2:
@@ -267,42 +290,42 @@ TextDecoder::Append(std::wstring& str, const uint8_t* bytes, size_t length, Char
 	}
 	case CharacterSet::Shift_JIS:
 	{
-		std::vector<uint16_t> buf;
+		auto& buf = Utf16Buffer();
 		JPTextDecoder::AppendShiftJIS(buf, bytes, length);
 		TextUtfEncoding::AppendUtf16(str, buf.data(), buf.size());
 		break;
 	}
 	case CharacterSet::Big5:
 	{
-		std::vector<uint16_t> buf;
+		auto& buf = Utf16Buffer();
 		Big5TextDecoder::AppendBig5(buf, bytes, length);
 		TextUtfEncoding::AppendUtf16(str, buf.data(), buf.size());
 		break;
 	}
 	case CharacterSet::GB2312:
 	{
-		std::vector<uint16_t> buf;
+		auto& buf = Utf16Buffer();
 		GBTextDecoder::AppendGB2312(buf, bytes, length);
 		TextUtfEncoding::AppendUtf16(str, buf.data(), buf.size());
 		break;
 	}
 	case CharacterSet::GB18030:
 	{
-		std::vector<uint16_t> buf;
+		auto& buf = Utf16Buffer();
 		GBTextDecoder::AppendGB18030(buf, bytes, length);
 		TextUtfEncoding::AppendUtf16(str, buf.data(), buf.size());
 		break;
 	}
 	case CharacterSet::EUC_JP:
 	{
-		std::vector<uint16_t> buf;
+		auto& buf = Utf16Buffer();
 		JPTextDecoder::AppendEUCJP(buf, bytes, length);
 		TextUtfEncoding::AppendUtf16(str, buf.data(), buf.size());
 		break;
 	}
 	case CharacterSet::EUC_KR:
 	{
-		std::vector<uint16_t> buf;
+		auto& buf = Utf16Buffer();
 		KRTextDecoder::AppendEucKr(buf, bytes, length);
 		TextUtfEncoding::AppendUtf16(str, buf.data(), buf.size());
 		break;
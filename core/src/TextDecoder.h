@@ -31,8 +31,10 @@ public:
 	static void Append(std::wstring& str, const uint8_t* bytes, size_t length, CharacterSet charset);
 
 	static void AppendLatin1(std::wstring& str, const std::string& latin1) {
-		auto ptr = (const uint8_t*)latin1.data();
-		str.append(ptr, ptr + latin1.length());
+		// not str.append(ptr, ptr + length), which builds a temporary string from the foreign iterators
+		str.reserve(str.length() + latin1.length());
+		for (char c : latin1)
+			str.push_back(static_cast<uint8_t>(c));
 	}
 	
 	static std::wstring FromLatin1(const std::string& latin1) {
@@ -25,8 +25,10 @@
 	#define ZX_NO_RTTI
 #endif
 
-// Thread local or static memory may be used to reduce the number of (re-)allocations of temporary variables
-// in e.g. the ReedSolomonDecoder. It is desabled by default. It can be enabled by modifying the following define.
+
+// Thread local memory is used to reduce the number of (re-)allocations of temporary variables, see e.g.
+// DecodeContext::ThreadLocal(). It must be 'thread_local': the library itself decodes and encodes on
+// several threads (Pdf417::Reader::decodeMultiple, BatchWriter), so a 'static' replacement would be
+// shared between them.
 // Note: The Apple clang compiler until XCode 8 does not support c++11's thread_local.
-// The alternative 'static' makes the code thread unsafe.
-#define ZX_THREAD_LOCAL // 'thread_local' or 'static'
+#define ZX_THREAD_LOCAL thread_local
@@ -0,0 +1,89 @@
+#pragma once
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <array>
+
+namespace ZXing {
+
+/**
+* A C array wrapped in a literal type. Unlike with std::array in C++11, where data() is not constexpr, a pointer
+* to the elements of a constexpr PlainArray is a constant expression.
+*/
+template <typename T, int N>
+struct PlainArray
+{
+	T values[N];
+};
+
+namespace ConstexprArray {
+
+template <int... I> struct Indexes {};
+
+template <typename A, typename B> struct Concat;
+
+template <int... I, int... J>
+struct Concat<Indexes<I...>, Indexes<J...>>
+{
+	using type = Indexes<I..., (sizeof...(I) + J)...>;
+};
+
+// Indexes<0, 1, ..., N - 1>, built by halving to keep the template recursion shallow
+template <int N>
+struct MakeIndexes
+{
+	using type = typename Concat<typename MakeIndexes<N / 2>::type, typename MakeIndexes<N - N / 2>::type>::type;
+};
+
+template <> struct MakeIndexes<0> { using type = Indexes<>; };
+template <> struct MakeIndexes<1> { using type = Indexes<0>; };
+
+template <typename T, int N, typename Generator, int... I>
+constexpr std::array<T, N> Generate(const Generator& generator, Indexes<I...>)
+{
+	return {{ static_cast<T>(generator(I))... }};
+}
+
+template <typename T, int N, typename Generator, int... I>
+constexpr PlainArray<T, N> GeneratePlain(const Generator& generator, Indexes<I...>)
+{
+	return {{ static_cast<T>(generator(I))... }};
+}
+
+} // ConstexprArray
+
+/**
+* Returns the array {generator(0), generator(1), ..., generator(N - 1)} as a constant expression, so that
+* lookup tables can be computed by the compiler instead of at runtime. generator is an object of a literal
+* type with a constexpr operator()(int). (A C++11 constexpr function cannot fill an array in a loop, hence
+* the elements are expanded from a pack of indexes.)
+*/
+template <typename T, int N, typename Generator>
+constexpr std::array<T, N> GenerateArray(const Generator& generator)
+{
+	return ConstexprArray::Generate<T, N>(generator, typename ConstexprArray::MakeIndexes<N>::type());
+}
+
+/**
+* The same as GenerateArray() as a PlainArray.
+*/
+template <typename T, int N, typename Generator>
+constexpr PlainArray<T, N> GeneratePlainArray(const Generator& generator)
+{
+	return ConstexprArray::GeneratePlain<T, N>(generator, typename ConstexprArray::MakeIndexes<N>::type());
+}
+
+} // ZXing
@@ -0,0 +1,45 @@
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "ZXThreads.h"
+
+#include <algorithm>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace ZXing {
+
+void RunOnThreads(int threadCount, int count, const std::function<void()>& worker)
+{
+	int extraThreads = std::max(std::min(threadCount, count) - 1, 0);
+	std::vector<std::thread> threads;
+	threads.reserve(extraThreads);
+	for (int t = 0; t < extraThreads; ++t) {
+		try {
+			threads.emplace_back(worker);
+		}
+		catch (const std::system_error&) {
+			break;
+		}
+	}
+	worker();
+	for (auto& t : threads) {
+		t.join();
+	}
+}
+
+} // ZXing
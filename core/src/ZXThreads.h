@@ -1,7 +1,6 @@
 #pragma once
 /*
-* Copyright 2016 Huy Cuong Nguyen
-* Copyright 2006 Jeremias Maerki.
+* Copyright 2017 Nu-book Inc.
 *
 * Licensed under the Apache License, Version 2.0 (the "License");
 * you may not use this file except in compliance with the License.
@@ -15,22 +14,17 @@
 * See the License for the specific language governing permissions and
 * limitations under the License.
 */
-#include <vector>
 
-namespace ZXing {
-
-class ByteMatrix;
+#include <functional>
 
-namespace DataMatrix {
+namespace ZXing {
 
 /**
-* Symbol Character Placement Program. Adapted from Annex M.1 in ISO/IEC 16022:2000(E).
+* Calls worker on min(threadCount, count) threads, the calling one included, and returns once all calls
+* returned. The worker has to take the count work items one at a time from a shared counter until none
+* are left, and must not throw. If the system cannot start a thread, the ones already running and the
+* calling thread do all the work.
 */
-class DefaultPlacement
-{
-public:
-	static void Place(const std::vector<int>& codewords, int numcols, int numrows, ByteMatrix& output);
-};
+void RunOnThreads(int threadCount, int count, const std::function<void()>& worker);
 
-} // DataMatrix
 } // ZXing
@@ -25,7 +25,13 @@
 #include "DecodeStatus.h"
 #include "BitMatrix.h"
 #include "TextDecoder.h"
+#include "DecodeContext.h"
+#include "BitHacks.h"
+#include "ByteArray.h"
+#include "ZXConstexprArray.h"
 
+#include <algorithm>
+#include <array>
 #include <numeric>
 
 namespace ZXing {
@@ -40,47 +46,146 @@ enum class Table {
 	BINARY
 };
 
-static const char* UPPER_TABLE[] = {
+static constexpr const char* UPPER_TABLE[] = {
 	"CTRL_PS", " ", "A", "B", "C", "D", "E", "F", "G", "H", "I", "J", "K", "L", "M", "N", "O", "P",
 	"Q", "R", "S", "T", "U", "V", "W", "X", "Y", "Z", "CTRL_LL", "CTRL_ML", "CTRL_DL", "CTRL_BS"
 };
 
-static const char* LOWER_TABLE[] = {
+static constexpr const char* LOWER_TABLE[] = {
 	"CTRL_PS", " ", "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m", "n", "o", "p",
 	"q", "r", "s", "t", "u", "v", "w", "x", "y", "z", "CTRL_US", "CTRL_ML", "CTRL_DL", "CTRL_BS"
 };
 
-static const char* MIXED_TABLE[] = {
+static constexpr const char* MIXED_TABLE[] = {
 	"CTRL_PS", " ", "\1", "\2", "\3", "\4", "\5", "\6", "\7", "\b", "\t", "\n",
 	"\13", "\f", "\r", "\33", "\34", "\35", "\36", "\37", "@", "\\", "^", "_",
 	"`", "|", "~", "\177", "CTRL_LL", "CTRL_UL", "CTRL_PL", "CTRL_BS"
 };
 
-static const char* PUNCT_TABLE[] = {
+static constexpr const char* PUNCT_TABLE[] = {
 	"", "\r", "\r\n", ". ", ", ", ": ", "!", "\"", "#", "$", "%", "&", "'", "(", ")",
 	"*", "+", ",", "-", ".", "/", ":", ";", "<", "=", ">", "?", "[", "]", "{", "}", "CTRL_UL"
 };
 
-static const char* DIGIT_TABLE[] = {
+static constexpr const char* DIGIT_TABLE[] = {
 	"CTRL_PS", " ", "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", ",", ".", "CTRL_UL", "CTRL_US"
 };
 
+namespace {
+
+/**
+* A sequence of bits, most significant bit first, packed into 32 bit words. The bits are appended and read
+* in groups of up to 32. There is always a spare word at the end, so that a read at any index below size()
+* needs no check at the end of the buffer; the bits past size() are 0.
+*/
+class PackedBits
+{
+	std::vector<uint32_t> _words;
+	int _size = 0;
+	uint32_t _pending = 0; // the bits appended since the last full word, in the low bits
+
+public:
+	void clear(int capacity) {
+		_words.assign(capacity / 32 + 2, 0);
+		_size = 0;
+		_pending = 0;
+	}
+
+	int size() const {
+		return _size;
+	}
+
+	/**
+	* Appends the length low bits of value, 1 <= length <= 32
+	*/
+	void append(uint32_t value, int length) {
+		int used = _size & 31;
+		uint64_t bits = (uint64_t(_pending) << length) | (value & (0xffffffffu >> (32 - length)));
+		_size += length;
+		if (used + length >= 32) {
+			int rest = used + length - 32;
+			_words[(_size >> 5) - 1] = static_cast<uint32_t>(bits >> rest);
+			_pending = static_cast<uint32_t>(bits) & ((1u << rest) - 1);
+		}
+		else {
+			_pending = static_cast<uint32_t>(bits);
+		}
+	}
+
+	/**
+	* Writes the last incomplete word, has to be called after appending and before reading
+	*/
+	void flush() {
+		int used = _size & 31;
+		if (used > 0) {
+			_words[_size >> 5] = _pending << (32 - used);
+		}
+	}
+
+	/**
+	* Reads length bits starting at index, 1 <= length <= 32
+	*/
+	uint32_t read(int index, int length) const {
+		uint64_t window = (uint64_t(_words[index >> 5]) << 32) | _words[(index >> 5) + 1];
+		return static_cast<uint32_t>((window << (index & 31)) >> (64 - length));
+	}
+
+	/**
+	* Packs the bits into bytes, the last one padded with 0s
+	*/
+	ByteArray toBytes() const {
+		ByteArray bytes((_size + 7) / 8);
+		for (int i = 0; i < bytes.length(); ++i) {
+			bytes[i] = static_cast<uint8_t>(_words[i >> 2] >> (24 - 8 * (i & 3)));
+		}
+		return bytes;
+	}
+};
+
+// The temporaries of Decode(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::vector<int> alignmentMap;
+	PackedBits rawbits, uncertainBits, correctedBits;
+	std::vector<int> dataWords, uncertainty, erasures;
+	std::string text;
+};
+
+/**
+* The entry of a code in one of the character tables: either the text it stands for, or a mode change to
+* another table, which is a latch or a shift for the next code only.
+*/
+struct TableEntry
+{
+	const char* text;
+	int length;
+	Table mode;
+	bool latch;
+	bool isModeChange;
+};
+
+} // anonymous
+
 inline static int TotalBitsInLayer(int layers, bool compact)
 {
 	return ((compact ? 88 : 112) + 16 * layers) * layers;
 }
 
 /**
-* Gets the array of bits from an Aztec Code matrix
+* Gets the array of bits from an Aztec Code matrix. The bits of a layer are read side by side, every side of
+* the layer two modules deep, with the column of the modules or the row pointer fixed along the side. The bits
+* are appended to the packed array in that order, so they are written a word at a time.
 *
-* @return the array of bits
+* @param matrix the sampled symbol, or a matrix of the same size that flags its modules
+* @param rawbits receives the array of bits
+* @return false if the matrix is too small for the number of layers
 */
-static std::vector<bool> ExtractBits(const DetectorResult& ddata)
+static bool ExtractBits(const DetectorResult& ddata, const BitMatrix& matrix, std::vector<int>& alignmentMap, PackedBits& rawbits)
 {
 	bool compact = ddata.isCompact();
 	int layers = ddata.nbLayers();
 	int baseMatrixSize = (compact ? 11 : 14) + layers * 4; // not including alignment lines
-	std::vector<int> alignmentMap(baseMatrixSize, 0);
+	alignmentMap.assign(baseMatrixSize, 0);
 
 	if (compact) {
 		std::iota(alignmentMap.begin(), alignmentMap.end(), 0);
@@ -95,56 +200,61 @@ static std::vector<bool> ExtractBits(const DetectorResult& ddata)
 			alignmentMap[origCenter + i] = center + newOffset + 1;
 		}
 	}
-	auto matrix = ddata.bits();
-	std::vector<bool> rawbits(TotalBitsInLayer(layers, compact));
-	for (int i = 0, rowOffset = 0; i < layers; i++) {
+	int matrixSize = alignmentMap.back() + 1;
+	if (matrix.width() < matrixSize || matrix.height() < matrixSize) {
+		return false;
+	}
+
+	// Appends the modules (x0 + dx * j, y0 + dy * j) and (x1 + dx * j, y1 + dy * j), for j in [0, rowSize),
+	// alternately, in base matrix coordinates
+	auto appendSide = [&](int x0, int y0, int x1, int y1, int dx, int dy, int rowSize) {
+		uint32_t bits = 0;
+		int count = 0;
+		for (int j = 0; j < rowSize; j++) {
+			bits = (bits << 2) | (static_cast<uint32_t>(matrix.getUnchecked(alignmentMap[x0 + dx * j], alignmentMap[y0 + dy * j])) << 1)
+							   | static_cast<uint32_t>(matrix.getUnchecked(alignmentMap[x1 + dx * j], alignmentMap[y1 + dy * j]));
+			if (++count == 16) {
+				rawbits.append(bits, 32);
+				bits = 0;
+				count = 0;
+			}
+		}
+		if (count > 0) {
+			rawbits.append(bits, 2 * count);
+		}
+	};
+
+	rawbits.clear(TotalBitsInLayer(layers, compact));
+	for (int i = 0; i < layers; i++) {
 		int rowSize = (layers - i) * 4 + (compact ? 9 : 12);
 		// The top-left most point of this layer is <low, low> (not including alignment lines)
 		int low = i * 2;
 		// The bottom-right most point of this layer is <high, high> (not including alignment lines)
 		int high = baseMatrixSize - 1 - low;
 		// We pull bits from the two 2 x rowSize columns and two rowSize x 2 rows
-		for (int j = 0; j < rowSize; j++) {
-			int columnOffset = j * 2;
-			for (int k = 0; k < 2; k++) {
-				// left column
-				rawbits[rowOffset + columnOffset + k] =
-					matrix->get(alignmentMap[low + k], alignmentMap[low + j]);
-				// bottom row
-				rawbits[rowOffset + 2 * rowSize + columnOffset + k] =
-					matrix->get(alignmentMap[low + j], alignmentMap[high - k]);
-				// right column
-				rawbits[rowOffset + 4 * rowSize + columnOffset + k] =
-					matrix->get(alignmentMap[high - k], alignmentMap[high - j]);
-				// top row
-				rawbits[rowOffset + 6 * rowSize + columnOffset + k] =
-					matrix->get(alignmentMap[high - j], alignmentMap[low + k]);
-			}
-		}
-		rowOffset += rowSize * 8;
+		// left column
+		appendSide(low, low, low + 1, low, 0, 1, rowSize);
+		// bottom row
+		appendSide(low, high, low, high - 1, 1, 0, rowSize);
+		// right column
+		appendSide(high, high, high - 1, high, 0, -1, rowSize);
+		// top row
+		appendSide(high, low, high, low + 1, -1, 0, rowSize);
 	}
-	return rawbits;
-}
-
-/**
-* Reads a code of given length and at given index in an array of bits
-*/
-static int ReadCode(const std::vector<bool>& rawbits, int startIndex, int length)
-{
-	int res = 0;
-	for (int i = startIndex; i < startIndex + length; i++) {
-		res = (res << 1) | static_cast<int>(rawbits[i]);
-	}
-	return res;
+	rawbits.flush();
+	return true;
 }
 
 /**
 * <p>Performs RS error correction on an array of bits.</p>
 *
+* If there are too many errors, the error correction is retried with the codewords containing unreliably
+* sampled modules (see DetectorResult::uncertainModules()) as erasures.
+*
 * @return the corrected array
 * @throws FormatException if the input contains too many errors
 */
-static bool CorrectBits(const DetectorResult& ddata, const std::vector<bool>& rawbits, std::vector<bool>& correctedBits)
+static bool CorrectBits(const DetectorResult& ddata, const PackedBits& rawbits, Scratch& scratch, PackedBits& correctedBits)
 {
 	const GenericGF* gf = nullptr;
 	int codewordSize;
@@ -167,138 +277,161 @@ static bool CorrectBits(const DetectorResult& ddata, const std::vector<bool>& ra
 	}
 
 	int numDataCodewords = ddata.nbDatablocks();
-	int numCodewords = static_cast<int>(rawbits.size()) / codewordSize;
+	int numCodewords = rawbits.size() / codewordSize;
 	if (numCodewords < numDataCodewords) {
 		return false;
 	}
 	int offset = rawbits.size() % codewordSize;
 	int numECCodewords = numCodewords - numDataCodewords;
 
-	
-	std::vector<int> dataWords(numCodewords);
-	for (int i = 0; i < numCodewords; i++, offset += codewordSize) {
-		dataWords[i] = ReadCode(rawbits, offset, codewordSize);
+	auto& dataWords = scratch.dataWords;
+	dataWords.resize(numCodewords);
+	for (int i = 0, o = offset; i < numCodewords; i++, o += codewordSize) {
+		dataWords[i] = rawbits.read(o, codewordSize);
 	}
 
-	if (StatusIsError(ReedSolomonDecoder(*gf).decode(dataWords, numECCodewords))) {
-		return false;
+	ReedSolomonDecoder rsDecoder(*gf);
+	if (StatusIsError(rsDecoder.decode(dataWords, numECCodewords))) {
+		// Too many errors, retry with the unreliable codewords as erasures
+		auto uncertain = ddata.uncertainModules()();
+		auto& uncertainBits = scratch.uncertainBits;
+		if (uncertain == nullptr || !ExtractBits(ddata, *uncertain, scratch.alignmentMap, uncertainBits)) {
+			return false;
+		}
+		auto& uncertainty = scratch.uncertainty;
+		uncertainty.resize(numCodewords);
+		for (int i = 0, o = offset; i < numCodewords; i++, o += codewordSize) {
+			dataWords[i] = rawbits.read(o, codewordSize);
+			uncertainty[i] = BitHacks::CountBitsSet(uncertainBits.read(o, codewordSize));
+		}
+		if (StatusIsError(rsDecoder.decodeWithUncertainty(dataWords, numECCodewords, uncertainty, scratch.erasures))) {
+			return false;
+		}
 	}
 
-	// Now perform the unstuffing operation.
-	// First, count how many bits are going to be thrown out as stuffing
+	// Now perform the unstuffing operation: unpack the bits and remove the stuffing
 	int mask = (1 << codewordSize) - 1;
-	int stuffedBits = 0;
+	correctedBits.clear(numDataCodewords * codewordSize);
 	for (int i = 0; i < numDataCodewords; i++) {
 		int dataWord = dataWords[i];
 		if (dataWord == 0 || dataWord == mask) {
 			return false;
 		}
 		else if (dataWord == 1 || dataWord == mask - 1) {
-			stuffedBits++;
-		}
-	}
-	// Now, actually unpack the bits and remove the stuffing
-	correctedBits.resize(numDataCodewords * codewordSize - stuffedBits);
-	int index = 0;
-	for (int i = 0; i < numDataCodewords; i++) {
-		int dataWord = dataWords[i];
-		if (dataWord == 1 || dataWord == mask - 1) {
 			// next codewordSize-1 bits are all zeros or all ones
-			std::fill_n(correctedBits.begin() + index, codewordSize - 1, dataWord > 1);
-			index += codewordSize - 1;
+			correctedBits.append(dataWord > 1 ? mask : 0, codewordSize - 1);
 		}
 		else {
-			for (int bit = codewordSize - 1; bit >= 0; --bit) {
-				correctedBits[index++] = (dataWord & (1 << bit)) != 0;
-			}
+			correctedBits.append(dataWord, codewordSize);
 		}
 	}
+	correctedBits.flush();
 	return true;
 }
 
 /**
 * gets the table corresponding to the char passed
 */
-static Table GetTable(char t)
+static constexpr Table GetTable(char t)
 {
-	switch (t) {
-	case 'L':
-		return Table::LOWER;
-	case 'P':
-		return Table::PUNCT;
-	case 'M':
-		return Table::MIXED;
-	case 'D':
-		return Table::DIGIT;
-	case 'B':
-		return Table::BINARY;
-	case 'U':
-	default:
-		return Table::UPPER;
-	}
+	return t == 'L' ? Table::LOWER
+		: t == 'P' ? Table::PUNCT
+		: t == 'M' ? Table::MIXED
+		: t == 'D' ? Table::DIGIT
+		: t == 'B' ? Table::BINARY
+		: Table::UPPER;
 }
 
 /**
-* Gets the character (or string) corresponding to the passed code in the given table
+* Gets the character (or string) corresponding to the passed code in the given table. The digit table has
+* only 16 codes, the others give "".
 *
 * @param table the table used
 * @param code the code of the character
 */
-static const char* GetCharacter(Table table, int code)
+static constexpr const char* GetCharacter(Table table, int code)
 {
-	switch (table) {
-	case Table::UPPER:
-		return UPPER_TABLE[code];
-	case Table::LOWER:
-		return LOWER_TABLE[code];
-	case Table::MIXED:
-		return MIXED_TABLE[code];
-	case Table::PUNCT:
-		return PUNCT_TABLE[code];
-	case Table::DIGIT:
-		return DIGIT_TABLE[code];
-	default:
-		return nullptr;
-		// Should not reach here.
-		//throw new IllegalStateException("Bad table");
-	}
+	return table == Table::UPPER ? UPPER_TABLE[code]
+		: table == Table::LOWER ? LOWER_TABLE[code]
+		: table == Table::MIXED ? MIXED_TABLE[code]
+		: table == Table::PUNCT ? PUNCT_TABLE[code]
+		: table == Table::DIGIT && code < 16 ? DIGIT_TABLE[code]
+		: "";
 }
 
+static constexpr int Length(const char* str)
+{
+	return *str == '\0' ? 0 : 1 + Length(str + 1);
+}
+
+static constexpr bool IsModeChange(const char* str)
+{
+	return str[0] == 'C' && str[1] == 'T' && str[2] == 'R' && str[3] == 'L' && str[4] == '_';
+}
+
+static constexpr TableEntry MakeTableEntry(Table table, const char* str)
+{
+	return { str, Length(str), IsModeChange(str) ? GetTable(str[5]) : table, IsModeChange(str) && str[6] == 'L', IsModeChange(str) };
+}
+
+// Parses code n of a table into its entry
+struct TableEntryOf
+{
+	Table table;
+
+	constexpr TableEntry operator()(int n) const {
+		return MakeTableEntry(table, GetCharacter(table, n));
+	}
+};
+
+// Parses all codes of table n
+struct TableEntriesOf
+{
+	constexpr std::array<TableEntry, 32> operator()(int n) const {
+		return GenerateArray<TableEntry, 32>(TableEntryOf{ static_cast<Table>(n) });
+	}
+};
+
+/**
+* The character tables with the "CTRL_" entries parsed into mode changes, indexed by table and code, computed
+* by the compiler.
+*/
+static constexpr std::array<std::array<TableEntry, 32>, 5> TABLE_ENTRIES = GenerateArray<std::array<TableEntry, 32>, 5>(TableEntriesOf());
+
 /**
 * Gets the string encoded in the aztec code bits
 *
-* @return the decoded string
+* @param result set to the decoded string
 */
-static std::string GetEncodedData(const std::vector<bool>& correctedBits)
+static void GetEncodedData(const PackedBits& correctedBits, std::string& result)
 {
-	int endIndex = static_cast<int>(correctedBits.size());
+	int endIndex = correctedBits.size();
 	Table latchTable = Table::UPPER; // table most recently latched to
 	Table shiftTable = Table::UPPER; // table to use for the next read
-	std::string result;
-	result.reserve(20);
+	result.clear();
+	result.reserve(endIndex / 5);
 	int index = 0;
 	while (index < endIndex) {
 		if (shiftTable == Table::BINARY) {
 			if (endIndex - index < 5) {
 				break;
 			}
-			int length = ReadCode(correctedBits, index, 5);
+			int length = correctedBits.read(index, 5);
 			index += 5;
 			if (length == 0) {
 				if (endIndex - index < 11) {
 					break;
 				}
-				length = ReadCode(correctedBits, index, 11) + 31;
+				length = correctedBits.read(index, 11) + 31;
 				index += 11;
 			}
-			for (int charCount = 0; charCount < length; charCount++) {
-				if (endIndex - index < 8) {
-					index = endIndex;  // Force outer loop to exit
-					break;
-				}
-				int code = ReadCode(correctedBits, index, 8);
-				result.push_back((char)code);
-				index += 8;
+			// Force outer loop to exit if the bytes are cut short
+			int available = std::min(length, (endIndex - index) / 8);
+			for (int charCount = 0; charCount < available; charCount++, index += 8) {
+				result.push_back(static_cast<char>(correctedBits.read(index, 8)));
+			}
+			if (available < length) {
+				index = endIndex;
 			}
 			// Go back to whatever mode we had been in
 			shiftTable = latchTable;
@@ -308,63 +441,41 @@ static std::string GetEncodedData(const std::vector<bool>& correctedBits)
 			if (endIndex - index < size) {
 				break;
 			}
-			int code = ReadCode(correctedBits, index, size);
+			const TableEntry& entry = TABLE_ENTRIES[static_cast<int>(shiftTable)][correctedBits.read(index, size)];
 			index += size;
-			const char* str = GetCharacter(shiftTable, code);
-			if (std::strncmp(str, "CTRL_", 5) == 0) {
+			if (entry.isModeChange) {
 				// Table changes
 				// ISO/IEC 24778:2008 prescibes ending a shift sequence in the mode from which it was invoked.
 				// That's including when that mode is a shift.
 				// Our test case dlusbs.png for issue #642 exercises that.
 				latchTable = shiftTable;  // Latch the current mode, so as to return to Upper after U/S B/S
-				shiftTable = GetTable(str[5]);
-				if (str[6] == 'L') {
+				shiftTable = entry.mode;
+				if (entry.latch) {
 					latchTable = shiftTable;
 				}
 			}
 			else {
-				result.append(str);
+				result.append(entry.text, entry.length);
 				// Go back to whatever mode we had been in
 				shiftTable = latchTable;
 			}
 		}
 	}
-	return result;
-}
-
-/**
-* Reads a code of length 8 in an array of bits, padding with zeros
-*/
-static uint8_t ReadByte(const std::vector<bool>& rawbits, int startIndex)
-{
-	int n = static_cast<int>(rawbits.size()) - startIndex;
-	if (n >= 8) {
-		return static_cast<uint8_t>(ReadCode(rawbits, startIndex, 8));
-	}
-	return static_cast<uint8_t>(ReadCode(rawbits, startIndex, n) << (8 - n));
-}
-
-/**
-* Packs a bit array into bytes, most significant bit first
-*/
-static ByteArray ConvertBoolArrayToByteArray(const std::vector<bool>& boolArr)
-{
-	ByteArray byteArr(((int)boolArr.size() + 7) / 8);
-	for (int i = 0; i < byteArr.length(); ++i) {
-		byteArr[i] = ReadByte(boolArr, 8 * i);
-	}
-	return byteArr;
 }
 
 DecodeStatus
 Decoder::Decode(const DetectorResult& detectorResult, DecoderResult& result)
 {
-	std::vector<bool> rawbits = ExtractBits(detectorResult);
-	std::vector<bool> correctedBits;
-	if (CorrectBits(detectorResult, rawbits, correctedBits)) {
-		result.setText(TextDecoder::FromLatin1(GetEncodedData(correctedBits)));
-		result.setRawBytes(ConvertBoolArrayToByteArray(correctedBits));
-		result.setNumBits(static_cast<int>(correctedBits.size()));
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+	auto& correctedBits = scratch.correctedBits;
+	if (!ExtractBits(detectorResult, *detectorResult.bits(), scratch.alignmentMap, scratch.rawbits)) {
+		return DecodeStatus::FormatError;
+	}
+	if (CorrectBits(detectorResult, scratch.rawbits, scratch, correctedBits)) {
+		GetEncodedData(correctedBits, scratch.text);
+		result.setText(TextDecoder::FromLatin1(scratch.text));
+		result.setRawBytes(correctedBits.toBytes());
+		result.setNumBits(correctedBits.size());
 		return DecodeStatus::NoError;
 	}
 	else {
@@ -23,7 +23,9 @@
 #include "GenericGF.h"
 #include "WhiteRectDetector.h"
 #include "GridSampler.h"
+#include "PerspectiveTransform.h"
 #include "DecodeStatus.h"
+#include "DecodeContext.h"
 #include "BitMatrix.h"
 
 #include <array>
@@ -31,6 +33,17 @@
 namespace ZXing {
 namespace Aztec {
 
+namespace {
+
+// The temporaries of Detect(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::vector<int> parameterWords;
+	std::shared_ptr<BitMatrix> bits;
+};
+
+} // anonymous
+
 static const int EXPECTED_CORNER_BITS[] = {
 	0xee0,  // 07340  XXX .XX X.. ...
 	0x1dc,  // 00734  ... XXX .XX X..
@@ -136,7 +149,8 @@ static bool GetCorrectedParameterData(int64_t parameterData, bool compact, int&
 	}
 
 	int numECCodewords = numCodewords - numDataCodewords;
-	std::vector<int> parameterWords(numCodewords);
+	auto& parameterWords = DecodeContext::ThreadLocal().scratch<Scratch>().parameterWords;
+	parameterWords.resize(numCodewords);
 	for (int i = numCodewords - 1; i >= 0; --i) {
 		parameterWords[i] = (int)parameterData & 0xF;
 		parameterData >>= 4;
@@ -495,16 +509,14 @@ static void GetMatrixCornerPoints(std::array<ResultPoint, 4>& bullsEyeCorners, b
 * topLeft, topRight, bottomRight, and bottomLeft are the centers of the squares on the
 * diagonal just outside the bull's eye.
 */
-static DecodeStatus SampleGrid(const BitMatrix& image, const ResultPoint& topLeft, const ResultPoint& topRight, const ResultPoint& bottomRight, const ResultPoint& bottomLeft, bool compact, int nbLayers, int nbCenterLayers, BitMatrix& result)
+static DecodeStatus SampleGrid(const std::shared_ptr<const BitMatrix>& image, const ResultPoint& topLeft, const ResultPoint& topRight, const ResultPoint& bottomRight, const ResultPoint& bottomLeft, bool compact, int nbLayers, int nbCenterLayers, const std::shared_ptr<const GridSampler>& sampler, BitMatrix& result, UncertainModules& uncertainModules)
 {
 	int dimension = GetDimension(compact, nbLayers);
 
 	float low = dimension / 2.0f - nbCenterLayers;
 	float high = dimension / 2.0f + nbCenterLayers;
 
-	return GridSampler::Instance()->sampleGrid(image,
-		dimension,
-		dimension,
+	auto transform = PerspectiveTransform::QuadrilateralToQuadrilateral(
 		low, low,   // topleft
 		high, low,  // topright
 		high, high, // bottomright
@@ -512,14 +524,29 @@ static DecodeStatus SampleGrid(const BitMatrix& image, const ResultPoint& topLef
 		topLeft.x(), topLeft.y(),
 		topRight.x(), topRight.y(),
 		bottomRight.x(), bottomRight.y(),
-		bottomLeft.x(), bottomLeft.y(),
-		result);
+		bottomLeft.x(), bottomLeft.y());
+	auto status = sampler->sampleGrid(*image, dimension, dimension, transform, result);
+	if (StatusIsOK(status))
+		uncertainModules = UncertainModules(sampler, image, dimension, dimension, transform);
+	return status;
 }
 
 
 DecodeStatus
 Detector::Detect(const BitMatrix& image, bool isMirror, DetectorResult& result)
 {
+	// The image is not shared with us, so the result must not keep it for its uncertain modules.
+	std::shared_ptr<const BitMatrix> unowned(std::shared_ptr<const BitMatrix>(), &image);
+	auto status = Detect(unowned, isMirror, GridSampler::Instance(), result);
+	result.setUncertainModules(UncertainModules());
+	return status;
+}
+
+DecodeStatus
+Detector::Detect(const std::shared_ptr<const BitMatrix>& sharedImage, bool isMirror, const std::shared_ptr<const GridSampler>& sampler, DetectorResult& result)
+{
+	const BitMatrix& image = *sharedImage;
+
 	// 1. Get the center of the aztec matrix
 	auto pCenter = GetMatrixCenter(image);
 
@@ -545,8 +572,12 @@ Detector::Detect(const BitMatrix& image, bool isMirror, DetectorResult& result)
 	}
 
 	// 4. Sample the grid
-	auto bits = std::make_shared<BitMatrix>();
-	auto status = SampleGrid(image, bullsEyeCorners[shift % 4], bullsEyeCorners[(shift + 1) % 4], bullsEyeCorners[(shift + 2) % 4], bullsEyeCorners[(shift + 3) % 4], compact, nbLayers, nbCenterLayers, *bits);
+	// The matrix is only reused once the DetectorResult of the previous call is gone.
+	auto& bits = DecodeContext::ThreadLocal().scratch<Scratch>().bits;
+	if (bits == nullptr || bits.use_count() > 1)
+		bits = std::make_shared<BitMatrix>();
+	UncertainModules uncertainModules;
+	auto status = SampleGrid(sharedImage, bullsEyeCorners[shift % 4], bullsEyeCorners[(shift + 1) % 4], bullsEyeCorners[(shift + 2) % 4], bullsEyeCorners[(shift + 3) % 4], compact, nbLayers, nbCenterLayers, sampler, *bits, uncertainModules);
 	if (StatusIsError(status)) {
 		return status;
 	}
@@ -555,7 +586,8 @@ Detector::Detect(const BitMatrix& image, bool isMirror, DetectorResult& result)
 	GetMatrixCornerPoints(bullsEyeCorners, compact, nbLayers, nbCenterLayers);
 
 	result.setBits(bits);
-	result.setPoints({ bullsEyeCorners.begin(), bullsEyeCorners.end() });
+	result.setUncertainModules(uncertainModules);
+	result.setPoints({ bullsEyeCorners[0], bullsEyeCorners[1], bullsEyeCorners[2], bullsEyeCorners[3] });
 	result.setCompact(compact);
 	result.setNbDatablocks(nbDataBlocks);
 	result.setNbLayers(nbLayers);
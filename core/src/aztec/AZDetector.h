@@ -16,9 +16,12 @@
 * limitations under the License.
 */
 
+#include <memory>
+
 namespace ZXing {
 
 class BitMatrix;
+class GridSampler;
 enum class DecodeStatus;
 
 namespace Aztec {
@@ -43,6 +46,13 @@ public:
 	* @throws NotFoundException if no Aztec Code can be found
 	*/
 	static DecodeStatus Detect(const BitMatrix& image, bool isMirror, DetectorResult& result);
+
+	/**
+	* Same as above, but reads the modules off the image with the given sampler instead of GridSampler::Instance().
+	* The result shares the image and the sampler to compute its uncertain modules, which the result of the
+	* overload above has none of.
+	*/
+	static DecodeStatus Detect(const std::shared_ptr<const BitMatrix>& image, bool isMirror, const std::shared_ptr<const GridSampler>& sampler, DetectorResult& result);
 };
 
 } // Aztec
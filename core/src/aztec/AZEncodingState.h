@@ -15,14 +15,10 @@
 * See the License for the specific language governing permissions and
 * limitations under the License.
 */
-#include "aztec/AZToken.h"
-#include <vector>
 
 namespace ZXing {
 namespace Aztec {
 
-class Token;
-
 /**
 * State represents all information about a sequence necessary to generate the current output.
 * Note that a state is immutable.
@@ -30,9 +26,10 @@ class Token;
 class EncodingState
 {
 public:
-	// The list of tokens that we output.  If we are in Binary Shift mode, this
-	// token list does *not* yet included the token for those bytes
-	std::vector<Token> tokens;
+	// The last token that we output, as an index into the token arena of the encoder, or -1 if there is none.
+	// Each token links to the one before it, so states that share a prefix share its tokens. If we are in
+	// Binary Shift mode, this chain does *not* yet include the token for those bytes
+	int lastToken;
 
 	// The current mode of the encoding (or the mode to which we'll return if
 	// we're in Binary Shift mode.
@@ -19,11 +19,12 @@
 #include "aztec/AZEncodingState.h"
 #include "aztec/AZToken.h"
 #include "BitArray.h"
-#include "ZXContainerAlgorithms.h"
+#include "ZXConstexprArray.h"
 
+#include <algorithm>
 #include <array>
 #include <type_traits>
-#include <list>
+#include <vector>
 
 namespace ZXing {
 namespace Aztec {
@@ -73,128 +74,160 @@ static const std::array<std::array<int, 5>, 5> LATCH_TABLE = {
 		0,
 };
 
+static constexpr int8_t MIXED_TABLE[] = {
+	0x00, 0x20, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
+	0x0b, 0x0c, 0x0d, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x40, 0x5c, 0x5e,
+	0x5f, 0x60, 0x7c, 0x7d, 0x7f,
+};
+
+static constexpr char PUNCT_TABLE[] = {
+	'\0', '\r', '\0', '\0', '\0', '\0', '!', '\'', '#', '$', '%', '&', '\'',
+	'(', ')', '*', '+', ',', '-', '.', '/', ':', ';', '<', '=', '>', '?',
+	'[', ']', '{', '}'
+};
+
+// The last index of c in table[0, i], or 0 if there is none
+template <typename T, int N>
+static constexpr int LastIndexOf(const T (&table)[N], int c, int i = N - 1)
+{
+	return i < 0 ? 0 : table[i] == c ? i : LastIndexOf(table, c, i - 1);
+}
+
+// Computes one row of CHAR_MAP
+struct CharMapRow
+{
+	int mode;
+
+	constexpr int operator()(int c) const {
+		return c == ' ' && mode != MODE_MIXED && mode != MODE_PUNCT ? 1
+			: mode == MODE_UPPER ? (c >= 'A' && c <= 'Z' ? c - 'A' + 2 : 0)
+			: mode == MODE_LOWER ? (c >= 'a' && c <= 'z' ? c - 'a' + 2 : 0)
+			: mode == MODE_DIGIT ? (c >= '0' && c <= '9' ? c - '0' + 2 : c == ',' ? 12 : c == '.' ? 13 : 0)
+			: mode == MODE_MIXED ? LastIndexOf(MIXED_TABLE, c)
+			: c == 0 ? 0 : LastIndexOf(PUNCT_TABLE, c);
+	}
+};
+
 // A reverse mapping from [mode][char] to the encoding for that character
 // in that mode.  An entry of 0 indicates no mapping exists.
-static const std::array<std::array<int8_t, 256>, 5>& InitCharMap()
+static constexpr std::array<std::array<int8_t, 256>, 5> CHAR_MAP = {{
+	GenerateArray<int8_t, 256>(CharMapRow{MODE_UPPER}),
+	GenerateArray<int8_t, 256>(CharMapRow{MODE_LOWER}),
+	GenerateArray<int8_t, 256>(CharMapRow{MODE_DIGIT}),
+	GenerateArray<int8_t, 256>(CharMapRow{MODE_MIXED}),
+	GenerateArray<int8_t, 256>(CharMapRow{MODE_PUNCT}),
+}};
+
+// A map showing the available shift codes.  (The shifts to BINARY are not shown
+static constexpr std::array<std::array<int8_t, 6>, 6> SHIFT_TABLE = {{
+	{{-1, -1, -1, -1,  0, -1}}, // UPPER -> PUNCT
+	{{28, -1, -1, -1,  0, -1}}, // LOWER -> UPPER, PUNCT
+	{{15, -1, -1, -1,  0, -1}}, // DIGIT -> UPPER, PUNCT
+	{{-1, -1, -1, -1,  0, -1}}, // MIXED -> PUNCT
+	{{-1, -1, -1, -1, -1, -1}},
+	{{-1, -1, -1, -1, -1, -1}},
+}};
+
+namespace {
+
+// A token in the arena, linked to the token before it
+struct TokenNode
 {
-	static std::array<std::array<int8_t, 256>, 5> charmap = {};
-	charmap[MODE_UPPER][' '] = 1;
-	for (int c = 'A'; c <= 'Z'; c++) {
-		charmap[MODE_UPPER][c] = c - 'A' + 2;
-	}
-	charmap[MODE_LOWER][' '] = 1;
-	for (int c = 'a'; c <= 'z'; c++) {
-		charmap[MODE_LOWER][c] = c - 'a' + 2;
-	}
-	charmap[MODE_DIGIT][' '] = 1;
-	for (int c = '0'; c <= '9'; c++) {
-		charmap[MODE_DIGIT][c] = c - '0' + 2;
-	}
-	charmap[MODE_DIGIT][','] = 12;
-	charmap[MODE_DIGIT]['.'] = 13;
-	const int8_t mixedTable[] = {
-		0x00, 0x20, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
-		0x0b, 0x0c, 0x0d, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x40, 0x5c, 0x5e,
-		0x5f, 0x60, 0x7c, 0x7d, 0x7f,
-	};
-	for (uint8_t i = 0; i < Length(mixedTable); i++) {
-		charmap[MODE_MIXED][mixedTable[i]] = i;
+	Token token;
+	int previous;
+};
+
+/**
+* The tokens of all states created while encoding. A state only refers to its last token, appending a token
+* to a state adds a node that links back to it. So a new state costs a few nodes instead of a copy of all its
+* tokens, and the states that survive share the tokens of their common past.
+*/
+class TokenArena
+{
+	std::vector<TokenNode> _nodes;
+
+public:
+	int append(int previous, const Token& token) {
+		_nodes.push_back(TokenNode{ token, previous });
+		return static_cast<int>(_nodes.size()) - 1;
 	}
-	const char punctTable[] = {
-		'\0', '\r', '\0', '\0', '\0', '\0', '!', '\'', '#', '$', '%', '&', '\'',
-		'(', ')', '*', '+', ',', '-', '.', '/', ':', ';', '<', '=', '>', '?',
-		'[', ']', '{', '}'
-	};
-	for (uint8_t i = 0; i < Length(punctTable); i++) {
-		if (punctTable[i] > 0) {
-			charmap[MODE_PUNCT][punctTable[i]] = i;
-		}
+
+	const TokenNode& operator[](int index) const {
+		return _nodes[index];
 	}
-	return charmap;
-}
-const std::array<std::array<int8_t, 256>, 5>& CHAR_MAP = InitCharMap();
 
-// A map showing the available shift codes.  (The shifts to BINARY are not shown
-static const std::array<std::array<int8_t, 6>, 6>& InitShiftTable()
-{
-	static std::array<std::array<int8_t, 6>, 6> table;
+	int size() const {
+		return static_cast<int>(_nodes.size());
+	}
 
-	for (auto& row : table) {
-		std::fill(row.begin(), row.end(), -1);
+	// Drops the nodes from size on, they must not be referenced by any state
+	void truncate(int size) {
+		_nodes.resize(size, TokenNode{ Token(0, 0), -1 });
 	}
-	table[MODE_UPPER][MODE_PUNCT] = 0;
-	table[MODE_LOWER][MODE_PUNCT] = 0;
-	table[MODE_LOWER][MODE_UPPER] = 28;
-	table[MODE_MIXED][MODE_PUNCT] = 0;
-	table[MODE_DIGIT][MODE_PUNCT] = 0;
-	table[MODE_DIGIT][MODE_UPPER] = 15;
-	return table;
-}
+};
 
-const std::array<std::array<int8_t, 6>, 6>& SHIFT_TABLE = InitShiftTable();
+} // anonymous
 
 // Create a new state representing this state with a latch to a (not
 // necessary different) mode, and then a code.
-static EncodingState LatchAndAppend(const EncodingState& state, int mode, int value)
+static EncodingState LatchAndAppend(TokenArena& arena, const EncodingState& state, int mode, int value)
 {
 	//assert binaryShiftByteCount == 0;
 	int bitCount = state.bitCount;
-	auto tokens = state.tokens;
+	int lastToken = state.lastToken;
 	if (mode != state.mode) {
 		int latch = LATCH_TABLE[state.mode][mode];
-		tokens.push_back(Token::CreateSimple(latch & 0xFFFF, latch >> 16));
+		lastToken = arena.append(lastToken, Token::CreateSimple(latch & 0xFFFF, latch >> 16));
 		bitCount += latch >> 16;
 	}
 	int latchModeBitCount = mode == MODE_DIGIT ? 4 : 5;
-	tokens.push_back(Token::CreateSimple(value, latchModeBitCount));
-	return EncodingState{ tokens, mode, 0, bitCount + latchModeBitCount };
+	lastToken = arena.append(lastToken, Token::CreateSimple(value, latchModeBitCount));
+	return EncodingState{ lastToken, mode, 0, bitCount + latchModeBitCount };
 }
 
 // Create a new state representing this state, with a temporary shift
 // to a different mode to output a single value.
-static EncodingState ShiftAndAppend(const EncodingState& state, int mode, int value)
+static EncodingState ShiftAndAppend(TokenArena& arena, const EncodingState& state, int mode, int value)
 {
 	//assert binaryShiftByteCount == 0 && this.mode != mode;
 	int thisModeBitCount = state.mode == MODE_DIGIT ? 4 : 5;
 	// Shifts exist only to UPPER and PUNCT, both with tokens size 5.
-	auto tokens = state.tokens;
-	tokens.push_back(Token::CreateSimple(SHIFT_TABLE[state.mode][mode], thisModeBitCount));
-	tokens.push_back(Token::CreateSimple(value, 5));
-	return EncodingState{ tokens, state.mode, 0, state.bitCount + thisModeBitCount + 5 };
+	int lastToken = arena.append(state.lastToken, Token::CreateSimple(SHIFT_TABLE[state.mode][mode], thisModeBitCount));
+	lastToken = arena.append(lastToken, Token::CreateSimple(value, 5));
+	return EncodingState{ lastToken, state.mode, 0, state.bitCount + thisModeBitCount + 5 };
 }
 
 // Create the state identical to this one, but we are no longer in
 // Binary Shift mode.
-static EncodingState EndBinaryShift(const EncodingState& state, int index)
+static EncodingState EndBinaryShift(TokenArena& arena, const EncodingState& state, int index)
 {
 	if (state.binaryShiftByteCount == 0) {
 		return state;
 	}
-	auto tokens = state.tokens;
-	tokens.push_back(Token::CreateBinaryShift(index - state.binaryShiftByteCount, state.binaryShiftByteCount));
+	int lastToken = arena.append(state.lastToken, Token::CreateBinaryShift(index - state.binaryShiftByteCount, state.binaryShiftByteCount));
 	//assert token.getTotalBitCount() == this.bitCount;
-	return EncodingState{ tokens, state.mode, 0, state.bitCount };
+	return EncodingState{ lastToken, state.mode, 0, state.bitCount };
 }
 
 // Create a new state representing this state, but an additional character
 // output in Binary Shift mode.
-static EncodingState AddBinaryShiftChar(const EncodingState& state, int index)
+static EncodingState AddBinaryShiftChar(TokenArena& arena, const EncodingState& state, int index)
 {
-	auto tokens = state.tokens;
+	int lastToken = state.lastToken;
 	int mode = state.mode;
 	int bitCount = state.bitCount;
 	if (state.mode == MODE_PUNCT || state.mode == MODE_DIGIT) {
 		//assert binaryShiftByteCount == 0;
 		int latch = LATCH_TABLE[mode][MODE_UPPER];
-		tokens.push_back(Token::CreateSimple(latch & 0xFFFF, latch >> 16));
+		lastToken = arena.append(lastToken, Token::CreateSimple(latch & 0xFFFF, latch >> 16));
 		bitCount += latch >> 16;
 		mode = MODE_UPPER;
 	}
 	int deltaBitCount = (state.binaryShiftByteCount == 0 || state.binaryShiftByteCount == 31) ? 18 : (state.binaryShiftByteCount == 62) ? 9 : 8;
-	EncodingState result{ tokens, mode, state.binaryShiftByteCount + 1, bitCount + deltaBitCount };
+	EncodingState result{ lastToken, mode, state.binaryShiftByteCount + 1, bitCount + deltaBitCount };
 	if (result.binaryShiftByteCount == 2047 + 31) {
 		// The string is as long as it's allowed to be.  We should end it.
-		result = EndBinaryShift(result, index + 1);
+		result = EndBinaryShift(arena, result, index + 1);
 	}
 	return result;
 }
@@ -212,77 +245,106 @@ static bool IsBetterThanOrEqualTo(const EncodingState& state, const EncodingStat
 	return mySize <= other.bitCount;
 }
 
-static void ToBitArray(const EncodingState& state, const std::string& text, BitArray& bitArray)
+static void ToBitArray(TokenArena& arena, const EncodingState& state, const std::string& text, BitArray& bitArray)
 {
-	auto endState = EndBinaryShift(state, static_cast<int>(text.length()));
+	auto endState = EndBinaryShift(arena, state, static_cast<int>(text.length()));
+	std::vector<int> chain;
+	for (int i = endState.lastToken; i >= 0; i = arena[i].previous) {
+		chain.push_back(i);
+	}
 	bitArray = BitArray();
 	// Add each token to the result.
-	for (const Token& symbol : endState.tokens) {
-		symbol.appendTo(bitArray, text);
+	for (auto i = chain.rbegin(); i != chain.rend(); ++i) {
+		arena[*i].token.appendTo(bitArray, text);
 	}
 	//assert bitArray.getSize() == this.bitCount;
 }
 
-static void UpdateStateForPair(const EncodingState& state, int index, int pairCode, std::list<EncodingState>& result)
+/**
+* The states for the next position. A new state is checked against the ones added before right away, so the
+* candidates never pile up. The result is the same as collecting all candidates in order and simplifying
+* them afterwards: dominated old states are removed in place, keeping the order of the others, up to the
+* first old state that is at least as good as the new one, which drops the new one. The tokens of a dropped
+* state are taken back from the arena.
+*/
+class StateSet
 {
-	EncodingState stateNoBinary = EndBinaryShift(state, index);
-	// Possibility 1.  Latch to MODE_PUNCT, and then append this code
-	result.push_back(LatchAndAppend(stateNoBinary, MODE_PUNCT, pairCode));
-	if (state.mode != MODE_PUNCT) {
-		// Possibility 2.  Shift to MODE_PUNCT, and then append this code.
-		// Every state except MODE_PUNCT (handled above) can shift
-		result.push_back(ShiftAndAppend(stateNoBinary, MODE_PUNCT, pairCode));
+	TokenArena& _arena;
+	std::vector<EncodingState> _states;
+	int _mark = 0;
+
+public:
+	explicit StateSet(TokenArena& arena) : _arena(arena) {}
+
+	const std::vector<EncodingState>& states() const {
+		return _states;
 	}
-	if (pairCode == 3 || pairCode == 4) {
-		// both characters are in DIGITS.  Sometimes better to just add two digits
-		auto digitState = LatchAndAppend(stateNoBinary, MODE_DIGIT, 16 - pairCode);	// period or comma in DIGIT
-		result.push_back(LatchAndAppend(digitState, MODE_DIGIT, 1));				// space in DIGIT
+
+	void clear() {
+		_states.clear();
 	}
-	if (state.binaryShiftByteCount > 0) {
-		// It only makes sense to do the characters as binary if we're already
-		// in binary mode.
-		result.push_back(AddBinaryShiftChar(AddBinaryShiftChar(state, index), index + 1));
+
+	void swap(StateSet& other) {
+		_states.swap(other._states);
 	}
-}
 
+	// Marks the end of the arena before the tokens of the next state are created
+	void begin() {
+		_mark = _arena.size();
+	}
 
-static std::list<EncodingState> SimplifyStates(const std::list<EncodingState>& states)
-{
-	std::list<EncodingState> result;
-	for (auto& newState : states) {
+	void add(const EncodingState& newState) {
+		auto out = _states.begin();
 		bool add = true;
-		for (auto iterator = result.begin(); iterator != result.end();) {
-			auto& oldState = *iterator;
-			if (IsBetterThanOrEqualTo(oldState, newState)) {
+		for (auto in = _states.begin(); in != _states.end(); ++in) {
+			if (add && IsBetterThanOrEqualTo(*in, newState)) {
 				add = false;
-				break;
 			}
-			if (IsBetterThanOrEqualTo(newState, oldState)) {
-				iterator = result.erase(iterator);
+			else if (add && IsBetterThanOrEqualTo(newState, *in)) {
+				continue;
 			}
+			*out++ = *in;
 		}
+		_states.erase(out, _states.end());
 		if (add) {
-			result.push_back(newState);
+			_states.push_back(newState);
+		}
+		else {
+			_arena.truncate(_mark);
 		}
 	}
-	return result;
-}
+};
 
-static std::list<EncodingState> UpdateStateListForPair(const std::list<EncodingState>& states, int index, int pairCode)
+static void UpdateStateForPair(TokenArena& arena, const EncodingState& state, int index, int pairCode, StateSet& result)
 {
-	std::list<EncodingState> result;
-	for (auto& state : states) {
-		UpdateStateForPair(state, index, pairCode, result);
+	EncodingState stateNoBinary = EndBinaryShift(arena, state, index);
+	// Possibility 1.  Latch to MODE_PUNCT, and then append this code
+	result.begin();
+	result.add(LatchAndAppend(arena, stateNoBinary, MODE_PUNCT, pairCode));
+	if (state.mode != MODE_PUNCT) {
+		// Possibility 2.  Shift to MODE_PUNCT, and then append this code.
+		// Every state except MODE_PUNCT (handled above) can shift
+		result.begin();
+		result.add(ShiftAndAppend(arena, stateNoBinary, MODE_PUNCT, pairCode));
+	}
+	if (pairCode == 3 || pairCode == 4) {
+		// both characters are in DIGITS.  Sometimes better to just add two digits
+		result.begin();
+		auto digitState = LatchAndAppend(arena, stateNoBinary, MODE_DIGIT, 16 - pairCode);	// period or comma in DIGIT
+		result.add(LatchAndAppend(arena, digitState, MODE_DIGIT, 1));						// space in DIGIT
+	}
+	if (state.binaryShiftByteCount > 0) {
+		// It only makes sense to do the characters as binary if we're already
+		// in binary mode.
+		result.begin();
+		result.add(AddBinaryShiftChar(arena, AddBinaryShiftChar(arena, state, index), index + 1));
 	}
-	return SimplifyStates(result);
 }
 
-
-
 // Return a set of states that represent the possible ways of updating this
 // state for the next character.  The resulting set of states are added to
-// the "result" list.
-static void UpdateStateForChar(const EncodingState& state, const std::string& text, int index, std::list<EncodingState>& result)
+// the "result" set.
+static void UpdateStateForChar(TokenArena& arena, const EncodingState& state, const std::string& text, int index, StateSet& result)
 {
 	int ch = (uint8_t)text[index];
 	bool charInCurrentTable = CHAR_MAP[state.mode][ch] > 0;
@@ -293,7 +355,7 @@ static void UpdateStateForChar(const EncodingState& state, const std::string& te
 		if (charInMode > 0) {
 			if (firstTime) {
 				// Only create stateNoBinary the first time it's required.
-				stateNoBinary = EndBinaryShift(state, index);
+				stateNoBinary = EndBinaryShift(arena, state, index);
 				firstTime = false;
 			}
 			// Try generating the character by latching to its mode
@@ -302,13 +364,15 @@ static void UpdateStateForChar(const EncodingState& state, const std::string& te
 				// any other mode except possibly digit (which uses only 4 bits).  Any
 				// other latch would be equally successful *after* this character, and
 				// so wouldn't save any bits.
-				result.push_back(LatchAndAppend(stateNoBinary, mode, charInMode));
+				result.begin();
+				result.add(LatchAndAppend(arena, stateNoBinary, mode, charInMode));
 			}
 			// Try generating the character by switching to its mode.
 			if (!charInCurrentTable && SHIFT_TABLE[state.mode][mode] >= 0) {
 				// It never makes sense to temporarily shift to another mode if the
 				// character exists in the current mode.  That can never save bits.
-				result.push_back(ShiftAndAppend(stateNoBinary, mode, charInMode));
+				result.begin();
+				result.add(ShiftAndAppend(arena, stateNoBinary, mode, charInMode));
 			}
 		}
 	}
@@ -316,30 +380,21 @@ static void UpdateStateForChar(const EncodingState& state, const std::string& te
 		// It's never worthwhile to go into binary shift mode if you're not already
 		// in binary shift mode, and the character exists in your current mode.
 		// That can never save bits over just outputting the char in the current mode.
-		result.push_back(AddBinaryShiftChar(state, index));
+		result.begin();
+		result.add(AddBinaryShiftChar(arena, state, index));
 	}
 }
 
-// We update a set of states for a new character by updating each state
-// for the new character, merging the results, and then removing the
-// non-optimal states.
-static std::list<EncodingState> UpdateStateListForChar(const std::list<EncodingState>& states, const std::string& text, int index)
-{
-	std::list<EncodingState> result;
-	for (auto& state : states) {
-		UpdateStateForChar(state, text, index, result);
-	}
-	return SimplifyStates(result);
-}
-
 /**
 * @return text represented by this encoder encoded as a {@link BitArray}
 */
 void
 HighLevelEncoder::Encode(const std::string& text, BitArray& output)
 {
-	std::list<EncodingState> states;
-	states.push_back(EncodingState{ std::vector<Token>(), MODE_UPPER, 0, 0 });
+	TokenArena arena;
+	StateSet states(arena);
+	StateSet next(arena);
+	states.add(EncodingState{ -1, MODE_UPPER, 0, 0 });
 	for (int index = 0; index < (int)text.length(); index++) {
 		int pairCode;
 		int nextChar = index + 1 < (int)text.length() ? text[index + 1] : 0;
@@ -359,21 +414,30 @@ HighLevelEncoder::Encode(const std::string& text, BitArray& output)
 		default:
 			pairCode = 0;
 		}
+		// We update the set of states for the new character (or pair) by updating each state and
+		// removing the non-optimal ones on the way.
+		next.clear();
 		if (pairCode > 0) {
 			// We have one of the four special PUNCT pairs.  Treat them specially.
 			// Get a new set of states for the two new characters.
-			states = UpdateStateListForPair(states, index, pairCode);
+			for (auto& state : states.states()) {
+				UpdateStateForPair(arena, state, index, pairCode, next);
+			}
 			index++;
 		}
 		else {
 			// Get a new set of states for the new character.
-			states = UpdateStateListForChar(states, text, index);
+			for (auto& state : states.states()) {
+				UpdateStateForChar(arena, state, text, index, next);
+			}
 		}
+		states.swap(next);
 	}
 	// We are left with a set of states.  Find the shortest one.
-	EncodingState minState = *std::min_element(states.begin(), states.end(), [](const EncodingState& a, const EncodingState& b) { return a.bitCount < b.bitCount; });
+	auto& finalStates = states.states();
+	EncodingState minState = *std::min_element(finalStates.begin(), finalStates.end(), [](const EncodingState& a, const EncodingState& b) { return a.bitCount < b.bitCount; });
 	// Convert it to a bit array, and return.
-	ToBitArray(minState, text, output);
+	ToBitArray(arena, minState, text, output);
 }
 
 } // Aztec
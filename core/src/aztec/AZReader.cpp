@@ -21,13 +21,35 @@
 #include "aztec/AZDecoder.h"
 #include "Result.h"
 #include "BitMatrix.h"
+#include "GridSampler.h"
 #include "BinaryBitmap.h"
 #include "DecoderResult.h"
 #include "DecodeHints.h"
+#include "DecodeContext.h"
 
 namespace ZXing {
 namespace Aztec {
 
+namespace {
+
+// The temporaries of Reader::decode(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::vector<ResultPoint> points; // those of a failed decode, whose memory the next detection reuses
+};
+
+} // anonymous
+
+Reader::Reader()
+{
+}
+
+Reader::Reader(const DecodeHints& hints) :
+	_gridSampler(hints.gridSampler()),
+	_sampleLuminance(hints.shouldSampleLuminance())
+{
+}
+
 Result
 Reader::decode(const BinaryBitmap& image) const
 {
@@ -36,24 +58,22 @@ Reader::decode(const BinaryBitmap& image) const
 		return Result(DecodeStatus::NotFound);
 	}
 
+	ImageGridSampler sampler(image, _gridSampler, _sampleLuminance);
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
 	DetectorResult detectResult;
-	DecodeStatus status = Detector::Detect(*binImg, false, detectResult);
+	detectResult.setPoints(std::move(scratch.points));
+	DecodeStatus status = Detector::Detect(binImg, false, sampler.get(), detectResult);
 	DecoderResult decodeResult;
-	std::vector<ResultPoint> points;
 	if (StatusIsOK(status)) {
-		points = detectResult.points();
 		status = Decoder::Decode(detectResult, decodeResult);
 	}
 	if (StatusIsError(status)) {
-		auto status2 = Detector::Detect(*binImg, true, detectResult);
+		auto status2 = Detector::Detect(binImg, true, sampler.get(), detectResult);
 		if (StatusIsOK(status2)) {
-			points = detectResult.points();
 			status2 = Decoder::Decode(detectResult, decodeResult);
-			if (StatusIsError(status2)) {
-				return Result(status);
-			}
 		}
-		else {
+		if (StatusIsError(status2)) {
+			scratch.points = std::move(detectResult).points();
 			return Result(status);
 		}
 	}
@@ -65,10 +85,12 @@ Reader::decode(const BinaryBitmap& image) const
 	//	}
 	//}
 
-	Result result(decodeResult.text(), decodeResult.rawBytes(), decodeResult.numBits(), points, BarcodeFormat::AZTEC);
-	auto& byteSegments = decodeResult.byteSegments();
-	if (!byteSegments.empty()) {
-		result.metadata().put(ResultMetadata::BYTE_SEGMENTS, byteSegments);
+	// the points of the detection that was decoded
+	auto points = std::move(detectResult).points();
+	int numBits = decodeResult.numBits();
+	Result result(std::move(decodeResult).text(), std::move(decodeResult).rawBytes(), numBits, std::move(points), BarcodeFormat::AZTEC);
+	if (!decodeResult.byteSegments().empty()) {
+		result.metadata().put(ResultMetadata::BYTE_SEGMENTS, std::move(decodeResult).byteSegments());
 	}
 	auto ecLevel = decodeResult.ecLevel();
 	if (!ecLevel.empty()) {
@@ -0,0 +1,208 @@
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "datamatrix/DMCodewordLayout.h"
+#include "datamatrix/DMVersion.h"
+
+#include <mutex>
+
+namespace ZXing {
+namespace DataMatrix {
+
+namespace {
+
+/**
+* Runs the placement program in the mapping matrix, i.e. the data regions without the alignment patterns.
+* Adapted from Annex M.1 in ISO/IEC 16022:2000(E).
+*/
+class Placement
+{
+	int _numRows;
+	int _numColumns;
+	std::vector<bool> _used;
+	std::vector<int> _positions; // row * numColumns + column of the codeword bits, most significant first
+
+public:
+	Placement(int numRows, int numColumns) : _numRows(numRows), _numColumns(numColumns), _used(numRows * numColumns, false) {}
+
+	const std::vector<int>& positions() const {
+		return _positions;
+	}
+
+	bool used(int row, int column) const {
+		return _used[row * _numColumns + column];
+	}
+
+	void module(int row, int column) {
+		// Wrap around the edges of the mapping matrix
+		if (row < 0) {
+			row += _numRows;
+			column += 4 - ((_numRows + 4) % 8);
+		}
+		if (column < 0) {
+			column += _numColumns;
+			row += 4 - ((_numColumns + 4) % 8);
+		}
+		_used[row * _numColumns + column] = true;
+		_positions.push_back(row * _numColumns + column);
+	}
+
+	/**
+	* The 8 bits of a utah-shaped symbol character, anchored at its least significant bit.
+	*/
+	void utah(int row, int column) {
+		module(row - 2, column - 2);
+		module(row - 2, column - 1);
+		module(row - 1, column - 2);
+		module(row - 1, column - 1);
+		module(row - 1, column);
+		module(row, column - 2);
+		module(row, column - 1);
+		module(row, column);
+	}
+
+	void corner1() {
+		module(_numRows - 1, 0);
+		module(_numRows - 1, 1);
+		module(_numRows - 1, 2);
+		module(0, _numColumns - 2);
+		module(0, _numColumns - 1);
+		module(1, _numColumns - 1);
+		module(2, _numColumns - 1);
+		module(3, _numColumns - 1);
+	}
+
+	void corner2() {
+		module(_numRows - 3, 0);
+		module(_numRows - 2, 0);
+		module(_numRows - 1, 0);
+		module(0, _numColumns - 4);
+		module(0, _numColumns - 3);
+		module(0, _numColumns - 2);
+		module(0, _numColumns - 1);
+		module(1, _numColumns - 1);
+	}
+
+	void corner3() {
+		module(_numRows - 3, 0);
+		module(_numRows - 2, 0);
+		module(_numRows - 1, 0);
+		module(0, _numColumns - 2);
+		module(0, _numColumns - 1);
+		module(1, _numColumns - 1);
+		module(2, _numColumns - 1);
+		module(3, _numColumns - 1);
+	}
+
+	void corner4() {
+		module(_numRows - 1, 0);
+		module(_numRows - 1, _numColumns - 1);
+		module(0, _numColumns - 3);
+		module(0, _numColumns - 2);
+		module(0, _numColumns - 1);
+		module(1, _numColumns - 3);
+		module(1, _numColumns - 2);
+		module(1, _numColumns - 1);
+	}
+
+	void run() {
+		int row = 4;
+		int column = 0;
+		do {
+			// repeatedly first check for one of the special corner cases, then...
+			if ((row == _numRows) && (column == 0)) {
+				corner1();
+			}
+			if ((row == _numRows - 2) && (column == 0) && ((_numColumns % 4) != 0)) {
+				corner2();
+			}
+			if ((row == _numRows - 2) && (column == 0) && (_numColumns % 8 == 4)) {
+				corner3();
+			}
+			if ((row == _numRows + 4) && (column == 2) && ((_numColumns % 8) == 0)) {
+				corner4();
+			}
+			// sweep upward diagonally, inserting successive characters...
+			do {
+				if ((row < _numRows) && (column >= 0) && !used(row, column)) {
+					utah(row, column);
+				}
+				row -= 2;
+				column += 2;
+			} while (row >= 0 && (column < _numColumns));
+			row++;
+			column += 3;
+
+			// and then sweep downward diagonally, inserting successive characters, ...
+			do {
+				if ((row >= 0) && (column < _numColumns) && !used(row, column)) {
+					utah(row, column);
+				}
+				row += 2;
+				column -= 2;
+			} while ((row < _numRows) && (column >= 0));
+			row += 3;
+			column++;
+
+			// ...until the entire array is scanned
+		} while ((row < _numRows) || (column < _numColumns));
+	}
+};
+
+} // anonymous
+
+void
+CodewordLayout::place(const Version& version)
+{
+	int regionRows = version.dataRegionSizeRows();
+	int regionColumns = version.dataRegionSizeColumns();
+	int numRows = version.symbolSizeRows() / (regionRows + 2) * regionRows;
+	int numColumns = version.symbolSizeColumns() / (regionColumns + 2) * regionColumns;
+
+	// Every data region is surrounded by the finder or alignment patterns, one module on each side
+	auto toSymbol = [=](int row, int column) {
+		return Module{ static_cast<uint8_t>(column + 1 + 2 * (column / regionColumns)), static_cast<uint8_t>(row + 1 + 2 * (row / regionRows)) };
+	};
+
+	Placement placement(numRows, numColumns);
+	placement.run();
+	_modules.reserve(placement.positions().size());
+	for (int position : placement.positions()) {
+		_modules.push_back(toSymbol(position / numColumns, position % numColumns));
+	}
+
+	// If the lower right corner is untouched, it holds a fixed pattern
+	if (!placement.used(numRows - 1, numColumns - 1)) {
+		_fixedModules.push_back(toSymbol(numRows - 1, numColumns - 1));
+		_fixedModules.push_back(toSymbol(numRows - 2, numColumns - 2));
+	}
+}
+
+const CodewordLayout&
+CodewordLayout::ForVersion(const Version& version)
+{
+	// the number of versions in Version::ALL_VERSIONS
+	static const int VERSION_COUNT = 30;
+	static std::once_flag once[VERSION_COUNT];
+	static CodewordLayout layouts[VERSION_COUNT];
+
+	int index = version.versionNumber() - 1;
+	std::call_once(once[index], [&version, index]() { layouts[index].place(version); });
+	return layouts[index];
+}
+
+} // DataMatrix
+} // ZXing
@@ -0,0 +1,72 @@
+#pragma once
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <cstdint>
+#include <vector>
+
+namespace ZXing {
+namespace DataMatrix {
+
+class Version;
+
+/**
+* The modules of all codewords of a Data Matrix symbol, as placed by the algorithm of ISO/IEC 16022:2006,
+* 5.8.1 and Annex F. The placement only depends on the symbol size, so it runs once per version. Module
+* coordinates are those of the whole symbol, with the finder and alignment patterns, so reader and writer
+* access the modules directly.
+*/
+class CodewordLayout
+{
+public:
+	struct Module
+	{
+		uint8_t x, y;
+	};
+
+	/**
+	* The layout of the symbols of the given version, built on first use. Thread safe.
+	*/
+	static const CodewordLayout& ForVersion(const Version& version);
+
+	int codewordCount() const {
+		return static_cast<int>(_modules.size() / 8);
+	}
+
+	/**
+	* The 8 modules of codeword index, most significant bit first.
+	*/
+	const Module* codeword(int index) const {
+		return _modules.data() + 8 * index;
+	}
+
+	/**
+	* The modules in the lower right corner of the data region that no codeword covers in some sizes.
+	* They are dark in a symbol, none or two.
+	*/
+	const std::vector<Module>& fixedModules() const {
+		return _fixedModules;
+	}
+
+private:
+	std::vector<Module> _modules;
+	std::vector<Module> _fixedModules;
+
+	void place(const Version& version);
+};
+
+} // DataMatrix
+} // ZXing
@@ -23,12 +23,14 @@ namespace ZXing {
 namespace DataMatrix {
 
 DecodeStatus
-DataBlock::GetDataBlocks(const ByteArray& rawCodewords, const Version& version, std::vector<DataBlock>& result)
+DataBlock::GetDataBlocks(const ByteArray& rawCodewords, const Version& version, std::vector<DataBlock>& result, int& numBlocks)
 {
 	// First count the total number of data blocks
 	// Now establish DataBlocks of the appropriate size and number of data codewords
 	auto& ecBlocks = version.ecBlocks();
-	result.resize(ecBlocks.numBlocks());
+	if (static_cast<int>(result.size()) < ecBlocks.numBlocks()) {
+		result.resize(ecBlocks.numBlocks());
+	}
 	int numResultBlocks = 0;
 	for (auto& ecBlock : ecBlocks.blockArray()) {
 		for (int i = 0; i < ecBlock.count; i++) {
@@ -72,6 +74,7 @@ DataBlock::GetDataBlocks(const ByteArray& rawCodewords, const Version& version,
 		}
 	}
 
+	numBlocks = numResultBlocks;
 	return rawCodewordsOffset == rawCodewords.length() ? DecodeStatus::NoError : DecodeStatus::FormatError;
 }
 
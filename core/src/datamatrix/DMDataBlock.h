@@ -55,10 +55,12 @@ public:
 	*
 	* @param rawCodewords bytes as read directly from the Data Matrix Code
 	* @param version version of the Data Matrix Code
-	* @return DataBlocks containing original bytes, "de-interleaved" from representation in the
-	*         Data Matrix Code
+	* @param result DataBlocks containing original bytes, "de-interleaved" from representation in the
+	*         Data Matrix Code, in its first numBlocks entries. It is never shrunk, so that the memory of
+	*         the surplus blocks gets reused by later calls.
+	* @param numBlocks the number of DataBlocks used by this version
 	*/
-	static DecodeStatus GetDataBlocks(const ByteArray& rawCodewords, const Version& version, std::vector<DataBlock>& result);
+	static DecodeStatus GetDataBlocks(const ByteArray& rawCodewords, const Version& version, std::vector<DataBlock>& result, int& numBlocks);
 
 private:
 	int _numDataCodewords = 0;
@@ -26,13 +26,31 @@
 #include "DecodeStatus.h"
 #include "TextDecoder.h"
 #include "ZXContainerAlgorithms.h"
+#include "BitHacks.h"
+#include "DecodeContext.h"
 #include "ZXStrConvWorkaround.h"
 
+#include <algorithm>
 #include <array>
 
 namespace ZXing {
 namespace DataMatrix {
 
+namespace {
+
+// The temporaries of Decoder::Decode(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	ByteArray codewords, uncertainCodewords, resultBytes;
+	std::vector<DataBlock> dataBlocks, uncertainBlocks;
+	std::vector<int> codewordsInts, uncertainty, erasures;
+	std::string text;
+	ByteArray segmentBytes; // the contents of all Base 256 segments, one after the other
+	std::vector<int> segmentLengths;
+};
+
+} // anonymous
+
 /**
 * <p>Data Matrix Codes can encode text as bits in one of several modes, and can use multiple modes
 * in one Data Matrix Code. This class decodes the bits back into text.</p>
@@ -452,7 +470,7 @@ static int Unrandomize255State(int randomizedBase256Codeword, int base256Codewor
 /**
 * See ISO 16022:2006, 5.2.9 and Annex B, B.2
 */
-static bool DecodeBase256Segment(BitSource& bits, std::string& result, std::list<ByteArray>& byteSegments)
+static bool DecodeBase256Segment(BitSource& bits, std::string& result, ByteArray& segmentBytes, std::vector<int>& segmentLengths)
 {
 	// Figure out how long the Base 256 Segment is.
 	int codewordPosition = 1 + bits.byteOffset(); // position is 1-indexed
@@ -473,7 +491,10 @@ static bool DecodeBase256Segment(BitSource& bits, std::string& result, std::list
 		return false;
 	}
 
-	ByteArray bytes(count);
+	// The segment is appended to the previous ones, the byte segments of the result are split off at the end
+	size_t offset = segmentBytes.size();
+	segmentBytes.resize(offset + count);
+	auto bytes = segmentBytes.data() + offset;
 	for (int i = 0; i < count; i++) {
 		// Have seen this particular error in the wild, such as at
 		// http://www.bcgen.com/demo/IDAutomationStreamingDataMatrix.aspx?MODE=3&D=Fred&PFMT=3&PT=F&X=0.3&O=0&LM=0.2
@@ -482,20 +503,21 @@ static bool DecodeBase256Segment(BitSource& bits, std::string& result, std::list
 		}
 		bytes[i] = (uint8_t)Unrandomize255State(bits.readBits(8), codewordPosition++);
 	}
-	byteSegments.push_back(bytes);
+	segmentLengths.push_back(count);
 
 	// bytes is in ISO-8859-1
-	result.append(bytes.charPtr(), bytes.size());
+	result.append(reinterpret_cast<const char*>(bytes), count);
 	return true;
 }
 
-static DecodeStatus Decode(const ByteArray& bytes, DecoderResult& decodeResult)
+static DecodeStatus Decode(const ByteArray& bytes, Scratch& scratch, DecoderResult& decodeResult)
 {
 	BitSource bits(bytes);
-	std::string result;
-	result.reserve(100);
+	auto& result = scratch.text;
+	result.clear();
 	std::string resultTrailer;
-	std::list<ByteArray> byteSegments;
+	scratch.segmentBytes.clear();
+	scratch.segmentLengths.clear();
 	Mode mode = Mode::ASCII_ENCODE;
 	do {
 		if (mode == Mode::ASCII_ENCODE) {
@@ -517,7 +539,7 @@ static DecodeStatus Decode(const ByteArray& bytes, DecoderResult& decodeResult)
 				decodeOK = DecodeEdifactSegment(bits, result);
 				break;
 			case BASE256_ENCODE:
-				decodeOK = DecodeBase256Segment(bits, result, byteSegments);
+				decodeOK = DecodeBase256Segment(bits, result, scratch.segmentBytes, scratch.segmentLengths);
 				break;
 			default:
 				decodeOK = false;
@@ -533,9 +555,17 @@ static DecodeStatus Decode(const ByteArray& bytes, DecoderResult& decodeResult)
 	if (resultTrailer.length() > 0) {
 		result.append(resultTrailer);
 	}
+	std::list<ByteArray> byteSegments;
+	auto segment = scratch.segmentBytes.begin();
+	for (int length : scratch.segmentLengths) {
+		byteSegments.emplace_back();
+		byteSegments.back().assign(segment, segment + length);
+		segment += length;
+	}
+
 	decodeResult.setRawBytes(bytes);
 	decodeResult.setText(TextDecoder::FromLatin1(result));
-	decodeResult.setByteSegments(byteSegments);
+	decodeResult.setByteSegments(std::move(byteSegments));
 	return DecodeStatus::NoError;
 }
 
@@ -560,15 +590,27 @@ static DecodeStatus Decode(const ByteArray& bytes, DecoderResult& decodeResult)
 *
 * @param codewordBytes data and error correction codewords
 * @param numDataCodewords number of codewords that are data bytes
+* @param uncertainBytes per codeword the bits that were sampled unreliably, or nullptr to correct errors only
 * @throws ChecksumException if error correction fails
 */
 static DecodeStatus
-CorrectErrors(ByteArray& codewordBytes, int numDataCodewords)
+CorrectErrors(ByteArray& codewordBytes, int numDataCodewords, const ByteArray* uncertainBytes, Scratch& scratch)
 {
 	// First read into an array of ints
-	std::vector<int> codewordsInts(codewordBytes.begin(), codewordBytes.end());
+	auto& codewordsInts = scratch.codewordsInts;
+	codewordsInts.assign(codewordBytes.begin(), codewordBytes.end());
 	int numECCodewords = codewordBytes.length() - numDataCodewords;
-	auto status = ReedSolomonDecoder(GenericGF::DataMatrixField256()).decode(codewordsInts, numECCodewords);
+	ReedSolomonDecoder rsDecoder(GenericGF::DataMatrixField256());
+	DecodeStatus status;
+	if (uncertainBytes == nullptr) {
+		status = rsDecoder.decode(codewordsInts, numECCodewords);
+	}
+	else {
+		auto& uncertainty = scratch.uncertainty;
+		uncertainty.resize(uncertainBytes->length());
+		std::transform(uncertainBytes->begin(), uncertainBytes->end(), uncertainty.begin(), [](uint8_t b) { return BitHacks::CountBitsSet(b); });
+		status = rsDecoder.decodeWithUncertainty(codewordsInts, numECCodewords, uncertainty, scratch.erasures);
+	}
 	if (StatusIsOK(status)) {
 		// Copy back into array of bytes -- only need to worry about the bytes that were data
 		// We don't care about errors in the error-correction codewords
@@ -582,6 +624,12 @@ CorrectErrors(ByteArray& codewordBytes, int numDataCodewords)
 
 DecodeStatus
 Decoder::Decode(const BitMatrix& bits, DecoderResult& result)
+{
+	return Decode(bits, UncertainModules(), result);
+}
+
+DecodeStatus
+Decoder::Decode(const BitMatrix& bits, const UncertainModules& uncertainModules, DecoderResult& result)
 {
 	// Construct a parser and read version, error-correction level
 	const Version* version = BitMatrixParser::ReadVersion(bits);
@@ -589,34 +637,53 @@ Decoder::Decode(const BitMatrix& bits, DecoderResult& result)
 		return DecodeStatus::FormatError;
 	}
 
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+
 	// Read codewords
-	ByteArray codewords;
+	auto& codewords = scratch.codewords;
 	DecodeStatus status = BitMatrixParser::ReadCodewords(bits, codewords);
 	if (StatusIsError(status)) {
 		return status;
 	}
 
 	// Separate into data blocks
-	std::vector<DataBlock> dataBlocks;
-	status = DataBlock::GetDataBlocks(codewords, *version, dataBlocks);
+	auto& dataBlocks = scratch.dataBlocks;
+	int dataBlocksCount = 0;
+	status = DataBlock::GetDataBlocks(codewords, *version, dataBlocks, dataBlocksCount);
 	if (StatusIsError(status)) {
 		return status;
 	}
 
 	// Count total number of data bytes
 	int totalBytes = 0;
-	for (const DataBlock& db : dataBlocks) {
-		totalBytes += db.numDataCodewords();
+	for (int j = 0; j < dataBlocksCount; j++) {
+		totalBytes += dataBlocks[j].numDataCodewords();
 	}
-	ByteArray resultBytes(totalBytes);
+	auto& resultBytes = scratch.resultBytes;
+	resultBytes.resize(totalBytes);
 
 	// Error-correct and copy data blocks together into a stream of bytes
-	int dataBlocksCount = static_cast<int>(dataBlocks.size());
+	auto& uncertainBlocks = scratch.uncertainBlocks;
+	bool haveUncertainBlocks = false;
 	for (int j = 0; j < dataBlocksCount; j++) {
 		auto& dataBlock = dataBlocks[j];
 		ByteArray& codewordBytes = dataBlock.codewords();
 		int numDataCodewords = dataBlock.numDataCodewords();
-		status = CorrectErrors(codewordBytes, numDataCodewords);
+		status = CorrectErrors(codewordBytes, numDataCodewords, nullptr, scratch);
+		if (status == DecodeStatus::ChecksumError && uncertainModules) {
+			// Too many errors, retry with the unreliable codewords, read and separated the same way, as erasures
+			if (!haveUncertainBlocks) {
+				auto uncertain = uncertainModules();
+				int uncertainBlocksCount = 0;
+				if (uncertain == nullptr
+					|| StatusIsError(BitMatrixParser::ReadCodewords(*uncertain, scratch.uncertainCodewords))
+					|| StatusIsError(DataBlock::GetDataBlocks(scratch.uncertainCodewords, *version, uncertainBlocks, uncertainBlocksCount))) {
+					return status;
+				}
+				haveUncertainBlocks = true;
+			}
+			status = CorrectErrors(codewordBytes, numDataCodewords, &uncertainBlocks[j].codewords(), scratch);
+		}
 		if (StatusIsError(status)) {
 			return status;
 		}
@@ -627,7 +694,7 @@ Decoder::Decode(const BitMatrix& bits, DecoderResult& result)
 	}
 
 	// Decode the contents of that stream of bytes
-	return DecodedBitStreamParser::Decode(resultBytes, result);
+	return DecodedBitStreamParser::Decode(resultBytes, scratch, result);
 }
 
 } // DataMatrix
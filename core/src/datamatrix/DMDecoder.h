@@ -16,6 +16,8 @@
 * limitations under the License.
 */
 
+#include "GridSampler.h"
+
 namespace ZXing {
 
 class DecoderResult;
@@ -54,6 +56,15 @@ public:
 	* @throws ChecksumException if error correction fails
 	*/
 	static DecodeStatus Decode(const BitMatrix& bits, DecoderResult& result);
+
+	/**
+	* <p>Same as above, but retries the error correction with the codewords containing modules set in
+	* the uncertain modules as erasures, if there are too many errors otherwise.</p>
+	*
+	* @param uncertainModules computes the modules whose sampled value is unreliable (see GridSampler), called only
+	*   if the error correction fails otherwise; may be empty
+	*/
+	static DecodeStatus Decode(const BitMatrix& bits, const UncertainModules& uncertainModules, DecoderResult& result);
 };
 
 } // DataMatrix
@@ -20,17 +20,29 @@
 #include "DetectorResult.h"
 #include "WhiteRectDetector.h"
 #include "GridSampler.h"
+#include "PerspectiveTransform.h"
 #include "DecodeStatus.h"
+#include "DecodeContext.h"
 
 #include <cstdlib>
 #include <cmath>
 #include <array>
 #include <algorithm>
-#include <map>
+#include <functional>
 
 namespace ZXing {
 namespace DataMatrix {
 
+namespace {
+
+// The matrix of the last sampled symbol, kept in the DecodeContext so that its memory gets reused.
+struct Scratch
+{
+	std::shared_ptr<BitMatrix> bits;
+};
+
+} // anonymous
+
 /**
 * Simply encapsulates two points and a number of transitions between them.
 */
@@ -174,12 +186,9 @@ static bool CorrectTopRight(const BitMatrix& image, const ResultPoint& bottomLef
 }
 
 static DecodeStatus
-SampleGrid(const BitMatrix& image, const ResultPoint& topLeft, const ResultPoint& bottomLeft, const ResultPoint& bottomRight, const ResultPoint& topRight, int dimensionX, int dimensionY, BitMatrix& result)
+SampleGrid(const std::shared_ptr<const BitMatrix>& image, const ResultPoint& topLeft, const ResultPoint& bottomLeft, const ResultPoint& bottomRight, const ResultPoint& topRight, int dimensionX, int dimensionY, const std::shared_ptr<const GridSampler>& sampler, BitMatrix& result, UncertainModules& uncertainModules)
 {
-	return GridSampler::Instance()->sampleGrid(
-		image,
-		dimensionX,
-		dimensionY,
+	auto transform = PerspectiveTransform::QuadrilateralToQuadrilateral(
 		0.5f,
 		0.5f,
 		dimensionX - 0.5f,
@@ -195,8 +204,11 @@ SampleGrid(const BitMatrix& image, const ResultPoint& topLeft, const ResultPoint
 		bottomRight.x(),
 		bottomRight.y(),
 		bottomLeft.x(),
-		bottomLeft.y(),
-		result);
+		bottomLeft.y());
+	auto status = sampler->sampleGrid(*image, dimensionX, dimensionY, transform, result);
+	if (StatusIsOK(status))
+		uncertainModules = UncertainModules(sampler, image, dimensionX, dimensionY, transform);
+	return status;
 }
 
 /**
@@ -256,6 +268,17 @@ void OrderByBestPatterns(const ResultPoint*& p0, const ResultPoint*& p1, const R
 DecodeStatus
 Detector::Detect(const BitMatrix& image, DetectorResult& result)
 {
+	// The image is not shared with us, so the result must not keep it for its uncertain modules.
+	std::shared_ptr<const BitMatrix> unowned(std::shared_ptr<const BitMatrix>(), &image);
+	auto status = Detect(unowned, GridSampler::Instance(), result);
+	result.setUncertainModules(UncertainModules());
+	return status;
+}
+
+DecodeStatus
+Detector::Detect(const std::shared_ptr<const BitMatrix>& sharedImage, const std::shared_ptr<const GridSampler>& sampler, DetectorResult& result)
+{
+	const BitMatrix& image = *sharedImage;
 	ResultPoint pointA, pointB, pointC, pointD;
 	DecodeStatus status = WhiteRectDetector::Detect(image, pointA, pointB, pointC, pointD);
 	if (StatusIsError(status)) {
@@ -280,26 +303,31 @@ Detector::Detect(const BitMatrix& image, DetectorResult& result)
 
 	// Figure out which point is their intersection by tallying up the number of times we see the
 	// endpoints in the four endpoints. One will show up twice.
-	std::map<const ResultPoint*, int> pointCount;
-	pointCount[lSideOne.from] += 1;
-	pointCount[lSideOne.to] += 1;
-	pointCount[lSideTwo.from] += 1;
-	pointCount[lSideTwo.to] += 1;
+	auto pointCount = [&lSideOne, &lSideTwo](const ResultPoint* p) {
+		return (lSideOne.from == p) + (lSideOne.to == p) + (lSideTwo.from == p) + (lSideTwo.to == p);
+	};
+	// visited in the order of their addresses, as by the std::map this tally used to be kept in
+	std::array<const ResultPoint*, 4> corners = { &pointA, &pointB, &pointC, &pointD };
+	std::sort(corners.begin(), corners.end(), std::less<const ResultPoint*>());
 
 	const ResultPoint* bottomRight = nullptr;
 	const ResultPoint* bottomLeft = nullptr;
 	const ResultPoint* topLeft = nullptr;
-	for (const auto& entry : pointCount) {
-		if (entry.second == 2) {
-			bottomLeft = entry.first; // this is definitely the bottom left, then -- end of two L sides
+	for (const ResultPoint* corner : corners) {
+		int count = pointCount(corner);
+		if (count == 0) {
+			continue;
+		}
+		if (count == 2) {
+			bottomLeft = corner; // this is definitely the bottom left, then -- end of two L sides
 		}
 		else {
 			// Otherwise it's either top left or bottom right -- just assign the two arbitrarily now
 			if (bottomRight == nullptr) {
-				bottomRight = entry.first;
+				bottomRight = corner;
 			}
 			else {
-				topLeft = entry.first;
+				topLeft = corner;
 			}
 		}
 	}
@@ -314,13 +342,13 @@ Detector::Detect(const BitMatrix& image, DetectorResult& result)
 
 	// Which point didn't we find in relation to the "L" sides? that's the top right corner
 	const ResultPoint* topRight;
-	if (pointCount.find(&pointA) == pointCount.end()) {
+	if (pointCount(&pointA) == 0) {
 		topRight = &pointA;
 	}
-	else if (pointCount.find(&pointB) == pointCount.end()) {
+	else if (pointCount(&pointB) == 0) {
 		topRight = &pointB;
 	}
-	else if (pointCount.find(&pointC) == pointCount.end()) {
+	else if (pointCount(&pointC) == 0) {
 		topRight = &pointC;
 	}
 	else {
@@ -351,7 +379,11 @@ Detector::Detect(const BitMatrix& image, DetectorResult& result)
 	}
 	dimensionRight += 2;
 
-	auto bits = std::make_shared<BitMatrix>();
+	// The matrix is only reused once the DetectorResult of the previous call is gone.
+	auto& bits = DecodeContext::ThreadLocal().scratch<Scratch>().bits;
+	if (bits == nullptr || bits.use_count() > 1)
+		bits = std::make_shared<BitMatrix>();
+	UncertainModules uncertainModules;
 	ResultPoint correctedTopRight;
 
 	// Rectanguar symbols are 6x16, 6x28, 10x24, 10x32, 14x32, or 14x44. If one dimension is more
@@ -377,7 +409,7 @@ Detector::Detect(const BitMatrix& image, DetectorResult& result)
 			dimensionRight++;
 		}
 
-		status = SampleGrid(image, *topLeft, *bottomLeft, *bottomRight, correctedTopRight, dimensionTop, dimensionRight, *bits);
+		status = SampleGrid(sharedImage, *topLeft, *bottomLeft, *bottomRight, correctedTopRight, dimensionTop, dimensionRight, sampler, *bits, uncertainModules);
 		if (StatusIsError(status)) {
 			return status;
 		}
@@ -399,12 +431,13 @@ Detector::Detect(const BitMatrix& image, DetectorResult& result)
 			dimensionCorrected++;
 		}
 
-		status = SampleGrid(image, *topLeft, *bottomLeft, *bottomRight, correctedTopRight, dimensionCorrected, dimensionCorrected, *bits);
+		status = SampleGrid(sharedImage, *topLeft, *bottomLeft, *bottomRight, correctedTopRight, dimensionCorrected, dimensionCorrected, sampler, *bits, uncertainModules);
 		if (StatusIsError(status)) {
 			return status;
 		}
 	}
 	result.setBits(bits);
+	result.setUncertainModules(uncertainModules);
 	result.setPoints({ *topLeft, *bottomLeft, *bottomRight, correctedTopRight });
 	return DecodeStatus::NoError;
 }
@@ -16,10 +16,13 @@
 * limitations under the License.
 */
 
+#include <memory>
+
 namespace ZXing {
 
 class BitMatrix;
 class DetectorResult;
+class GridSampler;
 enum class DecodeStatus;
 
 namespace DataMatrix {
@@ -40,6 +43,13 @@ public:
 	* @throws NotFoundException if no Data Matrix Code can be found
 	*/
 	static DecodeStatus Detect(const BitMatrix& image, DetectorResult& result);
+
+	/**
+	* Same as above, but reads the modules off the image with the given sampler instead of GridSampler::Instance().
+	* The result shares the image and the sampler to compute its uncertain modules, which the result of the
+	* overload above has none of.
+	*/
+	static DecodeStatus Detect(const std::shared_ptr<const BitMatrix>& image, const std::shared_ptr<const GridSampler>& sampler, DetectorResult& result);
 };
 
 } // DataMatrix
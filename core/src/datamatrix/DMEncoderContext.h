@@ -114,9 +114,13 @@ public:
 		return totalMessageCharCount() - _pos;
 	}
 
+	const SymbolInfo* lookupSymbolInfo(int len) const {
+		return SymbolInfo::Lookup(len, _shape, _minWidth, _minHeight, _maxWidth, _maxHeight);
+	}
+
 	const SymbolInfo* updateSymbolInfo(int len) {
 		if (_symbolInfo == nullptr || len > _symbolInfo->dataCapacity()) {
-			_symbolInfo = SymbolInfo::Lookup(len, _shape, _minWidth, _minHeight, _maxWidth, _maxHeight);
+			_symbolInfo = lookupSymbolInfo(len);
 			if (_symbolInfo == nullptr) {
 				throw std::invalid_argument("Can't find a symbol arrangement that matches the message. Data codewords: " + std::to_string(len));
 			}
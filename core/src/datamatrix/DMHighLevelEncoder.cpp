@@ -26,6 +26,7 @@
 #include <array>
 #include <limits>
 #include <cmath>
+#include <cstdint>
 #include <numeric>
 #include <functional>
 #include <stdexcept>
@@ -940,5 +941,455 @@ HighLevelEncoder::Encode(const std::wstring& msg, SymbolShape shape, int minWdit
 	output = context.codewords();
 }
 
+namespace MinimalEncoder {
+
+	/**
+	* The states of the search. C40, Text and X12 take three states each, for 0, 1 or 2 values in the open
+	* triplet, EDIFACT takes four, for 0 to 3 values in the open group.
+	*/
+	enum
+	{
+		ASCII_STATE = 0,
+		C40_STATE = 1,
+		TEXT_STATE = 4,
+		X12_STATE = 7,
+		EDIFACT_STATE = 10,
+		BASE256_STATE = 14,
+		STATE_COUNT = 15,
+	};
+
+	// Costs are counted in twelfths of a codeword, so that C40, Text and X12 values (2/3 of a codeword)
+	// and EDIFACT values (3/4 of a codeword) are whole numbers.
+	static const int CODEWORD = 12;
+	static const int C40_VALUE = 8;
+	static const int EDIFACT_VALUE = 9;
+	static const int EDIFACT_UNLATCH = 31;
+	static const int MAX_BASE256_RUN = 1555;
+	// small enough that adding a few codewords cannot overflow
+	static const int INFINITE_COST = std::numeric_limits<int>::max() / 2;
+
+	struct Step
+	{
+		int cost = INFINITE_COST;
+		int8_t from = 0;     // the previous state
+		int8_t consumed = 0; // the number of characters consumed on the way from there
+		int16_t run = 0;     // the number of bytes in the Base 256 run so far
+	};
+
+	static int ModeOf(int state)
+	{
+		return state < C40_STATE ? ASCII_ENCODATION : state < TEXT_STATE ? C40_ENCODATION : state < X12_STATE ? TEXT_ENCODATION
+			: state < EDIFACT_STATE ? X12_ENCODATION : state < BASE256_STATE ? EDIFACT_ENCODATION : BASE256_ENCODATION;
+	}
+
+	static int FirstStateOf(int mode)
+	{
+		static const int FIRST_STATES[] = { ASCII_STATE, C40_STATE, TEXT_STATE, X12_STATE, EDIFACT_STATE, BASE256_STATE };
+		return FIRST_STATES[mode];
+	}
+
+	/**
+	* The cost of ending an EDIFACT segment with r open values, the unlatch completes the group and the
+	* codewords of the group that are not needed are left out.
+	*/
+	static int EdifactUnlatchCost(int r)
+	{
+		return std::min(r + 1, 3) * CODEWORD - r * EDIFACT_VALUE;
+	}
+
+	/**
+	* The C40 and Text values of all bytes, as produced by the legacy encoders.
+	*/
+	static const std::array<std::string, 256>& Values(int mode)
+	{
+		struct Tables
+		{
+			std::array<std::string, 256> c40, text;
+			Tables() {
+				for (int b = 0; b < 256; ++b) {
+					C40Encoder::EncodeChar(static_cast<char>(b), c40[b]);
+					DMTextEncoder::EncodeChar(static_cast<char>(b), text[b]);
+				}
+			}
+		};
+		static const Tables tables;
+		return mode == C40_ENCODATION ? tables.c40 : tables.text;
+	}
+
+	/**
+	* Finds the cheapest way through the states for every prefix of the message. steps holds
+	* STATE_COUNT entries per position, the ones at startPos must be initialized.
+	*/
+	static void Search(const std::string& msg, int startPos, int endPos, std::vector<Step>& steps)
+	{
+		const auto& c40Values = Values(C40_ENCODATION);
+		const auto& textValues = Values(TEXT_ENCODATION);
+
+		auto relax = [](Step& to, int cost, int from, int consumed, int run) {
+			if (cost < to.cost) {
+				to.cost = cost;
+				to.from = static_cast<int8_t>(from);
+				to.consumed = static_cast<int8_t>(consumed);
+				to.run = static_cast<int16_t>(run);
+			}
+		};
+
+		for (int pos = startPos; pos < endPos; ++pos) {
+			Step* cur = &steps[pos * STATE_COUNT];
+			Step* next = cur + STATE_COUNT;
+
+			// Return to ASCII: C40 and Text can pad an open pair with a Shift 1, EDIFACT puts the unlatch into
+			// the open group, Base 256 runs end by their length.
+			for (int mode : { C40_ENCODATION, TEXT_ENCODATION, X12_ENCODATION }) {
+				int state = FirstStateOf(mode);
+				relax(cur[ASCII_STATE], cur[state].cost + CODEWORD, state, 0, 0);
+				if (mode != X12_ENCODATION) {
+					relax(cur[ASCII_STATE], cur[state + 2].cost + C40_VALUE + CODEWORD, state + 2, 0, 0);
+				}
+			}
+			for (int r = 0; r < 4; ++r) {
+				relax(cur[ASCII_STATE], cur[EDIFACT_STATE + r].cost + EdifactUnlatchCost(r), EDIFACT_STATE + r, 0, 0);
+			}
+			relax(cur[ASCII_STATE], cur[BASE256_STATE].cost, BASE256_STATE, 0, 0);
+
+			// Latches, a Base 256 latch is followed by at least one length codeword
+			int asciiCost = cur[ASCII_STATE].cost;
+			for (int state : { C40_STATE, TEXT_STATE, X12_STATE, EDIFACT_STATE }) {
+				relax(cur[state], asciiCost + CODEWORD, ASCII_STATE, 0, 0);
+			}
+			relax(cur[BASE256_STATE], asciiCost + 2 * CODEWORD, ASCII_STATE, 0, 0);
+
+			int c = static_cast<uint8_t>(msg[pos]);
+
+			if (pos + 1 < endPos && IsDigit(c) && IsDigit(msg[pos + 1])) {
+				relax(next[STATE_COUNT + ASCII_STATE], asciiCost + CODEWORD, ASCII_STATE, 2, 0);
+			}
+			relax(next[ASCII_STATE], asciiCost + (IsExtendedASCII(c) ? 2 : 1) * CODEWORD, ASCII_STATE, 1, 0);
+
+			for (int mode : { C40_ENCODATION, TEXT_ENCODATION }) {
+				int count = static_cast<int>((mode == C40_ENCODATION ? c40Values : textValues)[c].length());
+				int state = FirstStateOf(mode);
+				for (int r = 0; r < 3; ++r) {
+					relax(next[state + (r + count) % 3], cur[state + r].cost + count * C40_VALUE, state + r, 1, 0);
+				}
+			}
+			if (IsNativeX12(c)) {
+				for (int r = 0; r < 3; ++r) {
+					relax(next[X12_STATE + (r + 1) % 3], cur[X12_STATE + r].cost + C40_VALUE, X12_STATE + r, 1, 0);
+				}
+			}
+			if (IsNativeEDIFACT(c)) {
+				for (int r = 0; r < 4; ++r) {
+					relax(next[EDIFACT_STATE + (r + 1) % 4], cur[EDIFACT_STATE + r].cost + EDIFACT_VALUE, EDIFACT_STATE + r, 1, 0);
+				}
+			}
+			int run = cur[BASE256_STATE].run;
+			if (run < MAX_BASE256_RUN) {
+				// from 250 bytes on the length takes two codewords
+				int cost = cur[BASE256_STATE].cost + (run + 1 == 250 ? 2 : 1) * CODEWORD;
+				relax(next[BASE256_STATE], cost, BASE256_STATE, 1, run + 1);
+			}
+		}
+	}
+
+	/**
+	* The number of codewords of a path that ends in state, without the unlatch an open C40, Text, X12 or
+	* EDIFACT segment needs unless it fills the symbol. Returns -1 for states that cannot end the message.
+	*/
+	static int FinalCodewordCount(int state, int cost)
+	{
+		if (cost >= INFINITE_COST) {
+			return -1;
+		}
+		int mode = ModeOf(state);
+		int r = state - FirstStateOf(mode);
+		switch (mode) {
+		case C40_ENCODATION:
+		case TEXT_ENCODATION:
+			// two open values are padded with a Shift 1, a single one cannot be written
+			return r == 1 ? -1 : (cost + (r == 2 ? C40_VALUE : 0)) / CODEWORD;
+		case X12_ENCODATION:
+			return r == 0 ? cost / CODEWORD : -1;
+		case EDIFACT_ENCODATION:
+			return (cost + (r == 0 ? 0 : EdifactUnlatchCost(r))) / CODEWORD;
+		default:
+			return cost / CODEWORD;
+		}
+	}
+
+	/**
+	* The number of codewords of msg[startPos, endPos) in ASCII, with pairs of digits in one codeword.
+	*/
+	static int AsciiCodewordCount(const std::string& msg, int startPos, int endPos)
+	{
+		int count = 0;
+		for (int pos = startPos; pos < endPos; ++pos) {
+			if (pos + 1 < endPos && IsDigit(msg[pos]) && IsDigit(msg[pos + 1])) {
+				++pos;
+			}
+			count += IsExtendedASCII(static_cast<uint8_t>(msg[pos])) ? 2 : 1;
+		}
+		return count;
+	}
+
+	static void WriteAsciiChar(EncoderContext& context, int c)
+	{
+		if (IsExtendedASCII(c)) {
+			context.addCodeword(UPPER_SHIFT);
+			context.addCodeword(c - 128 + 1);
+		}
+		else {
+			context.addCodeword(c + 1);
+		}
+	}
+
+	static void WriteAscii(EncoderContext& context, const std::string& msg, int startPos, int endPos)
+	{
+		for (int pos = startPos; pos < endPos; ++pos) {
+			if (pos + 1 < endPos && IsDigit(msg[pos]) && IsDigit(msg[pos + 1])) {
+				context.addCodeword(ASCIIEncoder::EncodeASCIIDigits(msg[pos], msg[pos + 1]));
+				++pos;
+			}
+			else {
+				WriteAsciiChar(context, static_cast<uint8_t>(msg[pos]));
+			}
+		}
+	}
+
+	static void WriteTriplets(EncoderContext& context, std::string& values)
+	{
+		while (values.length() >= 3) {
+			C40Encoder::WriteNextTriplet(context, values);
+		}
+	}
+
+	static void WriteEdifactGroup(EncoderContext& context, std::string& values, int& lastGroupStart)
+	{
+		lastGroupStart = context.codewordCount();
+		for (int cw : EdifactEncoder::EncodeToCodewords(values, 0)) {
+			context.addCodeword(cw);
+		}
+		values.clear();
+	}
+
+	static void WriteBase256Run(EncoderContext& context, const std::string& bytes)
+	{
+		int count = static_cast<int>(bytes.length());
+		std::string buffer;
+		if (count <= 249) {
+			buffer.push_back((char)count);
+		}
+		else {
+			buffer.push_back((char)((count / 250) + 249));
+			buffer.push_back((char)(count % 250));
+		}
+		buffer.append(bytes);
+		for (char c : buffer) {
+			context.addCodeword(Base256Encoder::Randomize255State(static_cast<uint8_t>(c), context.codewordCount() + 1));
+		}
+	}
+
+	/**
+	* Writes the codewords along the path of states, pos and states hold one entry per step.
+	*/
+	static int WritePath(EncoderContext& context, const std::string& msg, const std::vector<int>& positions, const std::vector<int>& states, int& lastGroupStart)
+	{
+		const auto& c40Values = Values(C40_ENCODATION);
+		const auto& textValues = Values(TEXT_ENCODATION);
+		std::string values; // the open C40, Text, X12 or EDIFACT values, or the bytes of the Base 256 run
+
+		for (size_t i = 1; i < states.size(); ++i) {
+			int from = states[i - 1];
+			int to = states[i];
+			int mode = ModeOf(from);
+			int pos = positions[i - 1];
+			int consumed = positions[i] - pos;
+			if (consumed == 0) {
+				if (mode == ASCII_ENCODATION) {
+					context.addCodeword(LATCHES[ModeOf(to)]);
+				}
+				else if (mode == EDIFACT_ENCODATION) {
+					values.push_back(EDIFACT_UNLATCH);
+					WriteEdifactGroup(context, values, lastGroupStart);
+				}
+				else if (mode == BASE256_ENCODATION) {
+					WriteBase256Run(context, values);
+					values.clear();
+				}
+				else {
+					if (values.length() == 2) {
+						values.push_back('\0'); //Shift 1
+					}
+					WriteTriplets(context, values);
+					context.addCodeword(C40_UNLATCH);
+				}
+				continue;
+			}
+			int c = static_cast<uint8_t>(msg[pos]);
+			switch (mode) {
+			case ASCII_ENCODATION:
+				WriteAscii(context, msg, pos, pos + consumed);
+				break;
+			case C40_ENCODATION:
+			case TEXT_ENCODATION:
+				values.append((mode == C40_ENCODATION ? c40Values : textValues)[c]);
+				WriteTriplets(context, values);
+				break;
+			case X12_ENCODATION:
+				X12Encoder::EncodeChar(c, values);
+				WriteTriplets(context, values);
+				break;
+			case EDIFACT_ENCODATION:
+				EdifactEncoder::EncodeChar(c, values);
+				if (values.length() == 4) {
+					WriteEdifactGroup(context, values, lastGroupStart);
+				}
+				break;
+			case BASE256_ENCODATION:
+				values.push_back(static_cast<char>(c));
+				break;
+			}
+		}
+
+		// Close the last segment, except for the unlatch that is only needed if the symbol is not filled
+		int mode = ModeOf(states.back());
+		if (mode == BASE256_ENCODATION) {
+			WriteBase256Run(context, values);
+		}
+		else if (mode == EDIFACT_ENCODATION && !values.empty()) {
+			values.push_back(EDIFACT_UNLATCH);
+			WriteEdifactGroup(context, values, lastGroupStart);
+			mode = ASCII_ENCODATION;
+		}
+		else if (mode == C40_ENCODATION || mode == TEXT_ENCODATION) {
+			if (values.length() == 2) {
+				values.push_back('\0'); //Shift 1
+			}
+			WriteTriplets(context, values);
+		}
+		return mode;
+	}
+
+	static void Encode(EncoderContext& context)
+	{
+		const std::string& msg = context.message();
+		int startPos = context.currentPos();
+		int endPos = context.totalMessageCharCount();
+
+		std::vector<Step> steps((endPos + 1) * STATE_COUNT);
+		steps[startPos * STATE_COUNT + ASCII_STATE].cost = context.codewordCount() * CODEWORD;
+		Search(msg, startPos, endPos, steps);
+
+		// The decoder returns to ASCII by itself if only one codeword is left after a C40, Text or X12 triplet,
+		// or at most two after an EDIFACT group, so a short rest of the message may follow without an unlatch
+		// if it fills the symbol.
+		int bestPos = endPos;
+		int bestState = -1;
+		int bestCount = 0;
+		for (int pos = endPos; pos >= std::max(startPos, endPos - 4); --pos) {
+			int tail = AsciiCodewordCount(msg, pos, endPos);
+			for (int state = 0; state < STATE_COUNT; ++state) {
+				int count = FinalCodewordCount(state, steps[pos * STATE_COUNT + state].cost);
+				int mode = ModeOf(state);
+				bool open = mode == C40_ENCODATION || mode == TEXT_ENCODATION || mode == X12_ENCODATION || state == EDIFACT_STATE;
+				if (count < 0 || (pos < endPos && (!open || tail > (mode == EDIFACT_ENCODATION ? 2 : 1)))) {
+					continue;
+				}
+				count += tail;
+				// an open segment needs an unlatch unless it fills the symbol
+				if (open) {
+					auto symbolInfo = context.lookupSymbolInfo(count);
+					if (symbolInfo == nullptr || symbolInfo->dataCapacity() > count) {
+						if (pos < endPos) {
+							continue;
+						}
+						count++;
+					}
+				}
+				if (bestState < 0 || count < bestCount) {
+					bestPos = pos;
+					bestState = state;
+					bestCount = count;
+				}
+			}
+		}
+
+		std::vector<int> positions;
+		std::vector<int> states;
+		for (int pos = bestPos, state = bestState; ; ) {
+			positions.push_back(pos);
+			states.push_back(state);
+			if (pos == startPos && state == ASCII_STATE) {
+				break;
+			}
+			const Step& step = steps[pos * STATE_COUNT + state];
+			pos -= step.consumed;
+			state = step.from;
+		}
+		std::reverse(positions.begin(), positions.end());
+		std::reverse(states.begin(), states.end());
+
+		int lastGroupStart = -1;
+		int mode = WritePath(context, msg, positions, states, lastGroupStart);
+		if (bestPos < endPos) {
+			WriteAscii(context, msg, bestPos, endPos);
+			return;
+		}
+
+		// The decoder reads the last two codewords of a symbol in ASCII if they would start an EDIFACT group
+		auto symbolInfo = context.updateSymbolInfo(std::max(context.codewordCount(), lastGroupStart + 3));
+		if (context.codewordCount() < symbolInfo->dataCapacity()) {
+			if (mode == EDIFACT_ENCODATION) {
+				std::string values(1, static_cast<char>(EDIFACT_UNLATCH));
+				WriteEdifactGroup(context, values, lastGroupStart);
+				context.updateSymbolInfo(lastGroupStart + 3);
+			}
+			else if (mode != ASCII_ENCODATION && mode != BASE256_ENCODATION) {
+				context.addCodeword(C40_UNLATCH);
+			}
+		}
+	}
+
+} // MinimalEncoder
+
+/**
+* Performs message encoding of a DataMatrix message with the least number of codewords. The encodations
+* are chosen by a shortest path search over the positions in the message and the states of the encodations,
+* which takes time and memory linear in the length of the message.
+*/
+void
+HighLevelEncoder::EncodeMinimal(const std::wstring& msg, SymbolShape shape, int minWdith, int minHeight, int maxWidth, int maxHeight, std::vector<int>& output)
+{
+	std::string bytes;
+	TextEncoder::GetBytes(msg, CharacterSet::ISO8859_1, bytes);
+	EncoderContext context(bytes);
+	context.setSymbolShape(shape);
+	context.setSizeConstraints(minWdith, minHeight, maxWidth, maxHeight);
+
+	if (StartsWith(msg, MACRO_05_HEADER) && EndsWith(msg, MACRO_TRAILER)) {
+		context.addCodeword(MACRO_05);
+		context.setSkipAtEnd(2);
+		context.setCurrentPos(static_cast<int>(MACRO_05_HEADER.length()));
+	}
+	else if (StartsWith(msg, MACRO_06_HEADER) && EndsWith(msg, MACRO_TRAILER)) {
+		context.addCodeword(MACRO_06);
+		context.setSkipAtEnd(2);
+		context.setCurrentPos(static_cast<int>(MACRO_06_HEADER.length()));
+	}
+
+	MinimalEncoder::Encode(context);
+
+	int capacity = context.updateSymbolInfo(context.codewordCount())->dataCapacity();
+	//Padding
+	if (context.codewordCount() < capacity) {
+		context.addCodeword(PAD);
+	}
+	while (context.codewordCount() < capacity) {
+		context.addCodeword(Randomize253State(PAD, context.codewordCount() + 1));
+	}
+
+	output = context.codewords();
+}
+
 } // DataMatrix
 } // ZXing
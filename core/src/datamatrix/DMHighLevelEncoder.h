@@ -31,6 +31,12 @@ class HighLevelEncoder
 {
 public:
 	static void Encode(const std::wstring& msg, SymbolShape shape, int minWdith, int minHeight, int maxWidth, int maxHeight, std::vector<int>& output);
+
+	/**
+	* Encodes the message with the least number of codewords, in time and memory linear in its length.
+	* Encode is kept for output identical to earlier versions.
+	*/
+	static void EncodeMinimal(const std::wstring& msg, SymbolShape shape, int minWdith, int minHeight, int maxWidth, int maxHeight, std::vector<int>& output);
 };
 
 } // DataMatrix
@@ -21,13 +21,26 @@
 #include "Result.h"
 #include "DecodeHints.h"
 #include "BitMatrix.h"
+#include "GridSampler.h"
 #include "BinaryBitmap.h"
 #include "DecoderResult.h"
 #include "DetectorResult.h"
+#include "DecodeContext.h"
 
 namespace ZXing {
 namespace DataMatrix {
 
+namespace {
+
+// The temporaries of Reader::decode(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	BitMatrix pureBits;
+	std::vector<ResultPoint> points; // those of a failed decode, whose memory the next detection reuses
+};
+
+} // anonymous
+
 static int
 GetModuleSize(int x, int y, const BitMatrix& image)
 {
@@ -75,7 +88,7 @@ ExtractPureBits(const BitMatrix& image, BitMatrix& outBits)
 	left += nudge;
 
 	// Now just read off the bits
-	outBits = BitMatrix(matrixWidth, matrixHeight);
+	outBits.reset(matrixWidth, matrixHeight);
 	for (int y = 0; y < matrixHeight; y++) {
 		int iOffset = top + y * moduleSize;
 		for (int x = 0; x < matrixWidth; x++) {
@@ -87,6 +100,16 @@ ExtractPureBits(const BitMatrix& image, BitMatrix& outBits)
 	return DecodeStatus::NoError;
 }
 
+Reader::Reader()
+{
+}
+
+Reader::Reader(const DecodeHints& hints) :
+	_gridSampler(hints.gridSampler()),
+	_sampleLuminance(hints.shouldSampleLuminance())
+{
+}
+
 /**
 * Locates and decodes a Data Matrix code in an image.
 *
@@ -106,8 +129,9 @@ Reader::decode(const BinaryBitmap& image) const
 	DecoderResult decoderResult;
 	std::vector<ResultPoint> points;
 	DecodeStatus status;
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
 	if (image.isPureBarcode()) {
-		BitMatrix bits;
+		auto& bits = scratch.pureBits;
 		status = ExtractPureBits(*binImg, bits);
 		if (StatusIsOK(status)) {
 			status = Decoder::Decode(bits, decoderResult);
@@ -115,10 +139,15 @@ Reader::decode(const BinaryBitmap& image) const
 	}
 	else {
 		DetectorResult detectorResult;
-		status = Detector::Detect(*binImg, detectorResult);
+		detectorResult.setPoints(std::move(scratch.points));
+		ImageGridSampler sampler(image, _gridSampler, _sampleLuminance);
+		status = Detector::Detect(binImg, sampler.get(), detectorResult);
 		if (StatusIsOK(status)) {
-			status = Decoder::Decode(*detectorResult.bits(), decoderResult);
-			points = detectorResult.points();
+			status = Decoder::Decode(*detectorResult.bits(), detectorResult.uncertainModules(), decoderResult);
+		}
+		points = std::move(detectorResult).points();
+		if (StatusIsError(status)) {
+			scratch.points = std::move(points);
 		}
 	}
 
@@ -126,10 +155,10 @@ Reader::decode(const BinaryBitmap& image) const
 		return Result(status);
 	}
 
-	Result result(decoderResult.text(), decoderResult.rawBytes(), points, BarcodeFormat::DATA_MATRIX);
-	auto& byteSegments = decoderResult.byteSegments();
-	if (!byteSegments.empty()) {
-		result.metadata().put(ResultMetadata::BYTE_SEGMENTS, byteSegments);
+	int numBits = decoderResult.numBits();
+	Result result(std::move(decoderResult).text(), std::move(decoderResult).rawBytes(), numBits, std::move(points), BarcodeFormat::DATA_MATRIX);
+	if (!decoderResult.byteSegments().empty()) {
+		result.metadata().put(ResultMetadata::BYTE_SEGMENTS, std::move(decoderResult).byteSegments());
 	}
 	auto ecLevel = decoderResult.ecLevel();
 	if (!ecLevel.empty()) {
@@ -18,7 +18,13 @@
 
 #include "Reader.h"
 
+#include <memory>
+
 namespace ZXing {
+
+class DecodeHints;
+class GridSampler;
+
 namespace DataMatrix {
 
 /**
@@ -29,7 +35,13 @@ namespace DataMatrix {
 class Reader : public ZXing::Reader
 {
 public:
+	Reader();
+	explicit Reader(const DecodeHints& hints);
 	virtual Result decode(const BinaryBitmap& image) const override;
+
+private:
+	std::shared_ptr<const GridSampler> _gridSampler;
+	bool _sampleLuminance = false;
 };
 
 } // DataMatrix
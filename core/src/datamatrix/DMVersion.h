@@ -51,7 +51,7 @@ public:
 	}
 
 	int totalCodewords() const {
-		return _totalCodewords;
+		return _ecBlocks.totalDataCodewords();
 	}
 
 	const ECBlocks& ecBlocks() const {
@@ -75,9 +75,13 @@ private:
 	int _dataRegionSizeRows;
 	int _dataRegionSizeColumns;
 	ECBlocks _ecBlocks;
-	int _totalCodewords;
 
-	Version(int versionNumber, int symbolSizeRows, int symbolSizeColumns, int dataRegionSizeRows, int dataRegionSizeColumns, const ECBlocks& ecBlocks);
+	constexpr Version(int versionNumber, int symbolSizeRows, int symbolSizeColumns, int dataRegionSizeRows, int dataRegionSizeColumns, const ECBlocks& ecBlocks)
+		: _versionNumber(versionNumber), _symbolSizeRows(symbolSizeRows), _symbolSizeColumns(symbolSizeColumns),
+		  _dataRegionSizeRows(dataRegionSizeRows), _dataRegionSizeColumns(dataRegionSizeColumns), _ecBlocks(ecBlocks) {}
+
+	// Constant-initialized, hence read-only data without any initialization at runtime
+	static const Version ALL_VERSIONS[];
 };
 
 } // DataMatrix
@@ -20,9 +20,9 @@
 #include "datamatrix/DMHighLevelEncoder.h"
 #include "datamatrix/DMSymbolInfo.h"
 #include "datamatrix/DMECEncoder.h"
-#include "datamatrix/DMDefaultPlacement.h"
+#include "datamatrix/DMCodewordLayout.h"
+#include "datamatrix/DMVersion.h"
 #include "BitMatrix.h"
-#include "ByteMatrix.h"
 #include "ZXStrConvWorkaround.h"
 
 #include <stdexcept>
@@ -32,65 +32,47 @@ namespace ZXing {
 namespace DataMatrix {
 
 /**
-* Encode the given symbol info to a bit matrix.
+* Draws the finder and alignment patterns around every data region and the modules of the codewords.
 *
-* @param placement  The DataMatrix placement.
-* @param symbolInfo The symbol info to encode.
+* @param codewords  The data and error correction codewords.
+* @param version    The version of the symbol.
 * @return The bit matrix generated.
 */
-static void EncodeLowLevel(const ByteMatrix& placement, const SymbolInfo& symbolInfo, BitMatrix& output) {
-	int symbolWidth = symbolInfo.symbolDataWidth();
-	int symbolHeight = symbolInfo.symbolDataHeight();
+static void EncodeLowLevel(const std::vector<int>& codewords, const Version& version, BitMatrix& output)
+{
+	int width = version.symbolSizeColumns();
+	int height = version.symbolSizeRows();
+	int regionWidth = version.dataRegionSizeColumns() + 2;
+	int regionHeight = version.dataRegionSizeRows() + 2;
 
-	ByteMatrix matrix(symbolInfo.symbolWidth(), symbolInfo.symbolHeight());
-	int matrixY = 0;
-	for (int y = 0; y < symbolHeight; y++) {
-		// Fill the top edge with alternate 0 / 1
-		int matrixX;
-		if ((y % symbolInfo.matrixHeight()) == 0) {
-			matrixX = 0;
-			for (int x = 0; x < matrix.width(); x++) {
-				matrix.set(matrixX, matrixY, (x % 2) == 0);
-				matrixX++;
-			}
-			matrixY++;
-		}
-		matrixX = 0;
-		for (int x = 0; x < symbolWidth; x++) {
-			// Fill the right edge with full 1
-			if ((x % symbolInfo.matrixWidth()) == 0) {
-				matrix.set(matrixX, matrixY, true);
-				matrixX++;
-			}
-			matrix.set(matrixX, matrixY, placement.get(x, y) == 1);
-			matrixX++;
-			// Fill the right edge with alternate 0 / 1
-			if ((x % symbolInfo.matrixWidth()) == symbolInfo.matrixWidth() - 1) {
-				matrix.set(matrixX, matrixY, (y % 2) == 0);
-				matrixX++;
-			}
+	output = BitMatrix(width, height);
+	for (int y = 0; y < height; y += regionHeight) {
+		// Fill the top edge with alternate 0 / 1 and the bottom edge with full 1
+		for (int x = 0; x < width; x += 2) {
+			output.set(x, y);
 		}
-		matrixY++;
-		// Fill the bottom edge with full 1
-		if ((y % symbolInfo.matrixHeight()) == symbolInfo.matrixHeight() - 1) {
-			matrixX = 0;
-			for (int x = 0; x < matrix.width(); x++) {
-				matrix.set(matrixX, matrixY, true);
-				matrixX++;
-			}
-			matrixY++;
+		output.setRegion(0, y + regionHeight - 1, width, 1);
+	}
+	for (int x = 0; x < width; x += regionWidth) {
+		// Fill the left edge with full 1 and the right edge with alternate 0 / 1
+		output.setRegion(x, 0, 1, height);
+		for (int y = 1; y < height; y += 2) {
+			output.set(x + regionWidth - 1, y);
 		}
 	}
 
-	output = BitMatrix(matrix.width(), matrix.height());
-	for (int j = 0; j < matrix.height(); j++) {
-		for (int i = 0; i < matrix.width(); i++) {
-			// Zero is white in the bytematrix
-			if (matrix.get(i, j) == 1) {
-				output.set(i, j);
+	const CodewordLayout& layout = CodewordLayout::ForVersion(version);
+	for (int i = 0; i < layout.codewordCount(); ++i) {
+		const CodewordLayout::Module* modules = layout.codeword(i);
+		for (int k = 0; k < 8; ++k) {
+			if (codewords[i] & (0x80 >> k)) {
+				output.set(modules[k].x, modules[k].y);
 			}
 		}
 	}
+	for (auto module : layout.fixedModules()) {
+		output.set(module.x, module.y);
+	}
 }
 
 Writer::Writer() :
@@ -98,7 +80,8 @@ Writer::Writer() :
 	_minWidth(-1),
 	_minHeight(-1),
 	_maxWidth(-1),
-	_maxHeight(-1)
+	_maxHeight(-1),
+	_legacyEncoding(false)
 {
 }
 
@@ -115,7 +98,12 @@ Writer::encode(const std::wstring& contents, int width, int height, BitMatrix& o
 
 	//1. step: Data encodation
 	std::vector<int> codewords;
-	HighLevelEncoder::Encode(contents, _shapeHint, _minWidth, _minHeight, _maxWidth, _maxHeight, codewords);
+	if (_legacyEncoding) {
+		HighLevelEncoder::Encode(contents, _shapeHint, _minWidth, _minHeight, _maxWidth, _maxHeight, codewords);
+	}
+	else {
+		HighLevelEncoder::EncodeMinimal(contents, _shapeHint, _minWidth, _minHeight, _maxWidth, _maxHeight, codewords);
+	}
 	const SymbolInfo* symbolInfo = SymbolInfo::Lookup(static_cast<int>(codewords.size()), _shapeHint, _minWidth, _minHeight, _maxWidth, _maxHeight);
 	if (symbolInfo == nullptr) {
 		throw std::invalid_argument("Can't find a symbol arrangement that matches the message. Data codewords: " + std::to_string(codewords.size()));
@@ -124,12 +112,12 @@ Writer::encode(const std::wstring& contents, int width, int height, BitMatrix& o
 	//2. step: ECC generation
 	ECEncoder::EncodeECC200(codewords, *symbolInfo);
 
-	//3. step: Module placement in Matrix
-	ByteMatrix placement;
-	DefaultPlacement::Place(codewords, symbolInfo->symbolDataWidth(), symbolInfo->symbolDataHeight(), placement);
-
-	//4. step: low-level encoding
-	EncodeLowLevel(placement, *symbolInfo, output);
+	//3. step: Module placement in Matrix and low-level encoding
+	const Version* version = Version::VersionForDimensions(symbolInfo->symbolHeight(), symbolInfo->symbolWidth());
+	if (version == nullptr) {
+		throw std::invalid_argument("No Data Matrix version for the symbol size");
+	}
+	EncodeLowLevel(codewords, *version, output);
 }
 
 } // DataMatrix
@@ -46,11 +46,21 @@ public:
 		return *this;
 	}
 
+	/**
+	* Selects the encoder of earlier versions, which chooses the encodations by a look ahead heuristic. By
+	* default the message is encoded with the least number of codewords.
+	*/
+	Writer& setLegacyEncoding(bool legacy) {
+		_legacyEncoding = legacy;
+		return *this;
+	}
+
 	void encode(const std::wstring& contents, int width, int height, BitMatrix& output) const;
 
 private:
 	SymbolShape _shapeHint;
 	int _minWidth, _minHeight, _maxWidth, _maxHeight;
+	bool _legacyEncoding;
 };
 
 } // DataMatrix
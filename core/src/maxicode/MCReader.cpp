@@ -80,7 +80,8 @@ Reader::decode(const BinaryBitmap& image) const
 	if (StatusIsError(status)) {
 		return Result(status);
 	}
-	Result result(decoderResult.text(), decoderResult.rawBytes(), std::vector<ResultPoint>(), BarcodeFormat::MAXICODE);
+	int numBits = decoderResult.numBits();
+	Result result(std::move(decoderResult).text(), std::move(decoderResult).rawBytes(), numBits, std::vector<ResultPoint>(), BarcodeFormat::MAXICODE);
 
 	auto ecLevel = decoderResult.ecLevel();
 	if (!ecLevel.empty()) {
@@ -22,6 +22,7 @@
 #include "BitArray.h"
 #include "DecodeHints.h"
 #include "TextDecoder.h"
+#include "DecodeContext.h"
 #include "ZXContainerAlgorithms.h"
 
 #include <array>
@@ -234,11 +235,24 @@ CodabarReader::CodabarReader(const DecodeHints& hints)
 	_shouldReturnStartEnd = hints.shouldReturnCodabarStartEnd();
 }
 
+namespace {
+
+// The temporaries of decodeRow(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::vector<int> counters;
+	std::vector<int> charOffsets;
+	std::string text;
+};
+
+} // anonymous
+
 Result
 CodabarReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const
 {
-	std::vector<int> counters;
-	counters.reserve(80);
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+	auto& counters = scratch.counters;
+	counters.clear();
 	if (!InitCounters(row, counters)) {
 		return Result(DecodeStatus::NotFound);
 	}
@@ -248,8 +262,8 @@ CodabarReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Dec
 	}
 
 	int nextStart = startOffset;
-	std::vector<int> charOffsets;
-	charOffsets.reserve(20);
+	auto& charOffsets = scratch.charOffsets;
+	charOffsets.clear();
 	do {
 		int charOffset = ToNarrowWidePattern(counters, nextStart);
 		if (charOffset < 0) {
@@ -285,8 +299,8 @@ CodabarReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Dec
 	}
 
 	// Translate character table offsets to actual characters.
-	std::string decodeRowResult;
-	decodeRowResult.reserve(charOffsets.size());
+	auto& decodeRowResult = scratch.text;
+	decodeRowResult.clear();
 	for (int index : charOffsets) {
 		decodeRowResult += ALPHABET[index];
 	}
@@ -305,7 +319,8 @@ CodabarReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Dec
 	}
 
 	if (!_shouldReturnStartEnd) {
-		decodeRowResult = decodeRowResult.substr(1, decodeRowResult.size() - 2);
+		decodeRowResult.pop_back();
+		decodeRowResult.erase(0, 1);
 	}
 
 	int runningCount = 0;
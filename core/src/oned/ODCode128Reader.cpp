@@ -23,6 +23,7 @@
 #include "BitArray.h"
 #include "DecodeHints.h"
 #include "TextDecoder.h"
+#include "DecodeContext.h"
 #include "ZXContainerAlgorithms.h"
 #include "ZXStrConvWorkaround.h"
 
@@ -54,12 +55,12 @@ static const int CODE_START_C = 105;
 static const int CODE_STOP = 106;
 
 static BitArray::BitArrayRange
-FindStartPattern(const BitArray& row, int* startCode)
+FindStartPattern(const BitArray& row, std::vector<int>& counters, int* startCode)
 {
 	assert(startCode != nullptr);
 
 	using Counters = std::vector<int>;
-	Counters counters(Code128::CODE_PATTERNS[0].size());
+	counters.assign(Code128::CODE_PATTERNS[0].size(), 0);
 
 	return RowReader::FindPattern(
 	    row.getNextSet(row.begin()), row.end(), counters,
@@ -105,18 +106,32 @@ Code128Reader::Code128Reader(const DecodeHints& hints) :
 {
 }
 
+namespace {
+
+// The temporaries of decodeRow(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::vector<int> counters;
+	ByteArray rawCodes;
+	std::string text;
+};
+
+} // anonymous
+
 Result
 Code128Reader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const
 {
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+	auto& counters = scratch.counters;
 	int startCode = 0;
-	auto range = FindStartPattern(row, &startCode);
+	auto range = FindStartPattern(row, counters, &startCode);
 	if (!range) {
 		return Result(DecodeStatus::NotFound);
 	}
 
 	float left = (range.begin - row.begin()) + 0.5f * range.size();
-	ByteArray rawCodes;
-	rawCodes.reserve(20);
+	auto& rawCodes = scratch.rawCodes;
+	rawCodes.clear();
 	rawCodes.push_back(static_cast<uint8_t>(startCode));
 
 	int codeSet;
@@ -137,9 +152,9 @@ Code128Reader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Dec
 	bool done = false;
 	bool isNextShifted = false;
 
-	std::string result;
-	result.reserve(20);
-	std::vector<int> counters(6, 0);
+	auto& result = scratch.text;
+	result.clear();
+	counters.assign(6, 0);
 
 	int lastCode = 0;
 	int code = 0;
@@ -23,6 +23,7 @@
 #include "BitArray.h"
 #include "DecodeHints.h"
 #include "TextDecoder.h"
+#include "DecodeContext.h"
 #include "ZXContainerAlgorithms.h"
 
 #include <algorithm>
@@ -205,6 +206,17 @@ Code39Reader::Code39Reader(const DecodeHints& hints, bool extendedMode) :
 {
 }
 
+namespace {
+
+// The temporaries of decodeRow(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::string text;
+	std::string decoded;
+};
+
+} // anonymous
+
 Result
 Code39Reader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const
 {
@@ -214,8 +226,9 @@ Code39Reader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Deco
 
 	float left = (range.begin - row.begin()) + 0.5f * range.size();
 	CounterContainer theCounters = {};
-	std::string result;
-	result.reserve(20);
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+	auto& result = scratch.text;
+	result.clear();
 
 	do {
 		// Read off white space
@@ -262,16 +275,14 @@ Code39Reader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Deco
 		return Result(DecodeStatus::NotFound);
 	}
 
-	std::string resultString;
+	auto& resultString = _extendedMode ? scratch.decoded : result;
 	if (_extendedMode) {
+		resultString.clear();
 		auto status = DecodeExtended(result, resultString);
 		if (StatusIsError(status)) {
 			return Result(status);
 		}
 	}
-	else {
-		resultString = result;
-	}
 
 	float right = (range.begin - row.begin()) + 0.5f * range.size();
 	float ypos = static_cast<float>(rowNumber);
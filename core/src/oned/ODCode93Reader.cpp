@@ -22,6 +22,7 @@
 #include "BitArray.h"
 #include "ZXNumeric.h"
 #include "TextDecoder.h"
+#include "DecodeContext.h"
 #include "ZXContainerAlgorithms.h"
 
 #include <array>
@@ -213,6 +214,17 @@ CheckChecksums(const std::string& result)
 }
 
 
+namespace {
+
+// The temporaries of decodeRow(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::string text;
+	std::string decoded;
+};
+
+} // anonymous
+
 Result
 Code93Reader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const
 {
@@ -222,8 +234,9 @@ Code93Reader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Deco
 
 	float left = (range.begin - row.begin()) + 0.5f * range.size();
 	CounterContainer theCounters = {};
-	std::string result;
-	result.reserve(20);
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+	auto& result = scratch.text;
+	result.clear();
 
 	do {
 		// Read off white space
@@ -261,7 +274,8 @@ Code93Reader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Deco
 	// Remove checksum digits
 	result.resize(result.length() - 2);
 
-	std::string resultString;
+	auto& resultString = scratch.decoded;
+	resultString.clear();
 	status = DecodeExtended(result, resultString);
 	if (StatusIsError(status)) {
 		return Result(status);
@@ -20,6 +20,7 @@
 #include "BitArray.h"
 #include "DecodeHints.h"
 #include "TextDecoder.h"
+#include "DecodeContext.h"
 #include "ZXContainerAlgorithms.h"
 
 #include <array>
@@ -116,10 +117,8 @@ static bool DecodeDigit(const std::array<int, 5>& counters, int* outCode)
 * @param resultString {@link StringBuilder} to append decoded chars to
 * @throws NotFoundException if decoding could not complete successfully
 */
-static std::string DecodeMiddle(BitArray::Iterator begin, BitArray::Iterator end)
+static bool DecodeMiddle(BitArray::Iterator begin, BitArray::Iterator end, std::string& resultString)
 {
-	std::string resultString;
-	resultString.reserve(20);
 
 	// Digits are interleaved in pairs - 5 black lines for one digit, and the 5
 	// interleaved white lines for the second digit.
@@ -134,7 +133,7 @@ static std::string DecodeMiddle(BitArray::Iterator begin, BitArray::Iterator end
 		// Get 10 runs of black/white.
 		auto range = RowReader::RecordPattern(begin, end, counterDigitPair);
 		if (!range)
-			return {};
+			return false;
 
 		// Split them into each array
 		for (int k = 0; k < 5; k++) {
@@ -145,18 +144,18 @@ static std::string DecodeMiddle(BitArray::Iterator begin, BitArray::Iterator end
 
 		int bestMatch = 0;
 		if (!DecodeDigit(counterBlack, &bestMatch))
-			return {};
+			return false;
 
 		resultString.push_back((char)('0' + bestMatch));
 
 		if (!DecodeDigit(counterWhite, &bestMatch))
-			return {};
+			return false;
 
 		resultString.push_back((char)('0' + bestMatch));
 
 		begin = range.end;
 	}
-	return resultString;
+	return true;
 }
 
 /**
@@ -215,9 +214,8 @@ static BitArray::BitArrayRange DecodeStart(const BitArray& row)
 *         block'
 * @throws NotFoundException
 */
-static BitArray::BitArrayRange DecodeEnd(const BitArray& row)
+static BitArray::BitArrayRange DecodeEnd(const BitArray& row, BitArray& revRow)
 {
-	BitArray revRow;
 	row.copyTo(revRow);
 	// For convenience, reverse the row and then
 	// search from 'the start' for the end block
@@ -240,20 +238,34 @@ ITFReader::ITFReader(const DecodeHints& hints) :
 	}
 }
 
+namespace {
+
+// The temporaries of decodeRow(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	BitArray reversedRow;
+	std::string text;
+};
+
+} // anonymous
+
 Result
 ITFReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<DecodingState>& state) const
 {
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+
 	// Find out where the Middle section (payload) starts & ends
 	auto startRange = DecodeStart(row);
 	if (!startRange)
 		return Result(DecodeStatus::NotFound);
 
-	auto endRange = DecodeEnd(row);
+	auto endRange = DecodeEnd(row, scratch.reversedRow);
 	if (!endRange || !(startRange.end < endRange.begin))
 		return Result(DecodeStatus::NotFound);
 
-	std::string result = DecodeMiddle(startRange.end, endRange.begin);
-	if (result.empty())
+	auto& result = scratch.text;
+	result.clear();
+	if (!DecodeMiddle(startRange.end, endRange.begin, result) || result.empty())
 		return Result(DecodeStatus::NotFound);
 
 	// To avoid false positives with 2D barcodes (and other patterns), make
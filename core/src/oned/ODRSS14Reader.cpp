@@ -23,12 +23,12 @@
 #include "DecodeHints.h"
 #include "ZXConfig.h"
 
-#include <list>
 #include <array>
+#include <vector>
 #include <algorithm>
 #include <numeric>
-#include <sstream>
-#include <iomanip>
+#include <string>
+#include <utility>
 
 namespace ZXing {
 namespace OneD {
@@ -56,8 +56,14 @@ static const std::array<FinderCounters, 9> FINDER_PATTERNS = {
 
 struct RSS14DecodingState : public RowReader::DecodingState
 {
-	std::list<RSS::Pair> possibleLeftPairs;
-	std::list<RSS::Pair> possibleRightPairs;
+	std::vector<RSS::Pair> possibleLeftPairs;
+	std::vector<RSS::Pair> possibleRightPairs;
+	BitArray row;
+
+	void clear() override {
+		possibleLeftPairs.clear();
+		possibleRightPairs.clear();
+	}
 };
 
 //private final List<Pair> possibleLeftPairs;
@@ -363,7 +369,7 @@ DecodePair(const BitArray& row, bool right, int rowNumber)
 }
 
 static void
-AddOrTally(std::list<RSS::Pair>& possiblePairs, const RSS::Pair& pair)
+AddOrTally(std::vector<RSS::Pair>& possiblePairs, const RSS::Pair& pair)
 {
 	if (!pair.isValid()) {
 		return;
@@ -401,23 +407,31 @@ static Result
 ConstructResult(const RSS::Pair& leftPair, const RSS::Pair& rightPair)
 {
 	int64_t symbolValue = 4537077 * static_cast<int64_t>(leftPair.value()) + rightPair.value();
-	std::wstringstream buffer;
-	buffer << std::setw(13) << std::setfill(L'0') << symbolValue;
+	// the digits of the symbol value, padded to 13 with zeros, followed by the check digit. The text is formatted
+	// in place, a std::wstringstream would allocate its buffer and then copy it.
+	int length = 13;
+	for (int64_t rest = symbolValue / 10000000000000LL; rest > 0; rest /= 10) {
+		length++;
+	}
+	std::wstring buffer(length + 1, L'0');
+	for (int i = length - 1; symbolValue > 0; i--, symbolValue /= 10) {
+		buffer[i] = (wchar_t)(symbolValue % 10 + '0');
+	}
 
 	int checkDigit = 0;
 	for (int i = 0; i < 13; i++) {
-		int digit = buffer.get() - '0';
+		int digit = buffer[i] - '0';
 		checkDigit += (i & 0x01) == 0 ? 3 * digit : digit;
 	}
 	checkDigit = 10 - (checkDigit % 10);
 	if (checkDigit == 10) {
 		checkDigit = 0;
 	}
-	buffer.put((wchar_t)(checkDigit + '0'));
+	buffer[length] = (wchar_t)(checkDigit + '0');
 
 	auto& leftPoints = leftPair.finderPattern().points();
 	auto& rightPoints = rightPair.finderPattern().points();
-	return Result(buffer.str(), ByteArray(), { leftPoints[0], leftPoints[1], rightPoints[0], rightPoints[1] }, BarcodeFormat::RSS_14);
+	return Result(std::move(buffer), ByteArray(), { leftPoints[0], leftPoints[1], rightPoints[0], rightPoints[1] }, BarcodeFormat::RSS_14);
 }
 
 Result
@@ -441,7 +455,7 @@ RSS14Reader::decodeRow(int rowNumber, const BitArray& row_, std::unique_ptr<Deco
 		throw std::runtime_error("Invalid state");
 	}
 
-	BitArray row;
+	auto& row = prevState->row;
 	row_.copyTo(row);
 	AddOrTally(prevState->possibleLeftPairs, DecodePair(row, false, rowNumber));
 	row.reverse();
@@ -25,9 +25,9 @@
 #include "ZXConfig.h"
 
 #include <cmath>
-#include <list>
 #include <array>
 #include <vector>
+#include <string>
 #include <numeric>
 #include <algorithm>
 
@@ -96,7 +96,18 @@ static const std::array<std::vector<int>, 10> FINDER_PATTERN_SEQUENCES = { {
 
 struct RSSExpandedDecodingState : public RowReader::DecodingState
 {
-	std::list<RSS::ExpandedRow> rows;
+	std::vector<RSS::ExpandedRow> rows;
+	std::vector<RSS::ExpandedRow> spareRows; // the rows removed from rows, kept for the memory of their pairs
+	std::vector<RSS::ExpandedPair> pairs;
+	BitArray binary;
+	std::string text;
+
+	void clear() override {
+		for (auto& row : rows) {
+			spareRows.push_back(std::move(row));
+		}
+		rows.clear();
+	}
 };
 
 
@@ -104,7 +115,7 @@ using namespace RSS;
 
 
 static BitArray::BitArrayRange
-FindNextPair(const BitArray& row, const std::list<ExpandedPair>& previousPairs, int forcedOffset, bool startFromEven, std::array<int, 4>& counters)
+FindNextPair(const BitArray& row, const std::vector<ExpandedPair>& previousPairs, int forcedOffset, bool startFromEven, std::array<int, 4>& counters)
 {
 	int rowOffset;
 	if (forcedOffset >= 0) {
@@ -394,7 +405,7 @@ DecodeDataCharacter(const BitArray& row, const FinderPattern& pattern, bool isOd
 
 // not private for testing
 static bool
-RetrieveNextPair(const BitArray& row, const std::list<ExpandedPair>& previousPairs, int rowNumber, bool startFromEven, ExpandedPair& outPair)
+RetrieveNextPair(const BitArray& row, const std::vector<ExpandedPair>& previousPairs, int rowNumber, bool startFromEven, ExpandedPair& outPair)
 {
 	bool isOddPattern = previousPairs.size() % 2 == 0;
 	if (startFromEven) {
@@ -434,7 +445,7 @@ RetrieveNextPair(const BitArray& row, const std::list<ExpandedPair>& previousPai
 }
 
 static bool
-CheckChecksum(const std::list<ExpandedPair>& myPairs)
+CheckChecksum(const std::vector<ExpandedPair>& myPairs)
 {
 	if (myPairs.empty())
 		return false;
@@ -465,7 +476,7 @@ CheckChecksum(const std::list<ExpandedPair>& myPairs)
 
 // Returns true when one of the rows already contains all the pairs
 static bool
-IsPartialRow(const std::list<ExpandedPair>& pairs, const std::list<ExpandedRow>& rows) {
+IsPartialRow(const std::vector<ExpandedPair>& pairs, const std::vector<ExpandedRow>& rows) {
 	for (const ExpandedRow& r : rows) {
 		bool allFound = true;
 		for (const ExpandedPair& p : pairs) {
@@ -491,9 +502,10 @@ IsPartialRow(const std::list<ExpandedPair>& pairs, const std::list<ExpandedRow>&
 
 // Remove all the rows that contains only specified pairs 
 static void
-RemovePartialRows(std::list<ExpandedRow>& rows, const std::list<ExpandedPair>& pairs)
+RemovePartialRows(RSSExpandedDecodingState& state, const std::vector<ExpandedPair>& pairs)
 {
-	std::list<ExpandedRow>::iterator it = rows.begin();
+	auto& rows = state.rows;
+	auto it = rows.begin();
 	while (it != rows.end()) {
 		//ExpandedRow r = iterator.next();
 		if (it->pairs().size() == pairs.size()) {
@@ -516,9 +528,8 @@ RemovePartialRows(std::list<ExpandedRow>& rows, const std::list<ExpandedPair>& p
 		}
 		if (allFound) {
 			// 'pairs' contains all the pairs from the row 'r'
-			auto remPos = it;
-			++it;
-			rows.erase(remPos);
+			state.spareRows.push_back(std::move(*it));
+			it = rows.erase(it);
 		}
 		else {
 			++it;
@@ -527,12 +538,13 @@ RemovePartialRows(std::list<ExpandedRow>& rows, const std::list<ExpandedPair>& p
 }
 
 static void
-StoreRow(std::list<ExpandedRow>& rows, const std::list<ExpandedPair>& pairs, int rowNumber, bool wasReversed)
+StoreRow(RSSExpandedDecodingState& state, const std::vector<ExpandedPair>& pairs, int rowNumber, bool wasReversed)
 {
+	auto& rows = state.rows;
 	// Discard if duplicate above or below; otherwise insert in order by row number.
 	bool prevIsSame = false;
 	bool nextIsSame = false;
-	std::list<ExpandedRow>::iterator insertPos = rows.begin();
+	auto insertPos = rows.begin();
 	for (; insertPos != rows.end(); ++insertPos) {
 		if (insertPos->rowNumber() > rowNumber) {
 			nextIsSame = insertPos->isEquivalent(pairs);
@@ -553,15 +565,21 @@ StoreRow(std::list<ExpandedRow>& rows, const std::list<ExpandedPair>& pairs, int
 		return;
 	}
 
-	rows.insert(insertPos, ExpandedRow(pairs, rowNumber, wasReversed));
+	ExpandedRow row;
+	if (!state.spareRows.empty()) {
+		row = std::move(state.spareRows.back());
+		state.spareRows.pop_back();
+	}
+	row.assign(pairs, rowNumber, wasReversed);
+	rows.insert(insertPos, std::move(row));
 
-	RemovePartialRows(rows, pairs);
+	RemovePartialRows(state, pairs);
 }
 
 // Whether the pairs form a valid find pattern seqience,
 // either complete or a prefix
 static bool
-IsValidSequence(const std::list<ExpandedPair>& pairs)
+IsValidSequence(const std::vector<ExpandedPair>& pairs)
 {
 	for (auto& sequence : FINDER_PATTERN_SEQUENCES) {
 		if (pairs.size() <= sequence.size() && std::equal(pairs.begin(), pairs.end(), sequence.begin(), [](const ExpandedPair& p, int seq) { return p.finderPattern().value() == seq; })) {
@@ -573,106 +591,98 @@ IsValidSequence(const std::list<ExpandedPair>& pairs)
 
 // Try to construct a valid rows sequence
 // Recursion is used to implement backtracking
+// collectedPairs holds the pairs of the rows collected so far, on success it holds the pairs of the symbol
 template <typename RowIterator>
-static std::list<ExpandedPair>
-CheckRows(RowIterator currentRow, RowIterator endRow, const std::list<ExpandedRow>& collectedRows)
+static bool
+CheckRows(RowIterator currentRow, RowIterator endRow, std::vector<ExpandedPair>& collectedPairs)
 {
-	std::list<ExpandedPair> collectedPairs;
-	for (const auto& collectedRow : collectedRows) {
-		auto &p = collectedRow.pairs();
-		collectedPairs.insert(collectedPairs.end(), p.begin(), p.end());
-	}
-
+	size_t collectedCount = collectedPairs.size();
 	for (; currentRow != endRow; ++currentRow) {
 		//ExpandedRow row = rows.get(i);
-		std::list<ExpandedPair> result = collectedPairs;
 		auto &p = currentRow->pairs();
-		result.insert(result.end(), p.begin(), p.end());
-
-		if (!IsValidSequence(result)) {
-			continue;
-		}
+		collectedPairs.insert(collectedPairs.end(), p.begin(), p.end());
 
-		if (CheckChecksum(result)) {
-			return result;
-		}
+		if (IsValidSequence(collectedPairs)) {
+			if (CheckChecksum(collectedPairs)) {
+				return true;
+			}
 
-		std::list<ExpandedRow> rs = collectedRows;
-		rs.push_back(*currentRow);
-		auto nextRow = currentRow;
-		result = CheckRows(++nextRow, endRow, rs);
-		if (!result.empty()) {
-			return result;
+			auto nextRow = currentRow;
+			if (CheckRows(++nextRow, endRow, collectedPairs)) {
+				return true;
+			}
 		}
+		collectedPairs.resize(collectedCount);
 	}
-	return std::list<ExpandedPair>();
+	return false;
 }
 
-static std::list<ExpandedPair>
-CheckRows(std::list<ExpandedRow>& rows, bool reverse) {
+static bool
+CheckRows(std::vector<ExpandedRow>& rows, bool reverse, std::vector<ExpandedPair>& pairs) {
+	pairs.clear();
 	// Limit number of rows we are checking
 	// We use recursive algorithm with pure complexity and don't want it to take forever
 	// Stacked barcode can have up to 11 rows, so 25 seems reasonable enough
 	if (rows.size() > 25) {
 		rows.clear();  // We will never have a chance to get result, so clear it
-		return std::list<ExpandedPair>();
+		return false;
 	}
 
 	return reverse ?
-		CheckRows(rows.rbegin(), rows.rend(), std::list<ExpandedRow>()) :
-		CheckRows(rows.begin(), rows.end(), std::list<ExpandedRow>());
+		CheckRows(rows.rbegin(), rows.rend(), pairs) :
+		CheckRows(rows.begin(), rows.end(), pairs);
 }
 
 // Not private for testing
-static std::list<ExpandedPair>
-DecodeRow2Pairs(int rowNumber, const BitArray& row, bool startFromEven, std::list<ExpandedRow>& rows)
+// pairs is filled with the pairs of the symbol, or left empty if none was found
+static void
+DecodeRow2Pairs(int rowNumber, const BitArray& row, bool startFromEven, RSSExpandedDecodingState& state, std::vector<ExpandedPair>& pairs)
 {
-	std::list<ExpandedPair> pairs;
+	pairs.clear();
 	ExpandedPair nextPair;
 	while (RetrieveNextPair(row, pairs, rowNumber, startFromEven, nextPair)) {
 		pairs.push_back(nextPair);
 	}
 
 	if (pairs.empty()) {
-		return pairs;
+		return;
 	}
 
 	// TODO: verify sequence of finder patterns as in checkPairSequence()
 	if (CheckChecksum(pairs)) {
-		return pairs;
+		return;
 	}
 
+	auto& rows = state.rows;
 	bool tryStackedDecode = !rows.empty();
 	bool wasReversed = false; // TODO: deal with reversed rows
-	StoreRow(rows, pairs, rowNumber, wasReversed);
+	StoreRow(state, pairs, rowNumber, wasReversed);
 	if (tryStackedDecode) {
 		// When the image is 180-rotated, then rows are sorted in wrong direction.
 		// Try twice with both the directions.
-		auto ps = CheckRows(rows, false);
-		if (!ps.empty()) {
-			return ps;
+		if (CheckRows(rows, false, pairs)) {
+			return;
 		}
-		ps = CheckRows(rows, true);
-		if (!ps.empty()) {
-			return ps;
+		if (CheckRows(rows, true, pairs)) {
+			return;
 		}
 	}
-	return std::list<ExpandedPair>();
+	pairs.clear();
 }
 
 /**
 * @author Pablo Ordu�a, University of Deusto (pablo.orduna@deusto.es)
 * @author Eduardo Castillejo, University of Deusto (eduardo.castillejo@deusto.es)
 */
-static BitArray
-BuildBitArray(const std::list<ExpandedPair>& pairs)
+static void
+BuildBitArray(const std::vector<ExpandedPair>& pairs, BitArray& result)
 {
 	int charNumber = (static_cast<int>(pairs.size()) * 2) - 1;
 	if (pairs.back().mustBeLast()) {
 		charNumber -= 1;
 	}
 
-	BitArray result(12 * charNumber);
+	result.reset(12 * charNumber);
 	int accPos = 0;
 	auto it = pairs.begin();
 	int firstValue = it->rightChar().value();
@@ -702,19 +712,18 @@ BuildBitArray(const std::list<ExpandedPair>& pairs)
 			}
 		}
 	}
-	return result;
 }
 
 // Not private for unit testing
 static Result
-ConstructResult(const std::list<ExpandedPair>& pairs)
+ConstructResult(const std::vector<ExpandedPair>& pairs, BitArray& binary, std::string& resultString)
 {
 	if (pairs.empty()) {
 		return Result(DecodeStatus::NotFound);
 	}
 
-	BitArray binary = BuildBitArray(pairs);
-	auto resultString = ExpandedBinaryDecoder::Decode(binary);
+	BuildBitArray(pairs, binary);
+	ExpandedBinaryDecoder::Decode(binary, resultString);
 	if (resultString.empty()) {
 		return Result(DecodeStatus::NotFound);
 	}
@@ -748,9 +757,12 @@ RSSExpandedReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr
 
 	// Rows can start with even pattern in case in prev rows there where odd number of patters.
 	// So lets try twice
-	Result r = ConstructResult(DecodeRow2Pairs(rowNumber, row, false, prevState->rows));
+	auto& pairs = prevState->pairs;
+	DecodeRow2Pairs(rowNumber, row, false, *prevState, pairs);
+	Result r = ConstructResult(pairs, prevState->binary, prevState->text);
 	if (!r.isValid()) {
-		r = ConstructResult(DecodeRow2Pairs(rowNumber, row, true, prevState->rows));
+		DecodeRow2Pairs(rowNumber, row, true, *prevState, pairs);
+		r = ConstructResult(pairs, prevState->binary, prevState->text);
 	}
 	return r;
 }
@@ -28,14 +28,33 @@
 #include "BitArray.h"
 #include "BinaryBitmap.h"
 #include "DecodeHints.h"
+#include "DecodeContext.h"
 
 #include <unordered_set>
 #include <algorithm>
+#include <atomic>
 
 namespace ZXing {
 namespace OneD {
 
+namespace {
+
+// The temporaries of DoDecode() and decode(), kept in the DecodeContext so that their memory gets reused.
+// The states belong to the row readers of the Reader with the id readerId.
+struct Scratch
+{
+	BitArray row;
+	std::vector<ResultPoint> points;
+	int readerId = 0;
+	std::vector<std::unique_ptr<RowReader::DecodingState>> decodingState;
+};
+
+} // anonymous
+
+static std::atomic<int> LastReaderId(0);
+
 Reader::Reader(const DecodeHints& hints) :
+	_id(++LastReaderId),
 	_tryHarder(hints.shouldTryHarder()),
 	_tryRotate(hints.shouldTryRotate())
 {
@@ -104,9 +123,20 @@ Reader::~Reader()
 * @throws NotFoundException Any spontaneous errors which occur
 */
 static Result
-DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBitmap& image, bool tryHarder)
+DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, int readerId, const BinaryBitmap& image, bool tryHarder)
 {
-	std::vector<std::unique_ptr<RowReader::DecodingState>> decodingState(readers.size());
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+	auto& decodingState = scratch.decodingState;
+	if (scratch.readerId != readerId) {
+		scratch.readerId = readerId;
+		decodingState.clear();
+		decodingState.resize(readers.size());
+	}
+	for (auto& state : decodingState) {
+		if (state != nullptr) {
+			state->clear();
+		}
+	}
 
 	int width = image.width();
 	int height = image.height();
@@ -117,7 +147,7 @@ DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBit
 		height :	// Look at the whole image, not just the center
 		15;			// 15 rows spaced 1/32 apart is roughly the middle half of the image
 
-	BitArray row(width);
+	auto& row = scratch.row;
 	for (int x = 0; x < maxLines; x++) {
 
 		// Scanning from the middle out. Determine which row we're looking at next:
@@ -158,7 +188,8 @@ DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBit
 						// But it was upside down, so note that
 						result.metadata().put(ResultMetadata::ORIENTATION, 180);
 						// And remember to flip the result points horizontally.
-						auto points = result.resultPoints();
+						auto& points = scratch.points;
+						points = result.resultPoints();
 						if (!points.empty()) {
 							for (auto& p : points) {
 								p.set(width - p.x() - 1, p.y());
@@ -178,20 +209,21 @@ DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBit
 Result
 Reader::decode(const BinaryBitmap& image) const
 {
-	Result result = DoDecode(_readers, image, _tryHarder);
+	Result result = DoDecode(_readers, _id, image, _tryHarder);
 	if (result.isValid()) {
 		return result;
 	}
 
 	if (_tryRotate && image.canRotate()) {
 		auto rotatedImage = image.rotated(270);
-		result = DoDecode(_readers, *rotatedImage, _tryHarder);
+		result = DoDecode(_readers, _id, *rotatedImage, _tryHarder);
 		if (result.isValid()) {
 			// Record that we found it rotated 90 degrees CCW / 270 degrees CW
 			auto& metadata = result.metadata();
 			metadata.put(ResultMetadata::ORIENTATION, (270 + metadata.getInt(ResultMetadata::ORIENTATION)) % 360);
 			// Update result points
-			auto points = result.resultPoints();
+			auto& points = DecodeContext::ThreadLocal().scratch<Scratch>().points;
+			points = result.resultPoints();
 			if (!points.empty()) {
 				int height = rotatedImage->height();
 				for (auto& p : points) {
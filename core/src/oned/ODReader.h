@@ -44,6 +44,7 @@ public:
 
 private:
 	std::vector<std::unique_ptr<RowReader>> _readers;
+	int _id; // tells the decoding states of the readers of this instance apart from those of other instances
 	bool _tryHarder;
 	bool _tryRotate;
 };
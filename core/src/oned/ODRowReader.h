@@ -39,9 +39,18 @@ class RowReader
 {
 public:
 
+	/**
+	* What a reader collects across the rows of one image. The state is kept for the next image, so that its
+	* memory gets reused, and cleared before the first row of each image is decoded.
+	*/
 	struct DecodingState
 	{
 		virtual ~DecodingState() {}
+
+		/**
+		* Forgets everything collected from the rows of the previous image, keeping the memory.
+		*/
+		virtual void clear() = 0;
 	};
 
 
@@ -21,11 +21,12 @@
 namespace ZXing {
 namespace OneD {
 
-static Result MaybeReturnResult(const Result& result)
+static Result MaybeReturnResult(Result result)
 {
 	const std::wstring& text = result.text();
 	if (!text.empty() && text[0] == '0') {
-		return Result(text.substr(1), ByteArray(), result.resultPoints(), BarcodeFormat::UPC_A);
+		result.convertTo(BarcodeFormat::UPC_A, 1);
+		return result;
 	}
 	else {
 		return Result(DecodeStatus::FormatError);
@@ -18,7 +18,8 @@
 #include "oned/ODUPCEANExtensionSupport.h"
 #include "oned/ODUPCEANReader.h"
 #include "oned/ODUPCEANCommon.h"
-#include "Result.h"
+#include "ResultMetadata.h"
+#include "DecodeStatus.h"
 #include "BitArray.h"
 #include "TextDecoder.h"
 #include "ZXContainerAlgorithms.h"
@@ -140,40 +141,6 @@ namespace UPCEANExtension5Support
 		return buf.str();
 	}
 
-	/**
-	* @param raw raw content of extension
-	* @return formatted interpretation of raw content as a {@link Map} mapping
-	*  one {@link ResultMetadataType} to appropriate value, or {@code null} if not known
-	*/
-	static void
-	ParseExtensionString(const std::string& raw, Result& result) {
-		if (raw.length() == 5) {
-			std::string value = ParseExtension5String(raw);
-			if (!value.empty()) {
-				result.metadata().put(ResultMetadata::SUGGESTED_PRICE, TextDecoder::FromLatin1(value));
-			}
-		}
-	}
-
-
-	static Result
-	DecodeRow(int rowNumber, const BitArray& row, int extStartRangeBegin, int extStartRangeEnd)
-	{
-		std::string resultString;
-		int end = 0;
-		DecodeStatus status = DecodeMiddle(row, extStartRangeBegin, extStartRangeEnd, resultString, end);
-		if (StatusIsError(status)) {
-			return Result(status);
-		}
-
-		float y = static_cast<float>(rowNumber);
-		float x1 = 0.5f * static_cast<float>(extStartRangeBegin + extStartRangeEnd);
-		float x2 = static_cast<float>(end);
-		Result result(TextDecoder::FromLatin1(resultString), ByteArray(), { ResultPoint(x1, y), ResultPoint(x2, y) }, BarcodeFormat::UPC_EAN_EXTENSION);
-		ParseExtensionString(resultString, result);
-		return result;
-	}
-
 } // UPCEANExtension5Support
 
 namespace UPCEANExtension2Support
@@ -214,44 +181,44 @@ namespace UPCEANExtension2Support
 		return DecodeStatus::NoError;
 	}
 
-	static Result
-	DecodeRow(int rowNumber, const BitArray& row, int extStartRangeBegin, int extStartRangeEnd)
-	{
-		std::string resultString;;
-		int end = 0;
-		DecodeStatus status = DecodeMiddle(row, extStartRangeBegin, extStartRangeEnd, resultString, end);
-		if (StatusIsError(status)) {
-			return Result(status);
-		}
-
-		float y = static_cast<float>(rowNumber);
-		float x1 = 0.5f * static_cast<float>(extStartRangeBegin + extStartRangeEnd);
-		float x2 = static_cast<float>(end);
-
-		Result result(TextDecoder::FromLatin1(resultString), ByteArray(), { ResultPoint(x1, y), ResultPoint(x2, y) }, BarcodeFormat::UPC_EAN_EXTENSION);
-		if (resultString.length() == 2) {
-			result.metadata().put(ResultMetadata::ISSUE_NUMBER, std::stoi(resultString));
-		}
-		return result;
-	}
-
 } // UPCEANExtension2Support
 
 static const std::array<int, 3> EXTENSION_START_PATTERN = { 1,1,2 };
 
-Result
-UPCEANExtensionSupport::DecodeRow(int rowNumber, const BitArray& row, int rowOffset)
+DecodeStatus
+UPCEANExtensionSupport::DecodeRow(const BitArray& row, int rowOffset, std::string& text, float& left, float& right)
 {
 	int extStartRangeBegin, extStartRangeEnd;
 	auto status = UPCEANReader::FindGuardPattern(row, rowOffset, false, EXTENSION_START_PATTERN, extStartRangeBegin, extStartRangeEnd);
 	if (StatusIsError(status)) {
-		return Result(status);
+		return status;
+	}
+	int end = 0;
+	text.clear();
+	status = UPCEANExtension5Support::DecodeMiddle(row, extStartRangeBegin, extStartRangeEnd, text, end);
+	if (StatusIsError(status)) {
+		text.clear();
+		status = UPCEANExtension2Support::DecodeMiddle(row, extStartRangeBegin, extStartRangeEnd, text, end);
+	}
+	if (StatusIsOK(status)) {
+		left = 0.5f * static_cast<float>(extStartRangeBegin + extStartRangeEnd);
+		right = static_cast<float>(end);
+	}
+	return status;
+}
+
+void
+UPCEANExtensionSupport::ParseExtension(const std::string& text, ResultMetadata& metadata)
+{
+	if (text.length() == 5) {
+		std::string value = UPCEANExtension5Support::ParseExtension5String(text);
+		if (!value.empty()) {
+			metadata.put(ResultMetadata::SUGGESTED_PRICE, TextDecoder::FromLatin1(value));
+		}
 	}
-	Result result = UPCEANExtension5Support::DecodeRow(rowNumber, row, extStartRangeBegin, extStartRangeEnd);
-	if (!result.isValid()) {
-		result = UPCEANExtension2Support::DecodeRow(rowNumber, row, extStartRangeBegin, extStartRangeEnd);
+	else if (text.length() == 2) {
+		metadata.put(ResultMetadata::ISSUE_NUMBER, std::stoi(text));
 	}
-	return result;
 }
 
 } // OneD
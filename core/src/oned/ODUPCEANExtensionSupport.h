@@ -16,17 +16,29 @@
 * limitations under the License.
 */
 
+#include <string>
+
 namespace ZXing {
 
-class Result;
 class BitArray;
+class ResultMetadata;
+enum class DecodeStatus;
 
 namespace OneD {
 
 class UPCEANExtensionSupport
 {
 public:
-	static Result DecodeRow(int rowNumber, const BitArray& row, int rowOffset);
+	/**
+	* Decodes the 2 or 5 digit extension that may follow a UPC/EAN barcode at rowOffset into text,
+	* giving the horizontal positions where it starts and ends in left and right.
+	*/
+	static DecodeStatus DecodeRow(const BitArray& row, int rowOffset, std::string& text, float& left, float& right);
+
+	/**
+	* Puts what the extension text tells about the product, its suggested price or issue number, into metadata.
+	*/
+	static void ParseExtension(const std::string& text, ResultMetadata& metadata);
 };
 
 
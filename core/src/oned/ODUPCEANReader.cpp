@@ -23,6 +23,7 @@
 #include "BitArray.h"
 #include "DecodeHints.h"
 #include "TextDecoder.h"
+#include "DecodeContext.h"
 #include "ZXContainerAlgorithms.h"
 
 #include <algorithm>
@@ -88,23 +89,14 @@ UPCEANReader::DoFindGuardPattern(const BitArray& row, int rowOffset, bool whiteF
 	return DecodeStatus::NotFound;
 }
 
-DecodeStatus
-UPCEANReader::FindGuardPattern(const BitArray& row, int rowOffset, bool whiteFirst, const int* pattern, size_t length, int& begin, int& end)
-{
-	std::vector<int> counters(length, 0);
-	return DoFindGuardPattern(row, rowOffset, whiteFirst, pattern, counters.data(), length, begin, end);
-}
-
 DecodeStatus
 UPCEANReader::FindStartGuardPattern(const BitArray& row, int& begin, int& end)
 {
 	bool foundStart = false;
 	int start = 0;
 	int nextStart = 0;
-	std::vector<int> counters(UPCEANCommon::START_END_PATTERN.size());
 	while (!foundStart) {
-		std::fill(counters.begin(), counters.end(), 0);
-		auto status = DoFindGuardPattern(row, nextStart, false, UPCEANCommon::START_END_PATTERN.data(), counters.data(), UPCEANCommon::START_END_PATTERN.size(), start, nextStart);
+		auto status = FindGuardPattern(row, nextStart, false, UPCEANCommon::START_END_PATTERN, start, nextStart);
 		if (StatusIsError(status)) {
 			return status;
 		}
@@ -135,9 +127,19 @@ UPCEANReader::decodeRow(int rowNumber, const BitArray& row, std::unique_ptr<Deco
 DecodeStatus
 UPCEANReader::decodeEnd(const BitArray& row, int endStart, int& begin, int& end) const
 {
-	return FindGuardPattern(row, endStart, false, UPCEANCommon::START_END_PATTERN.data(), UPCEANCommon::START_END_PATTERN.size(), begin, end);
+	return FindGuardPattern(row, endStart, false, UPCEANCommon::START_END_PATTERN, begin, end);
 }
 
+namespace {
+
+// The temporaries of decodeRow(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::string text;
+};
+
+} // anonymous
+
 Result
 UPCEANReader::decodeRow(int rowNumber, const BitArray& row, int startGuardBegin, int startGuardEnd) const
 {
@@ -146,8 +148,8 @@ UPCEANReader::decodeRow(int rowNumber, const BitArray& row, int startGuardBegin,
 	//	pointCallback(0.5f * (startGuardBegin + startGuardEnd), static_cast<float>(rowNumber));
 	//}
 
-	std::string result;
-	result.reserve(20);
+	std::string& result = DecodeContext::ThreadLocal().scratch<Scratch>().text;
+	result.clear();
 	int endStart = startGuardEnd;
 	auto status = decodeMiddle(row, endStart, result);
 	if (StatusIsError(status))
@@ -187,21 +189,30 @@ UPCEANReader::decodeRow(int rowNumber, const BitArray& row, int startGuardBegin,
 	BarcodeFormat format = expectedFormat();
 	float ypos = static_cast<float>(rowNumber);
 
-	Result decodeResult(TextDecoder::FromLatin1(result), ByteArray(), { ResultPoint(left, ypos), ResultPoint(right, ypos) }, format);
-	int extensionLength = 0;
-	Result extensionResult = UPCEANExtensionSupport::DecodeRow(rowNumber, row, endRangeEnd);
-	if (extensionResult.isValid())
-	{
-		decodeResult.metadata().put(ResultMetadata::UPC_EAN_EXTENSION, extensionResult.text());
-		decodeResult.metadata().putAll(extensionResult.metadata());
-		decodeResult.addResultPoints(extensionResult.resultPoints());
-		extensionLength = static_cast<int>(extensionResult.text().length());
-	}
+	std::string extension;
+	float extensionLeft, extensionRight;
+	bool hasExtension = StatusIsOK(UPCEANExtensionSupport::DecodeRow(row, endRangeEnd, extension, extensionLeft, extensionRight));
+	int extensionLength = hasExtension ? static_cast<int>(extension.length()) : 0;
 
 	if (!_allowedExtensions.empty() && !Contains(_allowedExtensions, extensionLength)) {
 		return Result(DecodeStatus::NotFound);
 	}
 
+	std::vector<ResultPoint> points;
+	points.reserve(hasExtension ? 4 : 2);
+	points.emplace_back(left, ypos);
+	points.emplace_back(right, ypos);
+	if (hasExtension) {
+		points.emplace_back(extensionLeft, ypos);
+		points.emplace_back(extensionRight, ypos);
+	}
+
+	Result decodeResult(TextDecoder::FromLatin1(result), ByteArray(), std::move(points), format);
+	if (hasExtension) {
+		decodeResult.metadata().put(ResultMetadata::UPC_EAN_EXTENSION, TextDecoder::FromLatin1(extension));
+		UPCEANExtensionSupport::ParseExtension(extension, decodeResult.metadata());
+	}
+
 	if (format == BarcodeFormat::EAN_13 || format == BarcodeFormat::UPC_A) {
 		std::string countryID = EANManufacturerOrgSupport::LookupCountryIdentifier(result);
 		if (!countryID.empty()) {
@@ -91,9 +91,10 @@ protected:
 public:
 	static DecodeStatus FindStartGuardPattern(const BitArray& row, int& begin, int& end);
 
-	template <typename Container>
-	static DecodeStatus FindGuardPattern(const BitArray& row, int rowOffset, bool whiteFirst, const Container& pattern, int& begin, int& end) {
-		return FindGuardPattern(row, rowOffset, whiteFirst, pattern.data(), pattern.size(), begin, end);
+	template <size_t N>
+	static DecodeStatus FindGuardPattern(const BitArray& row, int rowOffset, bool whiteFirst, const std::array<int, N>& pattern, int& begin, int& end) {
+		std::array<int, N> counters = {};
+		return DoFindGuardPattern(row, rowOffset, whiteFirst, pattern.data(), counters.data(), N, begin, end);
 	}
 
 	/**
@@ -116,7 +117,6 @@ public:
 private:
 	std::vector<int> _allowedExtensions;
 
-	static DecodeStatus FindGuardPattern(const BitArray& row, int rowOffset, bool whiteFirst, const int* pattern, size_t length, int& begin, int& end);
 	static DecodeStatus DecodeDigit(const BitArray& row, int rowOffset, const std::array<int, 4>* patterns, size_t patternCount, std::array<int, 4>& counters, int &resultOffset);
 	static DecodeStatus DoFindGuardPattern(const BitArray& row, int rowOffset, bool whiteFirst, const int* pattern, int* counters, size_t length, int& begin, int& end);
 };
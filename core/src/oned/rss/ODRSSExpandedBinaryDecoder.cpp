@@ -105,88 +105,77 @@ static void AI01EncodeCompressedWeight(std::string& buffer, const BitArray& bits
 * @author Pablo Ordua, University of Deusto (pablo.orduna@deusto.es)
 * @author Eduardo Castillejo, University of Deusto (eduardo.castillejo@deusto.es)
 */
-static std::string
-DecodeAI01AndOtherAIs(const BitArray& bits)
+static void
+DecodeAI01AndOtherAIs(std::string& buffer, const BitArray& bits)
 {
 	static const int HEADER_SIZE = 1 + 1 + 2; //first bit encodes the linkage flag,
 													  //the second one is the encodation method, and the other two are for the variable length
-	std::string buffer;
 	buffer.append("(01)");
 	int initialGtinPosition = static_cast<int>(buffer.length());
 	int firstGtinDigit = GenericAppIdDecoder::ExtractNumeric(bits, HEADER_SIZE, 4);
 	buffer.append(std::to_string(firstGtinDigit));
 
 	AI01EncodeCompressedGtinWithoutAI(buffer, bits, HEADER_SIZE + 4, initialGtinPosition);
-	if (StatusIsOK(GenericAppIdDecoder::DecodeAllCodes(bits, HEADER_SIZE + 44, buffer))) {
-		return buffer;
+	if (StatusIsError(GenericAppIdDecoder::DecodeAllCodes(bits, HEADER_SIZE + 44, buffer))) {
+		buffer.clear();
 	}
-	return std::string();
 }
 
-static std::string
-DecodeAnyAI(const BitArray& bits)
+static void
+DecodeAnyAI(std::string& buffer, const BitArray& bits)
 {
 	static const int HEADER_SIZE = 2 + 1 + 2;
-	std::string buffer;
-	if (StatusIsOK(GenericAppIdDecoder::DecodeAllCodes(bits, HEADER_SIZE, buffer))) {
-		return buffer;
+	if (StatusIsError(GenericAppIdDecoder::DecodeAllCodes(bits, HEADER_SIZE, buffer))) {
+		buffer.clear();
 	}
-	return std::string();
 }
 
-static std::string
-DecodeAI013103(const BitArray& bits)
+static void
+DecodeAI013103(std::string& buffer, const BitArray& bits)
 {
 	static const int HEADER_SIZE = 4 + 1;
 	static const int WEIGHT_SIZE = 15;
 
 	if (bits.size() != HEADER_SIZE + AI01_GTIN_SIZE + WEIGHT_SIZE) {
-		return std::string();
+		return;
 	}
 
-	std::string buffer;
 	AI01EncodeCompressedGtin(buffer, bits, HEADER_SIZE);
 	AI01EncodeCompressedWeight(buffer, bits, HEADER_SIZE + AI01_GTIN_SIZE, WEIGHT_SIZE,
 		// addWeightCode
 		[](std::string& buf, int weight) { buf.append("(3103)"); },
 		// checkWeight
 		[](int weight) { return weight; });
-
-	return buffer;
 }
 
-static std::string
-DecodeAI01320x(const BitArray& bits)
+static void
+DecodeAI01320x(std::string& buffer, const BitArray& bits)
 {
 	static const int HEADER_SIZE = 4 + 1;
 	static const int WEIGHT_SIZE = 15;
 
 	if (bits.size() != HEADER_SIZE + AI01_GTIN_SIZE + WEIGHT_SIZE) {
-		return std::string();
+		return;
 	}
 
-	std::string buffer;
 	AI01EncodeCompressedGtin(buffer, bits, HEADER_SIZE);
 	AI01EncodeCompressedWeight(buffer, bits, HEADER_SIZE + AI01_GTIN_SIZE, WEIGHT_SIZE,
 		// addWeightCode
 		[](std::string& buf, int weight) { buf.append(weight < 10000 ? "(3202)" : "(3203)"); },
 		// checkWeight
 		[](int weight) { return weight < 10000 ? weight : weight - 10000; });
-
-	return buffer;
 }
 
-static std::string
-DecodeAI01392x(const BitArray& bits)
+static void
+DecodeAI01392x(std::string& buffer, const BitArray& bits)
 {
 	static const int HEADER_SIZE = 5 + 1 + 2;
 	static const int LAST_DIGIT_SIZE = 2;
 
 	if (bits.size() < HEADER_SIZE + AI01_GTIN_SIZE) {
-		return std::string();
+		return;
 	}
 
-	std::string buffer;
 	AI01EncodeCompressedGtin(buffer, bits, HEADER_SIZE);
 
 	int lastAIdigit = GenericAppIdDecoder::ExtractNumeric(bits, HEADER_SIZE + AI01_GTIN_SIZE, LAST_DIGIT_SIZE);
@@ -194,24 +183,22 @@ DecodeAI01392x(const BitArray& bits)
 	buffer.append(std::to_string(lastAIdigit));
 	buffer.push_back(')');
 
-	if (StatusIsOK(GenericAppIdDecoder::DecodeGeneralPurposeField(bits, HEADER_SIZE + AI01_GTIN_SIZE + LAST_DIGIT_SIZE, buffer))) {
-		return buffer;
+	if (StatusIsError(GenericAppIdDecoder::DecodeGeneralPurposeField(bits, HEADER_SIZE + AI01_GTIN_SIZE + LAST_DIGIT_SIZE, buffer))) {
+		buffer.clear();
 	}
-	return std::string();
 }
 
-static std::string
-DecodeAI01393x(const BitArray& bits)
+static void
+DecodeAI01393x(std::string& buffer, const BitArray& bits)
 {
 	static const int HEADER_SIZE = 5 + 1 + 2;
 	static const int LAST_DIGIT_SIZE = 2;
 	static const int FIRST_THREE_DIGITS_SIZE = 10;
 
 	if (bits.size() < HEADER_SIZE + AI01_GTIN_SIZE) {
-		return std::string();
+		return;
 	}
 
-	std::string buffer;
 	AI01EncodeCompressedGtin(buffer, bits, HEADER_SIZE);
 
 	int lastAIdigit = GenericAppIdDecoder::ExtractNumeric(bits, HEADER_SIZE + AI01_GTIN_SIZE, LAST_DIGIT_SIZE);
@@ -229,24 +216,22 @@ DecodeAI01393x(const BitArray& bits)
 	}
 	buffer.append(std::to_string(firstThreeDigits));
 
-	if (StatusIsOK(GenericAppIdDecoder::DecodeGeneralPurposeField(bits, HEADER_SIZE + AI01_GTIN_SIZE + LAST_DIGIT_SIZE + FIRST_THREE_DIGITS_SIZE, buffer))) {
-		return buffer;
+	if (StatusIsError(GenericAppIdDecoder::DecodeGeneralPurposeField(bits, HEADER_SIZE + AI01_GTIN_SIZE + LAST_DIGIT_SIZE + FIRST_THREE_DIGITS_SIZE, buffer))) {
+		buffer.clear();
 	}
-	return std::string();
 }
 
-static std::string
-DecodeAI013x0x1x(const BitArray& bits, const char* firstAIdigits, const char* dateCode)
+static void
+DecodeAI013x0x1x(std::string& buffer, const BitArray& bits, const char* firstAIdigits, const char* dateCode)
 {
 	static const int HEADER_SIZE = 7 + 1;
 	static const int WEIGHT_SIZE = 20;
 	static const int DATE_SIZE = 16;
 
 	if (bits.size() != HEADER_SIZE + AI01_GTIN_SIZE + WEIGHT_SIZE + DATE_SIZE) {
-		return std::string();
+		return;
 	}
 
-	std::string buffer;
 	AI01EncodeCompressedGtin(buffer, bits, HEADER_SIZE);
 	AI01EncodeCompressedWeight(buffer, bits, HEADER_SIZE + AI01_GTIN_SIZE, WEIGHT_SIZE,
 		// addWeightCode
@@ -287,46 +272,44 @@ DecodeAI013x0x1x(const BitArray& bits, const char* firstAIdigits, const char* da
 		}
 		buffer.append(std::to_string(day));
 	}
-
-	return buffer;
 }
 
-std::string
-ExpandedBinaryDecoder::Decode(const BitArray& bits)
+void
+ExpandedBinaryDecoder::Decode(const BitArray& bits, std::string& result)
 {
+	result.clear();
 	if (bits.get(1)) {
-		return DecodeAI01AndOtherAIs(bits);
+		return DecodeAI01AndOtherAIs(result, bits);
 	}
 	if (!bits.get(2)) {
-		return DecodeAnyAI(bits);
+		return DecodeAnyAI(result, bits);
 	}
 
 	int fourBitEncodationMethod = GenericAppIdDecoder::ExtractNumeric(bits, 1, 4);
 
 	switch (fourBitEncodationMethod) {
-	case 4: return DecodeAI013103(bits);
-	case 5: return DecodeAI01320x(bits);
+	case 4: return DecodeAI013103(result, bits);
+	case 5: return DecodeAI01320x(result, bits);
 	}
 
 	int fiveBitEncodationMethod = GenericAppIdDecoder::ExtractNumeric(bits, 1, 5);
 	switch (fiveBitEncodationMethod) {
-	case 12: return DecodeAI01392x(bits);
-	case 13: return DecodeAI01393x(bits);
+	case 12: return DecodeAI01392x(result, bits);
+	case 13: return DecodeAI01393x(result, bits);
 	}
 
 	int sevenBitEncodationMethod = GenericAppIdDecoder::ExtractNumeric(bits, 1, 7);
 	switch (sevenBitEncodationMethod) {
-	case 56: return DecodeAI013x0x1x(bits, "310", "11");
-	case 57: return DecodeAI013x0x1x(bits, "320", "11");
-	case 58: return DecodeAI013x0x1x(bits, "310", "13");
-	case 59: return DecodeAI013x0x1x(bits, "320", "13");
-	case 60: return DecodeAI013x0x1x(bits, "310", "15");
-	case 61: return DecodeAI013x0x1x(bits, "320", "15");
-	case 62: return DecodeAI013x0x1x(bits, "310", "17");
-	case 63: return DecodeAI013x0x1x(bits, "320", "17");
+	case 56: return DecodeAI013x0x1x(result, bits, "310", "11");
+	case 57: return DecodeAI013x0x1x(result, bits, "320", "11");
+	case 58: return DecodeAI013x0x1x(result, bits, "310", "13");
+	case 59: return DecodeAI013x0x1x(result, bits, "320", "13");
+	case 60: return DecodeAI013x0x1x(result, bits, "310", "15");
+	case 61: return DecodeAI013x0x1x(result, bits, "320", "15");
+	case 62: return DecodeAI013x0x1x(result, bits, "310", "17");
+	case 63: return DecodeAI013x0x1x(result, bits, "320", "17");
 	}
 
-	return std::string();
 	//throw new IllegalStateException("unknown decoder: " + information);
 }
 
@@ -32,7 +32,10 @@ namespace RSS {
 class ExpandedBinaryDecoder
 {
 public:
-	static std::string Decode(const BitArray& bits);
+	/**
+	* Decodes bits into result, which is left empty if they do not hold valid data.
+	*/
+	static void Decode(const BitArray& bits, std::string& result);
 };
 
 } // RSS
@@ -35,10 +35,21 @@ class ExpandedRow
 	bool _wasReversed;
 
 public:
+	ExpandedRow() : _rowNumber(0), _wasReversed(false) {}
+
+	template <typename U>
+	ExpandedRow(const U& pairs, int rowNumber, bool wasReversed) {
+		assign(pairs, rowNumber, wasReversed);
+	}
+
+	/**
+	* Replaces the content of the row, reusing the memory of its pairs.
+	*/
 	template <typename U>
-	ExpandedRow(const U& pairs, int rowNumber, bool wasReversed) : _rowNumber(rowNumber), _wasReversed(wasReversed) {
-		_pairs.reserve(pairs.size());
+	void assign(const U& pairs, int rowNumber, bool wasReversed) {
 		_pairs.assign(pairs.begin(), pairs.end());
+		_rowNumber = rowNumber;
+		_wasReversed = wasReversed;
 	}
 
 	const std::vector<ExpandedPair>& pairs() const {
@@ -178,52 +178,49 @@ static const DigitLength FOUR_DIGIT_DATA_LENGTH[] = {
 };
 
 static DecodeStatus
-ProcessVariableAI(int aiSize, int variableFieldSize, const std::string& rawInfo, std::string& result)
+ParseFields(const std::string& rawInfo, size_t pos, std::string& result);
+
+static DecodeStatus
+ProcessVariableAI(int aiSize, int variableFieldSize, const std::string& rawInfo, size_t pos, std::string& result)
 {
-	auto ai = rawInfo.substr(0, aiSize);
-	int maxSize = std::min((int)rawInfo.length(), aiSize + variableFieldSize);
-	auto field = rawInfo.substr(aiSize, maxSize - aiSize);
-	auto remaining = rawInfo.substr(maxSize);
-	result = '(' + ai + ')' + field;
-	std::string parsedAI;
-	auto status = FieldParser::ParseFieldsInGeneralPurpose(remaining, parsedAI);
-	result += parsedAI;
-	return status;
+	int maxSize = std::min((int)(rawInfo.length() - pos), aiSize + variableFieldSize);
+	result.push_back('(');
+	result.append(rawInfo, pos, aiSize);
+	result.push_back(')');
+	result.append(rawInfo, pos + aiSize, maxSize - aiSize);
+	return ParseFields(rawInfo, pos + maxSize, result);
 }
 
 
 static DecodeStatus
-ProcessFixedAI(int aiSize, int fieldSize, const std::string& rawInfo, std::string& result)
+ProcessFixedAI(int aiSize, int fieldSize, const std::string& rawInfo, size_t pos, std::string& result)
 {
-	if ((int)rawInfo.length() < aiSize) {
+	if ((int)(rawInfo.length() - pos) < aiSize) {
 		return DecodeStatus::NotFound;
 	}
 
-	auto ai = rawInfo.substr(0, aiSize);
-
-	if ((int)rawInfo.length() < aiSize + fieldSize) {
+	if ((int)(rawInfo.length() - pos) < aiSize + fieldSize) {
 		return DecodeStatus::NotFound;
 	}
 
-	auto field = rawInfo.substr(aiSize, fieldSize);
-	auto remaining = rawInfo.substr(aiSize + fieldSize);
-	result = '(' + ai + ')' + field;
-	std::string parsedAI;
-	auto status = FieldParser::ParseFieldsInGeneralPurpose(remaining, parsedAI);
-	result += parsedAI;
-	return status;
+	result.push_back('(');
+	result.append(rawInfo, pos, aiSize);
+	result.push_back(')');
+	result.append(rawInfo, pos + aiSize, fieldSize);
+	return ParseFields(rawInfo, pos + aiSize + fieldSize, result);
 }
 
-DecodeStatus
-FieldParser::ParseFieldsInGeneralPurpose(const std::string &rawInfo, std::string& result)
+// Parses the fields of rawInfo from pos on, appending them to result.
+static DecodeStatus
+ParseFields(const std::string& rawInfo, size_t pos, std::string& result)
 {
-	if (rawInfo.empty()) {
+	if (pos == rawInfo.length()) {
 		return DecodeStatus::NoError;
 	}
 
 	// Processing 2-digit AIs
 
-	if (rawInfo.length() < 2) {
+	if (rawInfo.length() - pos < 2) {
 		return DecodeStatus::NotFound;
 	}
 
@@ -238,23 +235,28 @@ FieldParser::ParseFieldsInGeneralPurpose(const std::string &rawInfo, std::string
 	int aiSizes[] = { 2, 3, 4, 4 };
 
 	for (int i = 0; i < 4; ++i) {
-		if (rawInfo.length() < digitSizes[i]) {
+		if (rawInfo.length() - pos < digitSizes[i]) {
 			return DecodeStatus::NotFound;
 		}
-		auto firstDigits = rawInfo.substr(0, digitSizes[i]);
 		for (int j = 0; j < dataSetSizes[i]; ++j) {
 			auto &dataLength = dataLengthSets[i][j];
-			if (firstDigits == dataLength.digits) {
+			if (rawInfo.compare(pos, digitSizes[i], dataLength.digits) == 0) {
 				if (dataLength.length < 0) {
-					return ProcessVariableAI(aiSizes[i], std::abs(dataLength.length), rawInfo, result);
+					return ProcessVariableAI(aiSizes[i], std::abs(dataLength.length), rawInfo, pos, result);
 				}
-				return ProcessFixedAI(aiSizes[i], dataLength.length, rawInfo, result);
+				return ProcessFixedAI(aiSizes[i], dataLength.length, rawInfo, pos, result);
 			}
 		}
 	}
 	return DecodeStatus::NotFound;
 }
 
+DecodeStatus
+FieldParser::ParseFieldsInGeneralPurpose(const std::string &rawInfo, std::string& result)
+{
+	return ParseFields(rawInfo, 0, result);
+}
+
 
 } // RSS
 } // OneD
@@ -19,6 +19,7 @@
 #include "oned/rss/ODRSSFieldParser.h"
 #include "BitArray.h"
 #include "DecodeStatus.h"
+#include "DecodeContext.h"
 #include "ZXStrConvWorkaround.h"
 
 #include <algorithm>
@@ -70,12 +71,11 @@ struct DecodedChar : public DecodedValue
 */
 struct DecodedInformation : public DecodedValue
 {
-	std::string newString;
 	int remainingValue = -1;
 
 	DecodedInformation() {}
-	DecodedInformation(int np, const std::string& s) : DecodedValue(np), newString(s) {}
-	DecodedInformation(int np, const std::string& s, int r) : DecodedValue(np), newString(s), remainingValue(r) {}
+	explicit DecodedInformation(int np) : DecodedValue(np) {}
+	DecodedInformation(int np, int r) : DecodedValue(np), remainingValue(r) {}
 
 	bool isRemaining() const { return remainingValue >= 0; }
 };
@@ -300,7 +300,7 @@ ParseAlphaBlock(const BitArray& bits, ParsingState& state, std::string& buffer)
 		state.position = alpha.newPosition;
 
 		if (alpha.isFNC1()) {
-			return DecodedInformation(state.position, buffer); //end of the char block
+			return DecodedInformation(state.position); //end of the char block
 		}
 		buffer.push_back(alpha.value);
 	}
@@ -422,7 +422,7 @@ ParseIsoIec646Block(const BitArray& bits, ParsingState& state, std::string& buff
 		DecodedChar iso = DecodeIsoIec646(bits, state.position);
 		state.position = iso.newPosition;
 		if (iso.isFNC1()) {
-			return DecodedInformation(state.position, buffer);
+			return DecodedInformation(state.position);
 		}
 		buffer.push_back(iso.value);
 	}
@@ -468,20 +468,19 @@ ParseNumericBlock(const BitArray& bits, ParsingState& state, std::string& buffer
 		state.position = numeric.newPosition;
 
 		if (numeric.isFirstDigitFNC1()) {
-			DecodedInformation information;
 			if (numeric.isSecondDigitFNC1()) {
-				return DecodedInformation(state.position, buffer);
+				return DecodedInformation(state.position);
 			}
 			else {
-				return DecodedInformation(state.position, buffer, numeric.secondDigit);
+				return DecodedInformation(state.position, numeric.secondDigit);
 			}
 		}
 
-		buffer.append(std::to_string(numeric.firstDigit));
+		buffer.push_back((char)('0' + numeric.firstDigit));
 		if (numeric.isSecondDigitFNC1()) {
-			return DecodedInformation(state.position, buffer);
+			return DecodedInformation(state.position);
 		}
-		buffer.append(std::to_string(numeric.secondDigit));
+		buffer.push_back((char)('0' + numeric.secondDigit));
 	}
 
 	if (IsNumericToAlphaNumericLatch(bits, state.position)) {
@@ -511,15 +510,15 @@ ParseBlocks(const BitArray& bits, ParsingState& state, std::string& buffer)
 	}
 }
 
+// Appends the decoded field to buffer, which may already hold the digit remaining from the previous field.
 static DecodedInformation
-DoDecodeGeneralPurposeField(ParsingState& state, const BitArray& bits, const std::string& prefix)
+DoDecodeGeneralPurposeField(ParsingState& state, const BitArray& bits, std::string& buffer)
 {
-	std::string buffer = prefix;
 	DecodedInformation lastDecoded = ParseBlocks(bits, state, buffer);
 	if (lastDecoded.isValid() && lastDecoded.isRemaining()) {
-		return DecodedInformation(state.position, buffer, lastDecoded.remainingValue);
+		return DecodedInformation(state.position, lastDecoded.remainingValue);
 	}
-	return DecodedInformation(state.position, buffer);
+	return DecodedInformation(state.position);
 }
 
 DecodeStatus
@@ -529,7 +528,7 @@ GenericAppIdDecoder::DecodeGeneralPurposeField(const BitArray& bits, int pos, st
 	{
 		ParsingState state;
 		state.position = pos;
-		result += DoDecodeGeneralPurposeField(state, bits, std::string()).newString;
+		DoDecodeGeneralPurposeField(state, bits, result);
 		return DecodeStatus::NoError;
 	}
 	catch (const std::exception &)
@@ -538,27 +537,34 @@ GenericAppIdDecoder::DecodeGeneralPurposeField(const BitArray& bits, int pos, st
 	return DecodeStatus::FormatError;
 }
 
+namespace {
+
+// The temporaries of DecodeAllCodes(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::string field;
+};
+
+} // anonymous
+
 DecodeStatus
 GenericAppIdDecoder::DecodeAllCodes(const BitArray& bits, int pos, std::string& result)
 {
 	try
 	{
 		ParsingState state;
-		std::string remaining;
+		auto& field = DecodeContext::ThreadLocal().scratch<Scratch>().field;
+		field.clear();
 		while (true) {
 			state.position = pos;
-			DecodedInformation info = DoDecodeGeneralPurposeField(state, bits, remaining);
-			std::string parsedFields;
-			auto status = FieldParser::ParseFieldsInGeneralPurpose(info.newString, parsedFields);
+			DecodedInformation info = DoDecodeGeneralPurposeField(state, bits, field);
+			auto status = FieldParser::ParseFieldsInGeneralPurpose(field, result);
 			if (StatusIsError(status)) {
 				return status;
 			}
-			result += parsedFields;
+			field.clear();
 			if (info.isRemaining()) {
-				remaining = std::to_string(info.remainingValue);
-			}
-			else {
-				remaining.clear();
+				field.push_back((char)('0' + info.remainingValue));
 			}
 
 			if (pos == info.newPosition) {// No step forward!
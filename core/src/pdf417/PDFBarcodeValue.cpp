@@ -17,6 +17,8 @@
 
 #include "pdf417/PDFBarcodeValue.h"
 
+#include <algorithm>
+
 namespace ZXing {
 namespace Pdf417 {
 
@@ -26,18 +28,24 @@ namespace Pdf417 {
 void
 BarcodeValue::setValue(int value)
 {
-	_values[value] += 1;
+	auto it = std::lower_bound(_values.begin(), _values.end(), value, [](const std::pair<int, int>& entry, int v) { return entry.first < v; });
+	if (it != _values.end() && it->first == value) {
+		it->second += 1;
+	}
+	else {
+		_values.insert(it, std::make_pair(value, 1));
+	}
 }
 
 /**
 * Determines the maximum occurrence of a set value and returns all values which were set with this occurrence.
-* @return an array of int, containing the values with the highest occurrence, or null, if no value was set
+* @param result filled with the values with the highest occurrence, empty if no value was set
 */
-std::vector<int>
-BarcodeValue::value() const
+void
+BarcodeValue::value(std::vector<int>& result) const
 {
 	int maxConfidence = -1;
-	std::vector<int> result;
+	result.clear();
 	for (auto& entry : _values) {
 		if (entry.second > maxConfidence) {
 			maxConfidence = entry.second;
@@ -48,14 +56,13 @@ BarcodeValue::value() const
 			result.push_back(entry.first);
 		}
 	}
-	return result;
 }
 
 int
 BarcodeValue::confidence(int value) const
 {
-	auto it = _values.find(value);
-	return it != _values.end() ? it->second : 0;
+	auto it = std::lower_bound(_values.begin(), _values.end(), value, [](const std::pair<int, int>& entry, int v) { return entry.first < v; });
+	return it != _values.end() && it->first == value ? it->second : 0;
 }
 
 } // Pdf417
@@ -16,7 +16,7 @@
 * limitations under the License.
 */
 
-#include <map>
+#include <utility>
 #include <vector>
 
 namespace ZXing {
@@ -27,7 +27,9 @@ namespace Pdf417 {
 */
 class BarcodeValue
 {
-	std::map<int, int> _values;
+	// the values with their number of occurrences, sorted by value. Unlike a std::map, the vector keeps its
+	// memory when it is cleared, so a BarcodeValue can be reused.
+	std::vector<std::pair<int, int>> _values;
 
 public:
 	/**
@@ -37,11 +39,18 @@ public:
 
 	/**
 	* Determines the maximum occurrence of a set value and returns all values which were set with this occurrence.
-	* @return an array of int, containing the values with the highest occurrence, or null, if no value was set
+	* @param result filled with the values with the highest occurrence, empty if no value was set
 	*/
-	std::vector<int> value() const;
+	void value(std::vector<int>& result) const;
 
 	int confidence(int value) const;
+
+	/**
+	* Removes all values, keeping the memory
+	*/
+	void clear() {
+		_values.clear();
+	}
 };
 
 } // Pdf417
@@ -16,7 +16,9 @@
 */
 
 #include "pdf417/PDFCodewordDecoder.h"
+#include "ZXConstexprArray.h"
 
+#include <cassert>
 #include <vector>
 #include <numeric>
 #include <limits>
@@ -32,7 +34,7 @@ static const int SYMBOL_COUNT = 2787;
 * specification. The index of a symbol in this table corresponds to the
 * index into the codeword table.
 */
-const std::array<int, 2787> SYMBOL_TABLE = {
+static constexpr int SYMBOL_TABLE[] = {
 	0x1025e, 0x1027a, 0x1029e, 0x102bc, 0x102f2, 0x102f4, 0x1032e, 0x1034e, 0x1035c, 0x10396, 0x103a6, 0x103ac,
 	0x10422, 0x10428, 0x10436, 0x10442, 0x10444, 0x10448, 0x10450, 0x1045e, 0x10466, 0x1046c, 0x1047a, 0x10482,
 	0x1049e, 0x104a0, 0x104bc, 0x104c6, 0x104d8, 0x104ee, 0x104f2, 0x104f4, 0x10504, 0x10508, 0x10510, 0x1051e,
@@ -418,30 +420,38 @@ static const std::array<uint16_t, 2787> CODEWORD_TABLE = {
 typedef std::array<std::array<float, CodewordDecoder::BARS_IN_MODULE>, SYMBOL_COUNT> RatioTableType;
 typedef std::array<int, CodewordDecoder::BARS_IN_MODULE> ModuleBitCountType;
 
-static const RatioTableType& GetRatioTable()
+// The width in modules of the run of equal bits at the least significant end of symbol
+static constexpr int RunLength(int symbol)
 {
-	auto initTable = [](RatioTableType& table) -> RatioTableType& {
-		for (int i = 0; i < SYMBOL_COUNT; i++) {
-			int currentSymbol = SYMBOL_TABLE[i];
-			int currentBit = currentSymbol & 0x1;
-			for (int j = 0; j < CodewordDecoder::BARS_IN_MODULE; j++) {
-				float size = 0.0f;
-				while ((currentSymbol & 0x1) == currentBit) {
-					size += 1.0f;
-					currentSymbol >>= 1;
-				}
-				currentBit = currentSymbol & 0x1;
-				table[i][CodewordDecoder::BARS_IN_MODULE - j - 1] = size / CodewordDecoder::MODULES_IN_CODEWORD;
-			}
-		}
-		return table;
-	};
+	return (symbol & 1) == ((symbol >> 1) & 1) ? 1 + RunLength(symbol >> 1) : 1;
+}
 
-	static RatioTableType table;
-	static const auto& ref = initTable(table);
-	return ref;
+// The width in modules of the bar or space number bar, counted from the least significant end of symbol
+static constexpr int BarWidth(int symbol, int bar)
+{
+	return bar == 0 ? RunLength(symbol) : BarWidth(symbol >> RunLength(symbol), bar - 1);
 }
 
+// Computes the row of the ratio table for one symbol
+struct RatioTableRow
+{
+	int symbol;
+
+	constexpr float operator()(int i) const {
+		return static_cast<float>(BarWidth(symbol, CodewordDecoder::BARS_IN_MODULE - i - 1)) / CodewordDecoder::MODULES_IN_CODEWORD;
+	}
+};
+
+struct RatioTableGenerator
+{
+	constexpr std::array<float, CodewordDecoder::BARS_IN_MODULE> operator()(int i) const {
+		return GenerateArray<float, CodewordDecoder::BARS_IN_MODULE>(RatioTableRow{SYMBOL_TABLE[i]});
+	}
+};
+
+// The widths of the bars and spaces of every symbol relative to the width of the whole symbol
+static constexpr RatioTableType RATIO_TABLE = GenerateArray<std::array<float, CodewordDecoder::BARS_IN_MODULE>, SYMBOL_COUNT>(RatioTableGenerator());
+
 static ModuleBitCountType SampleBitCounts(const ModuleBitCountType& moduleBitCount)
 {
 	float bitCountSum = static_cast<float>(std::accumulate(moduleBitCount.begin(), moduleBitCount.end(), 0));
@@ -481,33 +491,128 @@ static int GetDecodedCodewordValue(const ModuleBitCountType& moduleBitCount)
 	return CodewordDecoder::GetCodeword(decodedValue) == -1 ? -1 : decodedValue;
 }
 
-static int GetClosestDecodedValue(const ModuleBitCountType& moduleBitCount)
+/*
+* The rows of RATIO_TABLE form a prefix tree for the closest match search. SYMBOL_TABLE is sorted, and the bits of a
+* symbol are its bar and space widths from the most significant end, so the rows that agree in their first k
+* widths are contiguous. The table is therefore a tree with one level per bar or space: the children of a node
+* split its rows by the width at its level.
+*
+* The error of a row is summed over the bars in order, the sum up to a node is the same for all its rows and no
+* more than the error of any of them. A depth-first search that visits the closer children first and skips every
+* node whose sum is already above the best error therefore finds the same row as a scan of the whole table.
+*
+* The tree needs no nodes, only RUN_END: the rows that agree with a symbol in its first level + 1 widths are those
+* that agree in the bits of these widths and in the first bit of the next one, i.e. a range of symbol values.
+*/
+
+// The number of bits in the first count bars and spaces of symbol
+static constexpr int PrefixLength(int symbol, int count)
 {
-	static const RatioTableType& ratioTable = GetRatioTable();
+	return count == 0 ? 0 : PrefixLength(symbol, count - 1) + BarWidth(symbol, CodewordDecoder::BARS_IN_MODULE - count);
+}
 
-	float bitCountSum = (float)std::accumulate(moduleBitCount.begin(), moduleBitCount.end(), 0);
-	std::array<float, CodewordDecoder::BARS_IN_MODULE> bitCountRatios;
-	for (int i = 0; i < CodewordDecoder::BARS_IN_MODULE; i++) {
-		bitCountRatios[i] = moduleBitCount[i] / bitCountSum;
+// The index of the first symbol in SYMBOL_TABLE[first, first + count) that is not less than value
+static constexpr int LowerBound(int value, int first, int count)
+{
+	return count == 0 ? first
+		: SYMBOL_TABLE[first + count / 2] < value ? LowerBound(value, first + count / 2 + 1, count - count / 2 - 1)
+		: LowerBound(value, first, count / 2);
+}
+
+// The end of the rows that agree with the given symbol in its first level + 1 widths
+static constexpr int RunEnd(int symbol, int level)
+{
+	return LowerBound(PrefixLength(symbol, level + 1) == CodewordDecoder::MODULES_IN_CODEWORD
+						  ? symbol + 1
+						  : ((symbol >> (CodewordDecoder::MODULES_IN_CODEWORD - 1 - PrefixLength(symbol, level + 1))) + 1)
+								<< (CodewordDecoder::MODULES_IN_CODEWORD - 1 - PrefixLength(symbol, level + 1)),
+					  0, SYMBOL_COUNT);
+}
+
+struct RunEndRow
+{
+	int symbol;
+
+	constexpr int operator()(int level) const {
+		return RunEnd(symbol, level);
+	}
+};
+
+struct RunEndGenerator
+{
+	constexpr std::array<uint16_t, CodewordDecoder::BARS_IN_MODULE> operator()(int i) const {
+		return GenerateArray<uint16_t, CodewordDecoder::BARS_IN_MODULE>(RunEndRow{SYMBOL_TABLE[i]});
 	}
-	float bestMatchError = std::numeric_limits<float>::max();
-	int bestMatch = -1;
-	for (size_t j = 0; j < ratioTable.size(); j++) {
-		float error = 0.0f;
-		auto& ratioTableRow = ratioTable[j];
-		for (int k = 0; k < CodewordDecoder::BARS_IN_MODULE; k++) {
-			float diff = ratioTableRow[k] - bitCountRatios[k];
+};
+
+// RUN_END[row][level] is the end of the child at level that starts at row, i.e. of the rows that agree with row
+// in the widths up to level.
+static constexpr std::array<std::array<uint16_t, CodewordDecoder::BARS_IN_MODULE>, SYMBOL_COUNT> RUN_END =
+	GenerateArray<std::array<uint16_t, CodewordDecoder::BARS_IN_MODULE>, SYMBOL_COUNT>(RunEndGenerator());
+
+// a bar or space is at most 6 modules wide, so a node has at most 6 children
+static const int MAX_CHILD_COUNT = 6;
+
+/**
+* Searches the node of the rows [firstRow, lastRow), which agree in the widths before level, see above.
+*/
+static void SearchClosestRow(int firstRow, int lastRow, int level, float error, const std::array<float, CodewordDecoder::BARS_IN_MODULE>& ratios,
+							 float& bestError, int& bestRow)
+{
+	// a node below the last bar matches a single symbol, it is a leaf like all nodes of a single row
+	if (lastRow - firstRow == 1 || level == CodewordDecoder::BARS_IN_MODULE) {
+		auto& ratioTableRow = RATIO_TABLE[firstRow];
+		for (int k = level; k < CodewordDecoder::BARS_IN_MODULE; k++) {
+			float diff = ratioTableRow[k] - ratios[k];
 			error += diff * diff;
-			if (error >= bestMatchError) {
-				break;
+			if (error > bestError) {
+				return;
 			}
 		}
-		if (error < bestMatchError) {
-			bestMatchError = error;
-			bestMatch = SYMBOL_TABLE[j];
+		// on equal errors the linear scan keeps the first row
+		if (error < bestError || (error == bestError && firstRow < bestRow)) {
+			bestError = error;
+			bestRow = firstRow;
 		}
+		return;
+	}
+
+	std::array<float, MAX_CHILD_COUNT> childErrors;
+	std::array<int, MAX_CHILD_COUNT> childRows;
+	int childCount = 0;
+	for (int row = firstRow; row < lastRow; row = RUN_END[row][level], childCount++) {
+		assert(childCount < MAX_CHILD_COUNT);
+		float diff = RATIO_TABLE[row][level] - ratios[level];
+		float childError = error + diff * diff;
+		int j = childCount;
+		for (; j > 0 && childErrors[j - 1] > childError; j--) {
+			childErrors[j] = childErrors[j - 1];
+			childRows[j] = childRows[j - 1];
+		}
+		childErrors[j] = childError;
+		childRows[j] = row;
+	}
+	for (int i = 0; i < childCount; i++) {
+		if (childErrors[i] > bestError) {
+			return;
+		}
+		SearchClosestRow(childRows[i], RUN_END[childRows[i]][level], level + 1, childErrors[i], ratios, bestError, bestRow);
+	}
+}
+
+int
+CodewordDecoder::GetClosestDecodedValue(const std::array<int, BARS_IN_MODULE>& moduleBitCount)
+{
+	float bitCountSum = (float)std::accumulate(moduleBitCount.begin(), moduleBitCount.end(), 0);
+	std::array<float, CodewordDecoder::BARS_IN_MODULE> bitCountRatios;
+	for (int i = 0; i < CodewordDecoder::BARS_IN_MODULE; i++) {
+		bitCountRatios[i] = moduleBitCount[i] / bitCountSum;
 	}
-	return bestMatch;
+	// bestRow stays -1 if the ratios are not a number
+	float bestError = std::numeric_limits<float>::max();
+	int bestRow = -1;
+	SearchClosestRow(0, SYMBOL_COUNT, 0, 0.0f, bitCountRatios, bestError, bestRow);
+	return bestRow == -1 ? -1 : SYMBOL_TABLE[bestRow];
 }
 
 int
@@ -528,9 +633,9 @@ int
 CodewordDecoder::GetCodeword(int symbol)
 {
 	symbol &= 0x3FFFF;
-	auto it = std::lower_bound(SYMBOL_TABLE.begin(), SYMBOL_TABLE.end(), symbol);
-	if (it != SYMBOL_TABLE.end() && *it == symbol) {
-		return (CODEWORD_TABLE[it - SYMBOL_TABLE.begin()] - 1) % NUMBER_OF_CODEWORDS;
+	auto it = std::lower_bound(std::begin(SYMBOL_TABLE), std::end(SYMBOL_TABLE), symbol);
+	if (it != std::end(SYMBOL_TABLE) && *it == symbol) {
+		return (CODEWORD_TABLE[it - std::begin(SYMBOL_TABLE)] - 1) % NUMBER_OF_CODEWORDS;
 	}
 	return -1;
 }
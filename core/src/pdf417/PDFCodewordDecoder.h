@@ -43,6 +43,12 @@ public:
 	static int GetCodeword(int symbol);
 
 	static int GetDecodedValue(const std::array<int, BARS_IN_MODULE>& moduleBitCount);
+
+	/**
+	* @return the symbol whose bar and space widths relative to its width are closest to those of moduleBitCount,
+	* the first one in symbol order on equal distances, or -1 if moduleBitCount is all zeros.
+	*/
+	static int GetClosestDecodedValue(const std::array<int, BARS_IN_MODULE>& moduleBitCount);
 };
 
 } // Pdf417
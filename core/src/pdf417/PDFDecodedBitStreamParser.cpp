@@ -17,13 +17,14 @@
 
 #include "pdf417/PDFDecodedBitStreamParser.h"
 #include "pdf417/PDFDecoderResultExtra.h"
+#include "pdf417/PDFNumericGroup.h"
 #include "CharacterSetECI.h"
 #include "CharacterSet.h"
 #include "TextDecoder.h"
-#include "ZXBigInteger.h"
 #include "ByteArray.h"
 #include "DecodeStatus.h"
 #include "DecoderResult.h"
+#include "DecodeContext.h"
 #include "ZXStrConvWorkaround.h"
 
 #include <array>
@@ -65,28 +66,21 @@ static const char* PUNCT_CHARS = ";<>@[\\]_`~!\r\t,:\n-.$/\"|*()?{}'";
 static const char* MIXED_CHARS = "0123456789&\r\t,:#-.$/+%*=^";
 static const CharacterSet DEFAULT_ENCODING = CharacterSet::ISO8859_1;
 
-/**
-* Table containing values for the exponent of 900.
-* This is used in the numeric compaction decode algorithm.
-*/
-static const std::array<BigInteger, 16>& EXP900()
-{
-	auto initInstance = [](std::array<BigInteger, 16>& table)->std::array<BigInteger, 16>& {
-		table[0] = BigInteger(1);
-		BigInteger nineHundred(900);
-		table[1] = nineHundred;
-		for (size_t i = 2; i < table.size(); ++i) {
-			BigInteger::Multiply(table[i - 1], nineHundred, table[i]);
-		}
-		return table;
-	};
+static const int NUMBER_OF_SEQUENCE_CODEWORDS = 2;
 
-	static std::array<BigInteger, 16> instance;
-	static const std::array<BigInteger, 16>& ref = initInstance(instance);
-	return ref;
-}
+namespace {
 
-static const int NUMBER_OF_SEQUENCE_CODEWORDS = 2;
+// The temporaries of DecodedBitStreamParser::Decode(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::wstring text;
+	std::string buf;
+	std::vector<int> textCompactionData;
+	std::vector<int> byteCompactionData;
+	ByteArray decodedBytes;
+};
+
+} // anonymous
 
 
 /**
@@ -284,12 +278,14 @@ static void DecodeTextCompaction(const std::vector<int>& textCompactionData, con
 * @param result    The decoded data is appended to the result.
 * @return The next index into the codeword array.
 */
-static int TextCompaction(const std::vector<int>& codewords, int codeIndex, std::string& result)
+static int TextCompaction(const std::vector<int>& codewords, int codeIndex, Scratch& scratch, std::string& result)
 {
 	// 2 character per codeword
-	std::vector<int> textCompactionData((codewords[0] - codeIndex) * 2, 0);
+	auto& textCompactionData = scratch.textCompactionData;
+	textCompactionData.assign((codewords[0] - codeIndex) * 2, 0);
 	// Used to hold the byte compaction value if there is a mode shift
-	std::vector<int> byteCompactionData((codewords[0] - codeIndex) * 2, 0);
+	auto& byteCompactionData = scratch.byteCompactionData;
+	byteCompactionData.assign((codewords[0] - codeIndex) * 2, 0);
 
 	int index = 0;
 	bool end = false;
@@ -347,9 +343,10 @@ static int TextCompaction(const std::vector<int>& codewords, int codeIndex, std:
 * @param result    The decoded data is appended to the result.
 * @return The next index into the codeword array.
 */
-static int ByteCompaction(int mode, const std::vector<int>& codewords, CharacterSet encoding, int codeIndex, std::wstring& result)
+static int ByteCompaction(int mode, const std::vector<int>& codewords, CharacterSet encoding, int codeIndex, Scratch& scratch, std::wstring& result)
 {
-	ByteArray decodedBytes;
+	auto& decodedBytes = scratch.decodedBytes;
+	decodedBytes.clear();
 	if (mode == BYTE_COMPACTION_MODE_LATCH) {
 		// Total number of Byte Compaction characters to be encoded
 		// is not a multiple of 6
@@ -484,15 +481,23 @@ Decode the above codewords involves
 
 Remove leading 1 =>  Result is 000213298174000
 */
-static DecodeStatus DecodeBase900toBase10(const std::vector<int>& codewords, int count, std::string& resultString)
+template <typename StrT>
+static DecodeStatus DecodeBase900toBase10(const int* codewords, int count, StrT& result)
 {
-	BigInteger result;
+	NumericGroup value;
 	for (int i = 0; i < count; i++) {
-		result = result + (EXP900()[count - i - 1] * codewords[i]);
+		if (codewords[i] < 0 || !value.multiplyAdd(900, codewords[i])) {
+			return DecodeStatus::FormatError;
+		}
 	}
-	resultString = result.toString();
-	if (!resultString.empty() && resultString.front() == '1') {
-		resultString = resultString.substr(1);
+	char digits[NumericGroup::MAX_DIGITS];
+	int digitCount = value.toDigits(digits);
+	if (digits[0] == '1') {
+		// not result.append(digits + 1, digits + digitCount), which builds a temporary string from the foreign iterators
+		result.reserve(result.size() + digitCount - 1);
+		for (int i = 1; i < digitCount; ++i) {
+			result.push_back(digits[i]);
+		}
 		return DecodeStatus::NoError;
 	}
 	return DecodeStatus::FormatError;
@@ -512,7 +517,7 @@ static DecodeStatus NumericCompaction(const std::vector<int>& codewords, int cod
 	int count = 0;
 	bool end = false;
 
-	std::vector<int> numericCodewords(MAX_NUMERIC_CODEWORDS);
+	std::array<int, MAX_NUMERIC_CODEWORDS> numericCodewords;
 
 	while (codeIndex < codewords[0] && !end) {
 		int code = codewords[codeIndex++];
@@ -540,12 +545,10 @@ static DecodeStatus NumericCompaction(const std::vector<int>& codewords, int cod
 			// current Numeric Compaction mode grouping as described in 5.4.4.2,
 			// and then to start a new one grouping.
 			if (count > 0) {
-				std::string tmp;
-				auto status = DecodeBase900toBase10(numericCodewords, count, tmp);
+				auto status = DecodeBase900toBase10(numericCodewords.data(), count, result);
 				if (StatusIsError(status)) {
 					return status;
 				}
-				TextDecoder::AppendLatin1(result, tmp);
 				count = 0;
 			}
 		}
@@ -555,27 +558,24 @@ static DecodeStatus NumericCompaction(const std::vector<int>& codewords, int cod
 }
 
 
-static DecodeStatus DecodeMacroBlock(const std::vector<int>& codewords, int codeIndex, DecoderResultExtra& resultMetadata, int& next)
+static DecodeStatus DecodeMacroBlock(const std::vector<int>& codewords, int codeIndex, Scratch& scratch, DecoderResultExtra& resultMetadata, int& next)
 {
 	if (codeIndex + NUMBER_OF_SEQUENCE_CODEWORDS > codewords[0]) {
 		// we must have at least two bytes left for the segment index
 		return DecodeStatus::FormatError;
 	}
-	std::vector<int> segmentIndexArray(NUMBER_OF_SEQUENCE_CODEWORDS);
-	for (int i = 0; i < NUMBER_OF_SEQUENCE_CODEWORDS; i++, codeIndex++) {
-		segmentIndexArray[i] = codewords[codeIndex];
-	}
-
 	std::string strBuf;
-	DecodeStatus status = DecodeBase900toBase10(segmentIndexArray, NUMBER_OF_SEQUENCE_CODEWORDS, strBuf);
+	DecodeStatus status = DecodeBase900toBase10(codewords.data() + codeIndex, NUMBER_OF_SEQUENCE_CODEWORDS, strBuf);
+	codeIndex += NUMBER_OF_SEQUENCE_CODEWORDS;
 	if (StatusIsError(status)) {
 		return status;
 	}
 
 	resultMetadata.setSegmentIndex(std::stoi(strBuf));
 
-	std::string fileId;
-	codeIndex = TextCompaction(codewords, codeIndex, fileId);
+	auto& fileId = scratch.buf;
+	fileId.clear();
+	codeIndex = TextCompaction(codewords, codeIndex, scratch, fileId);
 	resultMetadata.setFileId(fileId);
 
 	if (codewords[codeIndex] == BEGIN_MACRO_PDF417_OPTIONAL_FIELD) {
@@ -602,7 +602,7 @@ static DecodeStatus DecodeMacroBlock(const std::vector<int>& codewords, int code
 			}
 		}
 
-		resultMetadata.setOptionalData(additionalOptionCodeWords);
+		resultMetadata.setOptionalData(std::move(additionalOptionCodeWords));
 	}
 	else if (codewords[codeIndex] == MACRO_PDF417_TERMINATOR) {
 		resultMetadata.setLastSegment(true);
@@ -616,7 +616,9 @@ static DecodeStatus DecodeMacroBlock(const std::vector<int>& codewords, int code
 DecodeStatus
 DecodedBitStreamParser::Decode(const std::vector<int>& codewords, int ecLevel, DecoderResult& result)
 {
-	std::wstring resultString;
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+	auto& resultString = scratch.text;
+	resultString.clear();
 	auto encoding = DEFAULT_ENCODING;
 	// Get compaction mode
 	int codeIndex = 1;
@@ -627,14 +629,15 @@ DecodedBitStreamParser::Decode(const std::vector<int>& codewords, int ecLevel, D
 		switch (code) {
 		case TEXT_COMPACTION_MODE_LATCH:
 		{
-			std::string buf;
-			codeIndex = TextCompaction(codewords, codeIndex, buf);
+			auto& buf = scratch.buf;
+			buf.clear();
+			codeIndex = TextCompaction(codewords, codeIndex, scratch, buf);
 			TextDecoder::AppendLatin1(resultString, buf);
 			break;
 		}
 		case BYTE_COMPACTION_MODE_LATCH:
 		case BYTE_COMPACTION_MODE_LATCH_6:
-			codeIndex = ByteCompaction(code, codewords, encoding, codeIndex, resultString);
+			codeIndex = ByteCompaction(code, codewords, encoding, codeIndex, scratch, resultString);
 			break;
 		case MODE_SHIFT_TO_BYTE_COMPACTION_MODE:
 			resultString.push_back((wchar_t)codewords[codeIndex++]);
@@ -654,7 +657,7 @@ DecodedBitStreamParser::Decode(const std::vector<int>& codewords, int ecLevel, D
 			codeIndex++;
 			break;
 		case BEGIN_MACRO_PDF417_CONTROL_BLOCK:
-			status = DecodeMacroBlock(codewords, codeIndex, *resultMetadata, codeIndex);
+			status = DecodeMacroBlock(codewords, codeIndex, scratch, *resultMetadata, codeIndex);
 			break;
 		case BEGIN_MACRO_PDF417_OPTIONAL_FIELD:
 		case MACRO_PDF417_TERMINATOR:
@@ -667,8 +670,9 @@ DecodedBitStreamParser::Decode(const std::vector<int>& codewords, int ecLevel, D
 			// appeared to be missing the starting mode. In these cases defaulting
 			// to text compaction seems to work.
 			codeIndex--;
-			std::string buf;
-			codeIndex = TextCompaction(codewords, codeIndex, buf);
+			auto& buf = scratch.buf;
+			buf.clear();
+			codeIndex = TextCompaction(codewords, codeIndex, scratch, buf);
 			TextDecoder::AppendLatin1(resultString, buf);
 			break;
 		}
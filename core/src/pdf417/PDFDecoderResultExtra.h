@@ -19,6 +19,7 @@
 #include "CustomData.h"
 
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace ZXing {
@@ -56,8 +57,8 @@ public:
 		return _optionalData;
 	}
 
-	void setOptionalData(const std::vector<int>& optionalData) {
-		_optionalData = optionalData;
+	void setOptionalData(std::vector<int> optionalData) {
+		_optionalData = std::move(optionalData);
 	}
 
 	bool isLastSegment() const {
@@ -18,6 +18,7 @@
 #include "pdf417/PDFDetectionResult.h"
 #include "pdf417/PDFCodewordDecoder.h"
 #include <array>
+#include <utility>
 
 namespace ZXing {
 namespace Pdf417 {
@@ -36,8 +37,31 @@ DetectionResult::init(const BarcodeMetadata& barcodeMetadata, const Nullable<Bou
 {
 	_barcodeMetadata = barcodeMetadata;
 	_boundingBox = boundingBox;
+	// Setting a column to null or dropping it would free its codewords, so move them aside for setColumn().
+	for (auto& column : _detectionResultColumns) {
+		if (column != nullptr) {
+			_spareColumns.push_back(std::move(column.value()));
+			column = nullptr;
+		}
+	}
 	_detectionResultColumns.resize(barcodeMetadata.columnCount() + 2);
-	std::fill(_detectionResultColumns.begin(), _detectionResultColumns.end(), nullptr);
+}
+
+void
+DetectionResult::setColumn(int barcodeColumn, const DetectionResultColumn& detectionResultColumn)
+{
+	auto& column = _detectionResultColumns[barcodeColumn];
+	if (column == nullptr) {
+		if (_spareColumns.empty()) {
+			// a new column: make room for init() to move it aside without reallocating
+			_spareColumns.reserve(_spareColumns.capacity() + 1);
+		}
+		else {
+			column = std::move(_spareColumns.back());
+			_spareColumns.pop_back();
+		}
+	}
+	column = detectionResultColumn;
 }
 
 static void AdjustIndicatorColumnRowNumbers(Nullable<DetectionResultColumn>& detectionResultColumn, const BarcodeMetadata& barcodeMetadata)
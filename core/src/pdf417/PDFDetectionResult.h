@@ -32,6 +32,7 @@ class DetectionResult
 {
 	BarcodeMetadata _barcodeMetadata;
 	std::vector<Nullable<DetectionResultColumn>> _detectionResultColumns;
+	std::vector<DetectionResultColumn> _spareColumns; // the columns dropped by init(), reused by setColumn()
 	Nullable<BoundingBox> _boundingBox;
 
 public:
@@ -66,9 +67,7 @@ public:
 		_boundingBox = box;
 	}
 
-	void setColumn(int barcodeColumn, const Nullable<DetectionResultColumn>& detectionResultColumn) {
-		_detectionResultColumns[barcodeColumn] = detectionResultColumn;
-	}
+	void setColumn(int barcodeColumn, const DetectionResultColumn& detectionResultColumn);
 
 	const Nullable<DetectionResultColumn>& column(int barcodeColumn) const {
 		return _detectionResultColumns[barcodeColumn];
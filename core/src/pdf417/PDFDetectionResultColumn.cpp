@@ -18,6 +18,7 @@
 #include "pdf417/PDFDetectionResultColumn.h"
 #include "pdf417/PDFBarcodeMetadata.h"
 #include "pdf417/PDFBarcodeValue.h"
+#include "DecodeContext.h"
 #include <algorithm>
 
 namespace ZXing {
@@ -27,19 +28,36 @@ static const int MAX_NEARBY_DISTANCE = 5;
 static const int MIN_ROWS_IN_BARCODE = 3;
 static const int MAX_ROWS_IN_BARCODE = 90;
 
+namespace {
+
+// The temporaries of getBarcodeMetadata(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	BarcodeValue columnCount, rowCountUpperPart, rowCountLowerPart, ecLevel;
+	std::vector<int> cc, rcu, rcl, ec;
+};
+
+} // anonymous
+
 DetectionResultColumn::DetectionResultColumn() :
 	_rowIndicator(RowIndicator::None)
 {
 }
 
-DetectionResultColumn::DetectionResultColumn(const BoundingBox& boundingBox, RowIndicator rowIndicator) :
-	_boundingBox(boundingBox),
-	_rowIndicator(rowIndicator)
+DetectionResultColumn::DetectionResultColumn(const BoundingBox& boundingBox, RowIndicator rowIndicator)
+{
+	reset(boundingBox, rowIndicator);
+}
+
+void
+DetectionResultColumn::reset(const BoundingBox& boundingBox, RowIndicator rowIndicator)
 {
 	if (boundingBox.maxY() < boundingBox.minY()) {
 		throw std::invalid_argument("Invalid bounding box");
 	}
-	_codewords.resize(boundingBox.maxY() - boundingBox.minY() + 1);
+	_boundingBox = boundingBox;
+	_rowIndicator = rowIndicator;
+	_codewords.assign(boundingBox.maxY() - boundingBox.minY() + 1, nullptr);
 }
 
 Nullable<Codeword>
@@ -262,7 +280,7 @@ DetectionResultColumn::getRowHeights(std::vector<int>& result)
 	}
 
 	adjustIncompleteIndicatorColumnRowNumbers(barcodeMetadata);
-	result.resize(barcodeMetadata.rowCount());
+	result.assign(barcodeMetadata.rowCount(), 0);
 	for (auto& item : allCodewords()) {
 		if (item != nullptr) {
 			size_t rowNumber = item.value().rowNumber();
@@ -286,10 +304,15 @@ DetectionResultColumn::getBarcodeMetadata(BarcodeMetadata& result)
 	}
 
 	auto& codewords = allCodewords();
-	BarcodeValue barcodeColumnCount;
-	BarcodeValue barcodeRowCountUpperPart;
-	BarcodeValue barcodeRowCountLowerPart;
-	BarcodeValue barcodeECLevel;
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+	auto& barcodeColumnCount = scratch.columnCount;
+	auto& barcodeRowCountUpperPart = scratch.rowCountUpperPart;
+	auto& barcodeRowCountLowerPart = scratch.rowCountLowerPart;
+	auto& barcodeECLevel = scratch.ecLevel;
+	barcodeColumnCount.clear();
+	barcodeRowCountUpperPart.clear();
+	barcodeRowCountLowerPart.clear();
+	barcodeECLevel.clear();
 	for (auto& item : codewords) {
 		if (item == nullptr) {
 			continue;
@@ -315,10 +338,14 @@ DetectionResultColumn::getBarcodeMetadata(BarcodeMetadata& result)
 		}
 	}
 	// Maybe we should check if we have ambiguous values?
-	auto cc = barcodeColumnCount.value();
-	auto rcu = barcodeRowCountUpperPart.value();
-	auto rcl = barcodeRowCountLowerPart.value();
-	auto ec = barcodeECLevel.value();
+	auto& cc = scratch.cc;
+	auto& rcu = scratch.rcu;
+	auto& rcl = scratch.rcl;
+	auto& ec = scratch.ec;
+	barcodeColumnCount.value(cc);
+	barcodeRowCountUpperPart.value(rcu);
+	barcodeRowCountLowerPart.value(rcl);
+	barcodeECLevel.value(ec);
 	if (cc.empty() || rcu.empty() || rcl.empty() || ec.empty() || cc[0] < 1 || rcu[0] + rcl[0] < MIN_ROWS_IN_BARCODE || rcu[0] + rcl[0] > MAX_ROWS_IN_BARCODE) {
 		return false;
 	}
@@ -42,6 +42,11 @@ public:
 	DetectionResultColumn();
 	DetectionResultColumn(const BoundingBox& boundingBox, RowIndicator rowInd = RowIndicator::None);
 
+	/**
+	* Turns this into an empty column for the given bounding box, reusing the memory of the codewords.
+	*/
+	void reset(const BoundingBox& boundingBox, RowIndicator rowInd = RowIndicator::None);
+
 	bool isRowIndicator() const {
 		return _rowIndicator != RowIndicator::None;
 	}
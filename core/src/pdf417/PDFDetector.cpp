@@ -19,10 +19,12 @@
 #include "BinaryBitmap.h"
 #include "DecodeStatus.h"
 #include "BitMatrix.h"
+#include "BitArray.h"
 #include "ZXNullable.h"
+#include "DecodeContext.h"
 
-#include <list>
 #include <array>
+#include <vector>
 #include <limits>
 #include <cstdlib>
 
@@ -61,11 +63,11 @@ static const int BARCODE_MIN_HEIGHT = 10;
 * @return ratio of total variance between counters and pattern compared to total pattern size
 */
 static float
-PatternMatchVariance(const std::vector<int>& counters, const std::vector<int>& pattern, float maxIndividualVariance)
+PatternMatchVariance(const int* counters, const std::vector<int>& pattern, float maxIndividualVariance)
 {
 	int total = 0;
 	int patternLength = 0;
-	for (size_t i = 0; i < counters.size(); i++) {
+	for (size_t i = 0; i < pattern.size(); i++) {
 		total += counters[i];
 		patternLength += pattern[i];
 	}
@@ -81,7 +83,7 @@ PatternMatchVariance(const std::vector<int>& counters, const std::vector<int>& p
 	maxIndividualVariance *= unitBarWidth;
 
 	float totalVariance = 0.0f;
-	for (size_t x = 0; x < counters.size(); x++) {
+	for (size_t x = 0; x < pattern.size(); x++) {
 		int counter = counters[x];
 		float scaledPattern = pattern[x] * unitBarWidth;
 		float variance = counter > scaledPattern ? counter - scaledPattern : scaledPattern - counter;
@@ -94,37 +96,83 @@ PatternMatchVariance(const std::vector<int>& counters, const std::vector<int>& p
 }
 
 
+namespace {
+
+/**
+* The rows of the binary image in one of the two orientations the detector checks, upright or rotated by 180
+* degrees. Row y of the rotated view is row height - 1 - y of the matrix in reverse, so the rotated search
+* works without a rotated copy of the matrix. The last row is kept, as the search asks for the same row
+* several times in a row, in a buffer provided by the caller.
+*/
+class RowView
+{
+	const BitMatrix& _matrix;
+	bool _rotated;
+	int _y = -1;
+	BitArray& _row;
+
+public:
+	RowView(const BitMatrix& matrix, bool rotated, BitArray& row) : _matrix(matrix), _rotated(rotated), _row(row) {}
+
+	int height() const {
+		return _matrix.height();
+	}
+
+	const BitArray& row(int y) {
+		if (y != _y) {
+			_matrix.getRow(_rotated ? _matrix.height() - 1 - y : y, _row);
+			if (_rotated) {
+				_row.reverse();
+			}
+			_y = y;
+		}
+		return _row;
+	}
+};
+
+// The row buffer and the rotated matrix of Detector::Detect(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	BitArray row;
+	std::shared_ptr<BitMatrix> rotatedBits;
+};
+
+} // anonymous
+
 /**
-* @param matrix row of black/white values to search
+* Searches a row for the guard pattern run by run: the runs of equal pixels are found with a word at a time
+* by getNextSet() and getNextUnset(), and the counters of the candidate are kept in a fixed array.
+*
+* @param row row of black/white values to search
 * @param column x position to start search
-* @param row y position to start search
-* @param width the number of pixels to search on this row
 * @param pattern pattern of counts of number of black and white pixels that are
 *                 being searched for as a pattern
-* @param counters array of counters, as long as pattern, to re-use
-* @return start/end horizontal offset of guard pattern, as an array of two ints.
+* @param startPos receives the start of the guard pattern
+* @param endPos receives the end of the guard pattern
+* @return true if the pattern was found
 */
 static bool
-FindGuardPattern(const BitMatrix& matrix, int column, int row, int width, bool whiteFirst, const std::vector<int>& pattern, std::vector<int>& counters, int& startPos, int& endPos)
+FindGuardPattern(const BitArray& row, int column, const std::vector<int>& pattern, int& startPos, int& endPos)
 {
-	std::fill(counters.begin(), counters.end(), 0);
+	static const int MAX_PATTERN_LENGTH = 9;
+
+	int width = row.size();
+	int counters[MAX_PATTERN_LENGTH] = {};
 	int patternLength = static_cast<int>(pattern.size());
-	bool isWhite = whiteFirst;
+	bool isWhite = false;
 	int patternStart = column;
 	int pixelDrift = 0;
 
 	// if there are black pixels left of the current pixel shift to the left, but only for MAX_PIXEL_DRIFT pixels 
-	while (matrix.get(patternStart, row) && patternStart > 0 && pixelDrift++ < MAX_PIXEL_DRIFT) {
+	while (row.get(patternStart) && patternStart > 0 && pixelDrift++ < MAX_PIXEL_DRIFT) {
 		patternStart--;
 	}
 	int x = patternStart;
 	int counterPosition = 0;
-	for (; x < width; x++) {
-		bool pixel = matrix.get(x, row);
-		if (pixel != isWhite) {
-			counters[counterPosition]++;
-		}
-		else {
+	while (x < width) {
+		bool pixel = row.get(x);
+		int runEnd = pixel ? row.getNextUnset(x) : row.getNextSet(x);
+		if (pixel == isWhite) {
 			if (counterPosition == patternLength - 1) {
 				if (PatternMatchVariance(counters, pattern, MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE) {
 					startPos = patternStart;
@@ -132,7 +180,7 @@ FindGuardPattern(const BitMatrix& matrix, int column, int row, int width, bool w
 					return true;
 				}
 				patternStart += counters[0] + counters[1];
-				std::copy(counters.begin() + 2, counters.end(), counters.begin());
+				std::copy(counters + 2, counters + patternLength, counters);
 				counters[patternLength - 2] = 0;
 				counters[patternLength - 1] = 0;
 				counterPosition--;
@@ -140,9 +188,10 @@ FindGuardPattern(const BitMatrix& matrix, int column, int row, int width, bool w
 			else {
 				counterPosition++;
 			}
-			counters[counterPosition] = 1;
 			isWhite = !isWhite;
 		}
+		counters[counterPosition] += runEnd - x;
+		x = runEnd;
 	}
 	if (counterPosition == patternLength - 1) {
 		if (PatternMatchVariance(counters, pattern, MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE) {
@@ -154,25 +203,26 @@ FindGuardPattern(const BitMatrix& matrix, int column, int row, int width, bool w
 	return false;
 }
 
+/**
+* @param startRow the first row to track the pattern from, the pattern was found in it in the initial search of the
+* rows, or height() if it was not found
+*/
 static std::array<Nullable<ResultPoint>, 4>&
-FindRowsWithPattern(const BitMatrix& matrix, int height, int width, int startRow, int startColumn, const std::vector<int>& pattern, std::array<Nullable<ResultPoint>, 4>& result)
+FindRowsWithPattern(RowView& view, int startRow, int startColumn, const std::vector<int>& pattern, std::array<Nullable<ResultPoint>, 4>& result)
 {
+	int height = view.height();
 	bool found = false;
 	int startPos, endPos;
-	std::vector<int> counters(pattern.size(), 0);
-	for (; startRow < height; startRow += ROW_STEP) {
-		if (FindGuardPattern(matrix, startColumn, startRow, width, false, pattern, counters, startPos, endPos)) {
-			while (startRow > 0) {
-				if (!FindGuardPattern(matrix, startColumn, --startRow, width, false, pattern, counters, startPos, endPos)) {
-					startRow++;
-					break;
-				}
+	if (startRow < height && FindGuardPattern(view.row(startRow), startColumn, pattern, startPos, endPos)) {
+		while (startRow > 0) {
+			if (!FindGuardPattern(view.row(--startRow), startColumn, pattern, startPos, endPos)) {
+				startRow++;
+				break;
 			}
-			result[0] = ResultPoint(startPos, startRow);
-			result[1] = ResultPoint(endPos, startRow);
-			found = true;
-			break;
 		}
+		result[0] = ResultPoint(startPos, startRow);
+		result[1] = ResultPoint(endPos, startRow);
+		found = true;
 	}
 	int stopRow = startRow + 1;
 	// Last row of the current symbol that contains pattern
@@ -182,7 +232,7 @@ FindRowsWithPattern(const BitMatrix& matrix, int height, int width, int startRow
 		int previousRowEnd = static_cast<int>(result[1].value().x());
 		for (; stopRow < height; stopRow++) {
 			int startPos, endPos;
-			found = FindGuardPattern(matrix, previousRowStart, stopRow, width, false, pattern, counters, startPos, endPos);
+			found = FindGuardPattern(view.row(stopRow), previousRowStart, pattern, startPos, endPos);
 			// a found pattern is only considered to belong to the same barcode if the start and end positions
 			// don't differ too much. Pattern drift should be not bigger than two for consecutive rows. With
 			// a higher number of skipped rows drift could be larger. To keep it simple for now, we allow a slightly
@@ -209,6 +259,45 @@ FindRowsWithPattern(const BitMatrix& matrix, int height, int width, int startRow
 	return result;
 }
 
+/**
+* @return the first row from startRow on in steps of ROW_STEP that contains the pattern, height() if there is none
+*/
+static int
+FindFirstRowWithPattern(RowView& view, int startRow, int startColumn, const std::vector<int>& pattern)
+{
+	int startPos, endPos;
+	for (; startRow < view.height(); startRow += ROW_STEP) {
+		if (FindGuardPattern(view.row(startRow), startColumn, pattern, startPos, endPos)) {
+			return startRow;
+		}
+	}
+	return view.height();
+}
+
+/**
+* Searches every ROW_STEP-th row from startRow on for the start pattern and, in the rows before it, also for the
+* stop pattern, so that both patterns are looked for in one pass over the rows. stopPatternRow is height() if the
+* stop pattern is not in a row before startPatternRow.
+*/
+static void
+FindFirstRowsWithPatterns(RowView& view, int startRow, int startColumn, int& startPatternRow, int& stopPatternRow)
+{
+	int height = view.height();
+	int startPos, endPos;
+	startPatternRow = height;
+	stopPatternRow = height;
+	for (int row = startRow; row < height; row += ROW_STEP) {
+		auto& bits = view.row(row);
+		if (FindGuardPattern(bits, startColumn, START_PATTERN, startPos, endPos)) {
+			startPatternRow = row;
+			return;
+		}
+		if (stopPatternRow == height && FindGuardPattern(bits, startColumn, STOP_PATTERN, startPos, endPos)) {
+			stopPatternRow = row;
+		}
+	}
+}
+
 static void
 CopyToResult(std::array<Nullable<ResultPoint>, 8>& result, const std::array<Nullable<ResultPoint>, 4>& tmpResult, const int destinationIndexes[4])
 {
@@ -232,20 +321,26 @@ CopyToResult(std::array<Nullable<ResultPoint>, 8>& result, const std::array<Null
 *           vertices[6] x, y top right codeword area
 *           vertices[7] x, y bottom right codeword area
 */
-static std::array<Nullable<ResultPoint>, 8> FindVertices(const BitMatrix& matrix, int startRow, int startColumn)
+static std::array<Nullable<ResultPoint>, 8> FindVertices(RowView& view, int startRow, int startColumn)
 {
-	int width = matrix.width();
-	int height = matrix.height();
+	int startPatternRow, stopPatternRow;
+	FindFirstRowsWithPatterns(view, startRow, startColumn, startPatternRow, stopPatternRow);
 
 	std::array<Nullable<ResultPoint>, 4> tmp;
 	std::array<Nullable<ResultPoint>, 8> result;
-	CopyToResult(result, FindRowsWithPattern(matrix, height, width, startRow, startColumn, START_PATTERN, tmp), INDEXES_START_PATTERN);
+	CopyToResult(result, FindRowsWithPattern(view, startPatternRow, startColumn, START_PATTERN, tmp), INDEXES_START_PATTERN);
 
 	if (result[4] != nullptr) {
+		// the stop pattern is searched from the start pattern on
 		startColumn = static_cast<int>(result[4].value().x());
-		startRow = static_cast<int>(result[4].value().y());
+		stopPatternRow = FindFirstRowWithPattern(view, static_cast<int>(result[4].value().y()), startColumn, STOP_PATTERN);
 	}
-	CopyToResult(result, FindRowsWithPattern(matrix, height, width, startRow, startColumn, STOP_PATTERN, tmp), INDEXES_STOP_PATTERN);
+	else if (startPatternRow < view.height() && stopPatternRow == view.height()) {
+		// The combined search stopped at a start pattern that is too short for a symbol, before it found a stop
+		// pattern. Without a start pattern it went through all rows, so only in this case is there more to search.
+		stopPatternRow = FindFirstRowWithPattern(view, startPatternRow, startColumn, STOP_PATTERN);
+	}
+	CopyToResult(result, FindRowsWithPattern(view, stopPatternRow, startColumn, STOP_PATTERN, tmp), INDEXES_STOP_PATTERN);
 	return result;
 }
 
@@ -254,17 +349,17 @@ static std::array<Nullable<ResultPoint>, 8> FindVertices(const BitMatrix& matrix
 * @param multiple if true, then the image is searched for multiple codes. If false, then at most one code will
 * be found and returned
 * @param bitMatrix bit matrix to detect barcodes in
-* @return List of ResultPoint arrays containing the coordinates of found barcodes
+* @param barcodeCoordinates filled with the ResultPoint arrays containing the coordinates of found barcodes
 */
-static std::list<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(const BitMatrix& bitMatrix, bool multiple)
+static void DetectBarcode(RowView& view, bool multiple, std::vector<std::array<Nullable<ResultPoint>, 8>>& barcodeCoordinates)
 {
 	int row = 0;
 	int column = 0;
 	bool foundBarcodeInRow = false;
-	std::list<std::array<Nullable<ResultPoint>, 8>> barcodeCoordinates;
+	barcodeCoordinates.clear();
 
-	while (row < bitMatrix.height()) {
-		auto vertices = FindVertices(bitMatrix, row, column);
+	while (row < view.height()) {
+		auto vertices = FindVertices(view, row, column);
 
 		if (vertices[0] == nullptr && vertices[3] == nullptr) {
 			if (!foundBarcodeInRow) {
@@ -302,7 +397,6 @@ static std::list<std::array<Nullable<ResultPoint>, 8>> DetectBarcode(const BitMa
 			row = static_cast<int>(vertices[4].value().y());
 		}
 	}
-	return barcodeCoordinates;
 }
 
 
@@ -328,18 +422,26 @@ Detector::Detect(const BinaryBitmap& image, bool multiple, Result& result)
 		return DecodeStatus::NotFound;
 	}
 
-	auto barcodeCoordinates = DetectBarcode(*binImg, multiple);
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+	auto& barcodeCoordinates = result.points;
+	RowView upright(*binImg, false, scratch.row);
+	DetectBarcode(upright, multiple, barcodeCoordinates);
 	if (barcodeCoordinates.empty()) {
-		auto newBits = std::make_shared<BitMatrix>();
+		RowView rotated(*binImg, true, scratch.row);
+		DetectBarcode(rotated, multiple, barcodeCoordinates);
+		if (barcodeCoordinates.empty()) {
+			return DecodeStatus::NotFound;
+		}
+		// the points are in the rotated orientation, which the decoder needs the matrix in.
+		// The matrix is only reused once the Result of the previous call is gone.
+		auto& newBits = scratch.rotatedBits;
+		if (newBits == nullptr || newBits.use_count() > 1) {
+			newBits = std::make_shared<BitMatrix>();
+		}
 		binImg->copyTo(*newBits);
 		newBits->rotate180();
 		binImg = newBits;
-		barcodeCoordinates = DetectBarcode(*binImg, multiple);
-	}
-	if (barcodeCoordinates.empty()) {
-		return DecodeStatus::NotFound;
 	}
-	result.points = barcodeCoordinates;
 	result.bits = binImg;
 	return DecodeStatus::NoError;
 }
@@ -19,9 +19,9 @@
 #include "ResultPoint.h"
 #include "ZXNullable.h"
 
-#include <list>
 #include <array>
 #include <memory>
+#include <vector>
 
 namespace ZXing {
 
@@ -45,7 +45,7 @@ public:
 	struct Result
 	{
 		std::shared_ptr<const BitMatrix> bits;
-		std::list<std::array<Nullable<ResultPoint>, 8>> points;
+		std::vector<std::array<Nullable<ResultPoint>, 8>> points;
 	};
 
 	static DecodeStatus Detect(const BinaryBitmap& image, bool multiple, Result& result);
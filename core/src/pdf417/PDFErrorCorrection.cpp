@@ -0,0 +1,310 @@
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "pdf417/PDFErrorCorrection.h"
+#include "pdf417/PDFCodewordDecoder.h"
+#include "pdf417/PDFModulusGF.h"
+#include "DecodeStatus.h"
+
+#include <algorithm>
+
+namespace ZXing {
+namespace Pdf417 {
+
+namespace {
+
+static const int CAPACITY = ErrorCorrection::MAX_EC_CODEWORDS + 1;
+
+// A polynomial with the coefficient of x^i at index i. Only the zero polynomial has a zero leading coefficient.
+struct Poly
+{
+	int degree;
+	int coefficients[CAPACITY];
+
+	bool isZero() const {
+		return degree == 0 && coefficients[0] == 0;
+	}
+
+	void setMonomial(int monomialDegree, int coefficient) {
+		std::fill_n(coefficients, monomialDegree, 0);
+		coefficients[monomialDegree] = coefficient;
+		degree = monomialDegree;
+	}
+
+	void normalize() {
+		while (degree > 0 && coefficients[degree] == 0) {
+			degree--;
+		}
+	}
+};
+
+} // anonymous
+
+static const ModulusGF& GetModulusGF()
+{
+	static const ModulusGF field(CodewordDecoder::NUMBER_OF_CODEWORDS, 3);
+	return field;
+}
+
+/**
+* Calculates the syndromes S_i = received(a^i) for i in [1, numECCodewords], as the coefficients of x^(i - 1).
+* Returns false if all of them are zero, i.e. there is no error. Each non-zero codeword c at degree d adds
+* c * a^(i * d) to all syndromes. The exponent of that term grows by d from one syndrome to the next, so every
+* term costs one table lookup. The terms of TERM_GROUP codewords are added side by side, so that their exponent
+* updates can overlap, and the sums are reduced only once at the end.
+*/
+static bool CalculateSyndromes(const ModulusGF& field, const std::vector<int>& received, int numECCodewords, Poly& syndrome)
+{
+	static const int TERM_GROUP = 8;
+
+	int order = field.size() - 1;
+	int* sums = syndrome.coefficients;
+	std::fill_n(sums, numECCodewords, 0);
+	int exponents[TERM_GROUP];
+	int steps[TERM_GROUP];
+	int count = 0;
+	auto addTerms = [&]() {
+		for (int i = 0; i < numECCodewords; i++) {
+			int sum = 0;
+			for (int k = 0; k < count; k++) {
+				exponents[k] += steps[k];
+				exponents[k] = exponents[k] >= order ? exponents[k] - order : exponents[k];
+				sum += field.exp(exponents[k]);
+			}
+			sums[i] += sum;
+		}
+		count = 0;
+	};
+
+	int degree = static_cast<int>(received.size());
+	for (int c : received) {
+		--degree;
+		if (c == 0) {
+			continue;
+		}
+		steps[count] = degree % order;
+		exponents[count] = field.log(c);
+		if (++count == TERM_GROUP) {
+			addTerms();
+		}
+	}
+	if (count > 0) {
+		addTerms();
+	}
+
+	bool error = false;
+	for (int i = 0; i < numECCodewords; i++) {
+		sums[i] %= field.size();
+		error |= sums[i] != 0;
+	}
+	syndrome.degree = std::max(numECCodewords - 1, 0);
+	syndrome.normalize();
+	return error;
+}
+
+/**
+* poly -= a^logScale * x^shift * other, with the logs of the coefficients of other given, -1 for 0
+*/
+static void SubtractScaled(const ModulusGF& field, Poly& poly, const int* otherLogs, int otherDegree, int shift, int logScale)
+{
+	int degree = shift + otherDegree;
+	if (degree > poly.degree) {
+		std::fill(poly.coefficients + poly.degree + 1, poly.coefficients + degree + 1, 0);
+		poly.degree = degree;
+	}
+	int* coefficients = poly.coefficients + shift;
+	for (int i = 0; i <= otherDegree; i++) {
+		if (otherLogs[i] >= 0) {
+			coefficients[i] = field.subtract(coefficients[i], field.exp(otherLogs[i] + logScale));
+		}
+	}
+}
+
+static void CoefficientLogs(const ModulusGF& field, const Poly& poly, int* logs)
+{
+	for (int i = 0; i <= poly.degree; i++) {
+		logs[i] = poly.coefficients[i] == 0 ? -1 : field.log(poly.coefficients[i]);
+	}
+}
+
+/**
+* Runs the extended Euclidean algorithm on x^R and the syndrome polynomial, which is passed in r. The buffers
+* of the four polynomials are swapped instead of copied, on return sigma and omega point to the results.
+* The quotient is never built, every step of the division subtracts its term times tLast from t right away.
+*/
+static bool RunEuclideanAlgorithm(const ModulusGF& field, int R, Poly* r, Poly* rLast, Poly* t, Poly* tLast, Poly*& sigma, Poly*& omega)
+{
+	rLast->setMonomial(R, 1);
+	tLast->setMonomial(0, 0);
+	t->setMonomial(0, 1);
+
+	int rLastLogs[CAPACITY];
+	int tLastLogs[CAPACITY];
+
+	// Run Euclidean algorithm until r's degree is less than R/2
+	while (r->degree >= R / 2) {
+		// r and t take the place of rLastLast and tLastLast
+		std::swap(r, rLast);
+		std::swap(t, tLast);
+
+		// Divide rLastLast by rLast, with the remainder in r, and t = tLastLast - quotient * tLast
+		if (rLast->isZero()) {
+			// Oops, Euclidean algorithm already terminated?
+			return false;
+		}
+		CoefficientLogs(field, *rLast, rLastLogs);
+		CoefficientLogs(field, *tLast, tLastLogs);
+		int dltInverse = field.inverse(rLast->coefficients[rLast->degree]);
+		while (r->degree >= rLast->degree && !r->isZero()) {
+			int degreeDiff = r->degree - rLast->degree;
+			int logScale = field.log(field.multiply(r->coefficients[r->degree], dltInverse));
+			SubtractScaled(field, *r, rLastLogs, rLast->degree, degreeDiff, logScale);
+			r->normalize();
+			SubtractScaled(field, *t, tLastLogs, tLast->degree, degreeDiff, logScale);
+		}
+		t->normalize();
+	}
+
+	int sigmaTildeAtZero = t->coefficients[0];
+	if (sigmaTildeAtZero == 0) {
+		return false;
+	}
+
+	int inverse = field.inverse(sigmaTildeAtZero);
+	for (int i = 0; i <= t->degree; i++) {
+		t->coefficients[i] = field.multiply(t->coefficients[i], inverse);
+	}
+	for (int i = 0; i <= r->degree; i++) {
+		r->coefficients[i] = field.multiply(r->coefficients[i], inverse);
+	}
+	sigma = t;
+	omega = r;
+	return true;
+}
+
+/**
+* Chien search: finds the roots a^k of the error locator by evaluating it at every non-zero field element.
+* The terms sigma_j * a^(k*j) are kept in log representation and advanced by j from one element to the next,
+* and their sum is reduced once per element. Stores the roots in log representation.
+*/
+static bool FindErrorLocations(const ModulusGF& field, const Poly& errorLocator, int* rootLogs)
+{
+	int numErrors = errorLocator.degree;
+	int order = field.size() - 1;
+	int logs[CAPACITY];
+	int steps[CAPACITY];
+	int numTerms = 0;
+	for (int j = 1; j <= numErrors; j++) {
+		int c = errorLocator.coefficients[j];
+		if (c != 0) {
+			logs[numTerms] = field.log(c);
+			steps[numTerms] = j;
+			numTerms++;
+		}
+	}
+
+	int e = 0;
+	for (int k = 0; k < order && e < numErrors; k++) {
+		int sum = errorLocator.coefficients[0];
+		for (int i = 0; i < numTerms; i++) {
+			sum += field.exp(logs[i]);
+			int l = logs[i] + steps[i];
+			logs[i] = l >= order ? l - order : l;
+		}
+		if (sum % field.size() == 0) {
+			rootLogs[e] = k;
+			e++;
+		}
+	}
+	return e == numErrors;
+}
+
+static int EvaluateAt(const ModulusGF& field, const int* coefficients, int degree, int a)
+{
+	int result = coefficients[degree];
+	for (int i = degree - 1; i >= 0; i--) {
+		result = field.add(field.multiply(a, result), coefficients[i]);
+	}
+	return result;
+}
+
+/**
+* This is directly applying Forney's Formula, the magnitude at the root x is -omega(x) / sigma'(x).
+*/
+static bool FindErrorMagnitudes(const ModulusGF& field, const Poly& errorEvaluator, const Poly& errorLocator, const int* rootLogs, int* magnitudes)
+{
+	int errorLocatorDegree = errorLocator.degree;
+	int formalDerivative[CAPACITY];
+	for (int i = 1; i <= errorLocatorDegree; i++) {
+		formalDerivative[i - 1] = field.multiply(i, errorLocator.coefficients[i]);
+	}
+
+	for (int i = 0; i < errorLocatorDegree; i++) {
+		int x = field.exp(rootLogs[i]);
+		int numerator = field.subtract(0, EvaluateAt(field, errorEvaluator.coefficients, errorEvaluator.degree, x));
+		int denominator = EvaluateAt(field, formalDerivative, errorLocatorDegree - 1, x);
+		if (denominator == 0) {
+			return false;
+		}
+		magnitudes[i] = field.multiply(numerator, field.inverse(denominator));
+	}
+	return true;
+}
+
+DecodeStatus
+ErrorCorrection::Decode(std::vector<int>& received, int numECCodewords, int& nbErrors)
+{
+	if (numECCodewords < 0 || numECCodewords > MAX_EC_CODEWORDS) {
+		return DecodeStatus::ChecksumError;
+	}
+
+	const ModulusGF& field = GetModulusGF();
+	Poly polys[4];
+	if (!CalculateSyndromes(field, received, numECCodewords, polys[0])) {
+		nbErrors = 0;
+		return DecodeStatus::NoError;
+	}
+
+	Poly* sigma;
+	Poly* omega;
+	if (!RunEuclideanAlgorithm(field, numECCodewords, &polys[0], &polys[1], &polys[2], &polys[3], sigma, omega)) {
+		return DecodeStatus::ChecksumError;
+	}
+
+	int rootLogs[CAPACITY];
+	int magnitudes[CAPACITY];
+	if (!FindErrorLocations(field, *sigma, rootLogs) || !FindErrorMagnitudes(field, *omega, *sigma, rootLogs, magnitudes)) {
+		return DecodeStatus::ChecksumError;
+	}
+
+	// The error location is the inverse of the root, a^(order - k). Check all of them before touching received.
+	int order = field.size() - 1;
+	int receivedSize = static_cast<int>(received.size());
+	for (int i = 0; i < sigma->degree; i++) {
+		if (receivedSize - 1 - (order - rootLogs[i]) % order < 0) {
+			return DecodeStatus::ChecksumError;
+		}
+	}
+	for (int i = 0; i < sigma->degree; i++) {
+		int position = receivedSize - 1 - (order - rootLogs[i]) % order;
+		received[position] = field.subtract(received[position], magnitudes[i]);
+	}
+	nbErrors = sigma->degree;
+	return DecodeStatus::NoError;
+}
+
+} // Pdf417
+} // ZXing
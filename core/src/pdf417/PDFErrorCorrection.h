@@ -0,0 +1,53 @@
+#pragma once
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <vector>
+
+namespace ZXing {
+
+enum class DecodeStatus;
+
+namespace Pdf417 {
+
+/**
+* <p>PDF417 error correction implementation over GF(929), see ModulusGF.</p>
+*
+* <p>The key equation is solved with the extended Euclidean algorithm. All polynomials live in arrays
+* with room for MAX_EC_CODEWORDS + 1 coefficients on the stack, nothing is allocated.</p>
+*
+* @author Sean Owen
+*/
+class ErrorCorrection
+{
+public:
+	// The number of error correction codewords at EC level 8
+	static const int MAX_EC_CODEWORDS = 512;
+
+	/**
+	* Corrects the errors in received in-place.
+	*
+	* @param received received codewords, data and error correction
+	* @param numECCodewords number of those codewords used for EC, at most MAX_EC_CODEWORDS
+	* @param nbErrors receives the number of corrected errors
+	* @return ChecksumError if the errors cannot be corrected, maybe because of too many errors; received
+	* is left unchanged then.
+	*/
+	static DecodeStatus Decode(std::vector<int>& received, int numECCodewords, int& nbErrors);
+};
+
+} // Pdf417
+} // ZXing
@@ -18,10 +18,10 @@
 
 #include "pdf417/PDFHighLevelEncoder.h"
 #include "pdf417/PDFCompaction.h"
+#include "pdf417/PDFNumericGroup.h"
 #include "CharacterSet.h"
 #include "CharacterSetECI.h"
 #include "TextEncoder.h"
-#include "ZXBigInteger.h"
 
 #include <cstdint>
 #include <array>
@@ -384,25 +384,30 @@ static void EncodeBinary(const std::string& bytes, int startpos, int count, int
 static void EncodeNumeric(const std::wstring& msg, int startpos, int count, std::vector<int>& output)
 {
 	int idx = 0;
-	std::vector<int> tmp;
-	tmp.reserve(count / 3 + 1);
-	BigInteger num900(900);
+	// a leading 1 and 44 digits take at most 15 codewords
+	std::array<int, 15> tmp;
 	while (idx < count) {
-		tmp.clear();
 		int len = std::min(44, count - idx);
-		auto part = L"1" + msg.substr(startpos + idx, len);
 
-		BigInteger bigint;
-		BigInteger::TryParse(part, bigint);
-		BigInteger q, r;
+		// the digits go into the value in chunks of up to 9, behind a leading 1
+		NumericGroup value;
+		value.multiplyAdd(1, 1);
+		for (int i = 0; i < len; i += 9) {
+			uint32_t factor = 1;
+			uint32_t chunk = 0;
+			for (int j = i; j < std::min(i + 9, len); j++) {
+				factor *= 10;
+				chunk = chunk * 10 + (msg[startpos + idx + j] - '0');
+			}
+			value.multiplyAdd(factor, chunk);
+		}
+		int tmpCount = 0;
 		do {
-			BigInteger::Divide(bigint, num900, q, r);
-			tmp.push_back(r.toInt());
-			bigint = q;
-		} while (!bigint.isZero());
+			tmp[tmpCount++] = value.divide(900);
+		} while (!value.isZero());
 
 		//Reverse temporary string
-		output.insert(output.end(), tmp.rbegin(), tmp.rend());
+		output.insert(output.end(), tmp.rend() - tmpCount, tmp.rend());
 		idx += len;
 	}
 }
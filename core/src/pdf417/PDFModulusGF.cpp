@@ -21,14 +21,12 @@ namespace ZXing {
 namespace Pdf417 {
 
 ModulusGF::ModulusGF(int modulus, int generator) :
-	_modulus(modulus),
-	_zero(*this, { 0 }),
-	_one(*this, { 1 })
+	_modulus(modulus)
 {
-	_expTable.resize(modulus, 0);
+	_expTable.resize(2 * (modulus - 1), 0);
 	_logTable.resize(modulus, 0);
 	int x = 1;
-	for (int i = 0; i < modulus; i++) {
+	for (size_t i = 0; i < _expTable.size(); i++) {
 		_expTable[i] = x;
 		x = (x * generator) % modulus;
 	}
@@ -38,19 +36,5 @@ ModulusGF::ModulusGF(int modulus, int generator) :
 	// logTable[0] == 0 but this should never be used
 }
 
-ModulusPoly
-ModulusGF::buildMonomial(int degree, int coefficient) const
-{
-	if (degree < 0) {
-		throw std::invalid_argument("degree < 0");
-	}
-	if (coefficient == 0) {
-		return _zero;
-	}
-	std::vector<int> coefficients(degree + 1, 0);
-	coefficients[0] = coefficient;
-	return ModulusPoly(*this, coefficients);
-}
-
 } // Pdf417
 } // ZXing
@@ -16,9 +16,8 @@
 * limitations under the License.
 */
 
-#include "PDFModulusPoly.h"
-
 #include <stdexcept>
+#include <vector>
 
 namespace ZXing {
 namespace Pdf417 {
@@ -26,6 +25,9 @@ namespace Pdf417 {
 /**
 * <p>A field based on powers of a generator integer, modulo some modulus.< / p>
 *
+* The exp table holds 2 * (modulus - 1) entries, so that the sum of two logs needs no modulo, and sums and
+* differences are reduced with a conditional subtraction instead of a division.
+*
 * @author Sean Owen
 * @see com.google.zxing.common.reedsolomon.GenericGF
 */
@@ -34,32 +36,25 @@ class ModulusGF
 	int _modulus;
 	std::vector<int> _expTable;
 	std::vector<int> _logTable;
-	ModulusPoly _zero;
-	ModulusPoly _one;
 
 public:
 	ModulusGF(int modulus, int generator);
 
-	const ModulusPoly& zero() const {
-		return _zero;
-	}
-
-	const ModulusPoly& one() const {
-		return _one;
-	}
-
-	ModulusPoly buildMonomial(int degree, int coefficient) const;
-
 	int add(int a, int b) const {
-		return (a + b) % _modulus;
+		int sum = a + b;
+		return sum >= _modulus ? sum - _modulus : sum;
 	}
 
 	int subtract(int a, int b) const {
-		return (_modulus + a - b) % _modulus;
+		int difference = a - b;
+		return difference < 0 ? difference + _modulus : difference;
 	}
 
+	/**
+	* @return the generator to the power of a, a must be in [0, 2 * (size - 1))
+	*/
 	int exp(int a) const {
-		return _expTable.at(a);
+		return _expTable[a];
 	}
 
 	int log(int a) const {
@@ -80,7 +75,7 @@ public:
 		if (a == 0 || b == 0) {
 			return 0;
 		}
-		return _expTable[(_logTable[a] + _logTable[b]) % (_modulus - 1)];
+		return _expTable[_logTable[a] + _logTable[b]];
 	}
 
 	int size() const {
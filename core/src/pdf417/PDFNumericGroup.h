@@ -0,0 +1,116 @@
+#pragma once
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <array>
+#include <cstdint>
+
+namespace ZXing {
+namespace Pdf417 {
+
+/**
+* The value of one group of numeric compaction (see 5.4.4), i.e. up to 15 base 900 codewords or a leading 1
+* followed by up to 44 decimal digits. 900^15 is less than 10^45, so 45 decimal digits hold either form.
+*
+* The value is kept in fixed base 10^9 limbs. Converting from base 900 or from decimal digits only needs to
+* multiply by small factors, and converting to base 900 or to decimal digits only needs to divide by small
+* divisors. That avoids both a general big integer and heap memory.
+*/
+class NumericGroup
+{
+public:
+	static const int MAX_DIGITS = 45;
+
+	NumericGroup() {
+		_limbs.fill(0);
+	}
+
+	bool isZero() const {
+		for (uint32_t limb : _limbs)
+			if (limb != 0)
+				return false;
+		return true;
+	}
+
+	/**
+	* Sets the value to value * factor + addend, with factor and addend at most 10^9.
+	* @return false if the result does not fit, the value is undefined then.
+	*/
+	bool multiplyAdd(uint32_t factor, uint32_t addend) {
+		uint64_t carry = addend;
+		for (uint32_t& limb : _limbs) {
+			uint64_t product = uint64_t(limb) * factor + carry;
+			limb = static_cast<uint32_t>(product % LIMB_BASE);
+			carry = product / LIMB_BASE;
+		}
+		return carry == 0;
+	}
+
+	/**
+	* Divides the value by divisor, which is at most 10^9.
+	* @return the remainder.
+	*/
+	uint32_t divide(uint32_t divisor) {
+		uint64_t remainder = 0;
+		for (int i = LIMB_COUNT - 1; i >= 0; --i) {
+			uint64_t dividend = remainder * LIMB_BASE + _limbs[i];
+			_limbs[i] = static_cast<uint32_t>(dividend / divisor);
+			remainder = dividend % divisor;
+		}
+		return static_cast<uint32_t>(remainder);
+	}
+
+	/**
+	* Writes the decimal digits of the value without leading zeros, "0" for zero.
+	* @param digits receives at most MAX_DIGITS characters, it is not 0 terminated.
+	* @return the number of digits.
+	*/
+	int toDigits(char* digits) const {
+		int top = LIMB_COUNT - 1;
+		while (top > 0 && _limbs[top] == 0)
+			--top;
+		int count = 0;
+		char buffer[LIMB_DIGITS];
+		int n = 0;
+		uint32_t limb = _limbs[top];
+		do {
+			buffer[n++] = static_cast<char>('0' + limb % 10);
+			limb /= 10;
+		} while (limb != 0);
+		while (n > 0)
+			digits[count++] = buffer[--n];
+		for (int i = top - 1; i >= 0; --i) {
+			limb = _limbs[i];
+			for (int k = LIMB_DIGITS - 1; k >= 0; --k) {
+				digits[count + k] = static_cast<char>('0' + limb % 10);
+				limb /= 10;
+			}
+			count += LIMB_DIGITS;
+		}
+		return count;
+	}
+
+private:
+	static const int LIMB_DIGITS = 9;
+	static const int LIMB_COUNT = MAX_DIGITS / LIMB_DIGITS;
+	static const uint32_t LIMB_BASE = 1000000000;
+
+	// least significant limb first
+	std::array<uint32_t, LIMB_COUNT> _limbs;
+};
+
+} // Pdf417
+} // ZXing
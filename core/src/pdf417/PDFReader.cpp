@@ -23,16 +23,30 @@
 #include "DecodeStatus.h"
 #include "DecoderResult.h"
 #include "Result.h"
+#include "DecodeContext.h"
+#include "ZXThreads.h"
 
 #include <vector>
 #include <cstdlib>
 #include <algorithm>
+#include <atomic>
+#include <exception>
 
 namespace ZXing {
 namespace Pdf417 {
 
 static const int MODULES_IN_STOP_PATTERN = 18;
 
+namespace {
+
+// The detector result of decode(), kept in the DecodeContext so that the memory of its points gets reused.
+struct Scratch
+{
+	Detector::Result detectorResult;
+};
+
+} // anonymous
+
 static int GetMinWidth(const Nullable<ResultPoint>& p1, const Nullable<ResultPoint>& p2)
 {
 	if (p1 == nullptr || p2 == nullptr) {
@@ -61,46 +75,87 @@ static int GetMaxCodewordWidth(const std::array<Nullable<ResultPoint>, 8>& p)
 					std::max(GetMaxWidth(p[1], p[5]), GetMaxWidth(p[7], p[3]) * CodewordDecoder::MODULES_IN_CODEWORD / MODULES_IN_STOP_PATTERN));
 }
 
-DecodeStatus DoDecode(const BinaryBitmap& image, bool multiple, std::list<Result>& results)
+static Result DecodeSymbol(const BitMatrix& bits, const std::array<Nullable<ResultPoint>, 8>& points)
 {
-	Detector::Result detectorResult;
-	DecodeStatus status = Detector::Detect(image, multiple, detectorResult);
+	DecoderResult decoderResult;
+	DecodeStatus status = ScanningDecoder::Decode(bits, points[4], points[5], points[6], points[7], GetMinCodewordWidth(points), GetMaxCodewordWidth(points), decoderResult);
 	if (StatusIsError(status)) {
-		return status;
+		return Result(status);
 	}
+	std::vector<ResultPoint> foundPoints(points.size());
+	std::transform(points.begin(), points.end(), foundPoints.begin(), [](const Nullable<ResultPoint>& p) { return p.value(); });
+	int numBits = decoderResult.numBits();
+	Result result(std::move(decoderResult).text(), std::move(decoderResult).rawBytes(), numBits, std::move(foundPoints), BarcodeFormat::PDF_417);
+	result.metadata().put(ResultMetadata::ERROR_CORRECTION_LEVEL, decoderResult.ecLevel());
+	if (auto extra = decoderResult.extra()) {
+		result.metadata().put(ResultMetadata::PDF417_EXTRA_METADATA, extra);
+	}
+	return result;
+}
+
+/**
+* Decodes the symbols of the detector result on threadCount threads. The symbols are handed out one at a time,
+* and the results are collected in the order of the symbols. A symbol whose decoding throws, e.g. on codewords
+* out of range, counts as a FormatError, as an exception must not leave a worker thread.
+*/
+static void DecodeSymbols(const Detector::Result& detectorResult, int threadCount, std::list<Result>& results)
+{
+	int count = static_cast<int>(detectorResult.points.size());
+	std::vector<Result> decoded(count, Result(DecodeStatus::NotFound));
+	std::atomic<int> next(0);
 
-	for (const auto& points : detectorResult.points) {
-		DecoderResult decoderResult;
-		DecodeStatus status = ScanningDecoder::Decode(*detectorResult.bits, points[4], points[5], points[6], points[7], GetMinCodewordWidth(points), GetMaxCodewordWidth(points), decoderResult);
-		if (StatusIsOK(status)) {
-			std::vector<ResultPoint> foundPoints(points.size());
-			std::transform(points.begin(), points.end(), foundPoints.begin(), [](const Nullable<ResultPoint>& p) { return p.value(); });
-			Result result(decoderResult.text(), decoderResult.rawBytes(), foundPoints, BarcodeFormat::PDF_417);
-			result.metadata().put(ResultMetadata::ERROR_CORRECTION_LEVEL, decoderResult.ecLevel());
-			if (auto extra = decoderResult.extra()) {
-				result.metadata().put(ResultMetadata::PDF417_EXTRA_METADATA, extra);
+	auto worker = [&]() {
+		for (int i; (i = next++) < count;) {
+			try {
+				decoded[i] = DecodeSymbol(*detectorResult.bits, detectorResult.points[i]);
 			}
-			results.push_back(result);
-			if (!multiple) {
-				return DecodeStatus::NoError;
+			catch (const std::exception&) {
+				decoded[i] = Result(DecodeStatus::FormatError);
 			}
 		}
-		else if (!multiple) {
-			return status;
+	};
+
+	RunOnThreads(threadCount, count, worker);
+
+	for (auto& result : decoded) {
+		if (result.isValid()) {
+			results.push_back(std::move(result));
 		}
 	}
-	return results.empty() ? DecodeStatus::NotFound : DecodeStatus::NoError;
 }
 
 Result
 Reader::decode(const BinaryBitmap& image) const
+{
+	auto& detectorResult = DecodeContext::ThreadLocal().scratch<Scratch>().detectorResult;
+	DecodeStatus status = Detector::Detect(image, false, detectorResult);
+	if (StatusIsError(status)) {
+		return Result(status);
+	}
+
+	// Without multiple only the first symbol is decoded
+	Result result = DecodeSymbol(*detectorResult.bits, detectorResult.points.front());
+	// do not keep the matrix alive, the image may be gone before the next call
+	detectorResult.bits = nullptr;
+	return result;
+}
+
+std::list<Result>
+Reader::decodeMultiple(const BinaryBitmap& image) const
 {
 	std::list<Result> results;
-	DecodeStatus status = DoDecode(image, false, results);
-	if (StatusIsOK(status)) {
-		return results.front();
+	Detector::Result detectorResult;
+	if (StatusIsOK(Detector::Detect(image, true, detectorResult))) {
+		DecodeSymbols(detectorResult, _threadCount, results);
 	}
-	return Result(status);
+	return results;
+}
+
+Reader&
+Reader::setThreadCount(int threadCount)
+{
+	_threadCount = threadCount;
+	return *this;
 }
 
 } // Pdf417
@@ -18,6 +18,8 @@
 
 #include "Reader.h"
 
+#include <list>
+
 namespace ZXing {
 namespace Pdf417 {
 
@@ -30,6 +32,23 @@ class Reader : public ZXing::Reader
 {
 public:
 	virtual Result decode(const BinaryBitmap& image) const override;
+
+	/**
+	* Decodes all PDF417 codes in the image, e.g. the stacked codes of a shipping form. The image is searched
+	* once for all of them, and the symbols found are decoded on up to setThreadCount() threads.
+	*
+	* @return the decoded codes in the order they were found in the image, top to bottom, empty if there are none.
+	* Symbols that were detected but could not be decoded are left out.
+	*/
+	std::list<Result> decodeMultiple(const BinaryBitmap& image) const;
+
+	/**
+	* Sets the number of threads decodeMultiple() decodes the symbols on, the calling one included. The default is 1.
+	*/
+	Reader& setThreadCount(int threadCount);
+
+private:
+	int _threadCount = 1;
 };
 
 } // Pdf417
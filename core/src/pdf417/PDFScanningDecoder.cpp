@@ -23,12 +23,13 @@
 #include "pdf417/PDFDetectionResult.h"
 #include "pdf417/PDFBarcodeValue.h"
 #include "pdf417/PDFDecodedBitStreamParser.h"
-#include "pdf417/PDFModulusGF.h"
+#include "pdf417/PDFErrorCorrection.h"
 #include "ResultPoint.h"
 #include "ZXNullable.h"
 #include "BitMatrix.h"
 #include "DecoderResult.h"
 #include "DecodeStatus.h"
+#include "DecodeContext.h"
 #include "DecoderResult.h"
 
 #include <cstdlib>
@@ -41,10 +42,30 @@ namespace Pdf417 {
 
 static const int CODEWORD_SKEW_SIZE = 2;
 static const int MAX_ERRORS = 3;
-static const int MAX_EC_CODEWORDS = 512;
 
 typedef std::array<int, CodewordDecoder::BARS_IN_MODULE> ModuleBitCountType;
 
+namespace {
+
+// The temporaries of ScanningDecoder::Decode(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	DetectionResultColumn leftRowIndicatorColumn;
+	DetectionResultColumn rightRowIndicatorColumn;
+	DetectionResultColumn column;
+	DetectionResult detectionResult;
+	std::vector<int> rowHeights;
+	std::vector<std::vector<BarcodeValue>> barcodeMatrix;
+	std::vector<int> values;
+	std::vector<int> erasures;
+	std::vector<int> codewords;
+	std::vector<int> ambiguousIndexesList;
+	std::vector<std::vector<int>> ambiguousIndexValues;
+	std::vector<int> ambiguousIndexCount;
+};
+
+} // anonymous
+
 static int AdjustCodewordStartColumn(const BitMatrix& image, int minColumn, int maxColumn, bool leftToRight, int codewordStartColumn, int imageRow)
 {
 	int correctedStartColumn = codewordStartColumn;
@@ -172,9 +193,9 @@ static Nullable<Codeword> DetectCodeword(const BitMatrix& image, int minColumn,
 	return nullptr;
 }
 
-static DetectionResultColumn GetRowIndicatorColumn(const BitMatrix& image, const BoundingBox& boundingBox, const ResultPoint& startPoint, bool leftToRight, int minCodewordWidth, int maxCodewordWidth)
+static void GetRowIndicatorColumn(const BitMatrix& image, const BoundingBox& boundingBox, const ResultPoint& startPoint, bool leftToRight, int minCodewordWidth, int maxCodewordWidth, DetectionResultColumn& rowIndicatorColumn)
 {
-	DetectionResultColumn rowIndicatorColumn(boundingBox, leftToRight ? DetectionResultColumn::RowIndicator::Left : DetectionResultColumn::RowIndicator::Right);
+	rowIndicatorColumn.reset(boundingBox, leftToRight ? DetectionResultColumn::RowIndicator::Left : DetectionResultColumn::RowIndicator::Right);
 	for (int i = 0; i < 2; i++) {
 		int increment = i == 0 ? 1 : -1;
 		int startColumn = (int)startPoint.x();
@@ -191,18 +212,17 @@ static DetectionResultColumn GetRowIndicatorColumn(const BitMatrix& image, const
 			}
 		}
 	}
-	return rowIndicatorColumn;
 }
 
-static bool GetBarcodeMetadata(Nullable<DetectionResultColumn>& leftRowIndicatorColumn, Nullable<DetectionResultColumn>& rightRowIndicatorColumn, BarcodeMetadata& result)
+static bool GetBarcodeMetadata(DetectionResultColumn* leftRowIndicatorColumn, DetectionResultColumn* rightRowIndicatorColumn, BarcodeMetadata& result)
 {
 	BarcodeMetadata leftBarcodeMetadata;
-	if (leftRowIndicatorColumn == nullptr || !leftRowIndicatorColumn.value().getBarcodeMetadata(leftBarcodeMetadata)) {
-		return rightRowIndicatorColumn != nullptr && rightRowIndicatorColumn.value().getBarcodeMetadata(result);
+	if (leftRowIndicatorColumn == nullptr || !leftRowIndicatorColumn->getBarcodeMetadata(leftBarcodeMetadata)) {
+		return rightRowIndicatorColumn != nullptr && rightRowIndicatorColumn->getBarcodeMetadata(result);
 	}
 
 	BarcodeMetadata rightBarcodeMetadata;
-	if (rightRowIndicatorColumn == nullptr || !rightRowIndicatorColumn.value().getBarcodeMetadata(rightBarcodeMetadata)) {
+	if (rightRowIndicatorColumn == nullptr || !rightRowIndicatorColumn->getBarcodeMetadata(rightBarcodeMetadata)) {
 		result = leftBarcodeMetadata;
 		return true;
 	}
@@ -223,14 +243,13 @@ static auto GetMax(Iter start, Iter end) -> typename std::remove_reference<declt
 	return it != end ? *it : -1;
 }
 
-static bool AdjustBoundingBox(Nullable<DetectionResultColumn>& rowIndicatorColumn, Nullable<BoundingBox>& result)
+static bool AdjustBoundingBox(DetectionResultColumn* rowIndicatorColumn, std::vector<int>& rowHeights, Nullable<BoundingBox>& result)
 {
 	if (rowIndicatorColumn == nullptr) {
 		result = nullptr;
 		return true;
 	}
-	std::vector<int> rowHeights;
-	if (!rowIndicatorColumn.value().getRowHeights(rowHeights)) {
+	if (!rowIndicatorColumn->getRowHeights(rowHeights)) {
 		result = nullptr;
 		return true;
 	}
@@ -242,7 +261,7 @@ static bool AdjustBoundingBox(Nullable<DetectionResultColumn>& rowIndicatorColum
 			break;
 		}
 	}
-	auto& codewords = rowIndicatorColumn.value().allCodewords();
+	auto& codewords = rowIndicatorColumn->allCodewords();
 	for (int row = 0; missingStartRows > 0 && codewords[row] == nullptr; row++) {
 		missingStartRows--;
 	}
@@ -257,20 +276,20 @@ static bool AdjustBoundingBox(Nullable<DetectionResultColumn>& rowIndicatorColum
 		missingEndRows--;
 	}
 	BoundingBox box;
-	if (BoundingBox::AddMissingRows(rowIndicatorColumn.value().boundingBox(), missingStartRows, missingEndRows, rowIndicatorColumn.value().isLeftRowIndicator(), box)) {
+	if (BoundingBox::AddMissingRows(rowIndicatorColumn->boundingBox(), missingStartRows, missingEndRows, rowIndicatorColumn->isLeftRowIndicator(), box)) {
 		result = box;
 		return true;
 	}
 	return false;
 }
 
-static bool Merge(Nullable<DetectionResultColumn>& leftRowIndicatorColumn, Nullable<DetectionResultColumn>& rightRowIndicatorColumn, DetectionResult& result)
+static bool Merge(DetectionResultColumn* leftRowIndicatorColumn, DetectionResultColumn* rightRowIndicatorColumn, std::vector<int>& rowHeights, DetectionResult& result)
 {
 	if (leftRowIndicatorColumn != nullptr || rightRowIndicatorColumn != nullptr) {
 		BarcodeMetadata barcodeMetadata;
 		if (GetBarcodeMetadata(leftRowIndicatorColumn, rightRowIndicatorColumn, barcodeMetadata)) {
 			Nullable<BoundingBox> leftBox, rightBox, mergedBox;
-			if (AdjustBoundingBox(leftRowIndicatorColumn, leftBox) && AdjustBoundingBox(rightRowIndicatorColumn, rightBox) && BoundingBox::Merge(leftBox, rightBox, mergedBox)) {
+			if (AdjustBoundingBox(leftRowIndicatorColumn, rowHeights, leftBox) && AdjustBoundingBox(rightRowIndicatorColumn, rowHeights, rightBox) && BoundingBox::Merge(leftBox, rightBox, mergedBox)) {
 				result.init(barcodeMetadata, mergedBox);
 				return true;
 			}
@@ -321,11 +340,21 @@ static int GetStartColumn(const DetectionResult& detectionResult, int barcodeCol
 	return leftToRight ? detectionResult.getBoundingBox().value().minX() : detectionResult.getBoundingBox().value().maxX();
 }
 
-static std::vector<std::vector<BarcodeValue>> CreateBarcodeMatrix(DetectionResult& detectionResult)
+static void CreateBarcodeMatrix(DetectionResult& detectionResult, std::vector<std::vector<BarcodeValue>>& barcodeMatrix)
 {
-	std::vector<std::vector<BarcodeValue>> barcodeMatrix(detectionResult.barcodeRowCount());
-	for (auto& row : barcodeMatrix) {
-		row.resize(detectionResult.barcodeColumnCount() + 2);
+	// The matrix only ever grows, shrinking it would free the memory of the values it holds.
+	int rowCount = detectionResult.barcodeRowCount();
+	size_t columnCount = detectionResult.barcodeColumnCount() + 2;
+	if ((int)barcodeMatrix.size() < rowCount) {
+		barcodeMatrix.resize(rowCount);
+	}
+	for (int row = 0; row < rowCount; row++) {
+		if (barcodeMatrix[row].size() < columnCount) {
+			barcodeMatrix[row].resize(columnCount);
+		}
+		for (size_t column = 0; column < columnCount; column++) {
+			barcodeMatrix[row][column].clear();
+		}
 	}
 
 	int column = 0;
@@ -335,7 +364,7 @@ static std::vector<std::vector<BarcodeValue>> CreateBarcodeMatrix(DetectionResul
 				if (codeword != nullptr) {
 					int rowNumber = codeword.value().rowNumber();
 					if (rowNumber >= 0) {
-						if (rowNumber >= (int)barcodeMatrix.size()) {
+						if (rowNumber >= rowCount) {
 							// We have more rows than the barcode metadata allows for, ignore them.
 							continue;
 						}
@@ -346,7 +375,6 @@ static std::vector<std::vector<BarcodeValue>> CreateBarcodeMatrix(DetectionResul
 		}
 		column++;
 	}
-	return barcodeMatrix;
 }
 
 static int GetNumberOfECCodeWords(int barcodeECLevel)
@@ -354,9 +382,9 @@ static int GetNumberOfECCodeWords(int barcodeECLevel)
 	return 2 << barcodeECLevel;
 }
 
-static bool AdjustCodewordCount(const DetectionResult& detectionResult, std::vector<std::vector<BarcodeValue>>& barcodeMatrix)
+static bool AdjustCodewordCount(const DetectionResult& detectionResult, std::vector<std::vector<BarcodeValue>>& barcodeMatrix, std::vector<int>& numberOfCodewords)
 {
-	auto numberOfCodewords = barcodeMatrix[0][1].value();
+	barcodeMatrix[0][1].value(numberOfCodewords);
 	int calculatedNumberOfCodewords = detectionResult.barcodeColumnCount() * detectionResult.barcodeRowCount() - GetNumberOfECCodeWords(detectionResult.barcodeECLevel());
 	if (numberOfCodewords.empty()) {
 		if (calculatedNumberOfCodewords < 1 || calculatedNumberOfCodewords > CodewordDecoder::MAX_CODEWORDS_IN_BARCODE) {
@@ -370,166 +398,6 @@ static bool AdjustCodewordCount(const DetectionResult& detectionResult, std::vec
 	}
 	return true;
 }
-// +++++++++++++++++++++++++++++++++++ Error Correction
-
-static const ModulusGF& GetModulusGF()
-{
-	static const ModulusGF field(CodewordDecoder::NUMBER_OF_CODEWORDS, 3);
-	return field;
-}
-
-static bool RunEuclideanAlgorithm(ModulusPoly a, ModulusPoly b, int R, ModulusPoly& sigma, ModulusPoly& omega)
-{
-	const ModulusGF& field = GetModulusGF();
-
-	// Assume a's degree is >= b's
-	if (a.degree() < b.degree()) {
-		swap(a, b);
-	}
-
-	ModulusPoly rLast = a;
-	ModulusPoly r = b;
-	ModulusPoly tLast = field.zero();
-	ModulusPoly t = field.one();
-
-	// Run Euclidean algorithm until r's degree is less than R/2
-	while (r.degree() >= R / 2) {
-		ModulusPoly rLastLast = rLast;
-		ModulusPoly tLastLast = tLast;
-		rLast = r;
-		tLast = t;
-
-		// Divide rLastLast by rLast, with quotient in q and remainder in r
-		if (rLast.isZero()) {
-			// Oops, Euclidean algorithm already terminated?
-			return false;
-		}
-		r = rLastLast;
-		ModulusPoly q = field.zero();
-		int denominatorLeadingTerm = rLast.coefficient(rLast.degree());
-		int dltInverse = field.inverse(denominatorLeadingTerm);
-		while (r.degree() >= rLast.degree() && !r.isZero()) {
-			int degreeDiff = r.degree() - rLast.degree();
-			int scale = field.multiply(r.coefficient(r.degree()), dltInverse);
-			q = q.add(field.buildMonomial(degreeDiff, scale));
-			r = r.subtract(rLast.multiplyByMonomial(degreeDiff, scale));
-		}
-
-		t = q.multiply(tLast).subtract(tLastLast).negative();
-	}
-
-	int sigmaTildeAtZero = t.coefficient(0);
-	if (sigmaTildeAtZero == 0) {
-		return false;
-	}
-
-	int inverse = field.inverse(sigmaTildeAtZero);
-	sigma = t.multiply(inverse);
-	omega = r.multiply(inverse);
-	return true;
-}
-
-static bool FindErrorLocations(const ModulusPoly& errorLocator, std::vector<int>& result)
-{
-	const ModulusGF& field = GetModulusGF();
-	// This is a direct application of Chien's search
-	int numErrors = errorLocator.degree();
-	result.resize(numErrors);
-	int e = 0;
-	for (int i = 1; i < field.size() && e < numErrors; i++) {
-		if (errorLocator.evaluateAt(i) == 0) {
-			result[e] = field.inverse(i);
-			e++;
-		}
-	}
-	return e == numErrors;
-}
-
-static std::vector<int> FindErrorMagnitudes(const ModulusPoly& errorEvaluator, const ModulusPoly& errorLocator, const std::vector<int>& errorLocations)
-{
-	const ModulusGF& field = GetModulusGF();
-	int errorLocatorDegree = errorLocator.degree();
-	std::vector<int> formalDerivativeCoefficients(errorLocatorDegree);
-	for (int i = 1; i <= errorLocatorDegree; i++) {
-		formalDerivativeCoefficients[errorLocatorDegree - i] = field.multiply(i, errorLocator.coefficient(i));
-	}
-
-	ModulusPoly formalDerivative(field, formalDerivativeCoefficients);
-	// This is directly applying Forney's Formula
-	std::vector<int> result(errorLocations.size());
-	for (size_t i = 0; i < result.size(); i++) {
-		int xiInverse = field.inverse(errorLocations[i]);
-		int numerator = field.subtract(0, errorEvaluator.evaluateAt(xiInverse));
-		int denominator = field.inverse(formalDerivative.evaluateAt(xiInverse));
-		result[i] = field.multiply(numerator, denominator);
-	}
-	return result;
-}
-
-/**
-* @param received received codewords
-* @param numECCodewords number of those codewords used for EC
-* @param erasures location of erasures
-* @return number of errors
-* @throws ChecksumException if errors cannot be corrected, maybe because of too many errors
-*/
-static bool DecodeErrorCorrection(std::vector<int>& received, int numECCodewords, const std::vector<int>& erasures, int& nbErrors)
-{
-	const ModulusGF& field = GetModulusGF();
-	ModulusPoly poly(field, received);
-	std::vector<int> S(numECCodewords);
-	bool error = false;
-	for (int i = numECCodewords; i > 0; i--) {
-		int eval = poly.evaluateAt(field.exp(i));
-		S[numECCodewords - i] = eval;
-		if (eval != 0) {
-			error = true;
-		}
-	}
-
-	if (!error) {
-		nbErrors = 0;
-		return true;
-	}
-
-	ModulusPoly knownErrors = field.one();
-	for (int erasure : erasures) {
-		int b = field.exp(static_cast<int>(received.size()) - 1 - erasure);
-		// Add (1 - bx) term:
-		ModulusPoly term(field, { field.subtract(0, b), 1 });
-		knownErrors = knownErrors.multiply(term);
-	}
-
-	ModulusPoly syndrome(field, S);
-	//syndrome = syndrome.multiply(knownErrors);
-
-	ModulusPoly sigma, omega;
-	if (!RunEuclideanAlgorithm(field.buildMonomial(numECCodewords, 1), syndrome, numECCodewords, sigma, omega)) {
-		return false;
-	}
-
-	//sigma = sigma.multiply(knownErrors);
-
-	std::vector<int> errorLocations;
-	if (!FindErrorLocations(sigma, errorLocations)) {
-		return false;
-	}
-
-	std::vector<int> errorMagnitudes = FindErrorMagnitudes(omega, sigma, errorLocations);
-
-	int receivedSize = static_cast<int>(received.size());
-	for (size_t i = 0; i < errorLocations.size(); i++) {
-		int position = receivedSize - 1 - field.log(errorLocations[i]);
-		if (position < 0) {
-			return false;
-		}
-		received[position] = field.subtract(received[position], errorMagnitudes[i]);
-	}
-	nbErrors = static_cast<int>(errorLocations.size());
-	return true;
-}
-
-// --------------------------------------- Error Correction
 
 /**
 * <p>Given data and error-correction codewords received, possibly corrupted by errors, attempts to
@@ -544,11 +412,11 @@ static DecodeStatus CorrectErrors(std::vector<int>& codewords, const std::vector
 {
 	if ((int)erasures.size() > numECCodewords / 2 + MAX_ERRORS ||
 		numECCodewords < 0 ||
-		numECCodewords > MAX_EC_CODEWORDS) {
+		numECCodewords > ErrorCorrection::MAX_EC_CODEWORDS) {
 		// Too many errors or EC Codewords is corrupted
 		return DecodeStatus::ChecksumError;
 	}
-	return DecodeErrorCorrection(codewords, numECCodewords, erasures, errorCount) ? DecodeStatus::NoError : DecodeStatus::ChecksumError;
+	return ErrorCorrection::Decode(codewords, numECCodewords, errorCount);
 }
 
 /**
@@ -618,9 +486,9 @@ static DecodeStatus DecodeCodewords(std::vector<int>& codewords, int ecLevel, co
 * @param ambiguousIndexValues two dimensional array that contains the ambiguous values. The first dimension must
 * be the same length as the ambiguousIndexes array
 */
-static DecodeStatus CreateDecoderResultFromAmbiguousValues(int ecLevel, std::vector<int>& codewords, const std::vector<int>& erasureArray, const std::vector<int>& ambiguousIndexes, const std::vector<std::vector<int>>& ambiguousIndexValues, DecoderResult& result)
+static DecodeStatus CreateDecoderResultFromAmbiguousValues(int ecLevel, std::vector<int>& codewords, const std::vector<int>& erasureArray, const std::vector<int>& ambiguousIndexes, const std::vector<std::vector<int>>& ambiguousIndexValues, std::vector<int>& ambiguousIndexCount, DecoderResult& result)
 {
-	std::vector<int> ambiguousIndexCount(ambiguousIndexes.size(), 0);
+	ambiguousIndexCount.assign(ambiguousIndexes.size(), 0);
 
 	int tries = 100;
 	while (tries-- > 0) {
@@ -652,19 +520,25 @@ static DecodeStatus CreateDecoderResultFromAmbiguousValues(int ecLevel, std::vec
 }
 
 
-static DecodeStatus CreateDecoderResult(DetectionResult& detectionResult, DecoderResult& result)
+static DecodeStatus CreateDecoderResult(DetectionResult& detectionResult, Scratch& scratch, DecoderResult& result)
 {
-	auto barcodeMatrix = CreateBarcodeMatrix(detectionResult);
-	if (!AdjustCodewordCount(detectionResult, barcodeMatrix)) {
+	auto& barcodeMatrix = scratch.barcodeMatrix;
+	auto& values = scratch.values;
+	CreateBarcodeMatrix(detectionResult, barcodeMatrix);
+	if (!AdjustCodewordCount(detectionResult, barcodeMatrix, values)) {
 		return DecodeStatus::NotFound;
 	}
-	std::vector<int> erasures;
-	std::vector<int> codewords(detectionResult.barcodeRowCount() * detectionResult.barcodeColumnCount(), 0);
-	std::vector<std::vector<int>> ambiguousIndexValues;
-	std::vector<int> ambiguousIndexesList;
+	auto& erasures = scratch.erasures;
+	auto& codewords = scratch.codewords;
+	// like the barcode matrix, the list of ambiguous values only grows, its first ambiguousIndexesList.size() entries are used
+	auto& ambiguousIndexValues = scratch.ambiguousIndexValues;
+	auto& ambiguousIndexesList = scratch.ambiguousIndexesList;
+	erasures.clear();
+	codewords.assign(detectionResult.barcodeRowCount() * detectionResult.barcodeColumnCount(), 0);
+	ambiguousIndexesList.clear();
 	for (int row = 0; row < detectionResult.barcodeRowCount(); row++) {
 		for (int column = 0; column < detectionResult.barcodeColumnCount(); column++) {
-			auto values = barcodeMatrix[row][column + 1].value();
+			barcodeMatrix[row][column + 1].value(values);
 			int codewordIndex = row * detectionResult.barcodeColumnCount() + column;
 			if (values.empty()) {
 				erasures.push_back(codewordIndex);
@@ -673,12 +547,15 @@ static DecodeStatus CreateDecoderResult(DetectionResult& detectionResult, Decode
 				codewords[codewordIndex] = values[0];
 			}
 			else {
+				if (ambiguousIndexValues.size() == ambiguousIndexesList.size()) {
+					ambiguousIndexValues.emplace_back();
+				}
+				ambiguousIndexValues[ambiguousIndexesList.size()] = values;
 				ambiguousIndexesList.push_back(codewordIndex);
-				ambiguousIndexValues.push_back(values);
 			}
 		}
 	}
-	return CreateDecoderResultFromAmbiguousValues(detectionResult.barcodeECLevel(), codewords, erasures, ambiguousIndexesList, ambiguousIndexValues, result);
+	return CreateDecoderResultFromAmbiguousValues(detectionResult.barcodeECLevel(), codewords, erasures, ambiguousIndexesList, ambiguousIndexValues, scratch.ambiguousIndexCount, result);
 }
 
 
@@ -696,16 +573,20 @@ ScanningDecoder::Decode(const BitMatrix& image, const Nullable<ResultPoint>& ima
 		return DecodeStatus::NotFound;
 	}
 	
-	Nullable<DetectionResultColumn> leftRowIndicatorColumn, rightRowIndicatorColumn;
-	DetectionResult detectionResult;
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+	DetectionResultColumn* leftRowIndicatorColumn = nullptr;
+	DetectionResultColumn* rightRowIndicatorColumn = nullptr;
+	auto& detectionResult = scratch.detectionResult;
 	for (int i = 0; i < 2; i++) {
 		if (imageTopLeft != nullptr) {
-			leftRowIndicatorColumn = GetRowIndicatorColumn(image, boundingBox, imageTopLeft, true, minCodewordWidth, maxCodewordWidth);
+			leftRowIndicatorColumn = &scratch.leftRowIndicatorColumn;
+			GetRowIndicatorColumn(image, boundingBox, imageTopLeft, true, minCodewordWidth, maxCodewordWidth, *leftRowIndicatorColumn);
 		}
 		if (imageTopRight != nullptr) {
-			rightRowIndicatorColumn = GetRowIndicatorColumn(image, boundingBox, imageTopRight, false, minCodewordWidth, maxCodewordWidth);
+			rightRowIndicatorColumn = &scratch.rightRowIndicatorColumn;
+			GetRowIndicatorColumn(image, boundingBox, imageTopRight, false, minCodewordWidth, maxCodewordWidth, *rightRowIndicatorColumn);
 		}
-		if (!Merge(leftRowIndicatorColumn, rightRowIndicatorColumn, detectionResult)) {
+		if (!Merge(leftRowIndicatorColumn, rightRowIndicatorColumn, scratch.rowHeights, detectionResult)) {
 			return DecodeStatus::NotFound;
 		}
 		if (i == 0 && detectionResult.getBoundingBox() != nullptr && (detectionResult.getBoundingBox().value().minY() < boundingBox.minY() || detectionResult.getBoundingBox().value().maxY() > boundingBox.maxY())) {
@@ -718,8 +599,12 @@ ScanningDecoder::Decode(const BitMatrix& image, const Nullable<ResultPoint>& ima
 	}
 
 	int maxBarcodeColumn = detectionResult.barcodeColumnCount() + 1;
-	detectionResult.setColumn(0, leftRowIndicatorColumn);
-	detectionResult.setColumn(maxBarcodeColumn, rightRowIndicatorColumn);
+	if (leftRowIndicatorColumn != nullptr) {
+		detectionResult.setColumn(0, *leftRowIndicatorColumn);
+	}
+	if (rightRowIndicatorColumn != nullptr) {
+		detectionResult.setColumn(maxBarcodeColumn, *rightRowIndicatorColumn);
+	}
 
 	bool leftToRight = leftRowIndicatorColumn != nullptr;
 	for (int barcodeColumnCount = 1; barcodeColumnCount <= maxBarcodeColumn; barcodeColumnCount++) {
@@ -729,7 +614,8 @@ ScanningDecoder::Decode(const BitMatrix& image, const Nullable<ResultPoint>& ima
 			continue;
 		}
 		DetectionResultColumn::RowIndicator rowIndicator = barcodeColumn == 0 ? DetectionResultColumn::RowIndicator::Left : (barcodeColumn == maxBarcodeColumn ? DetectionResultColumn::RowIndicator::Right : DetectionResultColumn::RowIndicator::None);
-		detectionResult.setColumn(barcodeColumn, DetectionResultColumn(boundingBox, rowIndicator));
+		scratch.column.reset(boundingBox, rowIndicator);
+		detectionResult.setColumn(barcodeColumn, scratch.column);
 		int startColumn = -1;
 		int previousStartColumn = startColumn;
 		// TODO start at a row for which we know the start position, then detect upwards and downwards from there.
@@ -750,7 +636,7 @@ ScanningDecoder::Decode(const BitMatrix& image, const Nullable<ResultPoint>& ima
 			}
 		}
 	}
-	return CreateDecoderResult(detectionResult, result);
+	return CreateDecoderResult(detectionResult, scratch, result);
 }
 
 } // Pdf417
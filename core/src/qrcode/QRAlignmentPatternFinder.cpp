@@ -19,6 +19,7 @@
 #include "qrcode/QRAlignmentPattern.h"
 #include "BitMatrix.h"
 #include "DecodeStatus.h"
+#include "DecodeContext.h"
 
 #include <array>
 #include <cmath>
@@ -28,6 +29,16 @@
 namespace ZXing {
 namespace QRCode {
 
+namespace {
+
+// The temporaries of Find(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::vector<AlignmentPattern> possibleCenters;
+};
+
+} // anonymous
+
 
 typedef std::array<int, 3> StateCount;
 
@@ -155,7 +166,8 @@ AlignmentPatternFinder::Find(const BitMatrix& image, int startX, int startY, int
 {
 	int maxJ = startX + width;
 	int middleI = startY + (height / 2);
-	std::vector<AlignmentPattern> possibleCenters;
+	auto& possibleCenters = DecodeContext::ThreadLocal().scratch<Scratch>().possibleCenters;
+	possibleCenters.clear();
 	possibleCenters.reserve(5);
 
 	// We are looking for black/white/black modules in 1:1:1 ratio;
@@ -20,11 +20,22 @@
 #include "qrcode/QRFormatInformation.h"
 #include "BitMatrix.h"
 #include "ByteArray.h"
+#include "DecodeContext.h"
 #include "DecodeStatus.h"
 
 namespace ZXing {
 namespace QRCode {
 
+namespace {
+
+// The temporaries of ReadCodewords(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	BitMatrix functionPattern;
+};
+
+} // anonymous
+
 static inline int copyBit(const BitMatrix& bitMatrix, int i, int j, int versionBits, bool mirrored)
 {
 	bool bit = mirrored ? bitMatrix.get(j, i) : bitMatrix.get(i, j);
@@ -147,7 +158,7 @@ BitMatrixParser::ReadCodewords(const BitMatrix& bitMatrix, const Version& versio
 		return DecodeStatus::FormatError;
 	}
 
-	BitMatrix functionPattern;
+	auto& functionPattern = DecodeContext::ThreadLocal().scratch<Scratch>().functionPattern;
 	version.buildFunctionPattern(functionPattern);
 
 	bool readingUp = true;
@@ -26,7 +26,7 @@ namespace ZXing {
 namespace QRCode {
 
 DecodeStatus
-DataBlock::GetDataBlocks(const ByteArray& rawCodewords, const Version& version, ErrorCorrectionLevel ecLevel, std::vector<DataBlock>& result)
+DataBlock::GetDataBlocks(const ByteArray& rawCodewords, const Version& version, ErrorCorrectionLevel ecLevel, std::vector<DataBlock>& result, int& numBlocks)
 {
 	if (rawCodewords.length() != version.totalCodewords()) {
 		return DecodeStatus::FormatError;
@@ -39,7 +39,9 @@ DataBlock::GetDataBlocks(const ByteArray& rawCodewords, const Version& version,
 	// First count the total number of data blocks
 	int totalBlocks = ecBlocks.numBlocks();
 
-	result.resize(totalBlocks);;
+	if (static_cast<int>(result.size()) < totalBlocks) {
+		result.resize(totalBlocks);
+	}
 	// Now establish DataBlocks of the appropriate size and number of data codewords
 	int numResultBlocks = 0;
 	for (auto& ecBlock : ecBlocks.blockArray()) {
@@ -53,7 +55,7 @@ DataBlock::GetDataBlocks(const ByteArray& rawCodewords, const Version& version,
 	// All blocks have the same amount of data, except that the last n
 	// (where n may be 0) have 1 more byte. Figure out where these start.
 	int shorterBlocksTotalCodewords = result[0]._codewords.length();
-	int longerBlocksStartAt = static_cast<int>(result.size()) - 1;
+	int longerBlocksStartAt = totalBlocks - 1;
 	while (longerBlocksStartAt >= 0) {
 		int numCodewords = result[longerBlocksStartAt]._codewords.length();
 		if (numCodewords == shorterBlocksTotalCodewords) {
@@ -84,6 +86,7 @@ DataBlock::GetDataBlocks(const ByteArray& rawCodewords, const Version& version,
 			result[j]._codewords[iOffset] = rawCodewords[rawCodewordsOffset++];
 		}
 	}
+	numBlocks = numResultBlocks;
 	return DecodeStatus::NoError;
 }
 
@@ -59,10 +59,12 @@ public:
 	* @param rawCodewords bytes as read directly from the QR Code
 	* @param version version of the QR Code
 	* @param ecLevel error-correction level of the QR Code
-	* @return DataBlocks containing original bytes, "de-interleaved" from representation in the
-	*         QR Code
+	* @param result DataBlocks containing original bytes, "de-interleaved" from representation in the
+	*         QR Code, in its first numBlocks entries. It is never shrunk, so that the memory of the
+	*         surplus blocks gets reused by later calls.
+	* @param numBlocks the number of DataBlocks used by this version and error-correction level
 	*/
-	static DecodeStatus GetDataBlocks(const ByteArray& rawCodewords, const Version& version, ErrorCorrectionLevel ecLevel, std::vector<DataBlock>& result);
+	static DecodeStatus GetDataBlocks(const ByteArray& rawCodewords, const Version& version, ErrorCorrectionLevel ecLevel, std::vector<DataBlock>& result, int& numBlocks);
 
 private:
 	int _numDataCodewords = 0;
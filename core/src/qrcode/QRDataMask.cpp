@@ -17,8 +17,11 @@
 
 #include "qrcode/QRDataMask.h"
 #include "BitMatrix.h"
-#include "ZXContainerAlgorithms.h"
+#include "DecodeContext.h"
+#include "ZXConstexprArray.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <stdexcept>
 
 namespace ZXing {
@@ -29,7 +32,7 @@ namespace {
 /**
 * 000: mask bits for which (x + y) mod 2 == 0
 */
-bool DataMask000(int i, int j)
+constexpr bool DataMask000(int i, int j)
 {
 	return ((i + j) & 0x01) == 0;
 }
@@ -37,7 +40,7 @@ bool DataMask000(int i, int j)
 /**
 * 001: mask bits for which x mod 2 == 0
 */
-bool DataMask001(int i, int j)
+constexpr bool DataMask001(int i, int j)
 {
 	return (i & 0x01) == 0;
 }
@@ -45,7 +48,7 @@ bool DataMask001(int i, int j)
 /**
 * 010: mask bits for which y mod 3 == 0
 */
-bool DataMask010(int i, int j)
+constexpr bool DataMask010(int i, int j)
 {
 	return j % 3 == 0;
 }
@@ -53,7 +56,7 @@ bool DataMask010(int i, int j)
 /**
 * 011: mask bits for which (x + y) mod 3 == 0
 */
-bool DataMask011(int i, int j)
+constexpr bool DataMask011(int i, int j)
 {
 	return (i + j) % 3 == 0;
 }
@@ -61,7 +64,7 @@ bool DataMask011(int i, int j)
 /**
 * 100: mask bits for which (x/2 + y/3) mod 2 == 0
 */
-bool DataMask100(int i, int j)
+constexpr bool DataMask100(int i, int j)
 {
 	return (((i / 2) + (j / 3)) & 0x01) == 0;
 }
@@ -70,7 +73,7 @@ bool DataMask100(int i, int j)
 * 101: mask bits for which xy mod 2 + xy mod 3 == 0
 * equivalently, such that xy mod 6 == 0
 */
-bool DataMask101(int i, int j)
+constexpr bool DataMask101(int i, int j)
 {
 	return (i * j) % 6 == 0;
 }
@@ -79,7 +82,7 @@ bool DataMask101(int i, int j)
 * 110: mask bits for which (xy mod 2 + xy mod 3) mod 2 == 0
 * equivalently, such that xy mod 6 < 3
 */
-bool DataMask110(int i, int j)
+constexpr bool DataMask110(int i, int j)
 {
 	return ((i * j) % 6) < 3;
 }
@@ -88,47 +91,78 @@ bool DataMask110(int i, int j)
 * 111: mask bits for which ((x+y)mod 2 + xy mod 3) mod 2 == 0
 * equivalently, such that (x + y + xy mod 3) mod 2 == 0
 */
-bool DataMask111(int i, int j)
+constexpr bool DataMask111(int i, int j)
 {
 	return ((i + j + ((i * j) % 3)) & 0x01) == 0;
 }
 
-typedef bool(*IsMaskedFunc)(int, int);
-
 /**
 * See ISO 18004:2006 6.8.1
 */
-static const IsMaskedFunc DATA_MASKS[] = {
-	DataMask000,
-	DataMask001,
-	DataMask010,
-	DataMask011,
-	DataMask100,
-	DataMask101,
-	DataMask110,
-	DataMask111,
+constexpr bool IsMasked(int reference, int i, int j)
+{
+	return reference == 0 ? DataMask000(i, j) :
+		   reference == 1 ? DataMask001(i, j) :
+		   reference == 2 ? DataMask010(i, j) :
+		   reference == 3 ? DataMask011(i, j) :
+		   reference == 4 ? DataMask100(i, j) :
+		   reference == 5 ? DataMask101(i, j) :
+		   reference == 6 ? DataMask110(i, j) :
+		   DataMask111(i, j);
+}
+
+static const int NUM_DATA_MASKS = 8;
+
+// All patterns repeat every 12 rows and every 12 columns. 96 columns, i.e. 3 words of a BitMatrix row,
+// are a multiple of that, so a row of any width is made of the same 3 words over and over again.
+static const int PATTERN_ROWS = 12;
+static const int PATTERN_WORDS = 3;
+
+constexpr uint32_t PatternBits(int reference, int i, int j, int bit)
+{
+	return bit == 32 ? 0 : (IsMasked(reference, i, j + bit) ? 1u << bit : 0) | PatternBits(reference, i, j, bit + 1);
+}
+
+// Computes word k of the flattened [reference][row][word] table of packed mask patterns
+struct PatternWord
+{
+	constexpr uint32_t operator()(int k) const {
+		return PatternBits(k / (PATTERN_ROWS * PATTERN_WORDS), k / PATTERN_WORDS % PATTERN_ROWS, k % PATTERN_WORDS * 32, 0);
+	}
 };
 
+static constexpr std::array<uint32_t, NUM_DATA_MASKS * PATTERN_ROWS * PATTERN_WORDS> MASK_PATTERNS =
+	GenerateArray<uint32_t, NUM_DATA_MASKS * PATTERN_ROWS * PATTERN_WORDS>(PatternWord());
+
 } // anonymous
 
-DataMask::DataMask(int reference)
+DataMask::DataMask(int reference) : _reference(reference)
 {
-	if (reference < 0 || reference >= Length(DATA_MASKS)) {
+	if (reference < 0 || reference >= NUM_DATA_MASKS) {
 		throw std::invalid_argument("Invalid data mask");
 	}
-	_isMasked = DATA_MASKS[reference];
 }
 
 void
 DataMask::unmaskBitMatrix(BitMatrix& bits, int dimension) const
 {
-	for (int i = 0; i < dimension; i++) {
-		for (int j = 0; j < dimension; j++) {
-			if (_isMasked(i, j)) {
-				bits.flip(j, i);
-			}
+	// Expand the pattern to mask planes for the rows of the given dimension, then unmask one word at a time.
+	DecodeContext& context = DecodeContext::ThreadLocal();
+	DecodeContext::Scope scope(context);
+	int rowSize = bits.rowSize();
+	int width = std::min(dimension, bits.width());
+	uint32_t* planes = context.allocate<uint32_t>(PATTERN_ROWS * rowSize);
+	const uint32_t* pattern = MASK_PATTERNS.data() + _reference * PATTERN_ROWS * PATTERN_WORDS;
+	for (int i = 0; i < PATTERN_ROWS; i++) {
+		for (int w = 0; w < rowSize; w++) {
+			int columns = std::min(std::max(width - w * 32, 0), 32);
+			uint32_t valid = columns == 32 ? ~0u : (1u << columns) - 1;
+			planes[i * rowSize + w] = pattern[i * PATTERN_WORDS + w % PATTERN_WORDS] & valid;
 		}
 	}
+	for (int i = 0; i < dimension; i++) {
+		bits.flipRow(i, planes + (i % PATTERN_ROWS) * rowSize);
+	}
 }
 
 } // QRCode
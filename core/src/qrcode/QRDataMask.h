@@ -45,7 +45,7 @@ public:
 
 	/**
 	* <p>Implementations of this method reverse the data masking process applied to a QR Code and
-	* make its bits ready to read.</p>
+	* make its bits ready to read. The pattern is applied to whole 32 bit words of the rows.</p>
 	*
 	* @param bits representation of QR Code bits
 	* @param dimension dimension of QR Code, represented by bits, being unmasked
@@ -53,7 +53,7 @@ public:
 	void unmaskBitMatrix(BitMatrix& bits, int dimension) const;
 
 private:
-	bool(*_isMasked)(int, int);
+	int _reference;
 };
 
 } // QRCode
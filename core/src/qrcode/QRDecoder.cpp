@@ -34,29 +34,62 @@
 #include "DecodeHints.h"
 #include "DecodeStatus.h"
 #include "ZXContainerAlgorithms.h"
+#include "BitHacks.h"
+#include "DecodeContext.h"
 
+#include <algorithm>
 #include <list>
 #include <type_traits>
 
 namespace ZXing {
 namespace QRCode {
 
+namespace {
+
+// The temporaries of Decode(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	BitMatrix bits;
+	ByteArray codewords, uncertainCodewords, resultBytes;
+	std::vector<DataBlock> dataBlocks, uncertainBlocks;
+	std::vector<int> codewordsInts, uncertainty, erasures;
+	std::wstring text;
+	std::string digits;     // the characters of a numeric or alphanumeric segment
+	ByteArray doubleBytes;  // the characters of a Hanzi or Kanji segment
+	ByteArray segmentBytes; // the contents of all byte segments, one after the other
+	std::vector<int> segmentLengths;
+};
+
+} // anonymous
+
 /**
 * <p>Given data and error-correction codewords received, possibly corrupted by errors, attempts to
 * correct the errors in-place using Reed-Solomon error correction.</p>
 *
 * @param codewordBytes data and error correction codewords
 * @param numDataCodewords number of codewords that are data bytes
+* @param uncertainBytes per codeword the bits that were sampled unreliably, or nullptr to correct errors only
 * @throws ChecksumException if error correction fails
 */
 static DecodeStatus
-CorrectErrors(ByteArray& codewordBytes, int numDataCodewords)
+CorrectErrors(ByteArray& codewordBytes, int numDataCodewords, const ByteArray* uncertainBytes, Scratch& scratch)
 {
 	// First read into an array of ints
-	std::vector<int> codewordsInts(codewordBytes.begin(), codewordBytes.end());
+	auto& codewordsInts = scratch.codewordsInts;
+	codewordsInts.assign(codewordBytes.begin(), codewordBytes.end());
 
 	int numECCodewords = codewordBytes.length() - numDataCodewords;
-	auto status = ReedSolomonDecoder(GenericGF::QRCodeField256()).decode(codewordsInts, numECCodewords);
+	ReedSolomonDecoder rsDecoder(GenericGF::QRCodeField256());
+	DecodeStatus status;
+	if (uncertainBytes == nullptr) {
+		status = rsDecoder.decode(codewordsInts, numECCodewords);
+	}
+	else {
+		auto& uncertainty = scratch.uncertainty;
+		uncertainty.resize(uncertainBytes->length());
+		std::transform(uncertainBytes->begin(), uncertainBytes->end(), uncertainty.begin(), [](uint8_t b) { return BitHacks::CountBitsSet(b); });
+		status = rsDecoder.decodeWithUncertainty(codewordsInts, numECCodewords, uncertainty, scratch.erasures);
+	}
 	if (StatusIsOK(status))
 	{
 		// Copy back into array of bytes -- only need to worry about the bytes that were data
@@ -75,7 +108,7 @@ CorrectErrors(ByteArray& codewordBytes, int numDataCodewords)
 * See specification GBT 18284-2000
 */
 static DecodeStatus
-DecodeHanziSegment(BitSource& bits, int count, std::wstring& result)
+DecodeHanziSegment(BitSource& bits, int count, std::wstring& result, ByteArray& buffer)
 {
 	// Don't crash trying to read more bits than we have available.
 	if (count * 13 > bits.available()) {
@@ -84,7 +117,7 @@ DecodeHanziSegment(BitSource& bits, int count, std::wstring& result)
 
 	// Each character will require 2 bytes. Read the characters as 2-byte pairs
 	// and decode as GB2312 afterwards
-	ByteArray buffer;
+	buffer.clear();
 	buffer.reserve(2 * count);
 	while (count > 0) {
 		// Each 13 bits encodes a 2-byte character
@@ -108,7 +141,7 @@ DecodeHanziSegment(BitSource& bits, int count, std::wstring& result)
 }
 
 static DecodeStatus
-DecodeKanjiSegment(BitSource& bits, int count, std::wstring& result)
+DecodeKanjiSegment(BitSource& bits, int count, std::wstring& result, ByteArray& buffer)
 {
 	// Don't crash trying to read more bits than we have available.
 	if (count * 13 > bits.available()) {
@@ -117,7 +150,7 @@ DecodeKanjiSegment(BitSource& bits, int count, std::wstring& result)
 
 	// Each character will require 2 bytes. Read the characters as 2-byte pairs
 	// and decode as Shift_JIS afterwards
-	ByteArray buffer;
+	buffer.clear();
 	buffer.reserve(2 * count);
 	while (count > 0) {
 		// Each 13 bits encodes a 2-byte character
@@ -141,14 +174,17 @@ DecodeKanjiSegment(BitSource& bits, int count, std::wstring& result)
 }
 
 static DecodeStatus
-DecodeByteSegment(BitSource& bits, int count, CharacterSet currentCharset, const std::string& hintedCharset, std::wstring& result, std::list<ByteArray>& byteSegments)
+DecodeByteSegment(BitSource& bits, int count, CharacterSet currentCharset, const std::string& hintedCharset, std::wstring& result, ByteArray& segmentBytes, std::vector<int>& segmentLengths)
 {
 	// Don't crash trying to read more bits than we have available.
 	if (8 * count > bits.available()) {
 		return DecodeStatus::FormatError;
 	}
 
-	ByteArray readBytes(count);
+	// The segment is appended to the previous ones, the byte segments of the result are split off at the end
+	size_t offset = segmentBytes.size();
+	segmentBytes.resize(offset + count);
+	auto readBytes = segmentBytes.data() + offset;
 	for (int i = 0; i < count; i++) {
 		readBytes[i] = static_cast<uint8_t>(bits.readBits(8));
 	}
@@ -164,11 +200,11 @@ DecodeByteSegment(BitSource& bits, int count, CharacterSet currentCharset, const
 		}
 		if (currentCharset == CharacterSet::Unknown)
 		{
-			currentCharset = TextDecoder::GuessEncoding(readBytes.data(), readBytes.length());
+			currentCharset = TextDecoder::GuessEncoding(readBytes, count);
 		}
 	}
-	TextDecoder::Append(result, readBytes.data(), readBytes.length(), currentCharset);
-	byteSegments.push_back(readBytes);
+	TextDecoder::Append(result, readBytes, count, currentCharset);
+	segmentLengths.push_back(count);
 	return DecodeStatus::NoError;
 }
 
@@ -192,10 +228,10 @@ ToAlphaNumericChar(int value)
 }
 
 static DecodeStatus
-DecodeAlphanumericSegment(BitSource& bits, int count, bool fc1InEffect, std::wstring& result)
+DecodeAlphanumericSegment(BitSource& bits, int count, bool fc1InEffect, std::wstring& result, std::string& buffer)
 {
 	// Read two characters at a time
-	std::string buffer;
+	buffer.clear();
 	while (count > 1) {
 		if (bits.available() < 11) {
 			return DecodeStatus::FormatError;
@@ -233,10 +269,10 @@ DecodeAlphanumericSegment(BitSource& bits, int count, bool fc1InEffect, std::wst
 }
 
 static DecodeStatus
-DecodeNumericSegment(BitSource& bits, int count, std::wstring& result)
+DecodeNumericSegment(BitSource& bits, int count, std::wstring& result, std::string& buffer)
 {
 	// Read three digits at a time
-	std::string buffer;
+	buffer.clear();
 	while (count >= 3) {
 		// Each 10 bits encodes three digits
 		if (bits.available() < 10) {
@@ -310,11 +346,13 @@ ParseECIValue(BitSource& bits, int &outValue)
 * <p>See ISO 18004:2006, 6.4.3 - 6.4.7</p>
 */
 static DecodeStatus
-DecodeBitStream(const ByteArray& bytes, const Version& version, ErrorCorrectionLevel ecLevel, const std::string& hintedCharset, DecoderResult& decodeResult)
+DecodeBitStream(const ByteArray& bytes, const Version& version, ErrorCorrectionLevel ecLevel, const std::string& hintedCharset, Scratch& scratch, DecoderResult& decodeResult)
 {
 	BitSource bits(bytes);
-	std::wstring result;
-	std::list<ByteArray> byteSegments;
+	auto& result = scratch.text;
+	result.clear();
+	scratch.segmentBytes.clear();
+	scratch.segmentLengths.clear();
 	int symbolSequence = -1;
 	int parityData = -1;
 	static const int GB2312_SUBSET = 1;
@@ -368,7 +406,7 @@ DecodeBitStream(const ByteArray& bytes, const Version& version, ErrorCorrectionL
 				int subset = bits.readBits(4);
 				int countHanzi = bits.readBits(CodecMode::CharacterCountBits(mode, version));
 				if (subset == GB2312_SUBSET) {
-					auto status = DecodeHanziSegment(bits, countHanzi, result);
+					auto status = DecodeHanziSegment(bits, countHanzi, result, scratch.doubleBytes);
 					if (StatusIsError(status)) {
 						return status;
 					}
@@ -382,16 +420,16 @@ DecodeBitStream(const ByteArray& bytes, const Version& version, ErrorCorrectionL
 				DecodeStatus status;
 				switch (mode) {
 				case CodecMode::NUMERIC:
-					status = DecodeNumericSegment(bits, count, result);
+					status = DecodeNumericSegment(bits, count, result, scratch.digits);
 					break;
 				case CodecMode::ALPHANUMERIC:
-					status = DecodeAlphanumericSegment(bits, count, fc1InEffect, result);
+					status = DecodeAlphanumericSegment(bits, count, fc1InEffect, result, scratch.digits);
 					break;
 				case CodecMode::BYTE:
-					status = DecodeByteSegment(bits, count, currentCharset, hintedCharset, result, byteSegments);
+					status = DecodeByteSegment(bits, count, currentCharset, hintedCharset, result, scratch.segmentBytes, scratch.segmentLengths);
 					break;
 				case CodecMode::KANJI:
-					status = DecodeKanjiSegment(bits, count, result);
+					status = DecodeKanjiSegment(bits, count, result, scratch.doubleBytes);
 					break;
 				default:
 					status = DecodeStatus::FormatError;
@@ -410,9 +448,17 @@ DecodeBitStream(const ByteArray& bytes, const Version& version, ErrorCorrectionL
 		return DecodeStatus::FormatError;
 	}
 	
+	std::list<ByteArray> byteSegments;
+	auto segment = scratch.segmentBytes.begin();
+	for (int length : scratch.segmentLengths) {
+		byteSegments.emplace_back();
+		byteSegments.back().assign(segment, segment + length);
+		segment += length;
+	}
+
 	decodeResult.setRawBytes(bytes);
 	decodeResult.setText(result);
-	decodeResult.setByteSegments(byteSegments);
+	decodeResult.setByteSegments(std::move(byteSegments));
 	decodeResult.setEcLevel(ToString(ecLevel));
 	decodeResult.setStructuredAppendSequenceNumber(symbolSequence);
 	decodeResult.setStructuredAppendParity(parityData);
@@ -421,37 +467,55 @@ DecodeBitStream(const ByteArray& bytes, const Version& version, ErrorCorrectionL
 
 
 static DecodeStatus
-DoDecode(const BitMatrix& bits, const Version& version, const FormatInformation& formatInfo, const std::string& hintedCharset, DecoderResult& result)
+DoDecode(const BitMatrix& bits, const UncertainModules& uncertainModules, const Version& version, const FormatInformation& formatInfo, const std::string& hintedCharset, Scratch& scratch, DecoderResult& result)
 {
 	auto ecLevel = formatInfo.errorCorrectionLevel();
 
 	// Read codewords
-	ByteArray codewords;
+	auto& codewords = scratch.codewords;
 	DecodeStatus status = BitMatrixParser::ReadCodewords(bits, version, codewords);
 	if (StatusIsError(status)) {
 		return status;
 	}
 	// Separate into data blocks
-	std::vector<DataBlock> dataBlocks;
-	status = DataBlock::GetDataBlocks(codewords, version, ecLevel, dataBlocks);
+	auto& dataBlocks = scratch.dataBlocks;
+	int numBlocks = 0;
+	status = DataBlock::GetDataBlocks(codewords, version, ecLevel, dataBlocks, numBlocks);
 	if (StatusIsError(status)) {
 		return status;
 	}
 	// Count total number of data bytes
 	int totalBytes = 0;
-	for (const auto& dataBlock : dataBlocks) {
-		totalBytes += dataBlock.numDataCodewords();
+	for (int i = 0; i < numBlocks; ++i) {
+		totalBytes += dataBlocks[i].numDataCodewords();
 	}
-	ByteArray resultBytes(totalBytes);
+	auto& resultBytes = scratch.resultBytes;
+	resultBytes.resize(totalBytes);
 	auto resultIterator = resultBytes.begin();
 
 	// Error-correct and copy data blocks together into a stream of bytes
-	for (auto& dataBlock : dataBlocks)
+	auto& uncertainBlocks = scratch.uncertainBlocks;
+	bool haveUncertainBlocks = false;
+	for (int i = 0; i < numBlocks; ++i)
 	{
-		ByteArray& codewordBytes = dataBlock.codewords();
-		int numDataCodewords = dataBlock.numDataCodewords();
+		ByteArray& codewordBytes = dataBlocks[i].codewords();
+		int numDataCodewords = dataBlocks[i].numDataCodewords();
 		
-		status = CorrectErrors(codewordBytes, numDataCodewords);
+		status = CorrectErrors(codewordBytes, numDataCodewords, nullptr, scratch);
+		if (status == DecodeStatus::ChecksumError && uncertainModules) {
+			// Too many errors, retry with the unreliable codewords, read and separated the same way, as erasures
+			if (!haveUncertainBlocks) {
+				auto uncertain = uncertainModules();
+				int numUncertainBlocks = 0;
+				if (uncertain == nullptr
+					|| StatusIsError(BitMatrixParser::ReadCodewords(*uncertain, version, scratch.uncertainCodewords))
+					|| StatusIsError(DataBlock::GetDataBlocks(scratch.uncertainCodewords, version, ecLevel, uncertainBlocks, numUncertainBlocks))) {
+					return status;
+				}
+				haveUncertainBlocks = true;
+			}
+			status = CorrectErrors(codewordBytes, numDataCodewords, &uncertainBlocks[i].codewords(), scratch);
+		}
 		if (StatusIsError(status)) {
 			return status;
 		}
@@ -459,7 +523,7 @@ DoDecode(const BitMatrix& bits, const Version& version, const FormatInformation&
 	}
 
 	// Decode the contents of that stream of bytes
-	return DecodeBitStream(resultBytes, version, ecLevel, hintedCharset, result);
+	return DecodeBitStream(resultBytes, version, ecLevel, hintedCharset, scratch, result);
 }
 
 static void
@@ -471,9 +535,16 @@ ReMask(BitMatrix& bitMatrix, const FormatInformation& formatInfo)
 
 
 DecodeStatus
-Decoder::Decode(const BitMatrix& bits_, const std::string& hintedCharset, DecoderResult& result)
+Decoder::Decode(const BitMatrix& bits, const std::string& hintedCharset, DecoderResult& result)
 {
-	BitMatrix bits;
+	return Decode(bits, UncertainModules(), hintedCharset, result);
+}
+
+DecodeStatus
+Decoder::Decode(const BitMatrix& bits_, const UncertainModules& uncertainModules, const std::string& hintedCharset, DecoderResult& result)
+{
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
+	auto& bits = scratch.bits;
 	bits_.copyTo(bits);
 	// Construct a parser and read version, error-correction level
 	const Version* version;
@@ -483,7 +554,7 @@ Decoder::Decode(const BitMatrix& bits_, const std::string& hintedCharset, Decode
 	if (StatusIsOK(status))
 	{
 		ReMask(bits, formatInfo);
-		status = DoDecode(bits, *version, formatInfo, hintedCharset, result);
+		status = DoDecode(bits, uncertainModules, *version, formatInfo, hintedCharset, scratch, result);
 		if (StatusIsOK(status)) {
 			return status;
 		}
@@ -506,9 +577,8 @@ Decoder::Decode(const BitMatrix& bits_, const std::string& hintedCharset, Decode
 		*/
 		// Prepare for a mirrored reading.
 		bits.mirror();
-
 		ReMask(bits, formatInfo);
-		status = DoDecode(bits, *version, formatInfo, hintedCharset, result);
+		status = DoDecode(bits, uncertainModules.mirrored(), *version, formatInfo, hintedCharset, scratch, result);
 		if (StatusIsOK(status))
 		{
 			result.setExtra(std::make_shared<DecoderMetadata>(true));
@@ -28,12 +28,23 @@
 #include "GridSampler.h"
 #include "ZXNumeric.h"
 #include "DecodeStatus.h"
+#include "DecodeContext.h"
 
 #include <cstdlib>
 
 namespace ZXing {
 namespace QRCode {
 
+namespace {
+
+// The matrix of the last sampled symbol, kept in the DecodeContext so that its memory gets reused.
+struct Scratch
+{
+	std::shared_ptr<BitMatrix> bits;
+};
+
+} // anonymous
+
 /**
 * <p>This method traces a line from a point in the image, in the direction towards another point.
 * It begins in a black region, and keeps going until it finds white, then black, then white again.
@@ -271,13 +282,13 @@ static int ComputeDimension(const ResultPoint& topLeft, const ResultPoint& topRi
 	return -1; // to signal error;
 }
 
-static DecodeStatus ProcessFinderPatternInfo(const BitMatrix& image, const FinderPatternInfo& info, /*const PointCallback& pointCallback, */DetectorResult& result)
+static DecodeStatus ProcessFinderPatternInfo(const std::shared_ptr<const BitMatrix>& image, const FinderPatternInfo& info, /*const PointCallback& pointCallback, */const std::shared_ptr<const GridSampler>& sampler, DetectorResult& result)
 {
 	//FinderPattern topLeft = info.getTopLeft();
 	//FinderPattern topRight = info.getTopRight();
 	//FinderPattern bottomLeft = info.getBottomLeft();
 
-	float moduleSize = CalculateModuleSize(image, info.topLeft, info.topRight, info.bottomLeft);
+	float moduleSize = CalculateModuleSize(*image, info.topLeft, info.topRight, info.bottomLeft);
 	if (moduleSize < 1.0f) {
 		return DecodeStatus::NotFound;
 	}
@@ -309,7 +320,7 @@ static DecodeStatus ProcessFinderPatternInfo(const BitMatrix& image, const Finde
 
 		// Kind of arbitrary -- expand search radius before giving up
 		for (int i = 4; i <= 16; i <<= 1) {
-			if (StatusIsOK(FindAlignmentInRegion(image, moduleSize, estAlignmentX, estAlignmentY, static_cast<float>(i), /*pointCallback,*/ alignmentPattern))) {
+			if (StatusIsOK(FindAlignmentInRegion(*image, moduleSize, estAlignmentX, estAlignmentY, static_cast<float>(i), /*pointCallback,*/ alignmentPattern))) {
 				haveAlignPattern = true;
 				break;
 			}
@@ -319,11 +330,16 @@ static DecodeStatus ProcessFinderPatternInfo(const BitMatrix& image, const Finde
 
 	PerspectiveTransform transform = CreateTransform(info.topLeft, info.topRight, info.bottomLeft, haveAlignPattern ? &alignmentPattern : nullptr, dimension);
 
-	auto bits = std::make_shared<BitMatrix>();
-	auto status = GridSampler::Instance()->sampleGrid(image, dimension, dimension, transform, *bits);
+	// The matrix is only reused once the DetectorResult of the previous call is gone.
+	auto& bits = DecodeContext::ThreadLocal().scratch<Scratch>().bits;
+	if (bits == nullptr || bits.use_count() > 1)
+		bits = std::make_shared<BitMatrix>();
+	auto status = sampler->sampleGrid(*image, dimension, dimension, transform, *bits);
 	if (StatusIsError(status))
 		return status;
 
+	result.setUncertainModules(UncertainModules(sampler, image, dimension, dimension, transform));
+
 	if (!haveAlignPattern) {
 		result.setBits(bits);
 		result.setPoints({ info.bottomLeft, info.topLeft, info.topRight });
@@ -337,15 +353,25 @@ static DecodeStatus ProcessFinderPatternInfo(const BitMatrix& image, const Finde
 
 DecodeStatus
 Detector::Detect(const BitMatrix& image, bool pureBarcode, bool tryHarder, DetectorResult& result)
+{
+	// The image is not shared with us, so the result must not keep it for its uncertain modules.
+	std::shared_ptr<const BitMatrix> unowned(std::shared_ptr<const BitMatrix>(), &image);
+	auto status = Detect(unowned, pureBarcode, tryHarder, GridSampler::Instance(), result);
+	result.setUncertainModules(UncertainModules());
+	return status;
+}
+
+DecodeStatus
+Detector::Detect(const std::shared_ptr<const BitMatrix>& image, bool pureBarcode, bool tryHarder, const std::shared_ptr<const GridSampler>& sampler, DetectorResult& result)
 {
 	/*PointCallback pointCallback = hints.resultPointCallback();*/
 
 	FinderPatternInfo info;
-	auto status = FinderPatternFinder::Find(image, /*pointCallback,*/ pureBarcode, tryHarder, info);
+	auto status = FinderPatternFinder::Find(*image, /*pointCallback,*/ pureBarcode, tryHarder, info);
 	if (StatusIsError(status))
 		return status;
 	
-	return ProcessFinderPatternInfo(image, info, /*pointCallback,*/ result);
+	return ProcessFinderPatternInfo(image, info, /*pointCallback,*/ sampler, result);
 }
 
 } // QRCode
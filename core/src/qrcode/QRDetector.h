@@ -16,9 +16,12 @@
 * limitations under the License.
 */
 
+#include <memory>
+
 namespace ZXing {
 
 class DetectorResult;
+class GridSampler;
 class BitMatrix;
 enum class DecodeStatus;
 
@@ -42,6 +45,13 @@ public:
 	* @throws FormatException if a QR Code cannot be decoded
 	*/
 	static DecodeStatus Detect(const BitMatrix& image, bool pureBarcode, bool tryHarder, DetectorResult& result);
+
+	/**
+	* Same as above, but reads the modules off the image with the given sampler instead of GridSampler::Instance().
+	* The result shares the image and the sampler to compute its uncertain modules, which the result of the
+	* overload above has none of.
+	*/
+	static DecodeStatus Detect(const std::shared_ptr<const BitMatrix>& image, bool pureBarcode, bool tryHarder, const std::shared_ptr<const GridSampler>& sampler, DetectorResult& result);
 };
 
 } // QRCode
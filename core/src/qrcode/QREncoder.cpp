@@ -18,6 +18,7 @@
 #include "qrcode/QREncoder.h"
 #include "qrcode/QRMaskUtil.h"
 #include "qrcode/QRMatrixUtil.h"
+#include "qrcode/QRPackedMatrix.h"
 #include "qrcode/QRErrorCorrectionLevel.h"
 #include "qrcode/QREncodeResult.h"
 #include "GenericGF.h"
@@ -47,7 +48,7 @@ static const std::array<int, 16*6> ALPHANUMERIC_TABLE = {
 
 // The mask penalty calculation is complicated.  See Table 21 of JISX0510:2004 (p.45) for details.
 // Basically it applies four rules and summate all penalties.
-static int CalculateMaskPenalty(const ByteMatrix& matrix)
+static int CalculateMaskPenalty(const PackedMatrix& matrix)
 {
 	return MaskUtil::ApplyMaskPenaltyRule1(matrix)
 		+ MaskUtil::ApplyMaskPenaltyRule2(matrix)
@@ -447,14 +448,15 @@ static void InterleaveWithECBytes(const BitArray& bits, int numTotalBytes, int n
 }
 
 
-static int ChooseMaskPattern(const BitArray& bits, ErrorCorrectionLevel ecLevel, const Version& version, ByteMatrix& matrix)
+static int ChooseMaskPattern(const BitArray& bits, ErrorCorrectionLevel ecLevel, const Version& version)
 {
+	std::vector<PackedMatrix> matrices;
+	MatrixUtil::BuildMatrices(bits, ecLevel, version, matrices);
 	int minPenalty = std::numeric_limits<int>::max();  // Lower penalty is better.
 	int bestMaskPattern = -1;
 	// We try all mask patterns to choose the best one.
 	for (int maskPattern = 0; maskPattern < MatrixUtil::NUM_MASK_PATTERNS; maskPattern++) {
-		MatrixUtil::BuildMatrix(bits, ecLevel, version, maskPattern, matrix);
-		int penalty = CalculateMaskPenalty(matrix);
+		int penalty = CalculateMaskPenalty(matrices[maskPattern]);
 		if (penalty < minPenalty) {
 			minPenalty = penalty;
 			bestMaskPattern = maskPattern;
@@ -556,7 +558,7 @@ Encoder::Encode(const std::wstring& content, ErrorCorrectionLevel ecLevel, Chara
 	//  Choose the mask pattern and set to "qrCode".
 	int dimension = version->dimensionForVersion();
 	output.matrix.init(dimension, dimension);
-	output.maskPattern = ChooseMaskPattern(finalBits, ecLevel, *version, output.matrix);
+	output.maskPattern = ChooseMaskPattern(finalBits, ecLevel, *version);
 
 	// Build the matrix and set it to "qrCode".
 	MatrixUtil::BuildMatrix(finalBits, ecLevel, *version, output.maskPattern, output.matrix);
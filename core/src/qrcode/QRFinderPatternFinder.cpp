@@ -20,6 +20,7 @@
 #include "BitMatrix.h"
 #include "DecodeHints.h"
 #include "DecodeStatus.h"
+#include "DecodeContext.h"
 
 #include <cmath>
 #include <cstdlib>
@@ -29,6 +30,16 @@
 namespace ZXing {
 namespace QRCode {
 
+namespace {
+
+// The temporaries of Find(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	std::vector<FinderPattern> possibleCenters;
+};
+
+} // anonymous
+
 static const int CENTER_QUORUM = 2;
 static const int MIN_SKIP = 3; // 1 pixel/module times 3 modules/center
 static const int MAX_MODULES = 57; // support up to version 10 for mobile clients
@@ -498,7 +509,8 @@ FinderPatternFinder::Find(const BitMatrix& image, /*const PointCallback& pointCa
 	}
 
 	bool hasSkipped = false;
-	std::vector<FinderPattern> possibleCenters;
+	auto& possibleCenters = DecodeContext::ThreadLocal().scratch<Scratch>().possibleCenters;
+	possibleCenters.clear();
 
 	bool done = false;
 	for (int i = iSkip - 1; i < maxI && !done; i += iSkip) {
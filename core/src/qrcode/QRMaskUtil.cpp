@@ -16,7 +16,9 @@
 */
 
 #include "qrcode/QRMaskUtil.h"
+#include "qrcode/QRPackedMatrix.h"
 #include "ByteMatrix.h"
+#include "BitHacks.h"
 
 #include <algorithm>
 #include <cstdlib>
@@ -183,5 +185,155 @@ int MaskUtil::ApplyMaskPenaltyRule4(const ByteMatrix& matrix)
 	return fivePercentVariances * N4;
 }
 
+/**
+* Returns the modules x + offset for the 32 modules x of word i of the row, for -32 < offset < 32. Modules
+* off the row are white, thanks to the white words around each row of a PackedMatrix.
+*/
+static inline uint32_t Shifted(const uint32_t* row, int i, int offset)
+{
+	if (offset > 0)
+		return (row[i] >> offset) | (row[i + 1] << (32 - offset));
+	if (offset < 0)
+		return (row[i] << -offset) | (row[i - 1] >> (32 + offset));
+	return row[i];
+}
+
+/**
+* Returns the bits of word i of a row for which x + span <= width, i.e. where a pattern of span modules
+* starting at x fits into the row.
+*/
+static inline uint32_t FittingBits(int width, int i, int span)
+{
+	int count = std::min(std::max(width - span + 1 - i * 32, 0), 32);
+	return count == 32 ? ~0u : (1u << count) - 1;
+}
+
+// Word i of row y, rows off the matrix are white
+static inline uint32_t RowWord(const PackedMatrix& matrix, int y, int i)
+{
+	return y >= 0 && y < matrix.height() ? matrix.row(y)[i] : 0;
+}
+
+/**
+* Counts the runs of 5 or more modules of the same color in rule 1. Bit x of "same" marks that modules
+* x to x + 4 all have the same color, so a run of n such modules sets n - 4 consecutive bits. Its penalty
+* N1 + (n - 5) is the number of these bits plus 2 for the start of the sequence.
+*/
+static inline int Rule1Penalty(uint32_t same, uint32_t previousSame)
+{
+	uint32_t starts = same & ~((same << 1) | (previousSame >> 31));
+	return BitHacks::CountBitsSet(same) + 2 * BitHacks::CountBitsSet(starts);
+}
+
+int MaskUtil::ApplyMaskPenaltyRule1(const PackedMatrix& matrix)
+{
+	static_assert(N1 == 3, "Rule1Penalty assumes N1 == 3");
+	int penalty = 0;
+	int width = matrix.width();
+	int height = matrix.height();
+	int rowWords = matrix.rowWords();
+	for (int y = 0; y < height; y++) {
+		const uint32_t* row = matrix.row(y);
+		uint32_t previous = 0;
+		for (int i = 0; i < rowWords; i++) {
+			uint32_t dark = row[i];
+			uint32_t light = ~row[i];
+			for (int k = 1; k < 5; k++) {
+				uint32_t next = Shifted(row, i, k);
+				dark &= next;
+				light &= ~next;
+			}
+			uint32_t same = (dark | light) & FittingBits(width, i, 5);
+			penalty += Rule1Penalty(same, previous);
+			previous = same;
+		}
+	}
+	for (int i = 0; i < rowWords; i++) {
+		uint32_t valid = FittingBits(width, i, 1);
+		uint32_t previous = 0;
+		for (int y = 0; y + 4 < height; y++) {
+			uint32_t dark = matrix.row(y)[i];
+			uint32_t light = ~dark;
+			for (int k = 1; k < 5; k++) {
+				dark &= matrix.row(y + k)[i];
+				light &= ~matrix.row(y + k)[i];
+			}
+			uint32_t same = (dark | light) & valid;
+			// Here the runs go down the columns, so a run starts where the word above has no bit.
+			penalty += BitHacks::CountBitsSet(same) + 2 * BitHacks::CountBitsSet(same & ~previous);
+			previous = same;
+		}
+	}
+	return penalty;
+}
+
+int MaskUtil::ApplyMaskPenaltyRule2(const PackedMatrix& matrix)
+{
+	int penalty = 0;
+	int width = matrix.width();
+	int rowWords = matrix.rowWords();
+	for (int y = 0; y + 1 < matrix.height(); y++) {
+		const uint32_t* top = matrix.row(y);
+		const uint32_t* bottom = matrix.row(y + 1);
+		for (int i = 0; i < rowWords; i++) {
+			uint32_t topRight = Shifted(top, i, 1);
+			uint32_t bottomRight = Shifted(bottom, i, 1);
+			uint32_t dark = top[i] & topRight & bottom[i] & bottomRight;
+			uint32_t light = ~(top[i] | topRight | bottom[i] | bottomRight);
+			penalty += BitHacks::CountBitsSet((dark | light) & FittingBits(width, i, 2));
+		}
+	}
+	return N2 * penalty;
+}
+
+int MaskUtil::ApplyMaskPenaltyRule3(const PackedMatrix& matrix)
+{
+	// Bit x of a word is set where the 7 modules from x on are 1011101. As the modules off the matrix are
+	// white, the last dark one makes sure that the pattern fits, and the white areas around are cut off at
+	// the border just like in IsWhiteHorizontal() and IsWhiteVertical().
+	auto finderLike = [](const uint32_t* m) {
+		return m[0] & ~m[1] & m[2] & m[3] & m[4] & ~m[5] & m[6];
+	};
+	auto white = [](const uint32_t* m) {
+		return ~(m[0] | m[1] | m[2] | m[3]);
+	};
+
+	int numPenalties = 0;
+	int rowWords = matrix.rowWords();
+	uint32_t m[15];
+	for (int y = 0; y < matrix.height(); y++) {
+		const uint32_t* row = matrix.row(y);
+		for (int i = 0; i < rowWords; i++) {
+			for (int k = 0; k < 15; k++) {
+				m[k] = Shifted(row, i, k - 4);
+			}
+			numPenalties += BitHacks::CountBitsSet(finderLike(m + 4) & (white(m) | white(m + 11)));
+		}
+	}
+	for (int i = 0; i < rowWords; i++) {
+		for (int y = 0; y < matrix.height(); y++) {
+			for (int k = 0; k < 15; k++) {
+				m[k] = RowWord(matrix, y + k - 4, i);
+			}
+			numPenalties += BitHacks::CountBitsSet(finderLike(m + 4) & (white(m) | white(m + 11)));
+		}
+	}
+	return numPenalties * N3;
+}
+
+int MaskUtil::ApplyMaskPenaltyRule4(const PackedMatrix& matrix)
+{
+	int numDarkCells = 0;
+	for (int y = 0; y < matrix.height(); y++) {
+		const uint32_t* row = matrix.row(y);
+		for (int i = 0; i < matrix.rowWords(); i++) {
+			numDarkCells += BitHacks::CountBitsSet(row[i]);
+		}
+	}
+	int numTotalCells = matrix.height() * matrix.width();
+	int fivePercentVariances = std::abs(numDarkCells * 2 - numTotalCells) * 10 / numTotalCells;
+	return fivePercentVariances * N4;
+}
+
 } // QRCode
 } // ZXing
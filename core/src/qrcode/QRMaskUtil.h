@@ -22,6 +22,8 @@ class ByteMatrix;
 
 namespace QRCode {
 
+class PackedMatrix;
+
 class MaskUtil
 {
 public:
@@ -29,6 +31,12 @@ public:
 	static int ApplyMaskPenaltyRule2(const ByteMatrix& matrix);
 	static int ApplyMaskPenaltyRule3(const ByteMatrix& matrix);
 	static int ApplyMaskPenaltyRule4(const ByteMatrix& matrix);
+
+	// The same rules on a bit-packed matrix, 32 modules at a time. They give exactly the same penalties.
+	static int ApplyMaskPenaltyRule1(const PackedMatrix& matrix);
+	static int ApplyMaskPenaltyRule2(const PackedMatrix& matrix);
+	static int ApplyMaskPenaltyRule3(const PackedMatrix& matrix);
+	static int ApplyMaskPenaltyRule4(const PackedMatrix& matrix);
 };
 
 } // QRCode
@@ -18,11 +18,13 @@
 #include "qrcode/QRMatrixUtil.h"
 #include "qrcode/QRErrorCorrectionLevel.h"
 #include "qrcode/QRVersion.h"
+#include "qrcode/QRPackedMatrix.h"
 #include "BitArray.h"
 #include "ByteMatrix.h"
 #include "BitHacks.h"
 #include "ZXStrConvWorkaround.h"
 
+#include <algorithm>
 #include <array>
 #include <string>
 
@@ -349,8 +351,9 @@ static void MakeTypeInfoBits(ErrorCorrectionLevel ecLevel, int maskPattern, BitA
 	}
 }
 
-// Embed type information. On success, modify the matrix.
-static void EmbedTypeInfo(ErrorCorrectionLevel ecLevel, int maskPattern, ByteMatrix& matrix)
+// Embed type information. On success, modify the matrix, which is a ByteMatrix or a PackedMatrix.
+template <typename Matrix>
+static void EmbedTypeInfo(ErrorCorrectionLevel ecLevel, int maskPattern, Matrix& matrix)
 {
 	BitArray typeInfoBits;
 	MakeTypeInfoBits(ecLevel, maskPattern, typeInfoBits);
@@ -526,5 +529,60 @@ MatrixUtil::BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel,
 	EmbedDataBits(dataBits, maskPattern, matrix);
 }
 
+// All mask patterns repeat every 12 rows.
+static const int MASK_PATTERN_ROWS = 12;
+
+void
+MatrixUtil::BuildMatrices(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, std::vector<PackedMatrix>& matrices)
+{
+	int dimension = version.dimensionForVersion();
+	ByteMatrix matrix(dimension, dimension);
+	makeEmpty(matrix);
+	EmbedBasicPatterns(version, matrix);
+	// This only reserves the type info cells, their bits depend on the mask pattern and are set below.
+	EmbedTypeInfo(ecLevel, 0, matrix);
+	MaybeEmbedVersionInfo(version, matrix);
+
+	PackedMatrix dataModules(dimension, dimension);
+	for (int y = 0; y < dimension; ++y) {
+		for (int x = 0; x < dimension; ++x) {
+			if (IsEmpty(matrix.get(x, y))) {
+				dataModules.set(x, y, true);
+			}
+		}
+	}
+	EmbedDataBits(dataBits, -1, matrix);
+	PackedMatrix unmasked(dimension, dimension);
+	for (int y = 0; y < dimension; ++y) {
+		for (int x = 0; x < dimension; ++x) {
+			unmasked.set(x, y, matrix.get(x, y) == 1);
+		}
+	}
+
+	int rowWords = unmasked.rowWords();
+	std::vector<uint32_t> pattern(MASK_PATTERN_ROWS * rowWords);
+	matrices.assign(NUM_MASK_PATTERNS, unmasked);
+	for (int maskPattern = 0; maskPattern < NUM_MASK_PATTERNS; ++maskPattern) {
+		std::fill(pattern.begin(), pattern.end(), 0);
+		for (int y = 0; y < MASK_PATTERN_ROWS; ++y) {
+			for (int x = 0; x < dimension; ++x) {
+				if (GetDataMaskBit(maskPattern, x, y)) {
+					pattern[y * rowWords + x / 32] |= 1u << (x & 0x1f);
+				}
+			}
+		}
+		PackedMatrix& masked = matrices[maskPattern];
+		for (int y = 0; y < dimension; ++y) {
+			uint32_t* row = masked.row(y);
+			const uint32_t* data = dataModules.row(y);
+			const uint32_t* mask = pattern.data() + (y % MASK_PATTERN_ROWS) * rowWords;
+			for (int i = 0; i < rowWords; ++i) {
+				row[i] ^= mask[i] & data[i];
+			}
+		}
+		EmbedTypeInfo(ecLevel, maskPattern, masked);
+	}
+}
+
 } // QRCode
 } // ZXing
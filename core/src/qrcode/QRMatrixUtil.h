@@ -16,6 +16,8 @@
 * limitations under the License.
 */
 
+#include <vector>
+
 namespace ZXing {
 
 class BitArray;
@@ -25,6 +27,7 @@ namespace QRCode {
 
 enum class ErrorCorrectionLevel;
 class Version;
+class PackedMatrix;
 
 class MatrixUtil
 {
@@ -32,6 +35,13 @@ public:
 	static const int NUM_MASK_PATTERNS = 8;
 
 	static void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, ByteMatrix& matrix);
+
+	/**
+	* Builds the matrices of BuildMatrix() for all NUM_MASK_PATTERNS mask patterns at once, bit-packed, to
+	* choose the mask pattern from. The modules are placed only once, then the data modules are masked a
+	* row word at a time.
+	*/
+	static void BuildMatrices(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, std::vector<PackedMatrix>& matrices);
 };
 
 } // QRCode
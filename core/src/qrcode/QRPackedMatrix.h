@@ -0,0 +1,80 @@
+#pragma once
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <cstdint>
+#include <vector>
+
+namespace ZXing {
+namespace QRCode {
+
+/**
+* A QR Code matrix as built by the encoder, packed into 32 bit words like the rows of a BitMatrix: bit
+* x % 32 of word x / 32 is module x, 1 is dark. The bits beyond the width are always 0. Every row is
+* surrounded by a white word on both sides, so that the mask penalty rules can combine a word with its
+* neighbours without bounds checks.
+*/
+class PackedMatrix
+{
+	int _width = 0;
+	int _height = 0;
+	int _rowWords = 0;
+	std::vector<uint32_t> _words;
+
+public:
+	PackedMatrix() {}
+	PackedMatrix(int width, int height) : _width(width), _height(height), _rowWords((width + 31) / 32), _words((_rowWords + 2) * height, 0) {}
+
+	int width() const {
+		return _width;
+	}
+
+	int height() const {
+		return _height;
+	}
+
+	/**
+	* @return the number of words of one row, without the white words around it.
+	*/
+	int rowWords() const {
+		return _rowWords;
+	}
+
+	/**
+	* @return the first of the rowWords() words of row y; the words at -1 and rowWords() are white.
+	*/
+	const uint32_t* row(int y) const {
+		return _words.data() + y * (_rowWords + 2) + 1;
+	}
+
+	uint32_t* row(int y) {
+		return _words.data() + y * (_rowWords + 2) + 1;
+	}
+
+	bool get(int x, int y) const {
+		return ((row(y)[x / 32] >> (x & 0x1f)) & 1) != 0;
+	}
+
+	void set(int x, int y, bool value) {
+		if (value)
+			row(y)[x / 32] |= 1u << (x & 0x1f);
+		else
+			row(y)[x / 32] &= ~(1u << (x & 0x1f));
+	}
+};
+
+} // QRCode
+} // ZXing
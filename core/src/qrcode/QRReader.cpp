@@ -26,12 +26,25 @@
 #include "DecodeHints.h"
 #include "BinaryBitmap.h"
 #include "BitMatrix.h"
+#include "GridSampler.h"
+#include "DecodeContext.h"
 #include "ZXNumeric.h"
 #include "ZXConfig.h"
 
 namespace ZXing {
 namespace QRCode {
 
+namespace {
+
+// The temporaries of Reader::decode(), kept in the DecodeContext so that their memory gets reused.
+struct Scratch
+{
+	BitMatrix pureBits;
+	std::vector<ResultPoint> points; // those of a failed decode, whose memory the next detection reuses
+};
+
+} // anonymous
+
 static float
 GetModuleSize(int x, int y, const BitMatrix& image)
 {
@@ -131,7 +144,7 @@ ExtractPureBits(const BitMatrix& image, BitMatrix& outBits)
 	}
 
 	// Now just read off the bits
-	outBits = BitMatrix(matrixWidth, matrixHeight);
+	outBits.reset(matrixWidth, matrixHeight);
 	for (int y = 0; y < matrixHeight; y++) {
 		int iOffset = top + (int)(y * moduleSize);
 		for (int x = 0; x < matrixWidth; x++) {
@@ -145,7 +158,9 @@ ExtractPureBits(const BitMatrix& image, BitMatrix& outBits)
 
 Reader::Reader(const DecodeHints& hints) :
 	_tryHarder(hints.shouldTryHarder()),
-	_charset(hints.characterSet())
+	_charset(hints.characterSet()),
+	_gridSampler(hints.gridSampler()),
+	_sampleLuminance(hints.shouldSampleLuminance())
 {
 }
 
@@ -160,8 +175,9 @@ Reader::decode(const BinaryBitmap& image) const
 	DecoderResult decoderResult;
 	std::vector<ResultPoint> points;
 	DecodeStatus status;
+	auto& scratch = DecodeContext::ThreadLocal().scratch<Scratch>();
 	if (image.isPureBarcode()) {
-		BitMatrix bits;
+		auto& bits = scratch.pureBits;
 		status = ExtractPureBits(*binImg, bits);
 		if (StatusIsOK(status)) {
 			status = Decoder::Decode(bits, _charset, decoderResult);
@@ -169,10 +185,15 @@ Reader::decode(const BinaryBitmap& image) const
 	}
 	else {
 		DetectorResult detectorResult;
-		status = Detector::Detect(*binImg, image.isPureBarcode(), _tryHarder, detectorResult);
+		detectorResult.setPoints(std::move(scratch.points));
+		ImageGridSampler sampler(image, _gridSampler, _sampleLuminance);
+		status = Detector::Detect(binImg, image.isPureBarcode(), _tryHarder, sampler.get(), detectorResult);
 		if (StatusIsOK(status)) {
-			status = Decoder::Decode(*detectorResult.bits(), _charset, decoderResult);
-			points = detectorResult.points();
+			status = Decoder::Decode(*detectorResult.bits(), detectorResult.uncertainModules(), _charset, decoderResult);
+		}
+		points = std::move(detectorResult).points();
+		if (StatusIsError(status)) {
+			scratch.points = std::move(points);
 		}
 	}
 
@@ -193,10 +214,10 @@ Reader::decode(const BinaryBitmap& image) const
 	}
 #endif
 
-	Result result(decoderResult.text(), decoderResult.rawBytes(), points, BarcodeFormat::QR_CODE);
-	auto& byteSegments = decoderResult.byteSegments();
-	if (!byteSegments.empty()) {
-		result.metadata().put(ResultMetadata::BYTE_SEGMENTS, byteSegments);
+	int numBits = decoderResult.numBits();
+	Result result(std::move(decoderResult).text(), std::move(decoderResult).rawBytes(), numBits, std::move(points), BarcodeFormat::QR_CODE);
+	if (!decoderResult.byteSegments().empty()) {
+		result.metadata().put(ResultMetadata::BYTE_SEGMENTS, std::move(decoderResult).byteSegments());
 	}
 	auto ecLevel = decoderResult.ecLevel();
 	if (!ecLevel.empty()) {
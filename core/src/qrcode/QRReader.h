@@ -18,11 +18,13 @@
 
 #include "Reader.h"
 
+#include <memory>
 #include <string>
 
 namespace ZXing {
 
 class DecodeHints;
+class GridSampler;
 
 namespace QRCode {
 
@@ -40,6 +42,8 @@ public:
 private:
 	bool _tryHarder;
 	std::string _charset;
+	std::shared_ptr<const GridSampler> _gridSampler;
+	bool _sampleLuminance;
 };
 
 } // QRCode
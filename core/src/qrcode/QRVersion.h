@@ -19,8 +19,8 @@
 #include "qrcode/QRECB.h"
 #include "qrcode/QRErrorCorrectionLevel.h"
 
-#include <initializer_list>
-#include <vector>
+#include <array>
+#include <cstddef>
 
 namespace ZXing {
 
@@ -40,12 +40,33 @@ public:
 		return _versionNumber;
 	}
 
-	const std::vector<int>& alignmentPatternCenters() const {
-		return _alignmentPatternCenters;
+	/**
+	* A read-only view of the alignment pattern center coordinates, which are kept in a fixed-size array.
+	*/
+	class AlignmentPatternCenters
+	{
+		const int* _begin;
+		const int* _end;
+
+	public:
+		AlignmentPatternCenters(const int* begin, const int* end) : _begin(begin), _end(end) {}
+
+		const int* begin() const { return _begin; }
+		const int* end() const { return _end; }
+		size_t size() const { return _end - _begin; }
+		bool empty() const { return _begin == _end; }
+		int operator[](size_t i) const { return _begin[i]; }
+	};
+
+	/**
+	* @return the alignment pattern center coordinates, none for version 1
+	*/
+	AlignmentPatternCenters alignmentPatternCenters() const {
+		return AlignmentPatternCenters(_alignmentPatternCenters.data(), _alignmentPatternCenters.data() + _numAlignmentPatternCenters);
 	}
 	
 	int totalCodewords() const {
-		return _totalCodewords;
+		return _ecBlocks[0].totalDataCodewords();
 	}
 	
 	int dimensionForVersion() const {
@@ -73,12 +94,17 @@ public:
 	
 private:
 	int _versionNumber;
-	std::vector<int> _alignmentPatternCenters;
+	int _numAlignmentPatternCenters;
+	std::array<int, 7> _alignmentPatternCenters;
 	std::array<ECBlocks, 4> _ecBlocks;
-	int _totalCodewords;
 
-	Version(int versionNumber, std::initializer_list<int> alignmentPatternCenters, const std::array<ECBlocks, 4> &ecBlocks);
-	static const Version* AllVersions();
+	// Versions 2 and above have version / 7 + 2 alignment pattern center coordinates
+	constexpr Version(int versionNumber, const std::array<int, 7>& alignmentPatternCenters, const std::array<ECBlocks, 4>& ecBlocks)
+		: _versionNumber(versionNumber), _numAlignmentPatternCenters(versionNumber == 1 ? 0 : versionNumber / 7 + 2),
+		  _alignmentPatternCenters(alignmentPatternCenters), _ecBlocks(ecBlocks) {}
+
+	// Constant-initialized, hence read-only data without any initialization at runtime
+	static const Version ALL_VERSIONS[];
 };
 
 } // QRCode
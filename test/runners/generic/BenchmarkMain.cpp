@@ -0,0 +1,638 @@
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "GenericLuminanceSource.h"
+#include "HybridBinarizer.h"
+#include "GlobalHistogramBinarizer.h"
+#include "BitArray.h"
+#include "BitMatrix.h"
+#include "ByteArray.h"
+#include "DecodeStatus.h"
+#include "DecoderResult.h"
+#include "DetectorResult.h"
+#include "Result.h"
+#include "GridSampler.h"
+#include "PerspectiveTransform.h"
+#include "ReedSolomonDecoder.h"
+#include "GenericGF.h"
+#include "TextDecoder.h"
+#include "CharacterSet.h"
+#include "qrcode/QRDetector.h"
+#include "qrcode/QRDataMask.h"
+#include "qrcode/QRDecoder.h"
+#include "datamatrix/DMBitMatrixParser.h"
+#include "datamatrix/DMDetector.h"
+#include "aztec/AZDecoder.h"
+#include "aztec/AZDetectorResult.h"
+#include "pdf417/PDFCodewordDecoder.h"
+#include "pdf417/PDFDetector.h"
+#include "pdf417/PDFErrorCorrection.h"
+#include "pdf417/PDFReader.h"
+#include "BlackboxImages.h"
+
+#ifdef ZXING_BENCHMARK_ENCODERS
+#include "BatchWriter.h"
+#include "RasterWriter.h"
+#include "qrcode/QRWriter.h"
+#include "datamatrix/DMWriter.h"
+#include "datamatrix/DMHighLevelEncoder.h"
+#include "datamatrix/DMSymbolShape.h"
+#include "aztec/AZWriter.h"
+#include "aztec/AZEncoder.h"
+#include "aztec/AZHighLevelEncoder.h"
+#include "pdf417/PDFWriter.h"
+#include "pdf417/PDFHighLevelEncoder.h"
+#include "pdf417/PDFCompaction.h"
+#include "pdf417/PDFDecodedBitStreamParser.h"
+#include "oned/ODCodabarWriter.h"
+#include "oned/ODCode39Writer.h"
+#include "oned/ODCode93Writer.h"
+#include "oned/ODCode128Writer.h"
+#include "oned/ODEAN8Writer.h"
+#include "oned/ODEAN13Writer.h"
+#include "oned/ODITFWriter.h"
+#include "oned/ODUPCAWriter.h"
+#include "oned/ODUPCEWriter.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ZXing;
+using namespace ZXing::Test;
+
+/**
+* Measures the stages of the decoding (and encoding) pipeline in isolation and prints the results as
+* JSON to stdout:
+*
+*   { "benchmarks": [ { "stage": ..., "name": ..., "iterations": ..., "ns_per_op": ...,
+*                       "throughput": ..., "unit": ... }, ... ] }
+*
+* One 'op' is one call of the measured function. The throughput is given in 'unit' per second, where
+* the unit is pixels, modules, codewords, bytes or symbols, depending on the stage.
+*
+* Usage: StageBenchmark <test path prefix> [-filter <substring>] [-time <seconds per benchmark>]
+*/
+
+namespace {
+
+struct Benchmark
+{
+	std::string stage;
+	std::string name;
+	std::string unit;
+	double unitsPerOp;
+	std::function<void()> op;
+};
+
+struct Measurement
+{
+	long long iterations;
+	double nsPerOp;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// Every measured op adds something to this, so that the compiler can not optimize the work away.
+volatile long long sink = 0;
+
+// Runs op until minSeconds have passed, doubling the batch size each round to keep the clock
+// overhead negligible for the very fast stages.
+Measurement run(const std::function<void()>& op, double minSeconds)
+{
+	op(); // warm-up, initializes static tables and scratch memory
+	long long iterations = 0;
+	long long batch = 1;
+	auto start = Clock::now();
+	double elapsed = 0;
+	while (elapsed < minSeconds) {
+		for (long long i = 0; i < batch; ++i)
+			op();
+		iterations += batch;
+		batch *= 2;
+		elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	}
+	return {iterations, elapsed * 1e9 / iterations};
+}
+
+std::string jsonEscape(const std::string& str)
+{
+	std::string result;
+	for (char c : str) {
+		if (c == '"' || c == '\\')
+			result += '\\';
+		result += c;
+	}
+	return result;
+}
+
+const char* CharsetName(CharacterSet cs)
+{
+	static const char* NAMES[] = {
+		"Unknown", "ASCII", "ISO8859_1", "ISO8859_2", "ISO8859_3", "ISO8859_4", "ISO8859_5", "ISO8859_6",
+		"ISO8859_7", "ISO8859_8", "ISO8859_9", "ISO8859_10", "ISO8859_11", "ISO8859_13", "ISO8859_14",
+		"ISO8859_15", "ISO8859_16", "Cp437", "Cp1250", "Cp1251", "Cp1252", "Cp1256", "Shift_JIS", "Big5",
+		"GB2312", "GB18030", "EUC_JP", "EUC_KR", "UnicodeBig", "UTF8",
+	};
+	static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == (int)CharacterSet::CharsetCount, "charset names out of date");
+	return NAMES[(int)cs];
+}
+
+struct Image
+{
+	std::string name;
+	std::shared_ptr<const LuminanceSource> source;
+	std::shared_ptr<const BitMatrix> bits;
+};
+
+std::vector<Image> loadImages(const fs::path& directory)
+{
+	std::vector<Image> result;
+	for (auto& path : getImagesInDirectory(directory)) {
+		Image img;
+		img.name = directory.filename().string() + "/" + path.filename().string();
+		img.source = readImage(path);
+		img.bits = HybridBinarizer(img.source).getBlackMatrix();
+		if (img.bits)
+			result.push_back(img);
+	}
+	return result;
+}
+
+double pixelCount(const std::vector<Image>& images)
+{
+	double result = 0;
+	for (auto& img : images)
+		result += img.source->width() * img.source->height();
+	return result;
+}
+
+void addImageBenchmarks(std::vector<Benchmark>& benchmarks, const std::string& set, const std::vector<Image>& images)
+{
+	// The RGB conversion gets an interleaved 3 byte per pixel copy of each image.
+	auto rgbImages = std::make_shared<std::vector<ByteArray>>();
+	for (auto& img : images) {
+		ByteArray gray;
+		int rowBytes;
+		auto pixels = img.source->getMatrix(gray, rowBytes);
+		int w = img.source->width(), h = img.source->height();
+		ByteArray rgb(w * h * 3);
+		for (int y = 0; y < h; ++y)
+			for (int x = 0; x < w; ++x)
+				std::fill_n(rgb.data() + (y * w + x) * 3, 3, pixels[y * rowBytes + x]);
+		rgbImages->push_back(std::move(rgb));
+	}
+
+	double pixels = pixelCount(images);
+	benchmarks.push_back({"GenericLuminanceSource", "RGB " + set, "pixels", pixels, [images, rgbImages]() {
+		for (size_t i = 0; i < images.size(); ++i) {
+			int w = images[i].source->width(), h = images[i].source->height();
+			GenericLuminanceSource source(w, h, (*rgbImages)[i].data(), w * 3, 3, 0, 1, 2);
+			ByteArray buffer;
+			sink += source.getRow(h / 2, buffer)[w / 2];
+		}
+	}});
+	benchmarks.push_back({"HybridBinarizer", set, "pixels", pixels, [images]() {
+		for (auto& img : images)
+			sink += HybridBinarizer(img.source).getBlackMatrix()->height();
+	}});
+	benchmarks.push_back({"GlobalHistogramBinarizer", set, "pixels", pixels, [images]() {
+		for (auto& img : images)
+			if (auto bits = GlobalHistogramBinarizer(img.source).getBlackMatrix())
+				sink += bits->height();
+	}});
+}
+
+std::vector<Benchmark> createBenchmarks(const fs::path& pathPrefix)
+{
+	std::vector<Benchmark> benchmarks;
+
+	auto qrImages = loadImages(pathPrefix / "blackbox" / "qrcode-2");
+	auto dmImages = loadImages(pathPrefix / "blackbox" / "datamatrix-1");
+	auto pdfImages = loadImages(pathPrefix / "blackbox" / "pdf417-1");
+	auto eanImages = loadImages(pathPrefix / "blackbox" / "ean13-1");
+
+	addImageBenchmarks(benchmarks, "qrcode-2", qrImages);
+	addImageBenchmarks(benchmarks, "datamatrix-1", dmImages);
+	addImageBenchmarks(benchmarks, "pdf417-1", pdfImages);
+	addImageBenchmarks(benchmarks, "ean13-1", eanImages);
+
+	benchmarks.push_back({"QRCode::Detector", "qrcode-2", "pixels", pixelCount(qrImages), [qrImages]() {
+		for (auto& img : qrImages) {
+			DetectorResult result;
+			sink += (int)QRCode::Detector::Detect(*img.bits, false, false, result);
+		}
+	}});
+	benchmarks.push_back({"QRCode::Detector", "qrcode-2 tryHarder", "pixels", pixelCount(qrImages), [qrImages]() {
+		for (auto& img : qrImages) {
+			DetectorResult result;
+			sink += (int)QRCode::Detector::Detect(*img.bits, false, true, result);
+		}
+	}});
+	benchmarks.push_back({"DataMatrix::Detector", "datamatrix-1", "pixels", pixelCount(dmImages), [dmImages]() {
+		for (auto& img : dmImages) {
+			DetectorResult result;
+			sink += (int)DataMatrix::Detector::Detect(*img.bits, result);
+		}
+	}});
+
+	// Reading all PDF417 samples, the codewords that do not sample to a valid symbol go through the closest match
+	// against the ratio table.
+	auto allPdfImages = std::make_shared<std::vector<Image>>();
+	for (auto set : {"pdf417-1", "pdf417-2", "pdf417-3", "pdf417-4"}) {
+		auto images = loadImages(pathPrefix / "blackbox" / set);
+		allPdfImages->insert(allPdfImages->end(), images.begin(), images.end());
+	}
+	// The binarizers cache their black matrix, so only the detection is measured. Images without a PDF417
+	// symbol are searched in both orientations.
+	for (auto set : {std::make_pair(std::string("pdf417-*"), *allPdfImages), std::make_pair(std::string("qrcode-2"), qrImages)}) {
+		auto binarizers = std::make_shared<std::vector<std::shared_ptr<HybridBinarizer>>>();
+		for (auto& img : set.second) {
+			binarizers->push_back(std::make_shared<HybridBinarizer>(img.source));
+			binarizers->back()->getBlackMatrix();
+		}
+		benchmarks.push_back({"Pdf417::Detector", set.first, "pixels", pixelCount(set.second), [binarizers]() {
+			for (auto& binarizer : *binarizers) {
+				Pdf417::Detector::Result result;
+				sink += (int)Pdf417::Detector::Detect(*binarizer, true, result);
+			}
+		}});
+	}
+	benchmarks.push_back({"Pdf417::Reader", "pdf417-*", "pixels", pixelCount(*allPdfImages), [allPdfImages]() {
+		for (auto& img : *allPdfImages)
+			sink += (int)Pdf417::Reader().decode(HybridBinarizer(img.source)).status();
+	}});
+
+	// The two scanned pages of pdf417-4 with four symbols each, read at once on one and on four threads. The
+	// binarizers cache their black matrix, so the detection and the decoding of the symbols are measured.
+	auto macroPages = std::make_shared<std::vector<std::shared_ptr<HybridBinarizer>>>();
+	for (auto& img : *allPdfImages) {
+		if (img.name == "pdf417-4/02-01.png" || img.name == "pdf417-4/02-02.png") {
+			macroPages->push_back(std::make_shared<HybridBinarizer>(img.source));
+			macroPages->back()->getBlackMatrix();
+		}
+	}
+	for (int threads : {1, 4}) {
+		benchmarks.push_back({"Pdf417::Reader", "decodeMultiple pdf417-4/02 " + std::to_string(threads) + " thread(s)", "symbols",
+							  4.0 * macroPages->size(), [macroPages, threads]() {
+			for (auto& page : *macroPages)
+				sink += Pdf417::Reader().setThreadCount(threads).decodeMultiple(*page).size();
+		}});
+	}
+
+	// Bar widths with noise of a few pixels, at about 2 to 4 pixels per module
+	auto pdfBarWidths = std::make_shared<std::vector<std::array<int, Pdf417::CodewordDecoder::BARS_IN_MODULE>>>(1000);
+	std::minstd_rand random(42);
+	for (auto& widths : *pdfBarWidths)
+		for (auto& w : widths)
+			w = 2 + random() % 12;
+	benchmarks.push_back({"Pdf417::CodewordDecoder", "noisy bar widths", "codewords", double(pdfBarWidths->size()), [pdfBarWidths]() {
+		for (auto& widths : *pdfBarWidths)
+			sink += Pdf417::CodewordDecoder::GetDecodedValue(widths);
+	}});
+
+	// Sampling up to the largest Data Matrix and QR Code sizes from a slightly rotated and skewed quadrilateral.
+	for (int dimension : {21, 57, 144, 177}) {
+		auto image = std::make_shared<BitMatrix>(800, 800);
+		for (int y = 0; y < 800; ++y)
+			for (int x = 0; x < 800; ++x)
+				if (((x / 3) ^ (y / 5)) & 1)
+					image->set(x, y);
+		auto transform = PerspectiveTransform::QuadrilateralToQuadrilateral(
+			0, 0, float(dimension), 0, float(dimension), float(dimension), 0, float(dimension),
+			50, 60, 740, 40, 760, 750, 40, 730);
+		benchmarks.push_back({"GridSampler", std::to_string(dimension) + "x" + std::to_string(dimension), "modules",
+							  double(dimension * dimension), [image, dimension, transform]() {
+			BitMatrix bits;
+			sink += (int)GridSampler::Default().sampleGrid(*image, dimension, dimension, transform, bits);
+		}});
+		benchmarks.push_back({"GridSampler", std::to_string(dimension) + "x" + std::to_string(dimension) + " uncertain modules", "modules",
+							  double(dimension * dimension), [image, dimension, transform]() {
+			BitMatrix uncertain;
+			GridSampler::Default().findUncertainModules(*image, dimension, dimension, transform, uncertain);
+			sink += uncertain.width();
+		}});
+	}
+
+	// Unmasking a version 40 symbol with each of the eight data mask patterns.
+	auto qrV40Bits = std::make_shared<BitMatrix>(177);
+	for (int y = 0; y < 177; ++y)
+		for (int x = 0; x < 177; ++x)
+			if ((x * 7 + y * 3) % 5 < 2)
+				qrV40Bits->set(x, y);
+	for (int reference = 0; reference < 8; ++reference) {
+		benchmarks.push_back({"QRCode::DataMask", "177x177 mask " + std::to_string(reference), "modules", 177.0 * 177,
+							  [qrV40Bits, reference]() {
+			QRCode::DataMask(reference).unmaskBitMatrix(*qrV40Bits, 177);
+			sink += qrV40Bits->get(176, 176);
+		}});
+	}
+
+	// The all-zero word is a codeword of every RS code, damaging a quarter of the EC capacity gives a
+	// correctable input. The decoder works in place, so every op starts from a fresh copy.
+	struct RSCase { const char* name; const GenericGF& field; int numCodewords; int numECCodewords; };
+	for (auto& c : {RSCase{"QRCodeField256", GenericGF::QRCodeField256(), 255, 68},
+					RSCase{"DataMatrixField256", GenericGF::DataMatrixField256(), 174, 68},
+					RSCase{"AztecData6", GenericGF::AztecData6(), 63, 20},
+					RSCase{"AztecData8", GenericGF::AztecData8(), 255, 60},
+					RSCase{"AztecData10", GenericGF::AztecData10(), 1000, 300},
+					RSCase{"AztecData12", GenericGF::AztecData12(), 1400, 400},
+					RSCase{"AztecParam", GenericGF::AztecParam(), 10, 6},
+					RSCase{"MaxiCodeField64", GenericGF::MaxiCodeField64(), 62, 30}}) {
+		for (int numErrors : {0, c.numECCodewords / 4, c.numECCodewords / 2}) {
+			std::vector<int> damaged(c.numCodewords, 0);
+			for (int i = 0; i < numErrors; ++i)
+				damaged[(i * 7) % c.numCodewords] = (i * 13 + 1) % c.field.size();
+			auto received = std::make_shared<std::vector<int>>();
+			auto& field = c.field;
+			int numECCodewords = c.numECCodewords;
+			for (auto algorithm : {ReedSolomonDecoder::Algorithm::Euclidean, ReedSolomonDecoder::Algorithm::BerlekampMassey}) {
+				// without errors the algorithms are not even run
+				if (numErrors == 0 && algorithm != ReedSolomonDecoder::Algorithm::Euclidean)
+					continue;
+				auto name = std::string(c.name) + " " + std::to_string(numErrors) + " errors";
+				if (numErrors > 0)
+					name += algorithm == ReedSolomonDecoder::Algorithm::Euclidean ? " Euclidean" : " BerlekampMassey";
+				benchmarks.push_back({"ReedSolomonDecoder", name, "codewords", double(c.numCodewords),
+									  [&field, damaged, received, numECCodewords, algorithm]() {
+					*received = damaged;
+					sink += (int)ReedSolomonDecoder(field, algorithm).decode(*received, numECCodewords);
+				}});
+			}
+		}
+		// A burst of damaged codewords at known positions, three times as many as correctable as errors.
+		int numErasures = c.numECCodewords * 3 / 4;
+		std::vector<int> damaged(c.numCodewords, 0);
+		auto erasures = std::make_shared<std::vector<int>>();
+		for (int i = 0; i < numErasures; ++i) {
+			damaged[i] = (i * 13 + 1) % c.field.size();
+			erasures->push_back(i);
+		}
+		auto received = std::make_shared<std::vector<int>>();
+		auto& field = c.field;
+		int numECCodewords = c.numECCodewords;
+		for (auto algorithm : {ReedSolomonDecoder::Algorithm::Euclidean, ReedSolomonDecoder::Algorithm::BerlekampMassey}) {
+			auto name = std::string(c.name) + " " + std::to_string(numErasures) + " erasures";
+			name += algorithm == ReedSolomonDecoder::Algorithm::Euclidean ? " Euclidean" : " BerlekampMassey";
+			benchmarks.push_back({"ReedSolomonDecoder", name, "codewords", double(c.numCodewords),
+								  [&field, damaged, erasures, received, numECCodewords, algorithm]() {
+				*received = damaged;
+				sink += (int)ReedSolomonDecoder(field, algorithm).decode(*received, numECCodewords, *erasures);
+			}});
+		}
+	}
+
+	// A full size PDF417 symbol of 928 codewords with 3^d at degree d. That is a codeword at every EC level, as
+	// the sum of (3^(i + 1))^d over all 928 degrees d vanishes for the syndromes i < 927.
+	std::vector<int> pdfCodewords(928);
+	for (int d = 0, x = 1; d < 928; ++d, x = x * 3 % 929)
+		pdfCodewords[927 - d] = x;
+	for (int ecLevel = 2; ecLevel <= 8; ++ecLevel) {
+		int numECCodewords = 1 << (ecLevel + 1);
+		for (int numErrors : {0, numECCodewords / 4, numECCodewords / 2}) {
+			auto damaged = pdfCodewords;
+			for (int i = 0; i < numErrors; ++i)
+				damaged[(i * 7) % 928] = (damaged[(i * 7) % 928] + i * 13 + 1) % 929;
+			auto received = std::make_shared<std::vector<int>>();
+			benchmarks.push_back({"Pdf417::ErrorCorrection", "EC level " + std::to_string(ecLevel) + " " + std::to_string(numErrors) + " errors",
+								  "codewords", 928, [damaged, received, numECCodewords]() {
+				*received = damaged;
+				int nbErrors;
+				sink += (int)Pdf417::ErrorCorrection::Decode(*received, numECCodewords, nbErrors);
+			}});
+		}
+	}
+
+	// Reading the 2178 codewords of the largest symbol, with its 36 data regions.
+	auto dmSymbol = std::make_shared<BitMatrix>(144, 144);
+	for (int i = 0; i < 144 * 144; ++i)
+		if ((i * 7919) % 13 < 6)
+			dmSymbol->set(i % 144, i / 144);
+	benchmarks.push_back({"DataMatrix::BitMatrixParser", "144x144", "modules", 144.0 * 144, [dmSymbol]() {
+		ByteArray codewords;
+		sink += (int)DataMatrix::BitMatrixParser::ReadCodewords(*dmSymbol, codewords);
+	}});
+
+	// Plain ASCII is valid in every supported charset (as byte pairs for UnicodeBig).
+	std::string text;
+	while (text.size() < 1024)
+		text += "The quick brown fox jumps over the lazy dog 0123456789. ";
+	text.resize(1024);
+	auto textBytes = std::make_shared<std::vector<uint8_t>>(text.begin(), text.end());
+	for (int i = 1; i < (int)CharacterSet::CharsetCount; ++i) {
+		auto charset = (CharacterSet)i;
+		benchmarks.push_back({"TextDecoder", CharsetName(charset), "bytes", double(textBytes->size()), [textBytes, charset]() {
+			std::wstring str;
+			TextDecoder::Append(str, textBytes->data(), textBytes->size(), charset);
+			sink += str.size();
+		}});
+	}
+
+#ifdef ZXING_BENCHMARK_ENCODERS
+	auto writer = [&benchmarks](const std::string& name, const std::wstring& contents,
+								std::function<void(const std::wstring&, BitMatrix&)> encode) {
+		benchmarks.push_back({"Writer", name, "symbols", 1, [contents, encode]() {
+			BitMatrix bits;
+			encode(contents, bits);
+			sink += bits.width();
+		}});
+	};
+	std::wstring longText;
+	for (int i = 0; i < 8; ++i)
+		longText += L"http://www.example.com/zxing/benchmark?page=" + std::to_wstring(i) + L" ";
+
+	// Decoding a version 40 symbol, which is dominated by unmasking and reading the codewords.
+	auto qrV40Symbol = std::make_shared<BitMatrix>();
+	QRCode::Writer().setMargin(0).setVersion(40).encode(longText, 0, 0, *qrV40Symbol);
+	benchmarks.push_back({"QRCode::Decoder", "version 40", "modules", 177.0 * 177, [qrV40Symbol]() {
+		DecoderResult result;
+		sink += (int)QRCode::Decoder::Decode(*qrV40Symbol, "", result);
+	}});
+
+	// Decoding a full range 32 layer symbol, i.e. bit extraction, 12 bit Reed-Solomon and the text tables.
+	std::string aztecText;
+	while (aztecText.size() < 1500)
+		aztecText += "Ticket 0123456789 zone A/B valid 2017-06-01, ";
+	auto aztecSymbol = std::make_shared<Aztec::EncodeResult>();
+	Aztec::Encoder::Encode(aztecText, Aztec::Encoder::DEFAULT_EC_PERCENT, 32, *aztecSymbol);
+	auto aztecBits = std::make_shared<BitMatrix>();
+	aztecSymbol->matrix.copyTo(*aztecBits);
+	auto aztecDetected = std::make_shared<Aztec::DetectorResult>();
+	aztecDetected->setBits(aztecBits);
+	aztecDetected->setCompact(aztecSymbol->compact);
+	aztecDetected->setNbLayers(aztecSymbol->layers);
+	aztecDetected->setNbDatablocks(aztecSymbol->codeWords);
+	benchmarks.push_back({"Aztec::Decoder", "32 layers", "modules", double(aztecSymbol->size) * aztecSymbol->size, [aztecDetected]() {
+		DecoderResult result;
+		sink += (int)Aztec::Decoder::Decode(*aztecDetected, result);
+	}});
+
+	// A boarding pass sized payload of 4000 characters, mixing all text modes with some binary bytes.
+	std::string boardingPass;
+	for (int i = 0; boardingPass.size() < 4000; ++i)
+		boardingPass += "M1DOE/JOHN E ABC123 LHRJFKBA 0175 123Y012A0001 seat 12a, gate b7. " + std::string(1, char(0x80 + i % 64));
+	benchmarks.push_back({"Aztec::HighLevelEncoder", "4000 characters", "characters", double(boardingPass.size()), [boardingPass]() {
+		BitArray bits;
+		Aztec::HighLevelEncoder::Encode(boardingPass, bits);
+		sink += bits.size();
+	}});
+
+	// 1000 characters of upper case, lower case, digits and EDIFACT punctuation, i.e. with many mode changes.
+	std::wstring shippingLabel;
+	while (shippingLabel.size() < 1000)
+		shippingLabel += L"SHIP TO 4711 ACME CORP 0012345678 attn: receiving dock 3, ORDER/REF:AB-12*77>X ";
+	shippingLabel.resize(1000);
+	benchmarks.push_back({"DataMatrix::HighLevelEncoder", "1000 characters minimal", "characters", double(shippingLabel.size()), [shippingLabel]() {
+		std::vector<int> codewords;
+		DataMatrix::HighLevelEncoder::EncodeMinimal(shippingLabel, DataMatrix::SymbolShape::NONE, -1, -1, -1, -1, codewords);
+		sink += codewords.size();
+	}});
+	benchmarks.push_back({"DataMatrix::HighLevelEncoder", "1000 characters legacy", "characters", double(shippingLabel.size()), [shippingLabel]() {
+		std::vector<int> codewords;
+		DataMatrix::HighLevelEncoder::Encode(shippingLabel, DataMatrix::SymbolShape::NONE, -1, -1, -1, -1, codewords);
+		sink += codewords.size();
+	}});
+
+	// A numeric payload, e.g. a list of tracking numbers, in numeric compaction: 20 groups of 44 digits.
+	std::wstring digits;
+	for (int i = 0; i < 880; ++i)
+		digits += L"0123456789"[(i * 7 + i / 10) % 10];
+	benchmarks.push_back({"Pdf417::HighLevelEncoder", "880 digits", "digits", double(digits.size()), [digits]() {
+		std::vector<int> highLevel;
+		Pdf417::HighLevelEncoder::EncodeHighLevel(digits, Pdf417::Compaction::NUMERIC, CharacterSet::ISO8859_1, highLevel);
+		sink += highLevel.size();
+	}});
+	auto numericCodewords = std::make_shared<std::vector<int>>(1);
+	Pdf417::HighLevelEncoder::EncodeHighLevel(digits, Pdf417::Compaction::NUMERIC, CharacterSet::ISO8859_1, *numericCodewords);
+	(*numericCodewords)[0] = int(numericCodewords->size());
+	benchmarks.push_back({"Pdf417::DecodedBitStreamParser", "880 digits", "digits", double(digits.size()), [numericCodewords]() {
+		DecoderResult result;
+		sink += (int)Pdf417::DecodedBitStreamParser::Decode(*numericCodewords, 2, result);
+	}});
+
+	// Print output of the version 40 symbol at 20 pixels per module, i.e. about 3700 x 3700 pixels.
+	auto qrModules = std::make_shared<BitMatrix>();
+	QRCode::Writer().setVersion(40).encode(longText, 0, 0, *qrModules);
+	double rasterPixels = qrModules->width() * 20.0 * qrModules->height() * 20.0;
+	auto byteCount = [](const uint8_t*, size_t size) { sink += size; };
+	benchmarks.push_back({"RasterWriter", "PBM", "pixels", rasterPixels, [qrModules, byteCount]() { RasterWriter::WritePBM(*qrModules, 20, byteCount); }});
+	benchmarks.push_back({"RasterWriter", "PGM", "pixels", rasterPixels, [qrModules, byteCount]() { RasterWriter::WritePGM(*qrModules, 20, byteCount); }});
+	benchmarks.push_back({"RasterWriter", "PNG", "pixels", rasterPixels, [qrModules, byteCount]() { RasterWriter::WritePNG(*qrModules, 20, byteCount); }});
+
+	writer("QRCode", longText, [](const std::wstring& s, BitMatrix& b) { QRCode::Writer().encode(s, 0, 0, b); });
+	writer("QRCode version 40", longText, [](const std::wstring& s, BitMatrix& b) { QRCode::Writer().setVersion(40).encode(s, 0, 0, b); });
+	writer("DataMatrix", longText, [](const std::wstring& s, BitMatrix& b) { DataMatrix::Writer().encode(s, 0, 0, b); });
+	writer("Aztec", longText, [](const std::wstring& s, BitMatrix& b) { Aztec::Writer().encode(s, 0, 0, b); });
+	writer("PDF417", longText, [](const std::wstring& s, BitMatrix& b) { Pdf417::Writer().encode(s, 0, 0, b); });
+	writer("Codabar", L"A0123456789-$:/.+B", [](const std::wstring& s, BitMatrix& b) { OneD::CodabarWriter().encode(s, 0, 0, b); });
+	writer("Code39", L"ZXING BENCHMARK 0123", [](const std::wstring& s, BitMatrix& b) { OneD::Code39Writer().encode(s, 0, 0, b); });
+	writer("Code93", L"ZXING BENCHMARK 0123", [](const std::wstring& s, BitMatrix& b) { OneD::Code93Writer().encode(s, 0, 0, b); });
+	writer("Code128", L"ZXing Benchmark 0123456789", [](const std::wstring& s, BitMatrix& b) { OneD::Code128Writer().encode(s, 0, 0, b); });
+	writer("EAN8", L"9638507", [](const std::wstring& s, BitMatrix& b) { OneD::EAN8Writer().encode(s, 0, 0, b); });
+	writer("EAN13", L"590123412345", [](const std::wstring& s, BitMatrix& b) { OneD::EAN13Writer().encode(s, 0, 0, b); });
+	writer("ITF", L"00123456789012", [](const std::wstring& s, BitMatrix& b) { OneD::ITFWriter().encode(s, 0, 0, b); });
+	writer("UPCA", L"48512343955", [](const std::wstring& s, BitMatrix& b) { OneD::UPCAWriter().encode(s, 0, 0, b); });
+	writer("UPCE", L"0123456", [](const std::wstring& s, BitMatrix& b) { OneD::UPCEWriter().encode(s, 0, 0, b); });
+
+	// A batch of 256 shipping labels, on one and on four threads.
+	auto labels = std::make_shared<std::vector<std::wstring>>();
+	for (int i = 0; i < 256; ++i)
+		labels->push_back(L"https://example.com/track?id=" + std::to_wstring(1000000 + i * 7919));
+	for (int threads : {1, 4}) {
+		benchmarks.push_back({"BatchWriter", "QRCode " + std::to_string(threads) + " thread(s)", "symbols", double(labels->size()), [labels, threads]() {
+			QRCode::Writer writer;
+			BatchWriter batch([&writer](const std::wstring& s, BitMatrix& b) { writer.encode(s, 0, 0, b); });
+			batch.setThreadCount(threads).encode(*labels, [](int, const BitMatrix& symbol) { sink += symbol.width(); });
+		}});
+	}
+
+	// A form with four PDF417 symbols stacked on top of each other at 3 pixels per module, read at once on one
+	// and on four threads.
+	std::vector<BitMatrix> formSymbols(4);
+	int formWidth = 0;
+	int formHeight = 0;
+	for (int i = 0; i < 4; ++i) {
+		Pdf417::Writer().setMargin(10).encode(longText.substr(i * 40, 200), 0, 0, formSymbols[i]);
+		formWidth = std::max(formWidth, 3 * formSymbols[i].width());
+		formHeight += 3 * formSymbols[i].height();
+	}
+	auto formPixels = std::make_shared<ByteArray>(formWidth * formHeight);
+	std::fill(formPixels->begin(), formPixels->end(), 255);
+	int formTop = 0;
+	for (auto& symbol : formSymbols) {
+		for (int y = 0; y < 3 * symbol.height(); ++y)
+			for (int x = 0; x < 3 * symbol.width(); ++x)
+				if (symbol.get(x / 3, y / 3))
+					(*formPixels)[(formTop + y) * formWidth + x] = 0;
+		formTop += 3 * symbol.height();
+	}
+	auto form = std::make_shared<HybridBinarizer>(std::make_shared<GenericLuminanceSource>(0, 0, formWidth, formHeight, formPixels, formWidth));
+	form->getBlackMatrix();
+	for (int threads : {1, 4}) {
+		benchmarks.push_back({"Pdf417::Reader", "decodeMultiple 4 symbols " + std::to_string(threads) + " thread(s)", "symbols", 4, [form, threads]() {
+			sink += Pdf417::Reader().setThreadCount(threads).decodeMultiple(*form).size();
+		}});
+	}
+#endif
+
+	return benchmarks;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <test path prefix> [-filter <substring>] [-time <seconds per benchmark>]\n";
+		return 1;
+	}
+
+	std::string filter;
+	double minSeconds = 0.5;
+	for (int i = 2; i + 1 < argc; i += 2) {
+		if (std::string(argv[i]) == "-filter")
+			filter = argv[i + 1];
+		else if (std::string(argv[i]) == "-time")
+			minSeconds = std::atof(argv[i + 1]);
+	}
+
+	try {
+		auto benchmarks = createBenchmarks(argv[1]);
+		bool first = true;
+		std::cout << "{\n\t\"benchmarks\": [";
+		for (auto& b : benchmarks) {
+			if (!filter.empty() && (b.stage + " " + b.name).find(filter) == std::string::npos)
+				continue;
+			auto m = run(b.op, minSeconds);
+			std::cout << (first ? "\n" : ",\n") << "\t\t{ \"stage\": \"" << jsonEscape(b.stage) << "\", \"name\": \""
+					  << jsonEscape(b.name) << "\", \"iterations\": " << m.iterations << ", \"ns_per_op\": " << m.nsPerOp
+					  << ", \"throughput\": " << b.unitsPerOp * 1e9 / m.nsPerOp << ", \"unit\": \"" << b.unit << "/s\" }";
+			std::cout.flush();
+			first = false;
+		}
+		std::cout << "\n\t]\n}\n";
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
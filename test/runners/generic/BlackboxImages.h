@@ -0,0 +1,76 @@
+#pragma once
+/*
+* Copyright 2016 Nu-book Inc.
+* Copyright 2017 Axel Waggershauser
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "GenericLuminanceSource.h"
+#include "ByteArray.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+namespace ZXing {
+namespace Test {
+
+namespace fs = boost::filesystem;
+
+inline std::vector<fs::path> getImagesInDirectory(const fs::path& dirPath)
+{
+	std::vector<fs::path> result;
+	for (fs::directory_iterator i(dirPath); i != fs::directory_iterator(); ++i)
+		if (is_regular_file(i->status()) && i->path().extension() == ".png")
+			result.push_back(i->path());
+	return result;
+}
+
+inline std::shared_ptr<LuminanceSource> readPNM(FILE* f)
+{
+	int w, h;
+	if (fscanf(f, "P5\n%d %d\n255\n", &w, &h) != 2)
+		throw std::runtime_error("Failed to parse PNM file header.");
+	auto ba = std::make_shared<ByteArray>(w * h);
+	auto read = fread(ba->data(), sizeof(uint8_t), w*h, f);
+//	if (read != w * h)
+//		throw std::runtime_error("Failed to read PNM file data: " + std::to_string(read) + " != " + std::to_string(w * h) + " -> " + std::to_string(feof(f)));
+	return std::make_shared<GenericLuminanceSource>(0, 0, w, h, ba, w);
+}
+
+inline std::shared_ptr<LuminanceSource> readImage(const fs::path& filename)
+{
+	std::string cmd = "convert " + filename.native() + " -intensity Rec601Luma -colorspace gray pgm:-";
+	bool pipe = filename.extension() != ".pgm";
+	FILE* f = pipe ? popen(cmd.c_str(), "r") : fopen(filename.c_str(), "r");
+	if (!f)
+		throw std::runtime_error("Failed to open pipe '" + cmd + "': " + std::strerror(errno));
+	try {
+		auto res = readPNM(f);
+		pipe ? pclose(f) : fclose(f);
+		return res;
+	} catch (std::runtime_error& e) {
+		pipe ? pclose(f) : fclose(f);
+		throw std::runtime_error("Failed to read pipe '" + cmd + "': " + e.what());
+	}
+}
+
+} // Test
+} // ZXing
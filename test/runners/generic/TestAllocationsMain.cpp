@@ -0,0 +1,359 @@
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "ReedSolomonDecoder.h"
+#include "GenericGF.h"
+#include "GridSampler.h"
+#include "PerspectiveTransform.h"
+#include "BitMatrix.h"
+#include "DecodeStatus.h"
+#include "DecodeHints.h"
+#include "BarcodeFormat.h"
+#include "HybridBinarizer.h"
+#include "Result.h"
+#include "DecoderResult.h"
+#include "qrcode/QRReader.h"
+#include "datamatrix/DMReader.h"
+#include "aztec/AZReader.h"
+#include "aztec/AZDecoder.h"
+#include "aztec/AZDetectorResult.h"
+#include "pdf417/PDFReader.h"
+#include "maxicode/MCReader.h"
+#include "oned/ODReader.h"
+#include "BlackboxImages.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Counting replacements of the global allocation functions. All other forms of operator new/delete
+// (array, nothrow) are implemented by the standard library on top of these. Every block starts with
+// the number of the decode it was allocated in, so that freeing it before that decode returned is
+// counted as a temporary.
+static const std::size_t HEADER_SIZE = alignof(std::max_align_t);
+static std::atomic<long long> allocationCount(0);
+static std::atomic<long long> allocatedBytes(0);
+static std::atomic<long long> temporaryCount(0);
+static std::atomic<int> currentDecode(0); // 0 while no decode is running
+
+void* operator new(std::size_t size)
+{
+	++allocationCount;
+	allocatedBytes += size;
+	if (auto block = static_cast<char*>(std::malloc(size + HEADER_SIZE))) {
+		*reinterpret_cast<int*>(block) = currentDecode.load();
+		return block + HEADER_SIZE;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	if (p == nullptr)
+		return;
+	auto block = static_cast<char*>(p) - HEADER_SIZE;
+	int decode = *reinterpret_cast<int*>(block);
+	if (decode != 0 && decode == currentDecode.load())
+		++temporaryCount;
+	std::free(block);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	operator delete(p);
+}
+
+using namespace ZXing;
+using namespace ZXing::Test;
+
+static const char* GOOD = "OK";
+static const char* BAD = "!!!!!! FAILED !!!!!!";
+
+static const int WARMUP_RUNS = 10;
+static const int TEST_RUNS = 100;
+
+// Returns the average number of allocations per call of func, after a few warm-up calls.
+static double allocationsPerRun(const std::function<bool()>& func, bool& ok)
+{
+	for (int i = 0; i < WARMUP_RUNS; ++i)
+		ok = func() && ok;
+	auto start = allocationCount.load();
+	for (int i = 0; i < TEST_RUNS; ++i)
+		ok = func() && ok;
+	return double(allocationCount.load() - start) / TEST_RUNS;
+}
+
+static bool check(const std::string& name, const std::function<bool()>& func, double maxAllocations)
+{
+	bool ok = true;
+	double allocations = allocationsPerRun(func, ok);
+	bool passed = ok && allocations <= maxAllocations;
+	std::cout << "TEST " << name << ": allocations per run: " << allocations << ", max: " << maxAllocations
+	          << (ok ? "" : ", decoding failed") << " => " << (passed ? GOOD : BAD) << "\n";
+	return passed;
+}
+
+// The all-zero word is a valid codeword of every RS code, so damaging a few positions of it gives
+// a test case that must be corrected back to all zeros.
+static bool checkReedSolomon(const std::string& name, const GenericGF& field, int numCodewords, int numECCodewords)
+{
+	std::vector<int> received(numCodewords);
+	bool passed = true;
+	for (auto algorithm : {ReedSolomonDecoder::Algorithm::Euclidean, ReedSolomonDecoder::Algorithm::BerlekampMassey}) {
+		auto algorithmName = algorithm == ReedSolomonDecoder::Algorithm::Euclidean ? " (Euclidean)" : " (BerlekampMassey)";
+		passed &= check("ReedSolomonDecoder " + name + algorithmName, [&]() {
+			std::fill(received.begin(), received.end(), 0);
+			for (int i = 0; i < numECCodewords / 2; ++i)
+				received[(i * 7) % numCodewords] = (i * 13 + 1) % field.size();
+			if (StatusIsError(ReedSolomonDecoder(field, algorithm).decode(received, numECCodewords)))
+				return false;
+			return std::all_of(received.begin(), received.end(), [](int c) { return c == 0; });
+		}, 0);
+		std::vector<int> erasures(numECCodewords * 3 / 4);
+		std::iota(erasures.begin(), erasures.end(), 0);
+		passed &= check("ReedSolomonDecoder " + name + " erasures" + algorithmName, [&]() {
+			std::fill(received.begin(), received.end(), 0);
+			for (int i : erasures)
+				received[i] = (i * 13 + 1) % field.size();
+			if (StatusIsError(ReedSolomonDecoder(field, algorithm).decode(received, numECCodewords, erasures)))
+				return false;
+			return std::all_of(received.begin(), received.end(), [](int c) { return c == 0; });
+		}, 0);
+	}
+	return passed;
+}
+
+static std::unique_ptr<Reader> createReader(BarcodeFormat format)
+{
+	DecodeHints hints;
+	hints.setPossibleFormats({format});
+	switch (format) {
+	case BarcodeFormat::QR_CODE: return std::unique_ptr<Reader>(new QRCode::Reader(hints));
+	case BarcodeFormat::DATA_MATRIX: return std::unique_ptr<Reader>(new DataMatrix::Reader(hints));
+	case BarcodeFormat::AZTEC: return std::unique_ptr<Reader>(new Aztec::Reader(hints));
+	case BarcodeFormat::PDF_417: return std::unique_ptr<Reader>(new Pdf417::Reader());
+	case BarcodeFormat::MAXICODE: return std::unique_ptr<Reader>(new MaxiCode::Reader());
+	default: return std::unique_ptr<Reader>(new OneD::Reader(hints));
+	}
+}
+
+struct Allocations
+{
+	int decodes = 0;
+	int failures = 0;
+	long long count = 0;
+	long long bytes = 0;
+	long long temporaries = 0;
+
+	long long countPerDecode() const { return decodes ? (count + decodes - 1) / decodes : 0; }
+	long long bytesPerDecode() const { return decodes ? (bytes + decodes - 1) / decodes : 0; }
+};
+
+// Decodes every image of the given directory with the reader for the given format and adds the
+// allocations of the second run (the first one initializes static tables and scratch memory).
+// Temporaries are the blocks that were allocated and freed again within reader->decode(), what is
+// left is owned by the Result and by the binarizer.
+static void measureDirectory(const fs::path& directory, const char* formatName, Allocations& allocations)
+{
+	static int lastDecode = 0;
+	auto format = FromString(formatName);
+	auto reader = createReader(format);
+	for (const fs::path& imagePath : getImagesInDirectory(directory)) {
+		auto source = readImage(imagePath);
+		for (int run = 0; run < 2; ++run) {
+			auto startCount = allocationCount.load();
+			auto startBytes = allocatedBytes.load();
+			auto startTemporaries = temporaryCount.load();
+			bool decoded;
+			{
+				HybridBinarizer binImg(source);
+				currentDecode = ++lastDecode;
+				Result result = reader->decode(binImg);
+				currentDecode = 0;
+				decoded = result.isValid();
+			}
+			if (run == 1) {
+				allocations.decodes++;
+				allocations.failures += !decoded;
+				allocations.count += allocationCount.load() - startCount;
+				allocations.bytes += allocatedBytes.load() - startBytes;
+				allocations.temporaries += temporaryCount.load() - startTemporaries;
+			}
+		}
+	}
+}
+
+// The baseline is a text file with one line 'FORMAT allocations-per-decode bytes-per-decode' per format.
+static std::map<std::string, Allocations> readBaseline(const fs::path& filename)
+{
+	std::map<std::string, Allocations> result;
+	std::ifstream in(filename.native());
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::istringstream ls(line);
+		std::string format;
+		Allocations a;
+		a.decodes = 1;
+		if (ls >> format >> a.count >> a.bytes)
+			result[format] = a;
+	}
+	return result;
+}
+
+static void writeBaseline(const fs::path& filename, const std::map<std::string, Allocations>& measured)
+{
+	std::ofstream out(filename.native());
+	out << "# Heap allocations per decode of the blackbox images, see TestAllocationsMain.cpp\n";
+	out << "# format allocations-per-decode bytes-per-decode\n";
+	for (auto& m : measured)
+		out << m.first << ' ' << m.second.countPerDecode() << ' ' << m.second.bytesPerDecode() << "\n";
+}
+
+// The steady-state decode is deterministic, so any allocation above the baseline is a regression.
+// The counts still depend on the standard library implementation; when a change to them is
+// intended, regenerate the baseline with -update.
+static bool withinBaseline(const Allocations& measured, const Allocations& baseline)
+{
+	return measured.countPerDecode() <= baseline.count && measured.bytesPerDecode() <= baseline.bytes;
+}
+
+static bool runBlackboxTests(const fs::path& pathPrefix, bool updateBaseline)
+{
+	static const std::vector<std::pair<const char*, const char*>> TESTS = {
+		{"aztec-1", "AZTEC"}, {"aztec-2", "AZTEC"},
+		{"datamatrix-1", "DATA_MATRIX"}, {"datamatrix-2", "DATA_MATRIX"},
+		{"maxicode-1", "MAXICODE"},
+		{"pdf417-1", "PDF_417"}, {"pdf417-2", "PDF_417"}, {"pdf417-3", "PDF_417"},
+		{"qrcode-1", "QR_CODE"}, {"qrcode-2", "QR_CODE"}, {"qrcode-3", "QR_CODE"},
+		{"qrcode-4", "QR_CODE"}, {"qrcode-5", "QR_CODE"}, {"qrcode-6", "QR_CODE"},
+		{"codabar-1", "CODABAR"},
+		{"code39-1", "CODE_39"}, {"code39-3", "CODE_39"},
+		{"code93-1", "CODE_93"},
+		{"code128-1", "CODE_128"}, {"code128-2", "CODE_128"}, {"code128-3", "CODE_128"},
+		{"ean8-1", "EAN_8"},
+		{"ean13-1", "EAN_13"}, {"ean13-2", "EAN_13"}, {"ean13-3", "EAN_13"}, {"ean13-4", "EAN_13"},
+		{"itf-1", "ITF"}, {"itf-2", "ITF"},
+		{"upca-1", "UPC_A"}, {"upca-2", "UPC_A"}, {"upca-3", "UPC_A"},
+		{"upce-1", "UPC_E"}, {"upce-2", "UPC_E"}, {"upce-3", "UPC_E"},
+		{"rss14-1", "RSS_14"}, {"rss14-2", "RSS_14"},
+		{"rssexpanded-1", "RSS_EXPANDED"}, {"rssexpanded-2", "RSS_EXPANDED"}, {"rssexpanded-3", "RSS_EXPANDED"},
+	};
+
+	std::map<std::string, Allocations> measured;
+	for (auto& test : TESTS)
+		measureDirectory(pathPrefix / "blackbox" / test.first, test.second, measured[test.second]);
+
+	auto baselineFile = pathPrefix / "runners" / "generic" / "AllocationBaseline.txt";
+	if (updateBaseline) {
+		writeBaseline(baselineFile, measured);
+		std::cout << "Baseline written to " << baselineFile << std::endl;
+		return true;
+	}
+
+	auto baseline = readBaseline(baselineFile);
+	bool passed = true;
+	for (auto& m : measured) {
+		auto& a = m.second;
+		auto b = baseline.find(m.first);
+		bool ok = a.temporaries == 0 && b != baseline.end() && withinBaseline(a, b->second);
+		std::cout << "TEST " << std::left << std::setw(13) << m.first << " images: " << std::setw(4) << a.decodes
+		          << " failed: " << std::setw(4) << a.failures << " temporaries: " << std::setw(4) << a.temporaries
+		          << " allocations/decode: " << std::setw(6) << a.countPerDecode() << " bytes/decode: " << std::setw(9)
+		          << a.bytesPerDecode();
+		if (b != baseline.end())
+			std::cout << " (baseline: " << b->second.count << " / " << b->second.bytes << ")";
+		else
+			std::cout << " (no baseline)";
+		std::cout << " => " << (ok ? GOOD : BAD) << "\n";
+		passed &= ok;
+	}
+	return passed;
+}
+
+int main(int argc, char** argv)
+{
+	bool passed = true;
+
+	passed &= checkReedSolomon("QRCodeField256", GenericGF::QRCodeField256(), 255, 68);
+	passed &= checkReedSolomon("DataMatrixField256", GenericGF::DataMatrixField256(), 174, 68);
+	passed &= checkReedSolomon("AztecData6", GenericGF::AztecData6(), 63, 20);
+	passed &= checkReedSolomon("AztecData10", GenericGF::AztecData10(), 1000, 300);
+	passed &= checkReedSolomon("AztecData12", GenericGF::AztecData12(), 1400, 400);
+	passed &= checkReedSolomon("MaxiCodeField64", GenericGF::MaxiCodeField64(), 62, 30);
+
+	// The sampled matrix itself is the only allocation left in sampleGrid, and it is reused if it
+	// already has the right size.
+	BitMatrix image(400, 400);
+	image.setRegion(100, 100, 200, 200);
+	const GridSampler& sampler = GridSampler::Default();
+	auto transform = PerspectiveTransform::QuadrilateralToQuadrilateral(
+		0, 0, 177, 0, 177, 177, 0, 177, 50, 50, 350, 60, 340, 350, 60, 340);
+	passed &= check("GridSampler 177x177", [&]() {
+		BitMatrix bits;
+		return StatusIsOK(sampler.sampleGrid(image, 177, 177, transform, bits));
+	}, 1);
+	BitMatrix sampled;
+	passed &= check("GridSampler 177x177 reused", [&]() {
+		return StatusIsOK(sampler.sampleGrid(image, 177, 177, transform, sampled));
+	}, 0);
+
+	// The Aztec decoder keeps all its temporaries in the DecodeContext, only a successful decode
+	// allocates the result. Random modules fail the error correction.
+	auto aztecBits = std::make_shared<BitMatrix>(31, 31);
+	unsigned seed = 1;
+	for (int y = 0; y < 31; ++y)
+		for (int x = 0; x < 31; ++x)
+			if (((seed = seed * 1103515245 + 12345) >> 16) & 1)
+				aztecBits->set(x, y);
+	Aztec::DetectorResult aztecDetectorResult;
+	aztecDetectorResult.setBits(aztecBits);
+	aztecDetectorResult.setCompact(false);
+	aztecDetectorResult.setNbLayers(4);
+	aztecDetectorResult.setNbDatablocks(40);
+	passed &= check("Aztec::Decoder 31x31 uncorrectable", [&]() {
+		DecoderResult result;
+		return StatusIsError(Aztec::Decoder::Decode(aztecDetectorResult, result));
+	}, 0);
+
+	// With a test path prefix given, additionally decode the blackbox images with all readers. No
+	// reader may free memory it allocated within the same decode, successful or not, and what the
+	// results keep is compared against the checked-in baseline. Use -update to rewrite the baseline.
+	if (argc > 1) {
+		try {
+			bool update = argc > 2 && std::string(argv[2]) == "-update";
+			passed &= runBlackboxTests(argv[1], update);
+		} catch (const std::exception& e) {
+			std::cout << e.what() << std::endl;
+			passed = false;
+		}
+	}
+
+	std::cout << (passed ? "All allocation tests passed." : "Some allocation tests failed.") << std::endl;
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,724 @@
+/*
+* Copyright 2017 Nu-book Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "GenericLuminanceSource.h"
+#include "ByteArray.h"
+#include "BitMatrix.h"
+#include "DecodeStatus.h"
+#include "GridSampler.h"
+#include "HybridBinarizer.h"
+#include "LuminanceGridSampler.h"
+#include "PerspectiveTransform.h"
+#include "pdf417/PDFCodewordDecoder.h"
+
+#ifdef ZXING_TEST_ENCODERS
+#include "BatchWriter.h"
+#include "BitArray.h"
+#include "ByteMatrix.h"
+#include "DecoderResult.h"
+#include "GenericGF.h"
+#include "RasterWriter.h"
+#include "ReedSolomonDecoder.h"
+#include "ReedSolomonEncoder.h"
+#include "qrcode/QRWriter.h"
+#include "qrcode/QRErrorCorrectionLevel.h"
+#include "qrcode/QRMaskUtil.h"
+#include "qrcode/QRMatrixUtil.h"
+#include "qrcode/QRPackedMatrix.h"
+#include "qrcode/QRVersion.h"
+#include "datamatrix/DMDecoder.h"
+#include "datamatrix/DMHighLevelEncoder.h"
+#include "datamatrix/DMSymbolShape.h"
+#include "datamatrix/DMWriter.h"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ZXing;
+
+static const char* GOOD = "OK";
+static const char* BAD = "!!!!!! FAILED !!!!!!";
+
+static bool check(const std::string& name, bool ok)
+{
+	std::cout << "TEST " << name << " => " << (ok ? GOOD : BAD) << "\n";
+	return ok;
+}
+
+// Pixel (x, y) of the image rotated clockwise by 'degreeCW', computed directly from the original pixels.
+static uint8_t rotatedPixel(const ByteArray& pixels, int left, int top, int width, int height, int rowBytes, int degreeCW, int x, int y)
+{
+	int srcX = x, srcY = y;
+	switch (degreeCW) {
+	case 90: srcX = y; srcY = height - 1 - x; break;
+	case 180: srcX = width - 1 - x; srcY = height - 1 - y; break;
+	case 270: srcX = width - 1 - y; srcY = x; break;
+	}
+	return pixels[(top + srcY) * rowBytes + left + srcX];
+}
+
+// Compares the rows returned by the lazily rotated view with the materialized rotation as well as with
+// a rotation computed pixel by pixel. The crop offset, the row stride and a width that is no multiple
+// of the strip size make sure the view does not depend on a tightly packed source.
+static bool checkRotation(int degreeCW)
+{
+	const int rowBytes = 50, left = 3, top = 5, width = 37, height = 21;
+	auto pixels = std::make_shared<ByteArray>(rowBytes * (top + height));
+	for (size_t i = 0; i < pixels->size(); ++i)
+		(*pixels)[i] = static_cast<uint8_t>(i * 7 + i / rowBytes);
+	GenericLuminanceSource source(left, top, width, height, pixels, rowBytes);
+
+	bool passed = true;
+	auto expectedRow = [&](int y) {
+		ByteArray row(degreeCW == 180 ? width : height);
+		for (int x = 0; x < (int)row.size(); ++x)
+			row[x] = rotatedPixel(*pixels, left, top, width, height, rowBytes, degreeCW, x, y);
+		return row;
+	};
+
+	// rows in an order that switches between strips all the time
+	auto rotated = source.rotated(degreeCW);
+	ByteArray buffer;
+	for (int i = 0; i < rotated->height(); ++i) {
+		int y = (i * 11) % rotated->height();
+		auto expected = expectedRow(y);
+		passed &= std::equal(expected.begin(), expected.end(), rotated->getRow(y, buffer, false));
+		const uint8_t* copy = rotated->getRow(y, buffer, true);
+		passed &= copy == buffer.data() && std::equal(expected.begin(), expected.end(), copy);
+	}
+
+	// all rows of a fresh view read concurrently while the strips get filled
+	rotated = source.rotated(degreeCW);
+	std::vector<int> mismatches(4, 0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < (int)mismatches.size(); ++t) {
+		threads.emplace_back([&, t]() {
+			ByteArray rowBuffer;
+			for (int i = 0; i < rotated->height(); ++i) {
+				int y = (i + t * 5) % rotated->height();
+				auto expected = expectedRow(y);
+				if (!std::equal(expected.begin(), expected.end(), rotated->getRow(y, rowBuffer)))
+					mismatches[t]++;
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	passed &= std::all_of(mismatches.begin(), mismatches.end(), [](int m) { return m == 0; });
+
+	// the materialized rotation must match the rows of the view
+	int matrixRowBytes = 0;
+	ByteArray matrixBuffer;
+	const uint8_t* matrix = rotated->getMatrix(matrixBuffer, matrixRowBytes, false);
+	for (int y = 0; y < rotated->height(); ++y)
+		passed &= std::equal(matrix + y * matrixRowBytes, matrix + y * matrixRowBytes + rotated->width(), rotated->getRow(y, buffer));
+
+	return check("RotatedLuminanceSource " + std::to_string(degreeCW), passed);
+}
+
+using Pdf417::CodewordDecoder;
+using BarWidths = std::array<int, CodewordDecoder::BARS_IN_MODULE>;
+
+// The bar and space widths of a PDF417 symbol, from its most significant bit.
+static BarWidths pdf417BarWidths(int symbol)
+{
+	BarWidths widths;
+	for (int i = CodewordDecoder::BARS_IN_MODULE - 1; i >= 0; --i) {
+		int bit = symbol & 1;
+		for (widths[i] = 0; (symbol & 1) == bit && widths[i] < CodewordDecoder::MODULES_IN_CODEWORD; symbol >>= 1)
+			widths[i]++;
+	}
+	return widths;
+}
+
+// The closest match as the original linear scan over the ratio table finds it, which keeps the first symbol
+// on equal errors.
+static int pdf417ClosestByScan(const std::vector<int>& symbols, const BarWidths& moduleBitCount)
+{
+	float bitCountSum = 0;
+	for (int count : moduleBitCount)
+		bitCountSum += count;
+	float bestMatchError = std::numeric_limits<float>::max();
+	int bestMatch = -1;
+	for (int symbol : symbols) {
+		auto widths = pdf417BarWidths(symbol);
+		float error = 0.0f;
+		for (int k = 0; k < CodewordDecoder::BARS_IN_MODULE; k++) {
+			float diff = static_cast<float>(widths[k]) / CodewordDecoder::MODULES_IN_CODEWORD - moduleBitCount[k] / bitCountSum;
+			error += diff * diff;
+			if (error >= bestMatchError)
+				break;
+		}
+		if (error < bestMatchError) {
+			bestMatchError = error;
+			bestMatch = symbol;
+		}
+	}
+	return bestMatch;
+}
+
+// The prefix tree search for the closest symbol must find the same symbol as the linear scan, for random bar
+// widths as well as for widths halfway between two symbols, where the first symbol has to win.
+static bool checkPdf417ClosestCodeword()
+{
+	std::vector<int> symbols;
+	for (int symbol = 0; symbol < 0x20000; ++symbol)
+		if (CodewordDecoder::GetCodeword(symbol) != -1)
+			symbols.push_back(symbol);
+
+	std::vector<BarWidths> inputs = { BarWidths{} };
+	unsigned state = 7;
+	auto random = [&state](unsigned n) {
+		state = state * 1103515245u + 12345u;
+		return static_cast<int>((state >> 16) % n);
+	};
+	for (int i = 0; i < 2000; ++i) {
+		BarWidths counts;
+		int scale = 1 + random(4);
+		for (auto& count : counts)
+			count = random(6 * scale + 2);
+		inputs.push_back(counts);
+	}
+	// Move one module of a symbol scaled by two from one bar or space to another. That is as close to the
+	// symbol as to the one with a whole module moved, if there is one.
+	for (size_t i = 0; i < symbols.size(); i += 7) {
+		auto counts = pdf417BarWidths(symbols[i]);
+		for (auto& count : counts)
+			count *= 2;
+		int from = random(CodewordDecoder::BARS_IN_MODULE);
+		int to = random(CodewordDecoder::BARS_IN_MODULE);
+		counts[from]--;
+		counts[to]++;
+		inputs.push_back(counts);
+	}
+
+	int mismatches = 0;
+	for (const auto& counts : inputs)
+		mismatches += CodewordDecoder::GetClosestDecodedValue(counts) != pdf417ClosestByScan(symbols, counts);
+	return check("Pdf417::CodewordDecoder closest symbol", symbols.size() == 2787 && mismatches == 0);
+}
+
+// A synthetic grayscale image of a checkerboard grid, 4 pixels per module with a quiet zone of 4 modules. Every
+// 7th module is drawn with a level close to the middle of black and white instead of full contrast.
+static const int GRID_DIMENSION = 21;
+static const int GRID_MODULE_SIZE = 4;
+static const int GRID_QUIET_ZONE = 4;
+
+static bool gridModuleIsBlack(int x, int y) { return (x + y) % 2 == 1; }
+static bool gridModuleIsFaint(int x, int y) { return (y * GRID_DIMENSION + x) % 7 == 3; }
+
+static bool checkLuminanceGridSampler()
+{
+	int size = (GRID_DIMENSION + 2 * GRID_QUIET_ZONE) * GRID_MODULE_SIZE;
+	ByteArray pixels(size * size);
+	std::fill(pixels.begin(), pixels.end(), 230);
+	for (int y = 0; y < GRID_DIMENSION; ++y) {
+		for (int x = 0; x < GRID_DIMENSION; ++x) {
+			uint8_t level = gridModuleIsBlack(x, y) ? (gridModuleIsFaint(x, y) ? 118 : 30) : (gridModuleIsFaint(x, y) ? 142 : 230);
+			for (int j = 0; j < GRID_MODULE_SIZE; ++j) {
+				int row = (GRID_QUIET_ZONE + y) * GRID_MODULE_SIZE + j;
+				std::fill_n(&pixels[row * size + (GRID_QUIET_ZONE + x) * GRID_MODULE_SIZE], GRID_MODULE_SIZE, level);
+			}
+		}
+	}
+	auto source = std::make_shared<GenericLuminanceSource>(size, size, pixels.data(), size);
+	auto binarized = HybridBinarizer(source).getBlackMatrix();
+
+	float from = static_cast<float>(GRID_QUIET_ZONE * GRID_MODULE_SIZE);
+	float to = static_cast<float>((GRID_QUIET_ZONE + GRID_DIMENSION) * GRID_MODULE_SIZE);
+	float dimension = static_cast<float>(GRID_DIMENSION);
+	auto transform = PerspectiveTransform::QuadrilateralToQuadrilateral(
+		0, 0, dimension, 0, dimension, dimension, 0, dimension, from, from, to, from, to, to, from, to);
+
+	LuminanceGridSampler luminanceSampler(source);
+	BitMatrix luminanceBits, binarizedBits, uncertain;
+	bool passed = binarized != nullptr &&
+	              StatusIsOK(luminanceSampler.sampleGrid(*binarized, GRID_DIMENSION, GRID_DIMENSION, transform, luminanceBits)) &&
+	              StatusIsOK(GridSampler::Default().sampleGrid(*binarized, GRID_DIMENSION, GRID_DIMENSION, transform, binarizedBits));
+	if (!passed)
+		return check("LuminanceGridSampler", false);
+	luminanceSampler.findUncertainModules(*binarized, GRID_DIMENSION, GRID_DIMENSION, transform, uncertain);
+
+	// Every module must be read correctly from the luminance, the faint ones (and only those) reported as
+	// uncertain. The binarized path must agree on all modules of full contrast.
+	int wrong = 0, wrongUncertainty = 0, disagreements = 0;
+	for (int y = 0; y < GRID_DIMENSION; ++y) {
+		for (int x = 0; x < GRID_DIMENSION; ++x) {
+			wrong += luminanceBits.get(x, y) != gridModuleIsBlack(x, y);
+			wrongUncertainty += (uncertain.width() != 0 && uncertain.get(x, y)) != gridModuleIsFaint(x, y);
+			disagreements += !gridModuleIsFaint(x, y) && binarizedBits.get(x, y) != luminanceBits.get(x, y);
+		}
+	}
+	return check("LuminanceGridSampler", wrong == 0 && wrongUncertainty == 0 && disagreements == 0);
+}
+
+#ifdef ZXING_TEST_ENCODERS
+
+// Data words that are the same in every run.
+static std::vector<int> testWords(int count, int fieldSize, int seed)
+{
+	std::vector<int> words(count);
+	unsigned state = 12345u + seed;
+	for (auto& word : words) {
+		state = state * 1103515245u + 12345u;
+		word = (state >> 16) % fieldSize;
+	}
+	return words;
+}
+
+// A code word of the encoder must be accepted by the decoder unchanged, and errors at half its capacity
+// must be corrected back to it.
+static bool isCorrectCodeWord(const GenericGF& field, const std::vector<int>& encoded, int numECCodewords)
+{
+	ReedSolomonDecoder decoder(field);
+	auto received = encoded;
+	if (StatusIsError(decoder.decode(received, numECCodewords)) || received != encoded)
+		return false;
+	for (int i = 0; i < numECCodewords / 2; ++i)
+		received[(i * 7) % received.size()] ^= 1;
+	return StatusIsOK(decoder.decode(received, numECCodewords)) && received == encoded;
+}
+
+static bool checkReedSolomonEncoder(const std::string& name, const GenericGF& field)
+{
+	bool passed = true;
+	ReedSolomonEncoder encoder(field);
+	int maxCodewords = std::min(field.size() - 1, 255);
+	for (int numECCodewords : {2, 7, 10, 30, 68}) {
+		if (2 * numECCodewords > maxCodewords)
+			continue;
+		int numCodewords = std::min(numECCodewords * 3, maxCodewords);
+		auto encoded = testWords(numCodewords, field.size(), numECCodewords);
+		encoder.encode(encoded, numECCodewords);
+		passed &= isCorrectCodeWord(field, encoded, numECCodewords);
+	}
+	return check("ReedSolomonEncoder " + name, passed);
+}
+
+// One encoder used by several threads at once, each of which builds the generators in its own cache,
+// as well as copies of it, must give the same code words as the calling thread.
+static bool checkReedSolomonEncoderThreads()
+{
+	const GenericGF& field = GenericGF::QRCodeField256();
+	const ReedSolomonEncoder shared(field);
+	ReedSolomonEncoder copy(GenericGF::AztecData6());
+	copy = shared;
+
+	std::vector<std::vector<int>> expected;
+	for (int numECCodewords = 1; numECCodewords <= 68; ++numECCodewords) {
+		expected.push_back(testWords(numECCodewords * 2, field.size(), numECCodewords));
+		copy.encode(expected.back(), numECCodewords);
+	}
+
+	std::vector<int> mismatches(4, 0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < (int)mismatches.size(); ++t) {
+		threads.emplace_back([&, t]() {
+			// every thread asks for the degrees in a different order
+			for (int i = 0; i < (int)expected.size(); ++i) {
+				int numECCodewords = t % 2 ? 68 - i : i + 1;
+				auto encoded = testWords(numECCodewords * 2, field.size(), numECCodewords);
+				shared.encode(encoded, numECCodewords);
+				if (encoded != expected[numECCodewords - 1])
+					mismatches[t]++;
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	return check("ReedSolomonEncoder threads", std::all_of(mismatches.begin(), mismatches.end(), [](int m) { return m == 0; }));
+}
+
+// A batch encoded on several threads must give the same symbols as one encoded on the calling thread only.
+static bool checkBatchWriter()
+{
+	QRCode::Writer writer;
+	BatchWriter batch([&writer](const std::wstring& contents, BitMatrix& output) { writer.encode(contents, 0, 0, output); });
+
+	std::vector<std::wstring> contents;
+	for (int i = 0; i < 64; ++i)
+		contents.push_back(L"LABEL-" + std::wstring(i * 5, L'0' + i % 10) + std::to_wstring(i));
+
+	auto encodeAll = [&](int threadCount) {
+		std::vector<BitMatrix> symbols(contents.size());
+		batch.setThreadCount(threadCount).encode(contents, [&symbols](int index, const BitMatrix& symbol) { symbol.copyTo(symbols[index]); });
+		return symbols;
+	};
+	auto expected = encodeAll(1);
+	auto symbols = encodeAll(4);
+	bool passed = expected.size() == symbols.size();
+	for (size_t i = 0; passed && i < symbols.size(); ++i)
+		passed &= expected[i].width() != 0 && expected[i] == symbols[i];
+	return check("BatchWriter threads", passed);
+}
+
+using QRPenalties = std::array<int, 4>;
+
+static QRPenalties qrPenalties(const ByteMatrix& matrix)
+{
+	using QRCode::MaskUtil;
+	return {{MaskUtil::ApplyMaskPenaltyRule1(matrix), MaskUtil::ApplyMaskPenaltyRule2(matrix),
+			 MaskUtil::ApplyMaskPenaltyRule3(matrix), MaskUtil::ApplyMaskPenaltyRule4(matrix)}};
+}
+
+static QRPenalties qrPenalties(const QRCode::PackedMatrix& matrix)
+{
+	using QRCode::MaskUtil;
+	return {{MaskUtil::ApplyMaskPenaltyRule1(matrix), MaskUtil::ApplyMaskPenaltyRule2(matrix),
+			 MaskUtil::ApplyMaskPenaltyRule3(matrix), MaskUtil::ApplyMaskPenaltyRule4(matrix)}};
+}
+
+static int qrBestMask(const std::vector<QRPenalties>& penalties)
+{
+	int best = 0;
+	for (int i = 1; i < static_cast<int>(penalties.size()); ++i)
+		if (std::accumulate(penalties[i].begin(), penalties[i].end(), 0) < std::accumulate(penalties[best].begin(), penalties[best].end(), 0))
+			best = i;
+	return best;
+}
+
+// The penalty rules on the packed matrix must give the same penalties as on the ByteMatrix, for random
+// matrices of all sizes and densities (long runs and blocks included), and the packed matrices of all
+// masks must equal the ByteMatrix ones, so that the same mask is chosen.
+static bool checkQRMaskPenalties()
+{
+	unsigned state = 5;
+	auto random = [&state](unsigned n) {
+		state = state * 1103515245u + 12345u;
+		return static_cast<int>((state >> 16) % n);
+	};
+
+	int mismatches = 0;
+	for (int i = 0; i < 300; ++i) {
+		int width = 1 + random(180);
+		int height = i % 3 == 0 ? width : 1 + random(180);
+		int density = 1 + random(15);
+		ByteMatrix bytes(width, height);
+		QRCode::PackedMatrix packed(width, height);
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				bool dark = random(16) < density;
+				bytes.set(x, y, dark);
+				packed.set(x, y, dark);
+			}
+		}
+		mismatches += qrPenalties(bytes) != qrPenalties(packed);
+	}
+
+	int chosenMismatches = 0;
+	for (int versionNumber = 1; versionNumber <= 40; versionNumber += 3) {
+		const QRCode::Version* version = QRCode::Version::VersionForNumber(versionNumber);
+		for (auto ecLevel : {QRCode::ErrorCorrectionLevel::Low, QRCode::ErrorCorrectionLevel::High}) {
+			BitArray dataBits;
+			for (int i = 0; i < version->totalCodewords(); ++i)
+				dataBits.appendBits(random(256), 8);
+			std::vector<QRCode::PackedMatrix> matrices;
+			QRCode::MatrixUtil::BuildMatrices(dataBits, ecLevel, *version, matrices);
+			std::vector<QRPenalties> expected, actual;
+			for (int mask = 0; mask < QRCode::MatrixUtil::NUM_MASK_PATTERNS; ++mask) {
+				ByteMatrix bytes(version->dimensionForVersion(), version->dimensionForVersion());
+				QRCode::MatrixUtil::BuildMatrix(dataBits, ecLevel, *version, mask, bytes);
+				for (int y = 0; y < bytes.height(); ++y)
+					for (int x = 0; x < bytes.width(); ++x)
+						mismatches += (bytes.get(x, y) == 1) != matrices[mask].get(x, y);
+				expected.push_back(qrPenalties(bytes));
+				actual.push_back(qrPenalties(matrices[mask]));
+			}
+			mismatches += expected != actual;
+			chosenMismatches += qrBestMask(expected) != qrBestMask(actual);
+		}
+	}
+	return check("QRCode::MaskUtil packed penalties", mismatches == 0 && chosenMismatches == 0);
+}
+
+// The image files are parsed here independently of RasterWriter: bitwise CRC-32 and Adler-32, and the stored
+// deflate blocks are unpacked by their headers.
+using RasterFile = std::vector<uint8_t>;
+
+static RasterFile writeRaster(void (*write)(const BitMatrix&, int, const RasterWriter::Sink&), const BitMatrix& modules, int scale)
+{
+	RasterFile file;
+	write(modules, scale, [&file](const uint8_t* data, size_t size) { file.insert(file.end(), data, data + size); });
+	return file;
+}
+
+static uint32_t readBigEndian(const uint8_t* p)
+{
+	return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+static uint32_t bitwiseCrc32(const uint8_t* data, size_t size)
+{
+	uint32_t crc = 0xffffffff;
+	for (size_t i = 0; i < size; ++i) {
+		crc ^= data[i];
+		for (int k = 0; k < 8; ++k)
+			crc = (crc & 1) ? 0xedb88320u ^ (crc >> 1) : crc >> 1;
+	}
+	return crc ^ 0xffffffff;
+}
+
+static uint32_t adler32(const std::vector<uint8_t>& data)
+{
+	uint32_t a = 1, b = 0;
+	for (uint8_t c : data) {
+		a = (a + c) % 65521;
+		b = (b + a) % 65521;
+	}
+	return (b << 16) | a;
+}
+
+// Checks the header "magic\nwidth height\n" + extra and returns the offset of the pixel data, or 0.
+static size_t checkNetpbmHeader(const RasterFile& file, const std::string& magic, int width, int height, const std::string& extra)
+{
+	auto header = magic + "\n" + std::to_string(width) + ' ' + std::to_string(height) + "\n" + extra;
+	return file.size() >= header.size() && std::equal(header.begin(), header.end(), file.begin()) ? header.size() : 0;
+}
+
+static bool checkPBM(const BitMatrix& modules, int scale)
+{
+	int width = modules.width() * scale, height = modules.height() * scale, rowBytes = (width + 7) / 8;
+	auto file = writeRaster(&RasterWriter::WritePBM, modules, scale);
+	size_t offset = checkNetpbmHeader(file, "P4", width, height, "");
+	if (offset == 0 || file.size() != offset + size_t(rowBytes) * height)
+		return false;
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			if (((file[offset + y * rowBytes + x / 8] >> (7 - x % 8)) & 1) != modules.get(x / scale, y / scale))
+				return false;
+	return true;
+}
+
+static bool checkPGM(const BitMatrix& modules, int scale)
+{
+	int width = modules.width() * scale, height = modules.height() * scale;
+	auto file = writeRaster(&RasterWriter::WritePGM, modules, scale);
+	size_t offset = checkNetpbmHeader(file, "P5", width, height, "255\n");
+	if (offset == 0 || file.size() != offset + size_t(width) * height)
+		return false;
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			if (file[offset + y * width + x] != (modules.get(x / scale, y / scale) ? 0 : 255))
+				return false;
+	return true;
+}
+
+static bool checkPNG(const BitMatrix& modules, int scale)
+{
+	int width = modules.width() * scale, height = modules.height() * scale, rowBytes = (width + 7) / 8;
+	auto file = writeRaster(&RasterWriter::WritePNG, modules, scale);
+	static const uint8_t SIGNATURE[] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+	if (file.size() < sizeof(SIGNATURE) || !std::equal(SIGNATURE, SIGNATURE + sizeof(SIGNATURE), file.begin()))
+		return false;
+
+	// Walk the chunks: IHDR first, then IDAT only, and IEND at the very end, each with a valid CRC.
+	std::vector<uint8_t> zlib;
+	std::vector<std::string> types;
+	for (size_t pos = sizeof(SIGNATURE); pos < file.size();) {
+		if (pos + 12 > file.size())
+			return false;
+		uint32_t length = readBigEndian(&file[pos]);
+		if (pos + 12 + length > file.size() || bitwiseCrc32(&file[pos + 4], length + 4) != readBigEndian(&file[pos + 8 + length]))
+			return false;
+		std::string type(file.begin() + pos + 4, file.begin() + pos + 8);
+		const uint8_t* data = &file[pos + 8];
+		if (type == "IHDR") {
+			static const uint8_t HEADER[] = {1, 0, 0, 0, 0};
+			if (length != 13 || int(readBigEndian(data)) != width || int(readBigEndian(data + 4)) != height ||
+			    !std::equal(HEADER, HEADER + sizeof(HEADER), data + 8))
+				return false;
+		}
+		else if (type == "IDAT") {
+			zlib.insert(zlib.end(), data, data + length);
+		}
+		else if (type != "IEND" || length != 0) {
+			return false;
+		}
+		types.push_back(type);
+		pos += 12 + length;
+	}
+	if (types.size() < 3 || types.front() != "IHDR" || types.back() != "IEND" ||
+	    std::count(types.begin(), types.end(), "IDAT") != int(types.size()) - 2)
+		return false;
+
+	// zlib header, stored deflate blocks up to the final one, Adler-32 of the uncompressed data
+	if (zlib.size() < 6 || zlib[0] != 0x78 || ((zlib[0] << 8) | zlib[1]) % 31 != 0 || (zlib[1] & 0x20) != 0)
+		return false;
+	std::vector<uint8_t> scanlines;
+	size_t pos = 2;
+	for (bool final = false; !final;) {
+		if (pos + 5 > zlib.size() || (zlib[pos] & 0x06) != 0)
+			return false;
+		final = (zlib[pos] & 1) != 0;
+		int length = zlib[pos + 1] | (zlib[pos + 2] << 8);
+		int inverted = zlib[pos + 3] | (zlib[pos + 4] << 8);
+		if ((length ^ inverted) != 0xffff || pos + 5 + length > zlib.size())
+			return false;
+		scanlines.insert(scanlines.end(), zlib.begin() + pos + 5, zlib.begin() + pos + 5 + length);
+		pos += 5 + length;
+	}
+	if (pos + 4 != zlib.size() || readBigEndian(&zlib[pos]) != adler32(scanlines))
+		return false;
+
+	// Filter type 0 in front of each row, 0 is black
+	if (scanlines.size() != size_t(rowBytes + 1) * height)
+		return false;
+	for (int y = 0; y < height; ++y) {
+		const uint8_t* row = &scanlines[y * (rowBytes + 1)];
+		if (row[0] != 0)
+			return false;
+		for (int x = 0; x < width; ++x)
+			if (((row[1 + x / 8] >> (7 - x % 8)) & 1) == modules.get(x / scale, y / scale))
+				return false;
+	}
+	return true;
+}
+
+// The written images must show the modules at the given scale, with rows that do not end on a byte boundary.
+static bool checkRasterWriter()
+{
+	BitMatrix modules(23, 17);
+	unsigned state = 11;
+	for (int y = 0; y < modules.height(); ++y)
+		for (int x = 0; x < modules.width(); ++x)
+			if (((state = state * 1103515245u + 12345u) >> 16) & 1)
+				modules.set(x, y);
+
+	bool passed = true;
+	for (int scale : {1, 3, 7}) {
+		auto suffix = " scale " + std::to_string(scale);
+		passed &= check("RasterWriter PBM" + suffix, checkPBM(modules, scale));
+		passed &= check("RasterWriter PGM" + suffix, checkPGM(modules, scale));
+		passed &= check("RasterWriter PNG" + suffix, checkPNG(modules, scale));
+	}
+	return passed;
+}
+
+// Messages that switch between the character sets of the Data Matrix encodations every few characters,
+// with a Macro 05 header and trailer on some of them. They are short enough for symbols up to 48x48.
+static std::vector<std::wstring> dataMatrixMessages()
+{
+	static const char* ALPHABETS[] = {
+		"0123456789", "ABCDEFGHIJKLMNOPQRSTUVWXYZ 0123456789", "abcdefghijklmnopqrstuvwxyz 0123",
+		"ABC*>\r 0123", "!\"#$%&'()*+,-./:;<=>?@[\\]^ABC", nullptr,
+	};
+	std::vector<std::wstring> messages = {
+		L"A", L"123456", L"ABCDEFGHIJ", L"abcdefghij", L"ABC>*\rXYZ>*\r", L"ABC@DEF^GHI",
+		L"\u00E4\u00F6\u00FC\u00DF", L"1234\u00E9abcd", L"Hello, World!",
+	};
+	unsigned state = 42;
+	auto random = [&state](unsigned n) {
+		state = state * 1103515245u + 12345u;
+		return (state >> 16) % n;
+	};
+	for (int i = 0; i < 1000; ++i) {
+		int length = 1 + random(i % 10 == 0 ? 100 : 50);
+		std::wstring message;
+		const char* alphabet = nullptr;
+		for (int run = 0, j = 0; j < length; ++j) {
+			if (run-- <= 0) {
+				run = random(12);
+				alphabet = ALPHABETS[random(6)];
+			}
+			if (alphabet) {
+				message.push_back(static_cast<unsigned char>(alphabet[random(static_cast<unsigned>(std::strlen(alphabet)))]));
+			}
+			else {
+				int c = 1 + random(222);
+				message.push_back(static_cast<wchar_t>(c < 128 ? c : c + 32));
+			}
+		}
+		if (i % 7 == 0)
+			message = L"[)>\x1E" L"05\x1D" + message + L"\x1E\x04";
+		messages.push_back(message);
+	}
+	return messages;
+}
+
+// The minimal encodation must read back as the message and never take more codewords than the legacy one.
+// Symbols of 52x52 and larger have several interleaved blocks, which do not read back with either encodation
+// yet, so the messages stay below that.
+static bool checkDataMatrixEncoder()
+{
+	int failures = 0, larger = 0, smaller = 0;
+	for (const auto& message : dataMatrixMessages()) {
+		std::vector<int> minimal, legacy;
+		DataMatrix::HighLevelEncoder::EncodeMinimal(message, DataMatrix::SymbolShape::NONE, -1, -1, -1, -1, minimal);
+		if (minimal.size() > 174) {
+			failures++;
+			continue;
+		}
+		BitMatrix symbol;
+		DataMatrix::Writer().encode(message, 0, 0, symbol);
+		DecoderResult result;
+		if (StatusIsError(DataMatrix::Decoder::Decode(symbol, result)) || result.text() != message)
+			failures++;
+
+		// Only compare with legacy symbols that read back, some with extended characters do not.
+		BitMatrix legacySymbol;
+		DecoderResult legacyResult;
+		try {
+			DataMatrix::HighLevelEncoder::Encode(message, DataMatrix::SymbolShape::NONE, -1, -1, -1, -1, legacy);
+			DataMatrix::Writer().setLegacyEncoding(true).encode(message, 0, 0, legacySymbol);
+		}
+		catch (const std::exception&) {
+			continue;
+		}
+		if (StatusIsError(DataMatrix::Decoder::Decode(legacySymbol, legacyResult)) || legacyResult.text() != message)
+			continue;
+		larger += minimal.size() > legacy.size();
+		smaller += minimal.size() < legacy.size();
+	}
+	return check("DataMatrix::Writer minimal encodation", failures == 0 && larger == 0 && smaller > 0);
+}
+
+#endif // ZXING_TEST_ENCODERS
+
+int main()
+{
+	bool passed = true;
+
+	for (int degreeCW : {90, 180, 270})
+		passed &= checkRotation(degreeCW);
+	passed &= checkPdf417ClosestCodeword();
+	passed &= checkLuminanceGridSampler();
+
+#ifdef ZXING_TEST_ENCODERS
+	passed &= checkReedSolomonEncoder("QRCodeField256", GenericGF::QRCodeField256());
+	passed &= checkReedSolomonEncoder("DataMatrixField256", GenericGF::DataMatrixField256());
+	passed &= checkReedSolomonEncoder("AztecData6", GenericGF::AztecData6());
+	passed &= checkReedSolomonEncoder("AztecData8", GenericGF::AztecData8());
+	passed &= checkReedSolomonEncoder("AztecData10", GenericGF::AztecData10());
+	passed &= checkReedSolomonEncoder("AztecData12", GenericGF::AztecData12());
+	passed &= checkReedSolomonEncoderThreads();
+	passed &= checkBatchWriter();
+	passed &= checkQRMaskPenalties();
+	passed &= checkRasterWriter();
+	passed &= checkDataMatrixEncoder();
+#endif
+
+	std::cout << (passed ? "All component tests passed." : "Some component tests failed.") << std::endl;
+	return passed ? 0 : 1;
+}
@@ -24,9 +24,19 @@
 #include "TextDecoder.h"
 #include "TextUtfEncoding.h"
 #include "ZXContainerAlgorithms.h"
-
+#include "BlackboxImages.h"
+#include "pdf417/PDFReader.h"
+#include "pdf417/PDFDecoderResultExtra.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <iomanip>
 #include <fstream>
+#include <map>
+#include <sstream>
 #include <streambuf>
 #include <string>
 #include <memory>
@@ -34,50 +44,10 @@
 #include <unordered_set>
 #include <chrono>
 #include <stdexcept>
-
-#include <boost/filesystem.hpp>
-
-namespace fs = boost::filesystem;
+#include <thread>
 
 using namespace ZXing;
-
-static std::vector<fs::path> getImagesInDirectory(const fs::path& dirPath)
-{
-	std::vector<fs::path> result;
-	for (fs::directory_iterator i(dirPath); i != fs::directory_iterator(); ++i)
-		if (is_regular_file(i->status()) && i->path().extension() == ".png")
-			result.push_back(i->path());
-	return result;
-}
-
-static std::shared_ptr<LuminanceSource> readPNM(FILE* f)
-{
-	int w, h;
-	if (fscanf(f, "P5\n%d %d\n255\n", &w, &h) != 2)
-		throw std::runtime_error("Failed to parse PNM file header.");
-	auto ba = std::make_shared<ByteArray>(w * h);
-	auto read = fread(ba->data(), sizeof(uint8_t), w*h, f);
-//	if (read != w * h)
-//		throw std::runtime_error("Failed to read PNM file data: " + std::to_string(read) + " != " + std::to_string(w * h) + " -> " + std::to_string(feof(f)));
-	return std::make_shared<GenericLuminanceSource>(0, 0, w, h, ba, w);
-}
-
-static std::shared_ptr<LuminanceSource> readImage(const fs::path& filename)
-{
-	std::string cmd = "convert " + filename.native() + " -intensity Rec601Luma -colorspace gray pgm:-";
-	bool pipe = filename.extension() != ".pgm";
-	FILE* f = pipe ? popen(cmd.c_str(), "r") : fopen(filename.c_str(), "r");
-	if (!f)
-		throw std::runtime_error("Failed to open pipe '" + cmd + "': " + std::strerror(errno));
-	try {
-		auto res = readPNM(f);
-		pipe ? pclose(f) : fclose(f);
-		return res;
-	} catch (std::runtime_error& e) {
-		pipe ? pclose(f) : fclose(f);
-		throw std::runtime_error("Failed to read pipe '" + cmd + "': " + e.what());
-	}
-}
+using namespace ZXing::Test;
 
 class TestReader
 {
@@ -115,6 +85,13 @@ public:
 		return {};
 	}
 
+	// Decodes the given image without touching the cache, hence it can be called from several threads,
+	// each with its own TestReader.
+	bool decode(const BinaryBitmap& image, int rotation) const
+	{
+		return _reader->read(*image.rotated(rotation)).isValid();
+	}
+
 	static void clearCache() { _cache.clear(); }
 };
 
@@ -233,6 +210,223 @@ static void doRunTests(std::ostream& cout, const fs::path& directory, const char
 	}
 }
 
+/**
+* Reads Macro PDF417 files spread over several symbols per image and several images with
+* Pdf417::Reader::decodeMultiple(). The images of a file are named <file>-<part>.png, its content is in
+* <file>.bin. The segments are put in the order of their segment index and must add up to the content,
+* when decoded on the calling thread only as well as on several threads.
+*/
+static void doRunPdf417MultipleTests(std::ostream& cout, const fs::path& directory, size_t totalTests)
+{
+	auto images = getImagesInDirectory(pathPrefix / directory);
+	auto folderName = directory.filename();
+
+	if (images.size() != totalTests) {
+		cout << "TEST " << folderName << " => Expected number of tests: " << totalTests
+		    << ", got: " << images.size() << " => " << BAD << std::endl;
+	}
+
+	cout << "TEST " << folderName << ", multiple symbols, total: " << images.size() << "\n";
+	for (int threadCount : {1, 4}) {
+		Pdf417::Reader reader;
+		reader.setThreadCount(threadCount);
+		std::map<fs::path, std::map<int, std::wstring>> segments; // file -> segment index -> text
+		for (const fs::path& imagePath : images) {
+			auto file = imagePath.parent_path() / imagePath.stem().string().substr(0, imagePath.stem().string().find('-'));
+			segments[file];
+			for (const auto& result : reader.decodeMultiple(HybridBinarizer(readImage(imagePath)))) {
+				auto extra = std::dynamic_pointer_cast<Pdf417::DecoderResultExtra>(result.metadata().getCustomData(ResultMetadata::PDF417_EXTRA_METADATA));
+				segments[file][extra ? extra->segmentIndex() : -1] = result.text();
+			}
+		}
+
+		std::vector<std::string> misReadFiles;
+		for (const auto& file : segments) {
+			std::wstring text;
+			for (const auto& segment : file.second)
+				text += segment.second;
+			std::ifstream latin1Stream(fs::path(file.first).replace_extension(".bin").native(), std::ios::binary);
+			std::wstring expected = ZXing::TextDecoder::FromLatin1(
+			    std::string((std::istreambuf_iterator<char>(latin1Stream)), std::istreambuf_iterator<char>()));
+			if (!latin1Stream || text != expected)
+				misReadFiles.push_back(file.first.filename().string());
+		}
+
+		auto passCount = segments.size() - misReadFiles.size();
+		cout << "    Files read (" << threadCount << (threadCount == 1 ? " thread" : " threads") << "): " << passCount
+		     << " of " << segments.size() << " => " << goodOrBad(misReadFiles.empty()) << "\n";
+		if (!misReadFiles.empty()) {
+			cout << "    Read error:";
+			for (const auto& f : misReadFiles)
+				cout << ' ' << f;
+			cout << "\n";
+		}
+	}
+	cout << std::endl;
+}
+
+/**
+* The performance mode (-perf) decodes every image of the selected tests 'runs' times after 'warmup' untimed
+* runs, optionally spread across several threads. The latencies of the single decode calls are collected per
+* barcode format and fast/slow TestReader and reported as images/s and p50/p95/p99 latency, as text and as
+* JSON. The JSON file can be used as baseline of a later run to flag regressions.
+*/
+struct PerfOptions
+{
+	bool enabled = false;
+	int runs = 10;
+	int warmup = 1;
+	int threads = 1;
+	double tolerance = 10; // in percent
+	std::string jsonFile;
+	std::string baselineFile;
+};
+
+struct PerfStats
+{
+	std::vector<double> latencies; // in microseconds
+	double wallSeconds = 0;
+
+	double imagesPerSecond() const { return wallSeconds > 0 ? latencies.size() / wallSeconds : 0; }
+
+	// Nearest-rank percentile, latencies must be sorted.
+	double percentile(double p) const
+	{
+		if (latencies.empty())
+			return 0;
+		int rank = static_cast<int>(std::ceil(p / 100 * latencies.size()));
+		return latencies[std::max(rank, 1) - 1];
+	}
+};
+
+static PerfOptions perfOptions;
+static std::map<std::string, PerfStats> perfResults; // key: "<format> <fast|slow>"
+
+static void doRunPerfTests(std::ostream& cout, const fs::path& directory, const char* format,
+                           const std::vector<TestCase>& tests)
+{
+	using Clock = std::chrono::steady_clock;
+
+	std::vector<std::shared_ptr<BinaryBitmap>> images;
+	for (const fs::path& imagePath : getImagesInDirectory(pathPrefix / directory))
+		images.push_back(std::make_shared<HybridBinarizer>(readImage(imagePath)));
+
+	const char* names[] = {"fast", "slow"};
+	for (auto& test : tests) {
+		for (int i = 0; i < Length(names); ++i) {
+			std::vector<std::vector<double>> latencies(perfOptions.threads);
+			std::atomic<size_t> nextWarmupImage(0), nextImage(0);
+			std::atomic<int> warmThreads(0);
+			Clock::time_point start;
+
+			// All threads first warm up on their share of the images and wait for each other, so that
+			// the wall time taken by the calling thread only covers the timed runs.
+			auto worker = [&](int thread) {
+				TestReader reader(i == 1, i == 1, format);
+				for (size_t n; (n = nextWarmupImage++) < images.size();) {
+					for (int run = 0; run < perfOptions.warmup; ++run)
+						reader.decode(*images[n], test.rotation);
+				}
+				++warmThreads;
+				while (warmThreads < perfOptions.threads)
+					std::this_thread::yield();
+				if (thread == 0)
+					start = Clock::now();
+				for (size_t n; (n = nextImage++) < images.size();) {
+					for (int run = 0; run < perfOptions.runs; ++run) {
+						auto begin = Clock::now();
+						reader.decode(*images[n], test.rotation);
+						latencies[thread].push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+					}
+				}
+			};
+
+			std::vector<std::thread> threads;
+			for (int t = 1; t < perfOptions.threads; ++t)
+				threads.emplace_back(worker, t);
+			worker(0);
+			for (auto& t : threads)
+				t.join();
+			double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+			PerfStats local;
+			auto& stats = perfResults[std::string(format) + " " + names[i]];
+			for (auto& l : latencies) {
+				local.latencies.insert(local.latencies.end(), l.begin(), l.end());
+				stats.latencies.insert(stats.latencies.end(), l.begin(), l.end());
+			}
+			local.wallSeconds = seconds;
+			stats.wallSeconds += seconds;
+			std::sort(local.latencies.begin(), local.latencies.end());
+
+			cout << "PERF " << directory.stem() << ", rotation: " << test.rotation << " (" << names[i]
+			     << "): " << std::fixed << std::setprecision(1) << local.imagesPerSecond() << " images/s, p50: "
+			     << local.percentile(50) << " us, p95: " << local.percentile(95) << " us, p99: "
+			     << local.percentile(99) << " us" << std::defaultfloat << "\n";
+		}
+	}
+}
+
+static void writePerfJson(std::ostream& out)
+{
+	out << "{\n\t\"runs\": " << perfOptions.runs << ",\n\t\"threads\": " << perfOptions.threads << ",\n\t\"results\": [";
+	bool first = true;
+	for (auto& r : perfResults) {
+		auto& stats = r.second;
+		auto split = r.first.find(' ');
+		out << (first ? "\n" : ",\n") << "\t\t{ \"format\": \"" << r.first.substr(0, split) << "\", \"reader\": \""
+		    << r.first.substr(split + 1) << "\", \"decodes\": " << stats.latencies.size() << std::fixed
+		    << std::setprecision(2) << ", \"images_per_second\": " << stats.imagesPerSecond()
+		    << ", \"p50_us\": " << stats.percentile(50) << ", \"p95_us\": " << stats.percentile(95)
+		    << ", \"p99_us\": " << stats.percentile(99) << std::defaultfloat << " }";
+		first = false;
+	}
+	out << "\n\t]\n}\n";
+}
+
+// Extracts the value of "key" from a line of the JSON written by writePerfJson (one result per line).
+static std::string jsonValue(const std::string& line, const std::string& key)
+{
+	auto pos = line.find("\"" + key + "\":");
+	if (pos == std::string::npos)
+		return {};
+	pos = line.find_first_not_of(" \"", pos + key.size() + 3);
+	auto end = line.find_first_of(",\"}", pos);
+	return line.substr(pos, end - pos);
+}
+
+static bool comparePerfBaseline(std::ostream& cout, const std::string& filename)
+{
+	std::ifstream in(filename);
+	if (!in)
+		throw std::runtime_error("Failed to open baseline " + filename);
+
+	bool passed = true;
+	double tolerance = 1 + perfOptions.tolerance / 100;
+	std::string line;
+	while (std::getline(in, line)) {
+		auto format = jsonValue(line, "format");
+		if (format.empty())
+			continue;
+		auto key = format + " " + jsonValue(line, "reader");
+		auto current = perfResults.find(key);
+		if (current == perfResults.end())
+			continue;
+		double baseThroughput = std::atof(jsonValue(line, "images_per_second").c_str());
+		double baseP50 = std::atof(jsonValue(line, "p50_us").c_str());
+		double baseP95 = std::atof(jsonValue(line, "p95_us").c_str());
+		auto& stats = current->second;
+		bool ok = stats.imagesPerSecond() * tolerance >= baseThroughput && stats.percentile(50) <= baseP50 * tolerance &&
+		          stats.percentile(95) <= baseP95 * tolerance;
+		cout << "COMPARE " << key << ": " << std::fixed << std::setprecision(1) << stats.imagesPerSecond()
+		     << " images/s (baseline: " << baseThroughput << "), p50: " << stats.percentile(50) << " us (baseline: "
+		     << baseP50 << "), p95: " << stats.percentile(95) << " us (baseline: " << baseP95 << ")"
+		     << std::defaultfloat << " => " << goodOrBad(ok) << "\n";
+		passed &= ok;
+	}
+	return passed;
+}
+
 struct FalsePositiveTestCase
 {
 	int maxAllowed; // Maximum number of images which can fail due to successfully reading the wrong contents
@@ -283,7 +477,8 @@ static void doRunFalsePositiveTests(std::ostream& cout, const fs::path& director
 int main(int argc, char** argv)
 {
 	if (argc <= 1) {
-		std::cout << "Usage: " << argv[0] << " <test_path_prefix>" << std::endl;
+		std::cout << "Usage: " << argv[0] << " <test_path_prefix> [-t<test>...] [-perf [-runs<n>] [-warmup<n>] [-threads<n>]"
+		          << " [-json<file>] [-baseline<file>] [-tolerance<percent>]]" << std::endl;
 		return 0;
 	}
 
@@ -302,8 +497,25 @@ int main(int argc, char** argv)
 
 	std::unordered_set<std::string> includedTests;
 	for (int i = 2; i < argc; ++i) {
-		if (std::strlen(argv[i]) > 2 && argv[i][0] == '-' && argv[i][1] == 't')
-			includedTests.insert(argv[i] + 2);
+		std::string arg = argv[i];
+		auto option = [&arg](const char* name) { return arg.compare(0, std::strlen(name), name) == 0; };
+		auto value = [&arg](const char* name) { return arg.substr(std::strlen(name)); };
+		if (arg == "-perf")
+			perfOptions.enabled = true;
+		else if (option("-runs"))
+			perfOptions.runs = std::max(1, std::stoi(value("-runs")));
+		else if (option("-warmup"))
+			perfOptions.warmup = std::max(0, std::stoi(value("-warmup")));
+		else if (option("-threads"))
+			perfOptions.threads = std::max(1, std::stoi(value("-threads")));
+		else if (option("-tolerance"))
+			perfOptions.tolerance = std::stod(value("-tolerance"));
+		else if (option("-json"))
+			perfOptions.jsonFile = value("-json");
+		else if (option("-baseline"))
+			perfOptions.baselineFile = value("-baseline");
+		else if (arg.size() > 2 && option("-t"))
+			includedTests.insert(value("-t"));
 	}
 
 	auto& out = std::cout;
@@ -315,16 +527,27 @@ int main(int argc, char** argv)
 	};
 
 	auto runTests = [&](const fs::path& directory, const char* format, int total, const std::vector<TestCase>& tests) {
-		if (hasTest(directory))
+		if (!hasTest(directory))
+			return;
+		if (perfOptions.enabled)
+			doRunPerfTests(out, directory, format, tests);
+		else
 			doRunTests(out, directory, format, total, tests);
 	};
 
 	auto runFalsePositiveTests = [&](const fs::path& directory, int total,
 	                                 const std::vector<FalsePositiveTestCase>& tests) {
-		if (hasTest(directory))
+		if (hasTest(directory) && !perfOptions.enabled)
 			doRunFalsePositiveTests(out, directory, total, tests);
 	};
 
+	auto runPdf417MultipleTests = [&](const fs::path& directory, int total) {
+		if (hasTest(directory) && !perfOptions.enabled)
+			doRunPdf417MultipleTests(out, directory, total);
+	};
+
+	bool passed = true;
+
 	try
 	{
 		auto startTime = std::chrono::steady_clock::now();
@@ -579,6 +802,8 @@ int main(int argc, char** argv)
 			{ 18, 18, 180 },
 		});
 
+		runPdf417MultipleTests("blackbox/pdf417-4", 3);
+
 		runFalsePositiveTests("blackbox/falsepositives-1", 22, {
 			{ 2, 0   },
 			{ 2, 90  },
@@ -597,9 +822,25 @@ int main(int argc, char** argv)
 		auto duration = std::chrono::steady_clock::now() - startTime;
 
 		std::cout << "Total time: " << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << " ms." << std::endl;
+
+		if (perfOptions.enabled) {
+			for (auto& r : perfResults)
+				std::sort(r.second.latencies.begin(), r.second.latencies.end());
+			if (perfOptions.jsonFile.empty()) {
+				writePerfJson(std::cout);
+			} else {
+				std::ofstream json(perfOptions.jsonFile);
+				writePerfJson(json);
+			}
+			if (!perfOptions.baselineFile.empty())
+				passed = comparePerfBaseline(std::cout, perfOptions.baselineFile);
+		}
 	} catch (const std::exception& e) {
 		std::cout << e.what() << std::endl;
+		passed = false;
 	} catch (...) {
 		std::cout << "Internal error" << std::endl;
+		passed = false;
 	}
+	return passed ? 0 : 1;
 }